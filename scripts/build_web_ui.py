@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+Build the gzipped settings page into a C header
+
+Usage:
+    python build_web_ui.py [--check]
+
+Runs before every PlatformIO build (extra_scripts in platformio.ini) and
+can be run by hand. Reads web/settings.html, minifies it, gzips it and
+writes src/network/web_ui_gz.h:
+
+    WEB_UI_GZ[]          - gzipped page, a const array that stays in flash
+    WEB_UI_ETAG          - strong ETag (hash of the gzipped bytes)
+    WEB_UI_SOURCE_BYTES  - size of web/settings.html
+
+The header is only rewritten when its content changes, so an unchanged
+page does not trigger a rebuild. --check prints the sizes without
+writing anything.
+
+Minifying is line-based and conservative: indentation, blank lines and
+whole-line comments go; every line break stays so no JavaScript
+statement is joined to the next.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "web", "settings.html")
+OUTPUT = os.path.join(ROOT, "src", "network", "web_ui_gz.h")
+
+WHOLE_LINE_COMMENT = re.compile(r"^(//.*|/\*.*\*/|<!--.*-->)$")
+
+
+def minify(html: str) -> str:
+    lines = []
+    for line in html.splitlines():
+        line = line.strip()
+        if not line or WHOLE_LINE_COMMENT.match(line):
+            continue
+        lines.append(line)
+    return "\n".join(lines) + "\n"
+
+
+def build():
+    with open(SOURCE, "rb") as f:
+        source = f.read()
+
+    minified = minify(source.decode("utf-8")).encode("utf-8")
+    # mtime=0 so the same page always gives the same bytes (and ETag)
+    gz = gzip.compress(minified, compresslevel=9, mtime=0)
+    etag = hashlib.sha256(gz).hexdigest()[:16]
+    return source, minified, gz, etag
+
+
+def render(source: bytes, gz: bytes, etag: str) -> str:
+    rows = []
+    for i in range(0, len(gz), 16):
+        rows.append("    " + ", ".join(f"0x{b:02x}" for b in gz[i:i + 16]) + ",")
+
+    return (
+        "/**\n"
+        " * @file web_ui_gz.h\n"
+        " * @brief Gzipped settings page - generated by scripts/build_web_ui.py\n"
+        " *\n"
+        " * Do not edit: change web/settings.html instead.\n"
+        " */\n"
+        "\n"
+        "#ifndef WEB_UI_GZ_H\n"
+        "#define WEB_UI_GZ_H\n"
+        "\n"
+        "#include <stdint.h>\n"
+        "\n"
+        f"#define WEB_UI_SOURCE_BYTES {len(source)}\n"
+        f"#define WEB_UI_ETAG \"\\\"{etag}\\\"\"\n"
+        "\n"
+        f"static const uint8_t WEB_UI_GZ[{len(gz)}] = {{\n"
+        + "\n".join(rows) + "\n"
+        "};\n"
+        "\n"
+        "#endif // WEB_UI_GZ_H\n"
+    )
+
+
+def main(check: bool = False):
+    source, minified, gz, etag = build()
+    print(f"[web_ui] settings.html {len(source)} B -> minified {len(minified)} B "
+          f"-> gzip {len(gz)} B, ETag {etag}")
+    if check:
+        return
+
+    header = render(source, gz, etag)
+    try:
+        with open(OUTPUT) as f:
+            if f.read() == header:
+                return
+    except FileNotFoundError:
+        pass
+    with open(OUTPUT, "w") as f:
+        f.write(header)
+
+
+try:
+    # PlatformIO pre-script
+    Import("env")  # noqa: F821
+    main()
+except NameError:
+    if __name__ == "__main__":
+        main("--check" in sys.argv[1:])
@@ -0,0 +1,463 @@
+#!/usr/bin/env python3
+"""
+Run a stand-in LLM provider that checks the shape of DeskBuddy's requests
+
+Usage:
+    python llm_standin.py [--port 8444] [--latency 0.3] [--device IP]
+                          [--min-cache-tokens 1024]
+
+Arguments:
+    --port             - HTTPS port (default: 8444, the firmware's LLM_STANDIN_PORT)
+    --latency          - Seconds before the response headers (default: 0.3)
+    --device           - DeskBuddy IP: compare its promptCache counters with
+                         what the stand-in reported after each request
+    --min-cache-tokens - Shortest prefix the stand-in caches, like the
+                         providers' minimum (default: 1024)
+    --cert/--key       - TLS certificate and key (default: a self-signed pair
+                         made with openssl)
+
+Example:
+    python llm_standin.py --device 192.168.1.42
+
+Build the firmware with the stand-in's address, e.g. in platformio.ini
+    build_flags = ... -DLLM_STANDIN_HOST=\\"192.168.1.10\\"
+and both providers (Claude and OpenAI paths) are sent here. The device
+skips certificate checks, so the self-signed certificate works. Then talk
+to the assistant for a few turns, on either provider.
+
+Every request body is checked, and each check prints PASS/FAIL:
+
+- Claude order: the top-level keys come as tools, system, messages, the
+  order the provider builds its cache prefix in.
+- Claude breakpoints: system is a list of text blocks whose last block has
+  cache_control {"type": "ephemeral"}, and the last tool, and only that
+  one, has the same.
+- OpenAI order: the system message is messages[0].
+- tool order: tools are sorted by name, so MCP rediscovery in a different
+  order does not change the prefix.
+- stable: while the tool names and the system prompt stay the same, the
+  tools and system bytes are identical to the previous request's. A
+  changed tool set or prompt is reported, not failed.
+
+The reply is a short streamed answer (or a plain JSON one without
+"stream") whose usage plays the provider's cache: Claude reads the tools +
+system prefix from cache when the same bytes were seen before, and
+OpenAI the longest prefix shared with an earlier request, in 128-token
+steps. Tokens are counted as 4 bytes each. With --device, the device's
+cachedTokens must grow by exactly what the stand-in reported.
+"""
+
+import argparse
+import http.client
+import json
+import os
+import socket
+import ssl
+import subprocess
+import tempfile
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+CLAUDE_PATH = "/v1/messages"
+OPENAI_PATH = "/v1/chat/completions"
+EPHEMERAL = {"type": "ephemeral"}
+BYTES_PER_TOKEN = 4
+
+
+def tokens(n_bytes: int) -> int:
+    return n_bytes // BYTES_PER_TOKEN
+
+
+def skip_ws(text: str, i: int) -> int:
+    while i < len(text) and text[i] in " \t\r\n":
+        i += 1
+    return i
+
+
+def raw_members(text: str):
+    """(key, raw value) of a JSON object's members, in the order sent"""
+    decoder = json.JSONDecoder()
+    members = []
+    i = skip_ws(text, 0)
+    if text[i] != "{":
+        raise ValueError("body is not an object")
+    i = skip_ws(text, i + 1)
+    while text[i] != "}":
+        key, i = decoder.raw_decode(text, i)
+        i = skip_ws(text, i)
+        if text[i] != ":":
+            raise ValueError(f"expected ':' after \"{key}\"")
+        start = skip_ws(text, i + 1)
+        _, end = decoder.raw_decode(text, start)
+        members.append((key, text[start:end]))
+        i = skip_ws(text, end)
+        if text[i] == ",":
+            i = skip_ws(text, i + 1)
+    return members
+
+
+def raw_items(text: str):
+    """Raw text of each element of a JSON array"""
+    decoder = json.JSONDecoder()
+    items = []
+    i = skip_ws(text, 1)
+    while text[i] != "]":
+        _, end = decoder.raw_decode(text, i)
+        items.append(text[i:end])
+        i = skip_ws(text, end)
+        if text[i] == ",":
+            i = skip_ws(text, i + 1)
+    return items
+
+
+class Checks:
+    def __init__(self):
+        self.lines = []
+        self.failed = 0
+
+    def check(self, name: str, ok: bool, detail: str):
+        self.lines.append(f"    {'PASS' if ok else 'FAIL'}  {name:18s} {detail}")
+        if not ok:
+            self.failed += 1
+
+    def note(self, name: str, detail: str):
+        self.lines.append(f"    ----  {name:18s} {detail}")
+
+
+def tool_name(tool: dict) -> str:
+    return tool.get("name") or tool.get("function", {}).get("name", "")
+
+
+def check_tools(checks: Checks, tools: list):
+    names = [tool_name(t) for t in tools]
+    checks.check("tool order", names == sorted(names),
+                 f"{len(names)} tools" + ("" if names == sorted(names) else
+                                          f", first out of order: {next(b for a, b in zip(names, names[1:]) if b < a)}"))
+
+
+def check_stable(checks: Checks, previous: dict, current: dict, provider: str):
+    """Same tool names and prompt as last time must mean the same bytes,
+    whatever order the tools were registered in"""
+    if previous is None:
+        checks.note("stable", f"first {provider} request")
+        return
+    if previous["tool_names"] != current["tool_names"]:
+        checks.note("stable", "tool set changed since the last request")
+    else:
+        checks.check("stable", previous["tools_raw"] == current["tools_raw"],
+                     f"tools block {len(current['tools_raw'])} bytes")
+    if previous["system_text"] != current["system_text"]:
+        checks.note("stable", "system prompt changed since the last request")
+    else:
+        checks.check("stable", previous["system_raw"] == current["system_raw"],
+                     f"system block {len(current['system_raw'])} bytes")
+
+
+def check_claude(checks: Checks, body: str, members: list):
+    order = [k for k, _ in members if k in ("tools", "system", "messages")]
+    expected = [k for k in ("tools", "system", "messages") if k in order]
+    checks.check("Claude order", order == expected and "system" in order,
+                 " -> ".join(order))
+
+    raw = dict(members)
+    request = json.loads(body)
+    system = request.get("system")
+    if isinstance(system, list) and system:
+        last = system[-1]
+        checks.check("system breakpoint",
+                     last.get("type") == "text" and last.get("cache_control") == EPHEMERAL,
+                     f"{len(system)} block(s), last cache_control {last.get('cache_control')}")
+        system_text = "".join(b.get("text", "") for b in system)
+        system_marked = last.get("cache_control") == EPHEMERAL
+    else:
+        checks.check("system breakpoint", False, "system is a plain string, nothing to cache")
+        system_text = system or ""
+        system_marked = False
+
+    tools = request.get("tools", [])
+    tools_marked = bool(tools) and tools[-1].get("cache_control") == EPHEMERAL
+    if tools:
+        marked = [i for i, t in enumerate(tools) if "cache_control" in t]
+        checks.check("tools breakpoint",
+                     marked == [len(tools) - 1] and tools[-1]["cache_control"] == EPHEMERAL,
+                     f"cache_control on tool(s) {marked} of {len(tools)}")
+        check_tools(checks, tools)
+
+    # Each breakpoint caches everything before it
+    prefixes = []
+    if tools_marked:
+        prefixes.append(raw["tools"])
+    if system_marked:
+        prefixes.append(raw.get("tools", "") + raw["system"])
+    return {
+        "tool_names": sorted(tool_name(t) for t in tools),
+        "tools_raw": raw.get("tools", ""),
+        "system_text": system_text,
+        "system_raw": raw.get("system", ""),
+        "prefixes": prefixes,
+        "stream": request.get("stream", False),
+    }
+
+
+def check_openai(checks: Checks, body: str, members: list):
+    raw = dict(members)
+    request = json.loads(body)
+    messages = request.get("messages", [])
+    first = messages[0] if messages else {}
+    checks.check("OpenAI order", first.get("role") == "system",
+                 f"messages[0] is {first.get('role', 'missing')}")
+
+    tools = request.get("tools", [])
+    if tools:
+        check_tools(checks, tools)
+
+    system_raw = raw_items(raw["messages"])[0] if messages else ""
+    # OpenAI renders tools ahead of the messages; the cache key is that prefix
+    return {
+        "tool_names": sorted(tool_name(t) for t in tools),
+        "tools_raw": raw.get("tools", ""),
+        "system_text": first.get("content", ""),
+        "system_raw": system_raw,
+        "prefix": raw.get("tools", "") + raw.get("messages", ""),
+        "stream": request.get("stream", False),
+    }
+
+
+def common_prefix(a: str, b: str) -> int:
+    n = min(len(a), len(b))
+    i = 0
+    while i < n and a[i] == b[i]:
+        i += 1
+    return i
+
+
+class ProviderCache:
+    """What the provider would have read from its prompt cache"""
+
+    def __init__(self, min_tokens: int):
+        self.min_tokens = min_tokens
+        self.claude = set()
+        self.openai = []
+
+    def claude_usage(self, prefixes: list, total_bytes: int) -> dict:
+        """Read the longest breakpoint prefix seen before, write the rest"""
+        usage = {"cache_read_input_tokens": 0, "cache_creation_input_tokens": 0}
+        cacheable = [p for p in prefixes if tokens(len(p)) >= self.min_tokens]
+        hits = [p for p in cacheable if p in self.claude]
+        read = tokens(len(hits[-1])) if hits else 0
+        written = tokens(len(cacheable[-1])) - read if cacheable else 0
+        usage["cache_read_input_tokens"] = read
+        usage["cache_creation_input_tokens"] = written
+        usage["input_tokens"] = tokens(total_bytes) - read - written
+        self.claude.update(cacheable)
+        return usage
+
+    def openai_cached(self, prefix: str) -> int:
+        longest = max((common_prefix(prefix, p) for p in self.openai), default=0)
+        self.openai.append(prefix)
+        cached = tokens(longest) // 128 * 128
+        return cached if cached >= self.min_tokens else 0
+
+
+def claude_stream(reply: str, usage: dict) -> bytes:
+    events = [
+        ("message_start", {"type": "message_start", "message": {
+            "id": "msg_standin", "type": "message", "role": "assistant", "content": [],
+            "model": "standin", "stop_reason": None,
+            "usage": dict(usage, output_tokens=1)}}),
+        ("content_block_start", {"type": "content_block_start", "index": 0,
+                                 "content_block": {"type": "text", "text": ""}}),
+        ("content_block_delta", {"type": "content_block_delta", "index": 0,
+                                 "delta": {"type": "text_delta", "text": reply}}),
+        ("content_block_stop", {"type": "content_block_stop", "index": 0}),
+        ("message_delta", {"type": "message_delta", "delta": {"stop_reason": "end_turn"},
+                           "usage": {"output_tokens": tokens(len(reply))}}),
+        ("message_stop", {"type": "message_stop"}),
+    ]
+    return "".join(f"event: {e}\ndata: {json.dumps(d)}\n\n" for e, d in events).encode()
+
+
+def claude_message(reply: str, usage: dict) -> bytes:
+    return json.dumps({
+        "id": "msg_standin", "type": "message", "role": "assistant", "model": "standin",
+        "content": [{"type": "text", "text": reply}], "stop_reason": "end_turn",
+        "usage": dict(usage, output_tokens=tokens(len(reply)))}).encode()
+
+
+def openai_usage(prompt_tokens: int, cached: int, reply: str) -> dict:
+    return {"prompt_tokens": prompt_tokens, "completion_tokens": tokens(len(reply)),
+            "total_tokens": prompt_tokens + tokens(len(reply)),
+            "prompt_tokens_details": {"cached_tokens": cached}}
+
+
+def openai_stream(reply: str, usage: dict) -> bytes:
+    base = {"id": "chatcmpl-standin", "object": "chat.completion.chunk", "model": "standin"}
+    chunks = [
+        dict(base, choices=[{"index": 0, "delta": {"role": "assistant", "content": ""},
+                             "finish_reason": None}]),
+        dict(base, choices=[{"index": 0, "delta": {"content": reply}, "finish_reason": None}]),
+        dict(base, choices=[{"index": 0, "delta": {}, "finish_reason": "stop"}]),
+        dict(base, choices=[], usage=usage),
+    ]
+    return ("".join(f"data: {json.dumps(c)}\n\n" for c in chunks) + "data: [DONE]\n\n").encode()
+
+
+def openai_message(reply: str, usage: dict) -> bytes:
+    return json.dumps({
+        "id": "chatcmpl-standin", "object": "chat.completion", "model": "standin",
+        "choices": [{"index": 0, "message": {"role": "assistant", "content": reply},
+                     "finish_reason": "stop"}],
+        "usage": usage}).encode()
+
+
+def device_cache_stats(host: str) -> dict:
+    conn = http.client.HTTPConnection(host, 80, timeout=5)
+    conn.request("GET", "/api/assistant/status")
+    resp = conn.getresponse()
+    body = resp.read()
+    conn.close()
+    return json.loads(body).get("promptCache", {})
+
+
+def make_handler(args, state: dict, lock: threading.Lock):
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def log_message(self, fmt, *fmt_args):
+            pass
+
+        def do_POST(self):
+            length = int(self.headers.get("Content-Length", 0))
+            body = self.rfile.read(length).decode("utf-8", "replace")
+            if self.path not in (CLAUDE_PATH, OPENAI_PATH):
+                self.send_error(404)
+                return
+            provider = "Claude" if self.path == CLAUDE_PATH else "OpenAI"
+
+            checks = Checks()
+            try:
+                members = raw_members(body)
+                check = check_claude if provider == "Claude" else check_openai
+                shape = check(checks, body, members)
+            except (ValueError, KeyError, IndexError, TypeError, AttributeError) as e:
+                checks.check("JSON", False, str(e))
+                shape = None
+
+            with lock:
+                state["requests"] += 1
+                number = state["requests"]
+                if shape:
+                    check_stable(checks, state["last"].get(provider), shape, provider)
+                    state["last"][provider] = shape
+                state["failed"] += checks.failed
+
+                reply = f"[happy] Stand-in reply {number}."
+                if shape and provider == "Claude":
+                    usage = state["cache"].claude_usage(shape["prefixes"], len(body))
+                    cached = usage["cache_read_input_tokens"]
+                    payload = (claude_stream if shape["stream"] else claude_message)(reply, usage)
+                else:
+                    cached = state["cache"].openai_cached(shape["prefix"]) if shape else 0
+                    usage = openai_usage(tokens(len(body)), cached, reply)
+                    stream = shape and shape["stream"]
+                    payload = (openai_stream if stream else openai_message)(reply, usage)
+                state["cached_tokens"] += cached
+
+            print(f"#{number} {provider} {len(body)} bytes, ~{tokens(len(body))} tokens, "
+                  f"{cached} from cache", flush=True)
+            print("\n".join(checks.lines), flush=True)
+
+            time.sleep(args.latency)
+            self.send_response(200)
+            streaming = shape is not None and shape["stream"]
+            self.send_header("Content-Type", "text/event-stream" if streaming else "application/json")
+            self.send_header("Content-Length", str(len(payload)))
+            self.end_headers()
+            self.wfile.write(payload)
+            self.wfile.flush()
+
+            if args.device:
+                threading.Timer(2.0, compare_device, args=(args, state, lock)).start()
+
+    return Handler
+
+
+def compare_device(args, state: dict, lock: threading.Lock):
+    """The device's cachedTokens must have grown by what the stand-in sent"""
+    try:
+        stats = device_cache_stats(args.device)
+    except (OSError, ValueError) as e:
+        print(f"    device: status unavailable ({e})", flush=True)
+        return
+    with lock:
+        if state["device_base"] is None:
+            # Unreachable at startup: count from here on
+            state["device_base"] = stats.get("cachedTokens", 0) - state["cached_tokens"]
+        grown = stats.get("cachedTokens", 0) - state["device_base"]
+        expected = state["cached_tokens"]
+    print(f"    {'PASS' if grown == expected else 'FAIL'}  {'device':18s} "
+          f"cachedTokens +{grown} (stand-in sent {expected}), "
+          f"{stats.get('hits', 0)}/{stats.get('requests', 0)} requests hit, "
+          f"hit rate {stats.get('hitRate', 0):.2f}", flush=True)
+
+
+def self_signed_cert(directory: str):
+    cert = os.path.join(directory, "cert.pem")
+    key = os.path.join(directory, "key.pem")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes",
+                    "-keyout", key, "-out", cert, "-days", "30", "-subj", "/CN=llm-standin"],
+                   check=True, capture_output=True)
+    return cert, key
+
+
+def local_ip() -> str:
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        s.connect(("10.255.255.255", 1))
+        return s.getsockname()[0]
+    except OSError:
+        return "127.0.0.1"
+    finally:
+        s.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in LLM provider")
+    parser.add_argument("--port", type=int, default=8444)
+    parser.add_argument("--latency", type=float, default=0.3)
+    parser.add_argument("--device", default=None)
+    parser.add_argument("--min-cache-tokens", type=int, default=1024)
+    parser.add_argument("--cert", default=None)
+    parser.add_argument("--key", default=None)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        cert, key = (args.cert, args.key) if args.cert else self_signed_cert(tmp)
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(cert, key)
+
+        state = {"requests": 0, "failed": 0, "last": {}, "cached_tokens": 0,
+                 "device_base": None, "cache": ProviderCache(args.min_cache_tokens)}
+        lock = threading.Lock()
+        if args.device:
+            # Counters since boot, before this run's requests
+            try:
+                state["device_base"] = device_cache_stats(args.device).get("cachedTokens", 0)
+            except (OSError, ValueError) as e:
+                print(f"Device status unavailable ({e}), comparing from the first request on")
+        server = ThreadingHTTPServer(("0.0.0.0", args.port), make_handler(args, state, lock))
+        server.daemon_threads = True
+        server.socket = context.wrap_socket(server.socket, server_side=True)
+
+        print(f"LLM stand-in on https://{local_ip()}:{args.port} "
+              f"({CLAUDE_PATH} and {OPENAI_PATH})", flush=True)
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+        print(f"{state['requests']} requests, {state['failed']} failed checks")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+Compare MCP round trips: one request per call vs JSON-RPC batches
+
+Usage:
+    python mcp_batch_bench.py <url> [--calls 3] [--tool tool0] [--repeat 20]
+
+Arguments:
+    url       - MCP server base URL, e.g. http://192.168.1.42:3001 (a
+                DeskBuddy) or http://127.0.0.1:8100 (mcp_standin.py)
+    --calls   - tools/call requests per LLM response (default: 3)
+    --tool    - Tool to call (default: tool0, as mcp_standin.py names them)
+    --repeat  - Runs of each pattern; the median is reported (default: 20)
+
+Example:
+    python mcp_standin.py --latency 0.05 ok &
+    python mcp_batch_bench.py http://127.0.0.1:8100 --calls 4
+
+Both patterns POST to <url>/mcp on a new connection per request, as the
+MCP client does for plain HTTP servers:
+
+- Discovery: initialize, notifications/initialized and tools/list as
+  three requests, or as one batch.
+- Tool calls: --calls tools/call requests one after another, or as one
+  batch.
+
+Reported: HTTP requests, bytes sent and received, and wall time per
+pattern. The DeskBuddy counters are "batches" / "batchEntries" under
+"mcpServer" in /api/assistant/status.
+"""
+
+import argparse
+import http.client
+import json
+import statistics
+import sys
+import time
+from urllib.parse import urlparse
+
+INITIALIZE = {"jsonrpc": "2.0", "id": 1, "method": "initialize",
+              "params": {"protocolVersion": "2025-03-26", "capabilities": {},
+                         "clientInfo": {"name": "mcp_batch_bench", "version": "1.0"}}}
+INITIALIZED = {"jsonrpc": "2.0", "method": "notifications/initialized"}
+TOOLS_LIST = {"jsonrpc": "2.0", "id": 2, "method": "tools/list", "params": {}}
+
+
+class Counter:
+    def __init__(self):
+        self.requests = 0
+        self.sent = 0
+        self.received = 0
+
+
+def post(url, payload, counter: Counter):
+    """POST one JSON-RPC message or batch on its own connection"""
+    body = json.dumps(payload).encode()
+    conn = http.client.HTTPConnection(url.hostname, url.port or 80, timeout=10)
+    try:
+        conn.request("POST", "/mcp", body,
+                     {"Content-Type": "application/json", "Accept": "application/json"})
+        response = conn.getresponse()
+        data = response.read()
+    finally:
+        conn.close()
+
+    counter.requests += 1
+    counter.sent += len(body)
+    counter.received += len(data)
+    if response.status not in (200, 202):
+        raise RuntimeError(f"HTTP {response.status}")
+    return json.loads(data) if data else None
+
+
+def tool_calls(tool: str, count: int):
+    return [{"jsonrpc": "2.0", "id": 10 + i, "method": "tools/call",
+             "params": {"name": tool, "arguments": {"value": f"call {i}"}}}
+            for i in range(count)]
+
+
+def run(pattern, repeat: int):
+    """Return (median ms, counter averaged per run)"""
+    counter = Counter()
+    times = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        pattern(counter)
+        times.append((time.perf_counter() - start) * 1000)
+    return statistics.median(times), counter
+
+
+def check_batch_reply(reply, ids):
+    if not isinstance(reply, list):
+        raise RuntimeError(f"Batch answered with {type(reply).__name__}, not an array")
+    got = sorted(r.get("id") for r in reply)
+    if got != sorted(ids):
+        raise RuntimeError(f"Batch reply ids {got}, expected {sorted(ids)}")
+    for r in reply:
+        if "error" in r:
+            raise RuntimeError(f"Batch entry {r['id']}: {r['error'].get('message')}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="MCP batch vs single request benchmark")
+    parser.add_argument("url")
+    parser.add_argument("--calls", type=int, default=3)
+    parser.add_argument("--tool", default="tool0")
+    parser.add_argument("--repeat", type=int, default=20)
+    args = parser.parse_args()
+    url = urlparse(args.url)
+    calls = tool_calls(args.tool, args.calls)
+
+    def discovery_single(c):
+        post(url, INITIALIZE, c)
+        post(url, INITIALIZED, c)
+        post(url, TOOLS_LIST, c)
+
+    def discovery_batch(c):
+        check_batch_reply(post(url, [INITIALIZE, INITIALIZED, TOOLS_LIST], c), [1, 2])
+
+    def calls_single(c):
+        for call in calls:
+            reply = post(url, call, c)
+            if "error" in reply:
+                raise RuntimeError(f"tools/call: {reply['error'].get('message')}")
+
+    def calls_batch(c):
+        check_batch_reply(post(url, calls, c), [call["id"] for call in calls])
+
+    patterns = [
+        ("Discovery", discovery_single, discovery_batch),
+        (f"{args.calls} tool calls", calls_single, calls_batch),
+    ]
+
+    print(f"{args.url}, median of {args.repeat} runs")
+    try:
+        for name, single, batch in patterns:
+            for label, pattern in (("one per call", single), ("batched", batch)):
+                ms, c = run(pattern, args.repeat)
+                print(f"{name:14s} {label:13s} requests={c.requests // args.repeat:2d}  "
+                      f"sent={c.sent // args.repeat:5d} B  received={c.received // args.repeat:6d} B  "
+                      f"time={ms:7.1f} ms")
+    except (OSError, RuntimeError, ValueError) as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
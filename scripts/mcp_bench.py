@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""
+Compare MCP per-call latency: legacy SSE transport vs Streamable HTTP
+
+Usage:
+    python mcp_bench.py <device_ip> [--port 3001] [--calls 50] [--method NAME | --tool NAME]
+
+Arguments:
+    device_ip  - DeskBuddy IP address
+    --port     - MCP server port (default: 3001)
+    --calls    - Calls per transport (default: 50)
+    --method   - JSON-RPC method without params (default: ping), e.g. tools/list
+    --tool     - Call this tool (no arguments) instead
+
+Example:
+    python mcp_bench.py 192.168.1.42 --calls 100 --tool get_device_info
+    python mcp_bench.py 192.168.1.42 --method tools/list
+
+The device's own view (handling time, tools/list cost, response cache
+hits) is under "mcpServer" in /api/assistant/status.
+
+SSE: every call is a new TCP connection to POST /mcp/message, a 202 reply,
+and the result read back from the /sse stream.
+Streamable HTTP: every call is a POST /mcp on one kept-alive connection,
+with the result in the reply.
+"""
+
+import argparse
+import http.client
+import json
+import socket
+import statistics
+import sys
+import time
+
+
+def make_request(req_id: int, method: str, tool: str = None) -> bytes:
+    if tool:
+        msg = {"jsonrpc": "2.0", "id": req_id, "method": "tools/call",
+               "params": {"name": tool, "arguments": {}}}
+    else:
+        msg = {"jsonrpc": "2.0", "id": req_id, "method": method}
+    return json.dumps(msg).encode()
+
+
+INITIALIZE = {"jsonrpc": "2.0", "id": 0, "method": "initialize",
+              "params": {"protocolVersion": "2025-03-26", "capabilities": {},
+                         "clientInfo": {"name": "mcp_bench", "version": "1.0"}}}
+
+
+class SSEStream:
+    """Minimal reader for the legacy /sse stream"""
+
+    def __init__(self, host: str, port: int):
+        self.sock = socket.create_connection((host, port), timeout=10)
+        self.sock.sendall(f"GET /sse HTTP/1.1\r\nHost: {host}\r\n"
+                          "Accept: text/event-stream\r\n\r\n".encode())
+        self.buf = b""
+        self._read_until(b"\r\n\r\n")      # Response headers
+
+    def _read_until(self, marker: bytes) -> bytes:
+        while marker not in self.buf:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("SSE stream closed")
+            self.buf += chunk
+        data, self.buf = self.buf.split(marker, 1)
+        return data
+
+    def next_event(self):
+        """Return (event, data), skipping keepalive comments"""
+        while True:
+            block = self._read_until(b"\n\n").decode()
+            event, data = "message", ""
+            for line in block.split("\n"):
+                if line.startswith("event:"):
+                    event = line[6:].strip()
+                elif line.startswith("data:"):
+                    data += line[5:].strip()
+            if data:
+                return event, data
+
+    def close(self):
+        self.sock.close()
+
+
+def bench_sse(host: str, port: int, calls: int, method: str, tool: str) -> list:
+    stream = SSEStream(host, port)
+    event, endpoint = stream.next_event()
+    if event != "endpoint":
+        raise RuntimeError(f"Expected endpoint event, got {event}")
+
+    def call(body: bytes, req_id: int):
+        conn = http.client.HTTPConnection(host, port, timeout=10)
+        conn.request("POST", endpoint, body, {"Content-Type": "application/json"})
+        resp = conn.getresponse()
+        resp.read()
+        conn.close()
+        if resp.status != 202:
+            raise RuntimeError(f"POST {endpoint} -> {resp.status}")
+        while True:
+            _, data = stream.next_event()
+            if json.loads(data).get("id") == req_id:
+                return
+
+    call(json.dumps(INITIALIZE).encode(), 0)
+
+    times = []
+    for i in range(1, calls + 1):
+        start = time.perf_counter()
+        call(make_request(i, method, tool), i)
+        times.append((time.perf_counter() - start) * 1000)
+    stream.close()
+    return times
+
+
+def bench_streamable(host: str, port: int, calls: int, method: str, tool: str) -> list:
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    headers = {"Content-Type": "application/json",
+               "Accept": "application/json, text/event-stream"}
+
+    def call(body: bytes):
+        conn.request("POST", "/mcp", body, headers)
+        resp = conn.getresponse()
+        resp.read()
+        if resp.status != 200:
+            raise RuntimeError(f"POST /mcp -> {resp.status}")
+
+    call(json.dumps(INITIALIZE).encode())
+
+    times = []
+    for i in range(1, calls + 1):
+        start = time.perf_counter()
+        call(make_request(i, method, tool))
+        times.append((time.perf_counter() - start) * 1000)
+    conn.close()
+    return times
+
+
+def report(name: str, times: list):
+    times = sorted(times)
+    p95 = times[min(len(times) - 1, int(len(times) * 0.95))]
+    print(f"{name:16s} n={len(times):4d}  min={times[0]:7.1f}  "
+          f"median={statistics.median(times):7.1f}  p95={p95:7.1f}  "
+          f"mean={statistics.mean(times):7.1f} ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="MCP transport latency benchmark")
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=3001)
+    parser.add_argument("--calls", type=int, default=50)
+    parser.add_argument("--method", default="ping")
+    parser.add_argument("--tool", default=None)
+    args = parser.parse_args()
+
+    try:
+        sse = bench_sse(args.host, args.port, args.calls, args.method, args.tool)
+        streamable = bench_streamable(args.host, args.port, args.calls, args.method, args.tool)
+    except (OSError, RuntimeError) as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    report("SSE", sse)
+    report("Streamable HTTP", streamable)
+    print(f"Median speedup: {statistics.median(sse) / statistics.median(streamable):.2f}x")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,271 @@
+#!/usr/bin/env python3
+"""
+Check the MCP server's session table with several SSE clients at once
+
+Usage:
+    python mcp_sessions_test.py <device_ip> [--port 3001] [--web-port 80]
+                                [--calls 20] [--flood 60]
+
+Arguments:
+    device_ip  - DeskBuddy IP address
+    --port     - MCP server port (default: 3001)
+    --web-port - Web server port, for /api/assistant/status (default: 80)
+    --calls    - Pings each session sends in the routing check (default: 20)
+    --flood    - Most tools/list POSTs sent to the stalled session (default: 60)
+
+Example:
+    python mcp_sessions_test.py 192.168.1.42
+
+Leave other MCP clients disconnected while it runs: it fills the session
+table itself. Prints PASS/FAIL per check and exits 1 if any failed.
+
+- routing: opens as many /sse sessions as the device allows (maxSessions
+  in the status), all at once, and has every session send pings from its
+  own thread at the same time. Each stream must carry exactly its own
+  replies, none of another session's.
+- table full: one more GET /sse gets 503 with Retry-After; a POST for an
+  unknown sessionId gets 404.
+- backpressure: one session stops reading its stream (with a small
+  receive buffer) while tools/list POSTs, whose replies are several KB,
+  keep coming. Once its queue is full the POSTs get 429, and the other
+  sessions still answer pings.
+- dropped: the stalled session then disconnects. The events still queued
+  for it must show up in eventsDropped, and the session must leave the
+  table.
+"""
+
+import argparse
+import http.client
+import json
+import socket
+import sys
+import threading
+import time
+
+INITIALIZE = {"jsonrpc": "2.0", "id": 0, "method": "initialize",
+              "params": {"protocolVersion": "2024-11-05", "capabilities": {},
+                         "clientInfo": {"name": "mcp_sessions_test", "version": "1.0"}}}
+
+
+class SSEStream:
+    """Reader for one /sse session"""
+
+    def __init__(self, host: str, port: int, rcvbuf: int = 0):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        if rcvbuf:
+            # Before connect, so the advertised window stays small
+            self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, rcvbuf)
+        self.sock.settimeout(10)
+        self.sock.connect((host, port))
+        self.sock.sendall(f"GET /sse HTTP/1.1\r\nHost: {host}\r\n"
+                          "Accept: text/event-stream\r\n\r\n".encode())
+        self.buf = b""
+        self.headers = self._read_until(b"\r\n\r\n").decode()
+        self.status_line = self.headers.split("\r\n")[0]
+        self.status = int(self.status_line.split()[1])
+        self.endpoint = None
+        if self.status == 200:
+            event, self.endpoint = self.next_event()
+            if event != "endpoint":
+                raise RuntimeError(f"Expected endpoint event, got {event}")
+
+    @property
+    def session_id(self) -> str:
+        return self.endpoint.split("sessionId=", 1)[1]
+
+    def _read_until(self, marker: bytes) -> bytes:
+        while marker not in self.buf:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("SSE stream closed")
+            self.buf += chunk
+        data, self.buf = self.buf.split(marker, 1)
+        return data
+
+    def next_event(self):
+        """Return (event, data), skipping keepalive comments"""
+        while True:
+            block = self._read_until(b"\n\n").decode()
+            event, data = "message", ""
+            for line in block.split("\n"):
+                if line.startswith("event:"):
+                    event = line[6:].strip()
+                elif line.startswith("data:"):
+                    data += line[5:].strip()
+            if data:
+                return event, data
+
+    def close(self):
+        self.sock.close()
+
+
+def post(host: str, port: int, path: str, msg: dict) -> int:
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    conn.request("POST", path, json.dumps(msg).encode(), {"Content-Type": "application/json"})
+    resp = conn.getresponse()
+    resp.read()
+    conn.close()
+    return resp.status
+
+
+def get_status(host: str, web_port: int) -> dict:
+    conn = http.client.HTTPConnection(host, web_port, timeout=10)
+    conn.request("GET", "/api/assistant/status")
+    resp = conn.getresponse()
+    body = resp.read()
+    conn.close()
+    if resp.status != 200:
+        raise RuntimeError(f"GET /api/assistant/status -> {resp.status}")
+    return json.loads(body)["mcpServer"]
+
+
+def client_stats(status: dict, stream: SSEStream):
+    """The session's entry in the status "clients" list (ids are cut to 8)"""
+    for entry in status.get("clients", []):
+        if stream.session_id.startswith(entry["id"]):
+            return entry
+    return None
+
+
+class Checks:
+    def __init__(self):
+        self.failed = 0
+
+    def check(self, name: str, ok: bool, detail: str):
+        print(f"{'PASS' if ok else 'FAIL'}  {name:14s} {detail}")
+        if not ok:
+            self.failed += 1
+
+
+def run_session(host: str, port: int, stream: SSEStream, index: int, calls: int,
+                results: list):
+    """Send pings with ids owned by this session, read them back in order"""
+    ids = [index * 1000 + i for i in range(calls)]
+    received = []
+    try:
+        if post(host, port, stream.endpoint, INITIALIZE) != 202:
+            raise RuntimeError("initialize not accepted")
+        received.append(json.loads(stream.next_event()[1]).get("id"))
+        for req_id in ids:
+            status = post(host, port, stream.endpoint,
+                          {"jsonrpc": "2.0", "id": req_id, "method": "ping"})
+            if status != 202:
+                raise RuntimeError(f"ping -> {status}")
+            received.append(json.loads(stream.next_event()[1]).get("id"))
+        results[index] = (ids, received[1:], None)
+    except (OSError, RuntimeError, ValueError) as e:
+        results[index] = (ids, received[1:], str(e))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="MCP multi-session check")
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=3001)
+    parser.add_argument("--web-port", type=int, default=80)
+    parser.add_argument("--calls", type=int, default=20)
+    parser.add_argument("--flood", type=int, default=60)
+    args = parser.parse_args()
+    host, port = args.host, args.port
+    checks = Checks()
+
+    try:
+        before = get_status(host, args.web_port)
+        if before["sessions"] != 0:
+            print(f"Error: {before['sessions']} MCP sessions already open, disconnect them first")
+            sys.exit(1)
+        max_sessions = before["maxSessions"]
+
+        # --- routing: every session at once ---------------------------------
+        # The first session gets a small receive buffer for the stall later
+        streams = [SSEStream(host, port, rcvbuf=1024 if i == 0 else 0)
+                   for i in range(max_sessions)]
+        results = [None] * max_sessions
+        threads = [threading.Thread(target=run_session,
+                                    args=(host, port, s, i, args.calls, results))
+                   for i, s in enumerate(streams)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        for i, (ids, received, error) in enumerate(results):
+            foreign = [r for r in received if r not in ids]
+            ok = error is None and received == ids
+            detail = f"session {i}: {len(received)}/{len(ids)} replies"
+            if foreign:
+                detail += f", {len(foreign)} from other sessions"
+            if error:
+                detail += f" ({error})"
+            checks.check("routing", ok, detail)
+
+        status = get_status(host, args.web_port)
+        checks.check("routing", status["sessions"] == max_sessions,
+                     f"{status['sessions']} sessions reported, {max_sessions} open")
+
+        # --- table full / unknown session -----------------------------------
+        extra = SSEStream(host, port)
+        extra.close()
+        checks.check("table full", extra.status == 503 and "Retry-After:" in extra.headers,
+                     extra.status_line)
+
+        bogus = post(host, port, "/mcp/message?sessionId=" + "0" * len(streams[0].session_id),
+                     {"jsonrpc": "2.0", "id": 1, "method": "ping"})
+        checks.check("unknown", bogus == 404, f"POST for an unknown sessionId -> {bogus}")
+
+        # --- backpressure: session 0 stops reading --------------------------
+        stalled = streams[0]
+        dropped_before = status["eventsDropped"]
+        backpressured_before = status["backpressured"]
+        accepted = 0
+        refused = 0
+        for i in range(args.flood):
+            code = post(host, port, stalled.endpoint,
+                        {"jsonrpc": "2.0", "id": 50000 + i, "method": "tools/list"})
+            if code == 202:
+                accepted += 1
+            elif code == 429:
+                refused += 1
+                break
+        checks.check("backpressure", refused > 0,
+                     f"{accepted} tools/list accepted before 429" if refused
+                     else f"no 429 after {accepted} POSTs (try a larger --flood)")
+
+        # The other sessions are not held up by the stalled one
+        start = time.perf_counter()
+        code = post(host, port, streams[1].endpoint, {"jsonrpc": "2.0", "id": 99999, "method": "ping"})
+        reply = json.loads(streams[1].next_event()[1]).get("id") if code == 202 else None
+        elapsed = (time.perf_counter() - start) * 1000
+        checks.check("isolation", reply == 99999,
+                     f"ping on session 1 while session 0 is stalled: {elapsed:.0f} ms")
+
+        status = get_status(host, args.web_port)
+        entry = client_stats(status, stalled)
+        queued = entry["queued"] if entry else 0
+        checks.check("backpressure", status["backpressured"] - backpressured_before >= refused,
+                     f"backpressured +{status['backpressured'] - backpressured_before}, "
+                     f"{queued} events queued for the stalled session")
+
+        # --- dropped: the stalled session goes away with a full queue -------
+        stalled.close()
+        deadline = time.time() + 5
+        while True:
+            status = get_status(host, args.web_port)
+            if status["sessions"] < max_sessions or time.time() > deadline:
+                break
+            time.sleep(0.2)
+        dropped = status["eventsDropped"] - dropped_before
+        checks.check("dropped", status["sessions"] == max_sessions - 1 and dropped >= queued > 0,
+                     f"session closed with {queued} queued, eventsDropped +{dropped}, "
+                     f"{status['sessions']} sessions left")
+
+        for s in streams[1:]:
+            s.close()
+    except (OSError, RuntimeError, KeyError, ValueError) as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    sys.exit(1 if checks.failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,316 @@
+#!/usr/bin/env python3
+"""
+Run stand-in MCP servers for testing DeskBuddy's MCP client
+
+Usage:
+    python mcp_standin.py [--port 8100] [--tools 3] [--latency 0]
+                          [--destructive 0] [--tls] MODE [MODE ...]
+
+Arguments:
+    MODE      - One server per mode, on consecutive ports:
+                ok        answers tools/list and tools/call at once
+                slow:N    answers after N seconds
+                dead      accepts connections but never answers
+                error     answers with a JSON-RPC error
+                nobatch   like ok, but only on the per-method paths
+                          (/mcp/tools/list, /mcp/tools/call); POST /mcp is 404
+    --port    - First port (default: 8100)
+    --tools   - Tools per server (default: 3)
+    --latency - Added to every answer, in seconds, to stand in for a
+                server across the internet (default: 0)
+    --destructive - How many of each server's tools are annotated
+                destructiveHint; the rest are readOnlyHint (default: 0)
+    --tls     - Serve https:// with a self-signed certificate (DeskBuddy
+                skips certificate checks) and count TLS handshakes
+
+Example:
+    python mcp_standin.py ok slow:2 dead ok slow:8
+
+Add each printed URL as a server in the web UI, then POST
+/api/mcp/discover (or reboot) and compare with "discovery" in
+GET /api/mcp/servers: dead and slow:8 servers should fail after about
+4 s each without holding up the others. Edit a server's tool list by
+restarting with a different --tools count to see the cache refresh.
+
+Every mode but nobatch also serves JSON-RPC at POST /mcp, single
+requests and batches alike. DeskBuddy sends initialize + tools/list
+there as one batch, and several tool calls to one server as one batch;
+a nobatch server shows the fallback to one request per call. Each
+request is logged, so the round trips can be counted. An initialize at
+/mcp is answered with an Mcp-Session-Id; later /mcp requests without it
+are logged as "no session".
+
+Each tools/call logs how many calls were in flight on that server when
+it started. With --latency 1 --destructive 1, ask for several tools in
+one turn: the readOnly tools should overlap (in flight > 1) while tool0
+runs alone, after the calls before it and before the calls after it.
+
+With --tls, the servers stand in for the HTTPS APIs that share the
+device's connection pool. Every handshake is logged with the number of
+TLS connections open across all servers, and every request made on a
+kept-alive connection is marked "reused". Compare with "tls" in
+/api/system/info:
+
+    python mcp_standin.py --tls ok ok ok ok ok
+
+- Keep-alive: add two of the servers and run discovery twice. The second
+  run makes no handshakes, and every request is reused.
+- Memory cap: add all five and run discovery. No more than
+  CONN_MAX_CONNECTIONS (3) connections are ever open at once. Idle ones
+  are evicted to make room, so evictions in /api/system/info go up.
+- Idle timeout: leave the device alone for 45 s. Its idle connections
+  close, and the count of open connections drops to 0.
+"""
+
+import argparse
+import json
+import os
+import socket
+import ssl
+import subprocess
+import tempfile
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+def make_handler(name: str, mode: str, tool_count: int, latency: float, destructive: int):
+    delay = float(mode.split(":", 1)[1]) if mode.startswith("slow:") else 0
+    in_flight = [0]
+    lock = threading.Lock()
+
+    def annotations(i: int) -> dict:
+        if i < destructive:
+            return {"destructiveHint": True}
+        return {"readOnlyHint": True}
+
+    def hold(calls: list):
+        """Sleep out the answer delay, logging how tool calls overlap"""
+        with lock:
+            in_flight[0] += len(calls)
+            for call in calls:
+                print(f"[{name}] {call} started, {in_flight[0]} in flight", flush=True)
+        start = time.time()
+        time.sleep(delay + latency)
+        with lock:
+            in_flight[0] -= len(calls)
+        for call in calls:
+            print(f"[{name}] {call} done after {time.time() - start:.2f} s", flush=True)
+
+    def answer(request: dict, method: str):
+        """Reply to one JSON-RPC request, None for a notification"""
+        if "id" not in request:
+            return None
+        if mode == "error":
+            return {"jsonrpc": "2.0", "id": request["id"],
+                    "error": {"code": -32603, "message": f"{name} is broken"}}
+        if method == "initialize":
+            result = {"protocolVersion": "2025-03-26", "capabilities": {"tools": {}},
+                      "serverInfo": {"name": name, "version": "1.0"}}
+        elif method == "tools/list":
+            result = {"tools": [{"name": f"tool{i}",
+                                 "description": f"Stand-in tool {i} of {name}",
+                                 "inputSchema": {"type": "object",
+                                                 "properties": {"value": {"type": "string"}}},
+                                 "annotations": annotations(i)}
+                                for i in range(tool_count)]}
+        elif method == "tools/call":
+            params = request.get("params", {})
+            text = f"{name} ran {params.get('name')} with {json.dumps(params.get('arguments'))}"
+            result = {"content": [{"type": "text", "text": text}]}
+        else:
+            return {"jsonrpc": "2.0", "id": request["id"],
+                    "error": {"code": -32601, "message": "Method not found"}}
+        return {"jsonrpc": "2.0", "id": request["id"], "result": result}
+
+    class Handler(BaseHTTPRequestHandler):
+        # Keep-alive, like the real APIs, so connection reuse can be seen
+        protocol_version = "HTTP/1.1"
+
+        def setup(self):
+            super().setup()
+            self.requests_on_connection = 0
+
+        def log_message(self, fmt, *args):
+            reused = " (reused)" if self.requests_on_connection > 1 else ""
+            print(f"[{name}] {self.command} {self.path}{reused}")
+
+        def parse_request(self):
+            self.requests_on_connection += 1
+            return super().parse_request()
+
+        def do_POST(self):
+            length = int(self.headers.get("Content-Length", 0))
+            request = json.loads(self.rfile.read(length) or b"{}")
+            entries = request if isinstance(request, list) else [request]
+            calls = [e.get("params", {}).get("name") for e in entries
+                     if e.get("method") == "tools/call" or self.path.endswith("/tools/call")]
+            hold(calls)
+
+            if self.path == "/mcp":
+                if mode == "nobatch":
+                    self.send_error(404)
+                    return
+                session = f"{name}-session"
+                if any(e.get("method") == "initialize" for e in entries):
+                    self.session_header = session
+                elif self.headers.get("Mcp-Session-Id") != session:
+                    print(f"[{name}] no session")
+                if isinstance(request, list):
+                    print(f"[{name}] batch of {len(request)}")
+                    reply = [r for r in (answer(e, e.get("method")) for e in request) if r]
+                else:
+                    reply = answer(request, request.get("method"))
+                if not reply:
+                    self.send_response(202)
+                    self.send_header("Content-Length", "0")
+                    self.end_headers()
+                    return
+            elif self.path.endswith("/tools/list"):
+                reply = answer(request, "tools/list")
+            else:
+                reply = answer(request, "tools/call")
+
+            body = json.dumps(reply).encode()
+            self.send_response(200)
+            if getattr(self, "session_header", None):
+                self.send_header("Mcp-Session-Id", self.session_header)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+    return Handler
+
+
+class TLSCounter:
+    """TLS handshakes and open connections across every server"""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.handshakes = 0
+        self.open = 0
+        self.max_open = 0
+
+    def opened(self, name: str):
+        with self.lock:
+            self.handshakes += 1
+            self.open += 1
+            self.max_open = max(self.max_open, self.open)
+            print(f"[{name}] TLS handshake #{self.handshakes}, {self.open} open "
+                  f"(most at once: {self.max_open})", flush=True)
+
+    def closed(self, name: str):
+        with self.lock:
+            self.open -= 1
+            print(f"[{name}] TLS connection closed, {self.open} open", flush=True)
+
+
+def make_tls_server(name: str, port: int, handler, context: ssl.SSLContext,
+                    counter: TLSCounter) -> ThreadingHTTPServer:
+    class TLSServer(ThreadingHTTPServer):
+        daemon_threads = True
+
+        def get_request(self):
+            # The handshake runs in accept(); a failed one raises and is skipped
+            request = super().get_request()
+            counter.opened(name)
+            return request
+
+        def shutdown_request(self, request):
+            counter.closed(name)
+            super().shutdown_request(request)
+
+    server = TLSServer(("0.0.0.0", port), handler)
+    server.socket = context.wrap_socket(server.socket, server_side=True)
+    return server
+
+
+def self_signed_context(directory: str) -> ssl.SSLContext:
+    cert = os.path.join(directory, "cert.pem")
+    key = os.path.join(directory, "key.pem")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes",
+                    "-keyout", key, "-out", cert, "-days", "30", "-subj", "/CN=mcp-standin"],
+                   check=True, capture_output=True)
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(cert, key)
+    return context
+
+
+def serve_dead(port: int, stop: threading.Event):
+    """Complete TCP handshakes but never read or answer"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("0.0.0.0", port))
+    sock.listen(16)
+    held = []
+    sock.settimeout(0.5)
+    while not stop.is_set():
+        try:
+            conn, _ = sock.accept()
+            held.append(conn)
+        except socket.timeout:
+            pass
+
+
+def local_ip() -> str:
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        s.connect(("10.255.255.255", 1))
+        return s.getsockname()[0]
+    except OSError:
+        return "127.0.0.1"
+    finally:
+        s.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in MCP servers")
+    parser.add_argument("modes", nargs="+")
+    parser.add_argument("--port", type=int, default=8100)
+    parser.add_argument("--tools", type=int, default=3)
+    parser.add_argument("--latency", type=float, default=0)
+    parser.add_argument("--destructive", type=int, default=0)
+    parser.add_argument("--tls", action="store_true")
+    args = parser.parse_args()
+
+    ip = local_ip()
+    stop = threading.Event()
+    servers = []
+    scheme = "https" if args.tls else "http"
+    tls_counter = TLSCounter()
+    cert_dir = tempfile.TemporaryDirectory()
+    context = self_signed_context(cert_dir.name) if args.tls else None
+
+    for i, mode in enumerate(args.modes):
+        port = args.port + i
+        name = f"{mode.split(':')[0]}{i}"
+        if mode == "dead":
+            threading.Thread(target=serve_dead, args=(port, stop), daemon=True).start()
+        elif mode in ("ok", "error", "nobatch") or mode.startswith("slow:"):
+            handler = make_handler(name, mode, args.tools, args.latency, args.destructive)
+            if args.tls:
+                server = make_tls_server(name, port, handler, context, tls_counter)
+            else:
+                server = ThreadingHTTPServer(("0.0.0.0", port), handler)
+            threading.Thread(target=server.serve_forever, daemon=True).start()
+            servers.append(server)
+        else:
+            parser.error(f"unknown mode: {mode}")
+        print(f"{name:10s} {mode:8s} {scheme}://{ip}:{port}", flush=True)
+
+    try:
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        stop.set()
+        for server in servers:
+            server.shutdown()
+        if args.tls:
+            print(f"{tls_counter.handshakes} TLS handshakes, "
+                  f"at most {tls_counter.max_open} connections open at once")
+        cert_dir.cleanup()
+
+
+if __name__ == "__main__":
+    main()
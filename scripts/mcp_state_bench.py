@@ -0,0 +1,333 @@
+#!/usr/bin/env python3
+"""
+Compare dashboard traffic: polling get_device_info vs resources/subscribe
+
+Usage:
+    python mcp_state_bench.py <device_ip> [--port 3001] [--duration 60]
+                              [--poll 1.0] [--change-every 5]
+
+Arguments:
+    device_ip       - DeskBuddy IP address
+    --port          - MCP server port (default: 3001)
+    --duration      - Seconds to run (default: 60)
+    --poll          - Poll interval of the polling dashboard (default: 1.0 s)
+    --change-every  - Mean seconds between expression changes (default: 5)
+
+Example:
+    python mcp_state_bench.py 192.168.1.42 --duration 120 --poll 0.5
+
+Both dashboards run at the same time and watch the expression, which a
+third connection changes at random intervals with set_expression:
+
+- Polling: tools/call get_device_info every --poll seconds on one
+  kept-alive Streamable HTTP connection.
+- Subscription: an SSE session subscribed to deskbuddy://state/expression
+  that sends resources/read only after notifications/resources/updated.
+
+Reported per dashboard: requests, bytes sent and received (HTTP headers
+included), changes seen and how long after the change they were seen.
+The device's counters are under "mcpServer" -> "resources" in
+/api/assistant/status.
+"""
+
+import argparse
+import json
+import random
+import socket
+import statistics
+import sys
+import threading
+import time
+
+EXPRESSIONS = ["happy", "sad", "surprised", "curious", "thinking", "excited", "relaxed", "neutral"]
+RESOURCE_URI = "deskbuddy://state/expression"
+
+INITIALIZE = {"jsonrpc": "2.0", "id": 0, "method": "initialize",
+              "params": {"protocolVersion": "2025-03-26", "capabilities": {},
+                         "clientInfo": {"name": "mcp_state_bench", "version": "1.0"}}}
+
+
+class Counter:
+    def __init__(self):
+        self.requests = 0
+        self.sent = 0
+        self.received = 0
+        self.delays = []
+
+
+class Changes:
+    """Expression changes made by the driver, for matching what dashboards see"""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.made = []      # (time, expression)
+
+    def add(self, expression: str):
+        with self.lock:
+            self.made.append((time.perf_counter(), expression))
+
+    def delay(self, expression: str, seen_at: float):
+        with self.lock:
+            for t, e in reversed(self.made):
+                if e == expression:
+                    return seen_at - t
+        return None
+
+
+class KeepAliveClient:
+    """Raw HTTP/1.1 client on one connection, counting every byte"""
+
+    def __init__(self, host: str, port: int, counter: Counter):
+        self.host = host
+        self.sock = socket.create_connection((host, port), timeout=10)
+        self.counter = counter
+        self.buf = b""
+
+    def _recv_until(self, marker: bytes) -> bytes:
+        while marker not in self.buf:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("Connection closed")
+            self.counter.received += len(chunk)
+            self.buf += chunk
+        data, self.buf = self.buf.split(marker, 1)
+        return data
+
+    def _recv_exact(self, n: int) -> bytes:
+        while len(self.buf) < n:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("Connection closed")
+            self.counter.received += len(chunk)
+            self.buf += chunk
+        data, self.buf = self.buf[:n], self.buf[n:]
+        return data
+
+    def post(self, msg: dict) -> dict:
+        body = json.dumps(msg).encode()
+        request = (f"POST /mcp HTTP/1.1\r\nHost: {self.host}\r\n"
+                   "Content-Type: application/json\r\n"
+                   "Accept: application/json, text/event-stream\r\n"
+                   f"Content-Length: {len(body)}\r\n\r\n").encode() + body
+        self.sock.sendall(request)
+        self.counter.sent += len(request)
+        self.counter.requests += 1
+
+        headers = self._recv_until(b"\r\n\r\n").decode()
+        length = 0
+        for line in headers.split("\r\n")[1:]:
+            name, _, value = line.partition(":")
+            if name.strip().lower() == "content-length":
+                length = int(value)
+        body = self._recv_exact(length)
+        return json.loads(body) if body else {}
+
+
+def post_message(host: str, port: int, endpoint: str, msg: dict, counter: Counter):
+    """One legacy-transport POST on its own connection; the reply is a 202"""
+    body = json.dumps(msg).encode()
+    request = (f"POST {endpoint} HTTP/1.1\r\nHost: {host}\r\n"
+               "Content-Type: application/json\r\n"
+               f"Content-Length: {len(body)}\r\n\r\n").encode() + body
+    with socket.create_connection((host, port), timeout=10) as sock:
+        sock.sendall(request)
+        counter.sent += len(request)
+        counter.requests += 1
+        while True:
+            chunk = sock.recv(4096)
+            if not chunk:
+                break
+            counter.received += len(chunk)
+
+
+class SSEStream:
+    """Reader for the /sse stream, counting every byte"""
+
+    def __init__(self, host: str, port: int, counter: Counter):
+        self.sock = socket.create_connection((host, port), timeout=1)
+        self.counter = counter
+        request = (f"GET /sse HTTP/1.1\r\nHost: {host}\r\n"
+                   "Accept: text/event-stream\r\n\r\n").encode()
+        self.sock.sendall(request)
+        counter.sent += len(request)
+        counter.requests += 1
+        self.buf = b""
+        self._read_until(b"\r\n\r\n", None)
+
+    def _read_until(self, marker: bytes, deadline):
+        while marker not in self.buf:
+            if deadline and time.perf_counter() > deadline:
+                return None
+            try:
+                chunk = self.sock.recv(4096)
+            except socket.timeout:
+                continue
+            if not chunk:
+                raise ConnectionError("SSE stream closed")
+            self.counter.received += len(chunk)
+            self.buf += chunk
+        data, self.buf = self.buf.split(marker, 1)
+        return data
+
+    def next_event(self, deadline=None):
+        """Return (event, data), skipping keepalives; None at the deadline"""
+        while True:
+            block = self._read_until(b"\n\n", deadline)
+            if block is None:
+                return None
+            event, data = "message", ""
+            for line in block.decode().split("\n"):
+                if line.startswith("event:"):
+                    event = line[6:].strip()
+                elif line.startswith("data:"):
+                    data += line[5:].strip()
+            if data:
+                return event, data
+
+    def close(self):
+        self.sock.close()
+
+
+def run_driver(host: str, port: int, stop: threading.Event, changes: Changes, mean_s: float):
+    client = KeepAliveClient(host, port, Counter())
+    client.post(INITIALIZE)
+    current = None
+    req_id = 1
+    while not stop.wait(random.expovariate(1.0 / mean_s)):
+        current = random.choice([e for e in EXPRESSIONS if e != current])
+        client.post({"jsonrpc": "2.0", "id": req_id, "method": "tools/call",
+                     "params": {"name": "set_expression", "arguments": {"expression": current}}})
+        changes.add(current)
+        req_id += 1
+
+
+def run_poller(host: str, port: int, stop: threading.Event, changes: Changes,
+               interval: float, counter: Counter):
+    client = KeepAliveClient(host, port, counter)
+    client.post(INITIALIZE)
+    last = None
+    req_id = 1
+    while not stop.is_set():
+        started = time.perf_counter()
+        reply = client.post({"jsonrpc": "2.0", "id": req_id, "method": "tools/call",
+                             "params": {"name": "get_device_info", "arguments": {}}})
+        req_id += 1
+        info = json.loads(reply["result"]["content"][0]["text"])
+        expression = info.get("expression", "").lower()
+        if last is not None and expression != last:
+            delay = changes.delay(expression, time.perf_counter())
+            if delay is not None:
+                counter.delays.append(delay)
+        last = expression
+        stop.wait(max(0.0, interval - (time.perf_counter() - started)))
+
+
+def run_subscriber(host: str, port: int, stop: threading.Event, changes: Changes,
+                   counter: Counter, ready: threading.Event):
+    stream = SSEStream(host, port, counter)
+    event, endpoint = stream.next_event()
+    if event != "endpoint":
+        raise RuntimeError(f"Expected endpoint event, got {event}")
+
+    def call(msg: dict):
+        post_message(host, port, endpoint, msg, counter)
+        while True:
+            _, data = stream.next_event()
+            reply = json.loads(data)
+            if reply.get("id") == msg["id"]:
+                return reply
+
+    call(INITIALIZE)
+    reply = call({"jsonrpc": "2.0", "id": 1, "method": "resources/subscribe",
+                  "params": {"uri": RESOURCE_URI}})
+    if "error" in reply:
+        raise RuntimeError(f"resources/subscribe failed: {reply['error']['message']}")
+    ready.set()
+
+    last = None
+    req_id = 2
+    while not stop.is_set():
+        item = stream.next_event(time.perf_counter() + 0.5)
+        if item is None:
+            continue
+        msg = json.loads(item[1])
+        if msg.get("method") != "notifications/resources/updated":
+            continue
+        reply = call({"jsonrpc": "2.0", "id": req_id, "method": "resources/read",
+                      "params": {"uri": RESOURCE_URI}})
+        req_id += 1
+        state = json.loads(reply["result"]["contents"][0]["text"])
+        expression = state.get("expression", "").lower()
+        if expression != last:
+            delay = changes.delay(expression, time.perf_counter())
+            if delay is not None:
+                counter.delays.append(delay)
+        last = expression
+    stream.close()
+
+
+def report(name: str, counter: Counter, duration: float):
+    delays = sorted(counter.delays) or [float("nan")]
+    print(f"{name:13s} requests={counter.requests:5d}  sent={counter.sent:8d} B  "
+          f"received={counter.received:8d} B  ({(counter.sent + counter.received) / duration:7.0f} B/s)  "
+          f"changes seen={len(counter.delays):3d}  "
+          f"delay median={statistics.median(delays) * 1000:6.0f} ms  max={delays[-1] * 1000:6.0f} ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="MCP state polling vs subscription benchmark")
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=3001)
+    parser.add_argument("--duration", type=float, default=60)
+    parser.add_argument("--poll", type=float, default=1.0)
+    parser.add_argument("--change-every", type=float, default=5)
+    args = parser.parse_args()
+
+    stop = threading.Event()
+    ready = threading.Event()
+    changes = Changes()
+    polling, subscribed = Counter(), Counter()
+    errors = []
+
+    def guarded(fn, *fn_args):
+        def run():
+            try:
+                fn(*fn_args)
+            except (OSError, RuntimeError, KeyError, ValueError) as e:
+                errors.append(f"{fn.__name__}: {e}")
+                stop.set()
+                ready.set()
+        return threading.Thread(target=run, daemon=True)
+
+    subscriber = guarded(run_subscriber, args.host, args.port, stop, changes, subscribed, ready)
+    subscriber.start()
+    ready.wait(10)
+
+    threads = [subscriber,
+               guarded(run_poller, args.host, args.port, stop, changes, args.poll, polling),
+               guarded(run_driver, args.host, args.port, stop, changes, args.change_every)]
+    for t in threads[1:]:
+        t.start()
+
+    print(f"Running for {args.duration:.0f} s (poll every {args.poll} s, "
+          f"a change every ~{args.change_every} s)...")
+    stop.wait(args.duration)
+    stop.set()
+    for t in threads:
+        t.join(5)
+
+    if errors:
+        print("Error: " + "; ".join(errors))
+        sys.exit(1)
+
+    print(f"Changes made: {len(changes.made)}")
+    report("Polling", polling, args.duration)
+    report("Subscription", subscribed, args.duration)
+    total_poll = polling.sent + polling.received
+    total_sub = subscribed.sent + subscribed.received
+    if total_sub:
+        print(f"Polling / subscription traffic: {total_poll / total_sub:.1f}x")
+
+
+if __name__ == "__main__":
+    main()
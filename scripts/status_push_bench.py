@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""
+Measure the traffic of an open settings page: polling vs WebSocket push
+
+Usage:
+    python status_push_bench.py <host> [--seconds 60] [--port 80]
+
+Arguments:
+    host       - DeskBuddy IP or hostname
+    --seconds  - How long to watch each mode (default: 60)
+    --port     - Web server port (default: 80)
+
+Example:
+    python status_push_bench.py 192.168.1.42 --seconds 120
+
+Runs the two ways the page keeps its dashboard live, one after the other,
+and counts every byte on the wire above TCP in both directions:
+
+- poll: GET /api/status once a second on a keep-alive connection, with
+  the request headers a browser sends (what the page does while the
+  WebSocket is down)
+- push: open /ws/status and read the pushed frames (the handshake and
+  frame headers included)
+
+Leave the device idle (no timers, no assistant activity) to measure an
+idle dashboard. The device's own counters are under "statusPush" in
+/api/system/info.
+"""
+
+import argparse
+import base64
+import json
+import os
+import socket
+import sys
+import time
+
+# Roughly what a desktop browser sends with each fetch()
+BROWSER_HEADERS = (
+    "Connection: keep-alive\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+    "(KHTML, like Gecko) Chrome/126.0.0.0 Safari/537.36\r\n"
+    "Accept: */*\r\n"
+    "Referer: http://{host}/\r\n"
+    "Accept-Encoding: gzip, deflate\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+)
+
+
+class Counter:
+    def __init__(self):
+        self.sent = 0
+        self.received = 0
+        self.messages = 0
+
+    @property
+    def total(self):
+        return self.sent + self.received
+
+
+def read_http_response(sock, buffer: bytes, counter: Counter):
+    """Read one response with a Content-Length body; return (body, rest)"""
+    while b"\r\n\r\n" not in buffer:
+        chunk = sock.recv(4096)
+        if not chunk:
+            raise ConnectionError("Connection closed")
+        counter.received += len(chunk)
+        buffer += chunk
+    head, _, rest = buffer.partition(b"\r\n\r\n")
+    length = 0
+    for line in head.split(b"\r\n")[1:]:
+        name, _, value = line.partition(b":")
+        if name.strip().lower() == b"content-length":
+            length = int(value)
+    while len(rest) < length:
+        chunk = sock.recv(4096)
+        if not chunk:
+            raise ConnectionError("Connection closed")
+        counter.received += len(chunk)
+        rest += chunk
+    return head, rest[:length], rest[length:]
+
+
+def run_poll(host: str, port: int, seconds: float) -> Counter:
+    counter = Counter()
+    request = ("GET /api/status HTTP/1.1\r\nHost: {host}\r\n" + BROWSER_HEADERS + "\r\n") \
+        .format(host=host).encode()
+    sock = socket.create_connection((host, port), timeout=5)
+    buffer = b""
+    end = time.monotonic() + seconds
+    next_poll = time.monotonic()
+    try:
+        while next_poll < end:
+            time.sleep(max(0.0, next_poll - time.monotonic()))
+            next_poll += 1.0
+            try:
+                sock.sendall(request)
+                counter.sent += len(request)
+                _, body, buffer = read_http_response(sock, buffer, counter)
+            except (ConnectionError, OSError):
+                # The server closed the keep-alive connection; reconnect
+                sock.close()
+                sock = socket.create_connection((host, port), timeout=5)
+                buffer = b""
+                sock.sendall(request)
+                counter.sent += len(request)
+                _, body, buffer = read_http_response(sock, buffer, counter)
+            json.loads(body)
+            counter.messages += 1
+    finally:
+        sock.close()
+    return counter
+
+
+def read_frame(sock, buffer: bytes, counter: Counter):
+    """Return (opcode, payload, rest) for one unmasked server frame, or None"""
+    def need(n):
+        nonlocal buffer
+        while len(buffer) < n:
+            chunk = sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("Connection closed")
+            counter.received += len(chunk)
+            buffer += chunk
+
+    need(2)
+    opcode = buffer[0] & 0x0F
+    length = buffer[1] & 0x7F
+    offset = 2
+    if length == 126:
+        need(4)
+        length = int.from_bytes(buffer[2:4], "big")
+        offset = 4
+    elif length == 127:
+        need(10)
+        length = int.from_bytes(buffer[2:10], "big")
+        offset = 10
+    need(offset + length)
+    return opcode, buffer[offset:offset + length], buffer[offset + length:]
+
+
+def run_push(host: str, port: int, seconds: float) -> Counter:
+    counter = Counter()
+    key = base64.b64encode(os.urandom(16)).decode()
+    request = ("GET /ws/status HTTP/1.1\r\nHost: {host}\r\n"
+               "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+               "Sec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n"
+               "Origin: http://{host}\r\n" + BROWSER_HEADERS.replace("Connection: keep-alive\r\n", "") +
+               "\r\n").format(host=host, key=key).encode()
+
+    sock = socket.create_connection((host, port), timeout=5)
+    sock.sendall(request)
+    counter.sent += len(request)
+
+    buffer = b""
+    while b"\r\n\r\n" not in buffer:
+        chunk = sock.recv(4096)
+        if not chunk:
+            raise ConnectionError("Handshake: connection closed")
+        counter.received += len(chunk)
+        buffer += chunk
+    head, _, buffer = buffer.partition(b"\r\n\r\n")
+    if b" 101 " not in head.split(b"\r\n")[0]:
+        raise ConnectionError("Handshake refused: " + head.split(b"\r\n")[0].decode())
+
+    end = time.monotonic() + seconds
+    fields = {}
+    try:
+        while True:
+            remaining = end - time.monotonic()
+            if remaining <= 0:
+                break
+            sock.settimeout(remaining)
+            try:
+                opcode, payload, buffer = read_frame(sock, buffer, counter)
+            except socket.timeout:
+                break
+            if opcode == 0x8:
+                raise ConnectionError("Server closed the WebSocket")
+            if opcode == 0x1:
+                update = json.loads(payload)
+                counter.messages += 1
+                for name in update:
+                    fields[name] = fields.get(name, 0) + 1
+    finally:
+        sock.close()
+    counter.fields = fields
+    return counter
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Settings page polling vs push traffic")
+    parser.add_argument("host")
+    parser.add_argument("--seconds", type=float, default=60)
+    parser.add_argument("--port", type=int, default=80)
+    args = parser.parse_args()
+
+    print(f"{args.host}:{args.port}, {args.seconds:.0f} s per mode")
+    try:
+        results = [("poll", run_poll(args.host, args.port, args.seconds)),
+                   ("push", run_push(args.host, args.port, args.seconds))]
+    except (OSError, ConnectionError, ValueError) as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    per_minute = 60.0 / args.seconds
+    for name, c in results:
+        print(f"{name}: {c.messages * per_minute:6.1f} messages/min  "
+              f"sent {c.sent * per_minute:8.0f} B/min  received {c.received * per_minute:8.0f} B/min  "
+              f"total {c.total * per_minute:8.0f} B/min")
+    push = results[1][1]
+    if push.fields:
+        counts = ", ".join(f"{k} {v}" for k, v in sorted(push.fields.items(), key=lambda kv: -kv[1]))
+        print(f"push fields (snapshot included): {counts}")
+    poll_total = results[0][1].total
+    if push.total:
+        print(f"push uses {push.total / poll_total:.1%} of the polling traffic")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+"""
+Run a stand-in TTS provider for testing DeskBuddy's sentence pipeline
+
+Usage:
+    python tts_standin.py [--port 8443] [--latency 0.3] [--rate 2.0]
+                          [--cps 15] [--chunk 1024] [--no-chunked]
+                          [--device IP] [--max-gap 50]
+
+Arguments:
+    --port       - HTTPS port (default: 8443, the firmware's TTS_STANDIN_PORT)
+    --latency    - Seconds before the response headers, like a provider's
+                   time to first byte (default: 0.3)
+    --rate       - How much faster than real time the audio is sent
+                   (default: 2.0; below 1 the device must wait for audio)
+    --cps        - Characters of text per second of audio (default: 15)
+    --chunk      - Bytes per write (default: 1024)
+    --no-chunked - Send Content-Length instead of chunked encoding
+    --device     - DeskBuddy IP: read its pipeline metrics after each answer
+    --max-gap    - Largest silence between segments that passes, in ms
+                   (default: 50)
+    --cert/--key - TLS certificate and key (default: a self-signed pair
+                   made with openssl)
+
+Example:
+    python tts_standin.py --latency 0.5 --device 192.168.1.42
+
+Build the firmware with the stand-in's address, e.g. in platformio.ini
+    build_flags = ... -DTTS_STANDIN_HOST=\\"192.168.1.10\\"
+and both TTS providers (ElevenLabs and OpenAI paths) are sent here. The
+device skips certificate checks, so the self-signed certificate works.
+Then ask the assistant something with a multi-sentence answer.
+
+The audio is silent MP3 whose length follows the text (--cps), so the
+timing is that of real speech. Every request is logged with its text,
+time to first byte, length of audio, and whether it reused a kept-alive
+connection. At each transition the stand-in checks that the next segment
+was fully delivered before the previous one could have finished playing
+(the device only plays complete segments, so that is when a gap would
+start), and that no two requests were in flight at once, which keeps
+segments in order.
+
+An answer ends when no request has come for 3 s. With --device, the
+summary adds the device's own view from /api/assistant/status ("tts":
+time to first audio, segments played, average and largest gap) and
+prints PASS/FAIL for in-order, gapless playback of every segment.
+"""
+
+import argparse
+import http.client
+import json
+import os
+import socket
+import ssl
+import subprocess
+import tempfile
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+# MPEG-2 Layer III, 32 kbps, 16 kHz, mono, no CRC: 144-byte frames of
+# 576 samples (36 ms) whose zeroed side info decodes to silence
+SILENT_FRAME = bytes([0xFF, 0xF3, 0x48, 0xC0]) + bytes(140)
+FRAME_SECONDS = 576 / 16000
+
+# An answer's segments come back to back; this much quiet ends it
+ANSWER_IDLE_S = 3.0
+
+
+def silent_mp3(seconds: float) -> bytes:
+    return SILENT_FRAME * max(1, round(seconds / FRAME_SECONDS))
+
+
+class Answer:
+    """Segments of one spoken answer, as the stand-in saw them"""
+
+    def __init__(self):
+        self.segments = []          # dicts: text, start, end, audio_s
+        self.in_flight = 0
+        self.max_in_flight = 0
+        self.last_activity = 0.0
+
+
+def make_handler(args, state: dict, lock: threading.Lock):
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def log_message(self, fmt, *fmt_args):
+            pass
+
+        def setup(self):
+            super().setup()
+            self.requests_on_connection = 0
+
+        def do_POST(self):
+            arrived = time.time()
+            length = int(self.headers.get("Content-Length", 0))
+            try:
+                request = json.loads(self.rfile.read(length) or b"{}")
+            except ValueError:
+                request = {}
+            if self.path.startswith("/v1/text-to-speech/"):
+                text = request.get("text", "")
+            elif self.path == "/v1/audio/speech":
+                text = request.get("input", "")
+            else:
+                self.send_error(404)
+                return
+            self.requests_on_connection += 1
+            reused = self.requests_on_connection > 1
+
+            with lock:
+                answer = state["answer"]
+                if answer is None or arrived - answer.last_activity > ANSWER_IDLE_S:
+                    answer = state["answer"] = Answer()
+                answer.in_flight += 1
+                answer.max_in_flight = max(answer.max_in_flight, answer.in_flight)
+                answer.last_activity = arrived
+                index = len(answer.segments)
+                segment = {"text": text, "start": arrived, "end": None,
+                           "audio_s": len(text) / args.cps}
+                answer.segments.append(segment)
+
+            audio = silent_mp3(segment["audio_s"])
+            time.sleep(args.latency)
+            self.send_response(200)
+            self.send_header("Content-Type", "audio/mpeg")
+            if args.no_chunked:
+                self.send_header("Content-Length", str(len(audio)))
+            else:
+                self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+
+            # Pace the audio at --rate times real time
+            bytes_per_s = len(SILENT_FRAME) / FRAME_SECONDS * args.rate
+            try:
+                for offset in range(0, len(audio), args.chunk):
+                    piece = audio[offset:offset + args.chunk]
+                    if args.no_chunked:
+                        self.wfile.write(piece)
+                    else:
+                        self.wfile.write(f"{len(piece):x}\r\n".encode() + piece + b"\r\n")
+                    self.wfile.flush()
+                    time.sleep(len(piece) / bytes_per_s)
+                if not args.no_chunked:
+                    self.wfile.write(b"0\r\n\r\n")
+                    self.wfile.flush()
+            except OSError as e:
+                print(f"  #{index + 1} aborted by the device ({e})", flush=True)
+            finished = time.time()
+
+            with lock:
+                segment["end"] = finished
+                answer.in_flight -= 1
+                answer.last_activity = finished
+            print(f"  #{index + 1} {'reused' if reused else 'new conn'}  "
+                  f"first byte {args.latency * 1000:.0f} ms  "
+                  f"{segment['audio_s']:.1f} s audio in {(finished - arrived):.2f} s  "
+                  f"\"{text[:60]}\"", flush=True)
+
+    return Handler
+
+
+def device_tts_stats(host: str) -> dict:
+    conn = http.client.HTTPConnection(host, 80, timeout=5)
+    conn.request("GET", "/api/assistant/status")
+    resp = conn.getresponse()
+    body = resp.read()
+    conn.close()
+    return json.loads(body).get("tts", {})
+
+
+def summarize(answer: Answer, args):
+    segments = [s for s in answer.segments if s["end"] is not None]
+    if not segments:
+        return
+    print(f"Answer: {len(segments)} segments, "
+          f"{sum(s['audio_s'] for s in segments):.1f} s of audio")
+
+    # Segment N+1 must be complete before N, which starts no earlier than
+    # its own delivery, can have finished playing
+    late = []
+    for prev, seg in zip(segments, segments[1:]):
+        slack = prev["end"] + prev["audio_s"] - seg["end"]
+        if slack < 0:
+            late.append(-slack * 1000)
+    print(f"  stand-in: {len(segments) - 1 - len(late)}/{len(segments) - 1} segments ready "
+          f"before the previous one ended"
+          + (f", worst {max(late):.0f} ms late" if late else "")
+          + f"; at most {answer.max_in_flight} request(s) in flight")
+
+    if not args.device:
+        return
+    try:
+        tts = device_tts_stats(args.device)
+    except (OSError, ValueError) as e:
+        print(f"  device: status unavailable ({e})")
+        return
+    ttfa = tts.get("timeToFirstAudioMs", -1)
+    played = tts.get("segments", 0)
+    max_gap = tts.get("maxGapMs", 0)
+    first_ready = (segments[0]["end"] - segments[0]["start"]) * 1000
+    print(f"  device: first audio {ttfa} ms (stand-in took {first_ready:.0f} ms of it), "
+          f"{played} segments played, gap avg {tts.get('avgGapMs', 0)} ms max {max_gap} ms")
+    ok = (played == len(segments) and answer.max_in_flight == 1 and
+          max_gap <= args.max_gap and ttfa >= 0)
+    print(f"  {'PASS' if ok else 'FAIL'}: every segment played in order, "
+          f"gaps within {args.max_gap} ms")
+
+
+def watch_answers(args, state: dict, lock: threading.Lock):
+    """Summarize each answer once its requests have stopped"""
+    while True:
+        time.sleep(0.5)
+        with lock:
+            answer = state["answer"]
+            done = (answer is not None and answer.in_flight == 0 and
+                    time.time() - answer.last_activity > ANSWER_IDLE_S)
+            if done:
+                state["answer"] = None
+        if done:
+            # The last segment is still playing; let the device finish it
+            time.sleep(answer.segments[-1]["audio_s"] if answer.segments else 0)
+            summarize(answer, args)
+
+
+def self_signed_cert(directory: str):
+    cert = os.path.join(directory, "cert.pem")
+    key = os.path.join(directory, "key.pem")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes",
+                    "-keyout", key, "-out", cert, "-days", "30", "-subj", "/CN=tts-standin"],
+                   check=True, capture_output=True)
+    return cert, key
+
+
+def local_ip() -> str:
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        s.connect(("10.255.255.255", 1))
+        return s.getsockname()[0]
+    except OSError:
+        return "127.0.0.1"
+    finally:
+        s.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in TTS provider")
+    parser.add_argument("--port", type=int, default=8443)
+    parser.add_argument("--latency", type=float, default=0.3)
+    parser.add_argument("--rate", type=float, default=2.0)
+    parser.add_argument("--cps", type=float, default=15)
+    parser.add_argument("--chunk", type=int, default=1024)
+    parser.add_argument("--no-chunked", action="store_true")
+    parser.add_argument("--device", default=None)
+    parser.add_argument("--max-gap", type=int, default=50)
+    parser.add_argument("--cert", default=None)
+    parser.add_argument("--key", default=None)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        cert, key = (args.cert, args.key) if args.cert else self_signed_cert(tmp)
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(cert, key)
+
+        state = {"answer": None}
+        lock = threading.Lock()
+        server = ThreadingHTTPServer(("0.0.0.0", args.port), make_handler(args, state, lock))
+        server.daemon_threads = True
+        server.socket = context.wrap_socket(server.socket, server_side=True)
+        threading.Thread(target=watch_answers, args=(args, state, lock), daemon=True).start()
+
+        print(f"TTS stand-in on https://{local_ip()}:{args.port} "
+              f"(first byte {args.latency * 1000:.0f} ms, audio at {args.rate}x real time, "
+              f"{'Content-Length' if args.no_chunked else 'chunked'})", flush=True)
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()
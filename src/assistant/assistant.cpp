@@ -4,24 +4,17 @@
  */
 
 #include "assistant.h"
+#include "device_tools.h"
+#include "device_tool_queue.h"
+#include "mcp_client.h"
 #include "../audio/audio_player.h"
-#include <LittleFS.h>
 
 // Global instance
 Assistant assistant;
 
-// Temporary file for TTS audio buffering
-static const char* TTS_TEMP_FILE = "/tts_response.mp3";
-
 // External audio player reference
 extern AudioPlayer audioPlayer;
 
-// TTS audio buffer size (128KB for buffering TTS response)
-#define TTS_BUFFER_SIZE (128 * 1024)
-
-// File handle for TTS temp file
-static File ttsFile;
-
 //=============================================================================
 // Constructor / Destructor
 //=============================================================================
@@ -33,16 +26,21 @@ Assistant::Assistant()
     , pttTriggered(false)
     , listeningStartTime(0)
     , speakingStartTime(0)
-    , ttsAudioBuffer(nullptr)
-    , ttsAudioSize(0)
-    , ttsAudioWritePos(0)
+    , llmStartTime(0)
+    , llmLatencyAvgMs(0)
+    , streamPrefixLen(0)
+    , emotionResolved(false)
+    , asyncResponseReady(false)
+    , textStreamed(false)
     , stateCallback(nullptr)
     , transcriptCallback(nullptr)
     , responseCallback(nullptr)
+    , emotionHintCallback(nullptr)
 {
     memset(audioChunkBuffer, 0, sizeof(audioChunkBuffer));
     memset(lastResponse, 0, sizeof(lastResponse));
     memset(lastEmotion, 0, sizeof(lastEmotion));
+    memset(streamPrefix, 0, sizeof(streamPrefix));
 }
 
 Assistant::~Assistant() {
@@ -89,10 +87,9 @@ bool Assistant::begin(const AssistantConfig& cfg) {
         }
     }
 
-    // Allocate TTS buffer
-    ttsAudioBuffer = (uint8_t*)malloc(TTS_BUFFER_SIZE);
-    if (!ttsAudioBuffer) {
-        Serial.println("[Assistant] Failed to allocate TTS buffer");
+    // Sentence-pipelined speech (owns the TTS audio callback)
+    if (!ttsPipeline.begin(&ttsClient, &audioPlayer)) {
+        Serial.println("[Assistant] Failed to init TTS pipeline");
     }
 
     // Set up callbacks
@@ -102,16 +99,44 @@ bool Assistant::begin(const AssistantConfig& cfg) {
         if (isFinal) processTranscript();
     });
 
-    ttsClient.onAudioChunk([this](const uint8_t* data, size_t len) {
-        handleTTSAudio(data, len);
+    // React to the emotion tag and start speaking while the answer streams
+    llmClient.onTextDelta([this](const char* delta) {
+        handleTextDelta(delta);
     });
 
-    ttsClient.onStateChange([this](TTSState ttsState) {
-        if (ttsState == TTSState::Complete) {
-            setState(AssistantState::Idle);
+    // Device tools run locally; MCP tools go to their server. The MCP
+    // calls of a response go out together - one JSON-RPC batch per
+    // server, servers concurrently - and every result goes back in one
+    // follow-up. Remote tools start from the cache; stale lists are
+    // re-fetched meanwhile.
+    registerDeviceTools(llmClient);
+    mcpClient.begin();
+    refreshRemoteTools();
+    mcpClient.startBackgroundRefresh();
+    llmClient.setToolExecutor([](const char* name, const char* input) -> String {
+        if (mcpClient.findTool(name)) {
+            return mcpClient.executeTool(name, input);
+        }
+        return deviceToolQueue.call(name, input);
+    });
+    llmClient.setToolBatchExecutor([](const std::vector<const ToolCall*>& calls,
+                                      std::vector<String>& results) {
+        std::vector<MCPToolCall> mcpCalls(calls.size());
+        for (size_t i = 0; i < calls.size(); i++) {
+            mcpCalls[i].name = calls[i]->name.c_str();
+            mcpCalls[i].arguments = calls[i]->input.c_str();
+        }
+        mcpClient.executeTools(mcpCalls.data(), mcpCalls.size());
+        for (size_t i = 0; i < calls.size(); i++) {
+            results[i] = std::move(mcpCalls[i].result);
         }
     });
 
+    // The answer continued after tool results opens with its own tag
+    llmClient.onToolRound([this](size_t calls) {
+        ttsPipeline.expectTag();
+    });
+
     initialized = true;
     state = AssistantState::Idle;
     Serial.println("[Assistant] Ready");
@@ -121,16 +146,12 @@ bool Assistant::begin(const AssistantConfig& cfg) {
 void Assistant::end() {
     if (!initialized) return;
 
+    ttsPipeline.stop();
     sttClient.end();
     ttsClient.end();
     llmClient.end();
     voiceInput.end();
 
-    if (ttsAudioBuffer) {
-        free(ttsAudioBuffer);
-        ttsAudioBuffer = nullptr;
-    }
-
     initialized = false;
     state = AssistantState::Disabled;
     Serial.println("[Assistant] Shutdown");
@@ -145,6 +166,30 @@ void Assistant::update(float dt) {
     // Update components
     sttClient.loop();
     ttsClient.loop();
+    ttsPipeline.loop();
+
+    // Pick up a finished LLM request from the worker task
+    if (asyncResponseReady) {
+        asyncResponseReady = false;
+        if (state == AssistantState::Processing || state == AssistantState::Speaking) {
+            if (asyncResponse.success) {
+                uint32_t sample = millis() - llmStartTime;
+                llmLatencyAvgMs = llmLatencyAvgMs ? (llmLatencyAvgMs * 7 + sample) / 8 : sample;
+                handleLLMResponse(asyncResponse);
+            } else {
+                Serial.printf("[Assistant] LLM error: %s\n", asyncResponse.error.c_str());
+                ttsPipeline.stop();
+                setState(AssistantState::Error);
+            }
+        }
+        asyncResponse = LLMResponse();
+    }
+
+    // First sentence is playing while the rest is still generating
+    if (state == AssistantState::Processing && ttsPipeline.hasStartedAudio()) {
+        speakingStartTime = millis();
+        setState(AssistantState::Speaking);
+    }
 
     // Handle PTT hold detection
     if (pttActive && !pttTriggered) {
@@ -165,11 +210,14 @@ void Assistant::update(float dt) {
         }
     }
 
-    // Check for speaking timeout
-    if (state == AssistantState::Speaking) {
-        if (!audioPlayer.isPlaying() && !ttsClient.isSpeaking()) {
-            setState(AssistantState::Idle);
-        }
+    // Done once every segment has been synthesized and played
+    if (state == AssistantState::Speaking && !llmClient.isBusy() && ttsPipeline.isIdle()) {
+        setState(AssistantState::Idle);
+    }
+
+    // Re-fetched remote tools go live between requests
+    if (state == AssistantState::Idle && mcpClient.applyBackgroundRefresh()) {
+        refreshRemoteTools();
     }
 }
 
@@ -202,7 +250,7 @@ void Assistant::onWakeWord() {
 
 void Assistant::interrupt() {
     if (state == AssistantState::Speaking) {
-        ttsClient.stop();
+        ttsPipeline.stop();
         audioPlayer.stop();
         setState(AssistantState::Idle);
         Serial.println("[Assistant] Interrupted");
@@ -262,15 +310,65 @@ void Assistant::processTranscript() {
 
     Serial.printf("[Assistant] Transcript: %s\n", transcript);
 
-    // Send to LLM
-    LLMResponse response = llmClient.send(transcript);
+    if (ASSISTANT_LOCAL_INTENTS && handleLocalIntent(transcript)) {
+        return;
+    }
+
+    // Reset streamed emotion detection for the new response
+    streamPrefixLen = 0;
+    streamPrefix[0] = '\0';
+    emotionResolved = false;
+    textStreamed = false;
+    ttsPipeline.start();
+
+    // Send to LLM on the worker task so the main loop keeps synthesizing
+    // and playing sentences while the rest of the answer streams in
+    llmStartTime = millis();
+    llmClient.sendAsync(transcript, [this](const LLMResponse& response) {
+        asyncResponse = response;
+        asyncResponseReady = true;
+    });
+}
+
+bool Assistant::handleLocalIntent(const char* transcript) {
+    uint32_t startTime = millis();
+
+    IntentMatch match;
+    if (!intentMatcher.match(transcript, match)) return false;
+
+    String result = match.tool ? deviceToolQueue.call(match.tool, match.input.c_str()) : String();
+    String reply = intentMatcher.formatReply(match, result);
+
+    uint32_t elapsed = millis() - startTime;
+    if (llmLatencyAvgMs > elapsed) {
+        intentMatcher.recordSaved(llmLatencyAvgMs - elapsed);
+    }
+    Serial.printf("[Assistant] Local intent handled in %lums (LLM avg %lums): %s\n",
+                  elapsed, llmLatencyAvgMs, reply.c_str());
+
+    // Keep the turn in history so "make it ten minutes" still has context
+    llmClient.recordExchange(transcript, reply.c_str());
+
+    strncpy(lastResponse, reply.c_str(), sizeof(lastResponse) - 1);
+    lastResponse[sizeof(lastResponse) - 1] = '\0';
+
+    ttsPipeline.start();
+    if (reply.length() > 0) {
+        ttsPipeline.append(reply.c_str());
+    }
+    ttsPipeline.finish();
 
-    if (response.success) {
-        handleLLMResponse(response);
+    if (ttsPipeline.isIdle()) {
+        setState(AssistantState::Idle);
     } else {
-        Serial.printf("[Assistant] LLM error: %s\n", response.error.c_str());
-        setState(AssistantState::Error);
+        speakingStartTime = millis();
+        setState(AssistantState::Speaking);
     }
+
+    if (responseCallback) {
+        responseCallback(lastResponse, lastEmotion);
+    }
+    return true;
 }
 
 void Assistant::handleLLMResponse(const LLMResponse& response) {
@@ -287,20 +385,19 @@ void Assistant::handleLLMResponse(const LLMResponse& response) {
         executeToolCalls(response.toolCalls);
     }
 
-    // Speak the response (strip emotion tag if present)
-    String textToSpeak = response.text;
-    if (textToSpeak.startsWith("[")) {
-        int endBracket = textToSpeak.indexOf(']');
-        if (endBracket > 0) {
-            textToSpeak = textToSpeak.substring(endBracket + 1);
-            textToSpeak.trim();
-        }
+    // Non-streamed responses arrive whole; streamed text is already queued.
+    // The pipeline strips the leading emotion tag either way.
+    if (!textStreamed) {
+        ttsPipeline.append(response.text.c_str());
     }
+    ttsPipeline.finish();
 
-    if (textToSpeak.length() > 0) {
-        playResponse(textToSpeak.c_str());
-    } else {
+    if (ttsPipeline.isIdle()) {
         setState(AssistantState::Idle);
+    } else if (state != AssistantState::Speaking) {
+        speakingStartTime = millis();
+        setState(AssistantState::Speaking);
+        Serial.println("[Assistant] Speaking...");
     }
 
     // Notify callback
@@ -309,54 +406,61 @@ void Assistant::handleLLMResponse(const LLMResponse& response) {
     }
 }
 
-void Assistant::executeToolCalls(const std::vector<ToolCall>& calls) {
-    // Tool execution will be implemented in Phase 3
-    for (const auto& call : calls) {
-        Serial.printf("[Assistant] Tool call: %s\n", call.name.c_str());
-    }
-}
+void Assistant::handleTextDelta(const char* delta) {
+    if (!delta) return;
 
-//=============================================================================
-// TTS Playback
-//=============================================================================
-void Assistant::playResponse(const char* text) {
-    setState(AssistantState::Speaking);
-    speakingStartTime = millis();
-
-    // Reset TTS buffer
-    ttsAudioWritePos = 0;
-
-    // Open temp file for writing
-    ttsFile = LittleFS.open(TTS_TEMP_FILE, "w");
-    if (!ttsFile) {
-        Serial.println("[Assistant] Failed to open TTS temp file");
-        setState(AssistantState::Error);
-        return;
-    }
+    // Segments are spoken as soon as a sentence boundary arrives
+    textStreamed = true;
+    ttsPipeline.append(delta);
 
-    // Start TTS synthesis
-    ttsClient.speak(text);
-    Serial.println("[Assistant] Speaking...");
-}
+    if (emotionResolved) return;
 
-void Assistant::handleTTSAudio(const uint8_t* data, size_t length) {
-    if (!ttsFile) return;
+    for (const char* p = delta; *p; p++) {
+        char c = *p;
 
-    // Write to temp file
-    size_t written = ttsFile.write(data, length);
-    ttsAudioWritePos += written;
+        // Tag must be the first non-space character
+        if (streamPrefixLen == 0) {
+            if (c == ' ' || c == '\n') continue;
+            if (c != '[') {
+                emotionResolved = true;
+                return;
+            }
+        }
 
-    // Check if TTS is complete
-    if (ttsClient.getState() == TTSState::Complete) {
-        ttsFile.close();
+        if (streamPrefixLen >= sizeof(streamPrefix) - 1) {
+            emotionResolved = true;  // Too long to be an emotion tag
+            return;
+        }
+        streamPrefix[streamPrefixLen++] = c;
+        streamPrefix[streamPrefixLen] = '\0';
+
+        if (c == ']') {
+            size_t len = streamPrefixLen - 2;
+            if (len > 0 && len < sizeof(lastEmotion)) {
+                memcpy(lastEmotion, streamPrefix + 1, len);
+                lastEmotion[len] = '\0';
+                Serial.printf("[Assistant] Early emotion: %s\n", lastEmotion);
+                if (emotionHintCallback) emotionHintCallback(lastEmotion);
+            }
+            emotionResolved = true;
+            return;
+        }
+    }
+}
 
-        // Play the temp file
-        audioPlayer.play(TTS_TEMP_FILE);
+void Assistant::executeToolCalls(const std::vector<ToolCall>& calls) {
+    for (const auto& call : calls) {
+        Serial.printf("[Assistant] Tool call not executed: %s\n", call.name.c_str());
     }
 }
 
-void Assistant::initTTSPlayback() {
-    // Placeholder for streaming playback initialization
+void Assistant::refreshRemoteTools() {
+    llmClient.removeTools(LLM_TOOL_REMOTE);
+    mcpClient.registerToolsWithLLM([this](const char* name, const char* desc, const char* schema,
+                                          bool ordered) {
+        return llmClient.addTool(name, desc, schema,
+                                 LLM_TOOL_REMOTE | (ordered ? LLM_TOOL_ORDERED : 0));
+    });
 }
 
 //=============================================================================
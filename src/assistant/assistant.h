@@ -15,6 +15,8 @@
 #include "stt_client.h"
 #include "tts_client.h"
 #include "llm_client.h"
+#include "tts_pipeline.h"
+#include "intent_matcher.h"
 
 //=============================================================================
 // Configuration
@@ -32,6 +34,9 @@
 /** Max speaking duration before auto-stop (ms) */
 #define ASSISTANT_MAX_SPEAK_MS 30000
 
+/** Answer matching device commands locally instead of via the LLM */
+#define ASSISTANT_LOCAL_INTENTS true
+
 //=============================================================================
 // Assistant State
 //=============================================================================
@@ -68,6 +73,11 @@ using TranscriptUpdateCallback = std::function<void(const char* text, bool isFin
  */
 using ResponseReadyCallback = std::function<void(const char* text, const char* emotion)>;
 
+/**
+ * @brief Callback for an emotion hint parsed from the start of a streamed response
+ */
+using EmotionHintCallback = std::function<void(const char* emotion)>;
+
 //=============================================================================
 // AssistantConfig
 //=============================================================================
@@ -117,8 +127,8 @@ struct AssistantConfig {
  * Manages the complete voice assistant pipeline:
  * 1. Activation (wake word or push-to-talk)
  * 2. Voice capture and streaming to STT
- * 3. Sending transcript to Claude LLM
- * 4. Playing TTS response
+ * 3. Sending transcript to Claude LLM (streamed, on a worker task)
+ * 4. Speaking the response sentence by sentence as it streams in
  */
 class Assistant {
 public:
@@ -246,6 +256,13 @@ public:
      */
     void onResponseReady(ResponseReadyCallback callback) { responseCallback = callback; }
 
+    /**
+     * @brief Set emotion hint callback
+     * Fires as soon as the streamed response's [emotion] tag is complete,
+     * before the rest of the answer arrives.
+     */
+    void onEmotionHint(EmotionHintCallback callback) { emotionHintCallback = callback; }
+
     //-------------------------------------------------------------------------
     // Components (for advanced use)
     //-------------------------------------------------------------------------
@@ -255,11 +272,31 @@ public:
      */
     LLMClient& getLLM() { return llmClient; }
 
+    /**
+     * @brief Re-register discovered MCP tools with the LLM (after discovery)
+     */
+    void refreshRemoteTools();
+
     /**
      * @brief Get voice input for level monitoring
      */
     VoiceInput& getVoiceInput() { return voiceInput; }
 
+    /**
+     * @brief Get TTS pipeline for latency metrics
+     */
+    const TTSPipeline& getTTSPipeline() const { return ttsPipeline; }
+
+    /**
+     * @brief Get local intent matcher (for stats)
+     */
+    const IntentMatcher& getIntentMatcher() const { return intentMatcher; }
+
+    /**
+     * @brief Running average LLM round trip (ms, 0 until measured)
+     */
+    uint32_t getLLMLatencyMs() const { return llmLatencyAvgMs; }
+
 private:
     /**
      * @brief Set state and notify callback
@@ -277,27 +314,26 @@ private:
     void processTranscript();
 
     /**
-     * @brief Handle LLM response
-     */
-    void handleLLMResponse(const LLMResponse& response);
-
-    /**
-     * @brief Play TTS response
+     * @brief Execute a transcript locally if it matches a device intent
+     * @return true if handled (the LLM is skipped)
      */
-    void playResponse(const char* text);
+    bool handleLocalIntent(const char* transcript);
 
     /**
-     * @brief Handle TTS audio chunk
+     * @brief Handle LLM response
      */
-    void handleTTSAudio(const uint8_t* data, size_t length);
+    void handleLLMResponse(const LLMResponse& response);
 
     /**
-     * @brief Initialize TTS audio playback
+     * @brief Handle a streamed LLM text delta (runs on the LLM task)
      */
-    void initTTSPlayback();
+    void handleTextDelta(const char* delta);
 
     /**
-     * @brief Execute tool calls from LLM
+     * @brief Report tool calls the LLM client left unexecuted
+     *
+     * LLMClient executes tool calls itself and batches the results; any
+     * remaining here hit LLM_MAX_TOOL_ROUNDS or had no executor.
      */
     void executeToolCalls(const std::vector<ToolCall>& calls);
 
@@ -321,6 +357,8 @@ private:
     STTClient sttClient;
     TTSClient ttsClient;
     LLMClient llmClient;
+    TTSPipeline ttsPipeline;
+    IntentMatcher intentMatcher;
 
     // PTT tracking
     bool pttActive;
@@ -336,15 +374,25 @@ private:
     char lastEmotion[32];
     uint32_t speakingStartTime;
 
-    // MP3 playback buffer
-    uint8_t* ttsAudioBuffer;
-    size_t ttsAudioSize;
-    size_t ttsAudioWritePos;
+    // LLM round trip, used to estimate what local intents save
+    uint32_t llmStartTime;
+    uint32_t llmLatencyAvgMs;
+
+    // Streamed emotion tag detection
+    char streamPrefix[32];
+    size_t streamPrefixLen;
+    bool emotionResolved;
+
+    // Async LLM hand-off (written by the LLM task, consumed in update)
+    LLMResponse asyncResponse;
+    volatile bool asyncResponseReady;
+    volatile bool textStreamed;
 
     // Callbacks
     AssistantStateCallback stateCallback;
     TranscriptUpdateCallback transcriptCallback;
     ResponseReadyCallback responseCallback;
+    EmotionHintCallback emotionHintCallback;
 };
 
 // Global assistant instance
@@ -0,0 +1,427 @@
+/**
+ * @file conversation_history.cpp
+ * @brief Arena-backed conversation history implementation
+ *
+ * Arena layout: records are appended at writePos in insertion order. When
+ * a record does not fit before the end of the arena it wraps to offset 0,
+ * provided the oldest record starts far enough in; otherwise the oldest
+ * records are evicted until it fits. Each record holds the Claude
+ * fragment immediately followed by the OpenAI fragment.
+ */
+
+#include "conversation_history.h"
+#include "token_budget.h"
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+
+//=============================================================================
+// FragmentStream
+//=============================================================================
+
+FragmentStream::FragmentStream() {
+    clear();
+}
+
+void FragmentStream::clear() {
+    count = 0;
+    totalSize = 0;
+    rewind();
+}
+
+bool FragmentStream::add(const void* data, size_t length) {
+    if (length == 0) return true;
+    if (count >= FRAGMENT_STREAM_MAX_PIECES) return false;
+
+    pieces[count].data = (const uint8_t*)data;
+    pieces[count].length = length;
+    count++;
+    totalSize += length;
+    return true;
+}
+
+void FragmentStream::rewind() {
+    pieceIndex = 0;
+    pieceOffset = 0;
+    consumed = 0;
+}
+
+int FragmentStream::available() {
+    return (int)(totalSize - consumed);
+}
+
+int FragmentStream::peek() {
+    if (pieceIndex >= count) return -1;
+    return pieces[pieceIndex].data[pieceOffset];
+}
+
+int FragmentStream::read() {
+    if (pieceIndex >= count) return -1;
+
+    uint8_t c = pieces[pieceIndex].data[pieceOffset++];
+    consumed++;
+    if (pieceOffset >= pieces[pieceIndex].length) {
+        pieceIndex++;
+        pieceOffset = 0;
+    }
+    return c;
+}
+
+size_t FragmentStream::readBytes(char* buffer, size_t length) {
+    size_t copied = 0;
+
+    while (copied < length && pieceIndex < count) {
+        const Piece& p = pieces[pieceIndex];
+        size_t n = min(length - copied, p.length - pieceOffset);
+        memcpy(buffer + copied, p.data + pieceOffset, n);
+        copied += n;
+        pieceOffset += n;
+        if (pieceOffset >= p.length) {
+            pieceIndex++;
+            pieceOffset = 0;
+        }
+    }
+
+    consumed += copied;
+    return copied;
+}
+
+//=============================================================================
+// Message Serialization
+//=============================================================================
+
+/**
+ * @brief Fill a Claude messages[] entry (tool calls: see addToolCalls)
+ */
+static void buildClaudeMessage(JsonDocument& doc, MessageRole role, const char* content,
+                               const char* toolUseId) {
+    if (role == MessageRole::Tool) {
+        doc["role"] = "user";
+        JsonObject toolResult = doc["content"].to<JsonArray>().add<JsonObject>();
+        toolResult["type"] = "tool_result";
+        toolResult["tool_use_id"] = toolUseId;
+        toolResult["content"] = content;
+    } else {
+        doc["role"] = role == MessageRole::User ? "user" : "assistant";
+        doc["content"] = content;
+    }
+}
+
+/**
+ * @brief Fill an OpenAI messages[] entry (tool calls: see addToolCalls)
+ */
+static void buildOpenAIMessage(JsonDocument& doc, MessageRole role, const char* content,
+                               const char* toolUseId) {
+    if (role == MessageRole::Tool) {
+        doc["role"] = "tool";
+        doc["tool_call_id"] = toolUseId;
+        doc["content"] = content;
+    } else {
+        doc["role"] = role == MessageRole::User ? "user" : "assistant";
+        doc["content"] = content;
+    }
+}
+
+//=============================================================================
+// ConversationHistory
+//=============================================================================
+
+ConversationHistory::ConversationHistory()
+    : arena(nullptr)
+    , arenaSize(0)
+    , inPsram(false)
+    , head(0)
+    , count(0)
+    , writePos(0)
+    , tokenTotal(0)
+{
+    memset(entries, 0, sizeof(entries));
+}
+
+ConversationHistory::~ConversationHistory() {
+    end();
+}
+
+bool ConversationHistory::begin(size_t arenaBytes) {
+    if (arena) return true;
+
+    arena = (uint8_t*)heap_caps_malloc(arenaBytes, MALLOC_CAP_SPIRAM);
+    inPsram = (arena != nullptr);
+    if (!arena) {
+        // No PSRAM - fall back to a smaller internal arena
+        arenaBytes /= 4;
+        arena = (uint8_t*)malloc(arenaBytes);
+    }
+    if (!arena) {
+        Serial.println("[History] Failed to allocate arena");
+        return false;
+    }
+
+    arenaSize = arenaBytes;
+    clear();
+    Serial.printf("[History] Arena %u KB in %s\n", arenaSize / 1024, inPsram ? "PSRAM" : "SRAM");
+    return true;
+}
+
+void ConversationHistory::end() {
+    if (arena) {
+        if (inPsram) {
+            heap_caps_free(arena);
+        } else {
+            free(arena);
+        }
+        arena = nullptr;
+    }
+    arenaSize = 0;
+    head = 0;
+    count = 0;
+    writePos = 0;
+    tokenTotal = 0;
+}
+
+void ConversationHistory::clear() {
+    head = 0;
+    count = 0;
+    writePos = 0;
+    tokenTotal = 0;
+}
+
+void ConversationHistory::dropOldest() {
+    if (count == 0) return;
+    tokenTotal -= at(0).tokens;
+    head = (head + 1) % HISTORY_MAX_ENTRIES;
+    count--;
+    if (count == 0) writePos = 0;
+}
+
+size_t ConversationHistory::dropOldestTurn() {
+    size_t next = 1;
+    while (next < count && at(next).role != MessageRole::User) next++;
+    if (next >= count) return 0;
+
+    for (size_t i = 0; i < next; i++) dropOldest();
+    return next;
+}
+
+bool ConversationHistory::add(MessageRole role, const char* content,
+                              const char* toolUseId, const char* toolName,
+                              const char* toolInput) {
+    if (!arena) return false;
+
+    if (!content) content = "";
+    if (!toolUseId) toolUseId = "";
+    if (!toolName) toolName = "";
+
+    if (role == MessageRole::Assistant && *toolName) {
+        HistoryToolCall call = { toolUseId, toolName, toolInput };
+        return addToolCalls(content, &call, 1);
+    }
+
+    JsonDocument claudeDoc;
+    buildClaudeMessage(claudeDoc, role, content, toolUseId);
+    JsonDocument openaiDoc;
+    buildOpenAIMessage(openaiDoc, role, content, toolUseId);
+
+    return store(claudeDoc, openaiDoc, false, role, false);
+}
+
+bool ConversationHistory::addToolCalls(const char* text, const HistoryToolCall* calls, size_t count) {
+    if (!arena) return false;
+    if (!text) text = "";
+
+    JsonDocument claudeDoc;
+    claudeDoc["role"] = "assistant";
+    JsonArray blocks = claudeDoc["content"].to<JsonArray>();
+    if (*text) {
+        JsonObject textBlock = blocks.add<JsonObject>();
+        textBlock["type"] = "text";
+        textBlock["text"] = text;
+    }
+
+    JsonDocument openaiDoc;
+    openaiDoc["role"] = "assistant";
+    // For tool calls, content can be null or empty
+    if (*text) {
+        openaiDoc["content"] = text;
+    } else {
+        openaiDoc["content"] = nullptr;
+    }
+    JsonArray toolCalls = openaiDoc["tool_calls"].to<JsonArray>();
+
+    JsonDocument check;
+
+    for (size_t i = 0; i < count; i++) {
+        const char* id = calls[i].id ? calls[i].id : "";
+        const char* name = calls[i].name ? calls[i].name : "";
+        const char* input = calls[i].input;
+
+        // Tool input is embedded raw in the Claude fragment - validate it once
+        // here rather than re-parsing it on every request
+        if (!input || !*input || deserializeJson(check, input)) input = "{}";
+
+        JsonObject toolUse = blocks.add<JsonObject>();
+        toolUse["type"] = "tool_use";
+        toolUse["id"] = id;
+        toolUse["name"] = name;
+        toolUse["input"] = serialized(input);
+
+        JsonObject tc = toolCalls.add<JsonObject>();
+        tc["id"] = id;
+        tc["type"] = "function";
+        JsonObject func = tc["function"].to<JsonObject>();
+        func["name"] = name;
+        func["arguments"] = input;
+    }
+
+    return store(claudeDoc, openaiDoc, false, MessageRole::Assistant, count > 0);
+}
+
+bool ConversationHistory::addToolResults(const HistoryToolResult* results, size_t count) {
+    if (!arena || count == 0) return false;
+
+    JsonDocument claudeDoc;
+    claudeDoc["role"] = "user";
+    JsonArray blocks = claudeDoc["content"].to<JsonArray>();
+
+    // OpenAI wants one "tool" message per result
+    JsonDocument openaiDoc;
+    JsonArray messages = openaiDoc.to<JsonArray>();
+
+    for (size_t i = 0; i < count; i++) {
+        const char* id = results[i].id ? results[i].id : "";
+        const char* content = results[i].content ? results[i].content : "";
+
+        JsonObject toolResult = blocks.add<JsonObject>();
+        toolResult["type"] = "tool_result";
+        toolResult["tool_use_id"] = id;
+        toolResult["content"] = content;
+
+        JsonObject msg = messages.add<JsonObject>();
+        msg["role"] = "tool";
+        msg["tool_call_id"] = id;
+        msg["content"] = content;
+    }
+
+    return store(claudeDoc, openaiDoc, true, MessageRole::Tool, false);
+}
+
+bool ConversationHistory::store(JsonDocument& claudeDoc, JsonDocument& openaiDoc, bool openaiIsList,
+                                MessageRole role, bool hasToolUse) {
+    size_t claudeLen = measureJson(claudeDoc);
+    size_t openaiLen = measureJson(openaiDoc);
+    // A list loses its enclosing brackets
+    if (openaiIsList) openaiLen -= 2;
+    if (claudeLen > UINT16_MAX || openaiLen > UINT16_MAX) {
+        Serial.println("[History] Message too large, not stored");
+        return false;
+    }
+
+    // +1 per fragment for the terminator serializeJson writes; a list is
+    // serialized with its brackets and then shifted down over the '['
+    size_t openaiRoom = openaiIsList ? openaiLen + 2 : openaiLen;
+    int32_t offset = reserve(claudeLen + openaiRoom + 2);
+    if (offset < 0) {
+        Serial.println("[History] Message larger than arena, not stored");
+        return false;
+    }
+
+    char* dst = (char*)arena + offset;
+    serializeJson(claudeDoc, dst, claudeLen + 1);
+
+    char* openaiDst = dst + claudeLen + 1;
+    serializeJson(openaiDoc, openaiDst, openaiRoom + 1);
+    if (openaiIsList) {
+        memmove(openaiDst, openaiDst + 1, openaiLen);
+        openaiDst[openaiLen] = '\0';
+    }
+
+    HistoryEntry& e = entries[(head + count) % HISTORY_MAX_ENTRIES];
+    e.offset = offset;
+    e.claudeLen = claudeLen;
+    e.openaiLen = openaiLen;
+    // Both fragments carry the same strings; the Claude one is estimated
+    e.tokens = min(TokenEstimator::estimate(dst, claudeLen), (uint32_t)UINT16_MAX);
+    e.role = role;
+    e.hasToolUse = hasToolUse;
+    count++;
+    tokenTotal += e.tokens;
+
+    writePos = offset + claudeLen + openaiRoom + 2;
+    return true;
+}
+
+bool ConversationHistory::restore(MessageRole role, bool hasToolUse,
+                                  const uint8_t* claude, size_t claudeLen,
+                                  const uint8_t* openai, size_t openaiLen) {
+    if (!arena || claudeLen > UINT16_MAX || openaiLen > UINT16_MAX) return false;
+
+    int32_t offset = reserve(claudeLen + openaiLen + 2);
+    if (offset < 0) return false;
+
+    uint8_t* dst = arena + offset;
+    memcpy(dst, claude, claudeLen);
+    dst[claudeLen] = '\0';
+    memcpy(dst + claudeLen + 1, openai, openaiLen);
+    dst[claudeLen + 1 + openaiLen] = '\0';
+
+    HistoryEntry& e = entries[(head + count) % HISTORY_MAX_ENTRIES];
+    e.offset = offset;
+    e.claudeLen = claudeLen;
+    e.openaiLen = openaiLen;
+    e.tokens = min(TokenEstimator::estimate((const char*)dst, claudeLen), (uint32_t)UINT16_MAX);
+    e.role = role;
+    e.hasToolUse = hasToolUse;
+    count++;
+    tokenTotal += e.tokens;
+
+    writePos = offset + claudeLen + openaiLen + 2;
+    return true;
+}
+
+int32_t ConversationHistory::reserve(size_t length) {
+    if (length > arenaSize) return -1;
+
+    while (true) {
+        if (count == 0) {
+            writePos = 0;
+            return 0;
+        }
+
+        // Entry ring is full - the oldest turn goes regardless of space
+        if (count == HISTORY_MAX_ENTRIES) {
+            if (dropOldestTurn() == 0) dropOldest();
+            continue;
+        }
+
+        size_t oldest = at(0).offset;
+        bool wrapped = at(count - 1).offset < oldest;
+
+        if (!wrapped) {
+            if (arenaSize - writePos >= length) return writePos;
+            if (oldest >= length) return 0;     // Wrap to the start
+        } else if (oldest - writePos >= length) {
+            return writePos;
+        }
+
+        // Whole turns, so no tool_result outlives its tool_use
+        if (dropOldestTurn() == 0) dropOldest();
+    }
+}
+
+const uint8_t* ConversationHistory::claudeFragment(size_t i, size_t& length) const {
+    const HistoryEntry& e = at(i);
+    length = e.claudeLen;
+    return arena + e.offset;
+}
+
+const uint8_t* ConversationHistory::openaiFragment(size_t i, size_t& length) const {
+    const HistoryEntry& e = at(i);
+    length = e.openaiLen;
+    return arena + e.offset + e.claudeLen + 1;
+}
+
+size_t ConversationHistory::bytesUsed() const {
+    if (count == 0) return 0;
+    size_t oldest = at(0).offset;
+    if (writePos > oldest) return writePos - oldest;
+    return (arenaSize - oldest) + writePos;
+}
@@ -0,0 +1,297 @@
+/**
+ * @file conversation_history.h
+ * @brief Arena-backed conversation history with pre-serialized messages
+ *
+ * Each message is serialized to its Claude and OpenAI JSON form once, when
+ * it is added, and stored in a single arena (PSRAM when available). The
+ * entries form a ring: pruning the oldest message only advances the tail,
+ * and request bodies are assembled by pointing a FragmentStream at the
+ * stored bytes instead of rebuilding a JsonDocument every turn.
+ */
+
+#ifndef CONVERSATION_HISTORY_H
+#define CONVERSATION_HISTORY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Arena size for serialized history (bytes) */
+#define HISTORY_ARENA_SIZE (64 * 1024)
+
+/** Maximum entries held in the ring (oldest dropped beyond this) */
+#define HISTORY_MAX_ENTRIES 32
+
+/** Maximum pieces in one request body */
+#define FRAGMENT_STREAM_MAX_PIECES (HISTORY_MAX_ENTRIES * 2 + 16)
+
+//=============================================================================
+// Message Role
+//=============================================================================
+
+/**
+ * @enum MessageRole
+ * @brief Role of a conversation message
+ */
+enum class MessageRole {
+    User,
+    Assistant,
+    Tool        // For tool results
+};
+
+//=============================================================================
+// FragmentStream
+//=============================================================================
+
+/**
+ * @class FragmentStream
+ * @brief Read-only Stream over a list of borrowed byte ranges
+ *
+ * Handed to HTTPClient::sendRequest() so the request body is copied from
+ * the history arena to the socket in buffer-sized pieces, without ever
+ * existing as one contiguous String. The referenced memory must stay
+ * valid until the request has been sent.
+ */
+class FragmentStream : public Stream {
+public:
+    FragmentStream();
+
+    /**
+     * @brief Drop all pieces
+     */
+    void clear();
+
+    /**
+     * @brief Append a byte range (not copied)
+     * @return false if the piece list is full
+     */
+    bool add(const void* data, size_t length);
+
+    /**
+     * @brief Append a null-terminated string (not copied)
+     */
+    bool add(const char* str) { return add(str, strlen(str)); }
+
+    /**
+     * @brief Append a String's buffer (not copied)
+     */
+    bool add(const String& str) { return add(str.c_str(), str.length()); }
+
+    /**
+     * @brief Total body size in bytes
+     */
+    size_t size() const { return totalSize; }
+
+    /**
+     * @brief Number of pieces
+     */
+    size_t pieceCount() const { return count; }
+
+    /**
+     * @brief Rewind to the first byte
+     */
+    void rewind();
+
+    // Stream interface
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char* buffer, size_t length) override;
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    struct Piece {
+        const uint8_t* data;
+        size_t length;
+    };
+
+    Piece pieces[FRAGMENT_STREAM_MAX_PIECES];
+    size_t count;
+    size_t totalSize;
+
+    // Read cursor
+    size_t pieceIndex;
+    size_t pieceOffset;
+    size_t consumed;
+};
+
+//=============================================================================
+// ConversationHistory
+//=============================================================================
+
+/**
+ * @struct HistoryToolCall
+ * @brief One tool_use block of an assistant message (borrowed strings)
+ */
+struct HistoryToolCall {
+    const char* id;
+    const char* name;
+    const char* input;      ///< Arguments as JSON
+};
+
+/**
+ * @struct HistoryToolResult
+ * @brief One tool_result answering a HistoryToolCall (borrowed strings)
+ */
+struct HistoryToolResult {
+    const char* id;
+    const char* content;
+};
+
+/**
+ * @struct HistoryEntry
+ * @brief Location and metadata of one stored message
+ */
+struct HistoryEntry {
+    uint32_t offset;        ///< Start of the record in the arena
+    uint16_t claudeLen;     ///< Claude fragment length
+    uint16_t openaiLen;     ///< OpenAI fragment length (follows Claude's)
+    uint16_t tokens;        ///< Estimated prompt tokens of the message
+    MessageRole role;
+    bool hasToolUse;        ///< Assistant message carrying tool calls
+};
+
+/**
+ * @class ConversationHistory
+ * @brief Ring of pre-serialized messages in one contiguous arena
+ */
+class ConversationHistory {
+public:
+    ConversationHistory();
+    ~ConversationHistory();
+
+    /**
+     * @brief Allocate the arena (PSRAM preferred)
+     * @return true if allocated
+     */
+    bool begin(size_t arenaBytes = HISTORY_ARENA_SIZE);
+
+    /**
+     * @brief Free the arena
+     */
+    void end();
+
+    /**
+     * @brief Serialize and append a message, evicting the oldest if full
+     * @return true if stored
+     */
+    bool add(MessageRole role, const char* content,
+             const char* toolUseId = nullptr,
+             const char* toolName = nullptr,
+             const char* toolInput = nullptr);
+
+    /**
+     * @brief Append an assistant message carrying one or more tool calls
+     * @param text Text that accompanied the calls (may be empty)
+     */
+    bool addToolCalls(const char* text, const HistoryToolCall* calls, size_t count);
+
+    /**
+     * @brief Append the results of a batch of tool calls as one turn
+     *
+     * Claude gets a single user message with every tool_result block;
+     * OpenAI gets one "tool" message per result, stored back to back.
+     */
+    bool addToolResults(const HistoryToolResult* results, size_t count);
+
+    /**
+     * @brief Append an already-serialized message (restored from flash)
+     * @param claude Claude fragment
+     * @param openai OpenAI fragment
+     */
+    bool restore(MessageRole role, bool hasToolUse,
+                 const uint8_t* claude, size_t claudeLen,
+                 const uint8_t* openai, size_t openaiLen);
+
+    /**
+     * @brief Drop the oldest message (O(1))
+     */
+    void dropOldest();
+
+    /**
+     * @brief Drop the oldest turn: everything before the second user message
+     *
+     * Keeps tool_use / tool_result pairs together and the history starting
+     * with a user message, as both providers require.
+     *
+     * @return Messages dropped (0 if only one turn is stored)
+     */
+    size_t dropOldestTurn();
+
+    /**
+     * @brief Remove every message
+     */
+    void clear();
+
+    /**
+     * @brief Number of stored messages
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Estimated prompt tokens of all stored messages
+     */
+    uint32_t tokens() const { return tokenTotal; }
+
+    /**
+     * @brief Entry metadata, 0 = oldest
+     */
+    const HistoryEntry& at(size_t i) const { return entries[(head + i) % HISTORY_MAX_ENTRIES]; }
+
+    /**
+     * @brief Pre-serialized Claude message object
+     */
+    const uint8_t* claudeFragment(size_t i, size_t& length) const;
+
+    /**
+     * @brief Pre-serialized OpenAI message object
+     */
+    const uint8_t* openaiFragment(size_t i, size_t& length) const;
+
+    /**
+     * @brief Arena bytes currently holding messages
+     */
+    size_t bytesUsed() const;
+
+    /**
+     * @brief Arena capacity
+     */
+    size_t capacity() const { return arenaSize; }
+
+    /**
+     * @brief True if the arena lives in PSRAM
+     */
+    bool isInPsram() const { return inPsram; }
+
+private:
+    /**
+     * @brief Reserve contiguous arena space, evicting oldest entries as needed
+     * @return Offset of the reserved space, or -1 if it can never fit
+     */
+    int32_t reserve(size_t length);
+
+    /**
+     * @brief Serialize both provider forms of a message into the arena
+     * @param openaiIsList openaiDoc is an array whose elements are stored
+     *        as consecutive messages (brackets stripped)
+     */
+    bool store(JsonDocument& claudeDoc, JsonDocument& openaiDoc, bool openaiIsList,
+               MessageRole role, bool hasToolUse);
+
+    uint8_t* arena;
+    size_t arenaSize;
+    bool inPsram;
+
+    HistoryEntry entries[HISTORY_MAX_ENTRIES];
+    size_t head;            ///< Index of the oldest entry
+    size_t count;
+    size_t writePos;        ///< Next free arena byte after the newest record
+    uint32_t tokenTotal;    ///< Sum of entry token estimates
+};
+
+#endif // CONVERSATION_HISTORY_H
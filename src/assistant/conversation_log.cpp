@@ -0,0 +1,255 @@
+/**
+ * @file conversation_log.cpp
+ * @brief Append-only conversation log implementation
+ */
+
+#include "conversation_log.h"
+#include <esp_rom_crc.h>
+#include <stddef.h>
+
+//=============================================================================
+// Constructor / Initialization
+//=============================================================================
+
+ConversationLog::ConversationLog()
+    : available(false)
+    , restored(false)
+    , needsCompaction(false)
+    , fileSize(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool ConversationLog::begin() {
+    uint32_t t0 = micros();
+
+    // Usually already mounted by the audio player
+    available = LittleFS.begin(true);
+    if (!available) {
+        Serial.println("[HistoryLog] LittleFS not available, history not persisted");
+        restored = true;
+        return false;
+    }
+
+    // Only the size is read here - the records are loaded on first use
+    fileSize = 0;
+    if (LittleFS.exists(CONV_LOG_PATH)) {
+        File file = LittleFS.open(CONV_LOG_PATH, "r");
+        if (file) {
+            fileSize = file.size();
+            file.close();
+        }
+    }
+    restored = (fileSize == 0);
+
+    stats.beginUs = micros() - t0;
+    Serial.printf("[HistoryLog] %u bytes from previous session (%lu us)\n",
+                  fileSize, stats.beginUs);
+    return true;
+}
+
+//=============================================================================
+// Restore
+//=============================================================================
+
+uint32_t ConversationLog::recordCrc(const RecordHeader& header,
+                                    const uint8_t* claude, const uint8_t* openai) {
+    uint32_t crc = esp_rom_crc32_le(0, &header.role,
+                                    offsetof(RecordHeader, crc) - offsetof(RecordHeader, role));
+    crc = esp_rom_crc32_le(crc, claude, header.claudeLen);
+    crc = esp_rom_crc32_le(crc, openai, header.openaiLen);
+    return crc;
+}
+
+size_t ConversationLog::restore(ConversationHistory& history) {
+    if (restored) return 0;
+    restored = true;
+    if (!available) return 0;
+
+    uint32_t startTime = millis();
+
+    File file = LittleFS.open(CONV_LOG_PATH, "r");
+    if (!file) return 0;
+
+    uint8_t* payload = nullptr;
+    size_t payloadCap = 0;
+    size_t goodBytes = 0;
+    size_t count = 0;
+
+    while (true) {
+        RecordHeader header;
+        size_t n = file.read((uint8_t*)&header, sizeof(header));
+        if (n == 0) break;      // Clean end of log
+
+        if (n != sizeof(header) || header.magic != CONV_LOG_MAGIC ||
+            header.role > (uint8_t)MessageRole::Tool) {
+            stats.corruptRecords++;
+            break;
+        }
+
+        size_t length = header.claudeLen + header.openaiLen;
+        if (length > payloadCap) {
+            uint8_t* grown = (uint8_t*)realloc(payload, length);
+            if (!grown) break;
+            payload = grown;
+            payloadCap = length;
+        }
+
+        if (file.read(payload, length) != length ||
+            recordCrc(header, payload, payload + header.claudeLen) != header.crc) {
+            // Torn write from a power cut - everything before it is good
+            stats.corruptRecords++;
+            break;
+        }
+
+        history.restore((MessageRole)header.role, header.flags & FLAG_TOOL_USE,
+                        payload, header.claudeLen,
+                        payload + header.claudeLen, header.openaiLen);
+        goodBytes += sizeof(header) + length;
+        count++;
+    }
+
+    file.close();
+    free(payload);
+
+    // Rewrite without the bad tail before anything is appended after it
+    if (goodBytes < fileSize) needsCompaction = true;
+
+    // A restored history must still start at a user message
+    while (history.size() > 0 && history.at(0).role != MessageRole::User) {
+        history.dropOldest();
+    }
+
+    stats.restoredRecords = count;
+    stats.restoreMs = millis() - startTime;
+    Serial.printf("[HistoryLog] Restored %u messages (%u bytes) in %lu ms%s\n",
+                  count, goodBytes, stats.restoreMs,
+                  stats.corruptRecords ? ", corrupt tail dropped" : "");
+    return count;
+}
+
+//=============================================================================
+// Append / Compaction
+//=============================================================================
+
+size_t ConversationLog::writeRecord(File& file, const ConversationHistory& history, size_t i) {
+    const HistoryEntry& e = history.at(i);
+
+    size_t claudeLen, openaiLen;
+    const uint8_t* claude = history.claudeFragment(i, claudeLen);
+    const uint8_t* openai = history.openaiFragment(i, openaiLen);
+
+    RecordHeader header;
+    header.magic = CONV_LOG_MAGIC;
+    header.role = (uint8_t)e.role;
+    header.flags = e.hasToolUse ? FLAG_TOOL_USE : 0;
+    header.claudeLen = claudeLen;
+    header.openaiLen = openaiLen;
+    header.crc = recordCrc(header, claude, openai);
+
+    size_t written = file.write((const uint8_t*)&header, sizeof(header));
+    written += file.write(claude, claudeLen);
+    written += file.write(openai, openaiLen);
+
+    size_t expected = sizeof(header) + claudeLen + openaiLen;
+    return written == expected ? written : 0;
+}
+
+void ConversationLog::appendNewest(const ConversationHistory& history) {
+    if (!available || history.size() == 0) return;
+
+    size_t last = history.size() - 1;
+    const HistoryEntry& e = history.at(last);
+    size_t recordSize = sizeof(RecordHeader) + e.claudeLen + e.openaiLen;
+
+    // Rewriting also persists this record - it is already in history
+    if (needsCompaction || fileSize + recordSize > CONV_LOG_MAX_BYTES) {
+        compact(history);
+        return;
+    }
+
+    File file = LittleFS.open(CONV_LOG_PATH, "a");
+    if (!file) {
+        Serial.println("[HistoryLog] Failed to open log for append");
+        return;
+    }
+    size_t written = writeRecord(file, history, last);
+    file.close();
+
+    if (written == 0) {
+        // Partial record on flash - drop it at the next append
+        needsCompaction = true;
+        Serial.println("[HistoryLog] Append failed");
+        return;
+    }
+
+    fileSize += written;
+    stats.appends++;
+    stats.appendedBytes += written;
+    stats.flashBytes += written;
+}
+
+bool ConversationLog::compact(const ConversationHistory& history) {
+    if (history.size() == 0) return false;
+    uint32_t startTime = millis();
+
+    File file = LittleFS.open(CONV_LOG_TEMP_PATH, "w");
+    if (!file) {
+        Serial.println("[HistoryLog] Failed to open temp file");
+        return false;
+    }
+
+    // Keep the newest turns within half the cap so the log isn't rewritten
+    // on every append when the history itself is near the cap
+    size_t start = history.size();
+    size_t keepBytes = 0;
+    while (start > 0) {
+        const HistoryEntry& e = history.at(start - 1);
+        size_t recordSize = sizeof(RecordHeader) + e.claudeLen + e.openaiLen;
+        if (keepBytes + recordSize > CONV_LOG_MAX_BYTES / 2 && start < history.size()) break;
+        keepBytes += recordSize;
+        start--;
+    }
+    while (start < history.size() - 1 && history.at(start).role != MessageRole::User) start++;
+
+    size_t total = 0;
+    bool ok = true;
+    for (size_t i = start; i < history.size() && ok; i++) {
+        size_t n = writeRecord(file, history, i);
+        ok = n > 0;
+        total += n;
+    }
+    file.close();
+
+    // The rename replaces the old log atomically
+    if (!ok || !LittleFS.rename(CONV_LOG_TEMP_PATH, CONV_LOG_PATH)) {
+        LittleFS.remove(CONV_LOG_TEMP_PATH);
+        Serial.println("[HistoryLog] Compaction failed");
+        return false;
+    }
+
+    // The newest record counts as appended; the rest is rewrite overhead
+    if (history.size() > 0) {
+        const HistoryEntry& e = history.at(history.size() - 1);
+        stats.appends++;
+        stats.appendedBytes += sizeof(RecordHeader) + e.claudeLen + e.openaiLen;
+    }
+
+    fileSize = total;
+    needsCompaction = false;
+    stats.flashBytes += total;
+    stats.compactions++;
+
+    Serial.printf("[HistoryLog] Compacted to %u messages, %u bytes in %lu ms\n",
+                  history.size() - start, total, millis() - startTime);
+    return true;
+}
+
+void ConversationLog::clear() {
+    restored = true;
+    needsCompaction = false;
+    fileSize = 0;
+    if (available && LittleFS.exists(CONV_LOG_PATH)) {
+        LittleFS.remove(CONV_LOG_PATH);
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * @file conversation_log.h
+ * @brief Append-only conversation log on LittleFS
+ *
+ * Keeps the running conversation across reboots (OTA, brownout, crash).
+ * Every message added to ConversationHistory is appended as one binary
+ * record holding its pre-serialized Claude and OpenAI fragments, so
+ * restoring is a sequential read and memcpy into the arena - no JSON is
+ * parsed at boot.
+ *
+ * Record layout (little-endian):
+ *   u16 magic | u8 role | u8 flags | u16 claudeLen | u16 openaiLen |
+ *   u32 crc32 | claude bytes | openai bytes
+ *
+ * The CRC covers role through the payload. A torn or corrupt record ends
+ * the restore; the next append compacts the file, which drops it. When
+ * the file passes CONV_LOG_MAX_BYTES it is rewritten from the (already
+ * pruned) in-memory history.
+ */
+
+#ifndef CONVERSATION_LOG_H
+#define CONVERSATION_LOG_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "conversation_history.h"
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Log file path */
+#define CONV_LOG_PATH "/conversation.log"
+
+/** Temporary file used while compacting */
+#define CONV_LOG_TEMP_PATH "/conversation.tmp"
+
+/** Compact once the log grows past this (bytes) */
+#define CONV_LOG_MAX_BYTES (48 * 1024)
+
+/** Record marker */
+#define CONV_LOG_MAGIC 0xC07E
+
+//=============================================================================
+// Statistics
+//=============================================================================
+
+/**
+ * @struct ConversationLogStats
+ * @brief Persistence counters since boot
+ */
+struct ConversationLogStats {
+    uint32_t beginUs;           ///< Time spent in begin() (boot cost)
+    uint32_t restoreMs;         ///< Time spent restoring (first use)
+    uint32_t restoredRecords;   ///< Messages restored
+    uint32_t corruptRecords;    ///< Records rejected by length/CRC check
+    uint32_t appends;           ///< Records appended
+    uint32_t appendedBytes;     ///< Bytes of records appended
+    uint32_t flashBytes;        ///< Bytes written including compaction
+    uint32_t compactions;       ///< Rewrites of the log
+};
+
+//=============================================================================
+// ConversationLog Class
+//=============================================================================
+
+/**
+ * @class ConversationLog
+ * @brief Binary append-only log mirroring a ConversationHistory
+ *
+ * Called from whichever task owns the history (the LLM worker); not
+ * internally synchronized.
+ */
+class ConversationLog {
+public:
+    ConversationLog();
+
+    /**
+     * @brief Check for a log from the previous boot (does not read it)
+     * @return true if the filesystem is available
+     */
+    bool begin();
+
+    /**
+     * @brief Load logged messages into history
+     *
+     * Call once before the history is first used. Records that no longer
+     * fit are evicted by the arena as usual.
+     *
+     * @return Number of messages restored
+     */
+    size_t restore(ConversationHistory& history);
+
+    /**
+     * @brief Append the newest history message
+     * @param history History whose last entry was just added
+     */
+    void appendNewest(const ConversationHistory& history);
+
+    /**
+     * @brief Delete the log (conversation cleared)
+     */
+    void clear();
+
+    /**
+     * @brief True once restore() has run (or nothing needed restoring)
+     */
+    bool isRestored() const { return restored; }
+
+    /**
+     * @brief Persistence counters
+     */
+    const ConversationLogStats& getStats() const { return stats; }
+
+    /**
+     * @brief Current log file size (bytes)
+     */
+    size_t getFileSize() const { return fileSize; }
+
+private:
+    struct __attribute__((packed)) RecordHeader {
+        uint16_t magic;
+        uint8_t role;
+        uint8_t flags;
+        uint16_t claudeLen;
+        uint16_t openaiLen;
+        uint32_t crc;
+    };
+
+    /** RecordHeader::flags */
+    static const uint8_t FLAG_TOOL_USE = 0x01;
+
+    /**
+     * @brief Write history entry i as one record
+     * @return Bytes written, 0 on failure
+     */
+    size_t writeRecord(File& file, const ConversationHistory& history, size_t i);
+
+    /**
+     * @brief Rewrite the log from the in-memory history
+     */
+    bool compact(const ConversationHistory& history);
+
+    /**
+     * @brief CRC over the header fields after the CRC and the payload
+     */
+    static uint32_t recordCrc(const RecordHeader& header,
+                              const uint8_t* claude, const uint8_t* openai);
+
+    bool available;
+    bool restored;
+    bool needsCompaction;       ///< Tail is corrupt or the cap was hit
+    size_t fileSize;
+    ConversationLogStats stats;
+};
+
+#endif // CONVERSATION_LOG_H
@@ -0,0 +1,245 @@
+/**
+ * @file device_tool_queue.cpp
+ * @brief Main-loop hand-over for device tool calls
+ */
+
+#include "device_tool_queue.h"
+#include "device_tools.h"
+
+DeviceToolQueue deviceToolQueue;
+
+//=============================================================================
+// Constructor / Initialization
+//=============================================================================
+
+DeviceToolQueue::DeviceToolQueue()
+    : mutex(nullptr)
+    , mainTask(nullptr)
+    , stagedCount(0)
+{
+    for (Slot& slot : slots) {
+        slot.state = SlotState::Free;
+        slot.toolName = nullptr;
+        slot.input = nullptr;
+        slot.stagedMs = 0;
+        slot.done = nullptr;
+        slot.detached = false;
+        slot.cancelled = false;
+    }
+    memset(&stats, 0, sizeof(stats));
+}
+
+void DeviceToolQueue::begin() {
+    if (mutex) return;
+    mainTask = xTaskGetCurrentTaskHandle();
+    for (Slot& slot : slots) {
+        slot.done = xSemaphoreCreateBinary();
+    }
+    mutex = xSemaphoreCreateMutex();
+}
+
+//=============================================================================
+// Calls (any task)
+//=============================================================================
+
+String DeviceToolQueue::call(const char* toolName, const char* input) {
+    return dispatch(toolName, input ? input : "{}", JsonObjectConst());
+}
+
+String DeviceToolQueue::call(const char* toolName, JsonObjectConst arguments) {
+    return dispatch(toolName, nullptr, arguments);
+}
+
+String DeviceToolQueue::run(const char* toolName, const char* input, JsonObjectConst arguments) {
+    return input ? executeDeviceTool(toolName, input) : executeDeviceTool(toolName, arguments);
+}
+
+String DeviceToolQueue::dispatch(const char* toolName, const char* input, JsonObjectConst arguments) {
+    // Before begin() nothing else is running; on the main loop, run it now
+    if (!mutex || xTaskGetCurrentTaskHandle() == mainTask) {
+        stats.inlineCalls++;
+        return run(toolName, input, arguments);
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    Slot* slot = freeSlot();
+    if (!slot) {
+        stats.busy++;
+        xSemaphoreGive(mutex);
+        Serial.printf("[DeviceTools] %s rejected, %d calls waiting\n", toolName, DEVICE_TOOL_QUEUE_SLOTS);
+        return "{\"error\":\"Device busy, try again\"}";
+    }
+    slot->state = SlotState::Staged;
+    slot->toolName = toolName;
+    slot->input = input;
+    slot->arguments = arguments;
+    slot->stagedMs = millis();
+    slot->result = "";
+    slot->detached = false;
+    xSemaphoreTake(slot->done, 0);  // Clear a wake-up left by a withdrawn call
+    stagedCount++;
+    stats.queued++;
+    xSemaphoreGive(mutex);
+
+    bool finished = xSemaphoreTake(slot->done, pdMS_TO_TICKS(DEVICE_TOOL_TIMEOUT_MS)) == pdTRUE;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (!finished && slot->state == SlotState::Staged) {
+        // Not started: withdraw it so the main loop never sees our arguments
+        slot->state = SlotState::Free;
+        stagedCount--;
+        stats.timeouts++;
+        xSemaphoreGive(mutex);
+        Serial.printf("[DeviceTools] %s timed out waiting for the main loop\n", toolName);
+        return "{\"error\":\"Device did not respond\"}";
+    }
+    bool running = (slot->state == SlotState::Running);
+    xSemaphoreGive(mutex);
+
+    // Started: it reads our arguments, so wait for it to finish
+    if (running) xSemaphoreTake(slot->done, portMAX_DELAY);
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    String result = std::move(slot->result);
+    slot->state = SlotState::Free;
+    xSemaphoreGive(mutex);
+    return result;
+}
+
+DeviceToolQueue::Slot* DeviceToolQueue::freeSlot() {
+    for (Slot& slot : slots) {
+        if (slot.state == SlotState::Free) return &slot;
+    }
+    return nullptr;
+}
+
+//=============================================================================
+// Staged Calls (any task, without waiting)
+//=============================================================================
+
+int DeviceToolQueue::stage(const char* toolName, JsonObjectConst arguments, String& result) {
+    if (!mutex || xTaskGetCurrentTaskHandle() == mainTask) {
+        stats.inlineCalls++;
+        result = run(toolName, nullptr, arguments);
+        return -1;
+    }
+
+    // Copied before taking the mutex; the request they came from is freed
+    // as soon as this returns
+    String name = toolName;
+    String input;
+    if (arguments.isNull()) {
+        input = "{}";
+    } else {
+        serializeJson(arguments, input);
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    Slot* slot = freeSlot();
+    if (!slot) {
+        stats.busy++;
+        xSemaphoreGive(mutex);
+        Serial.printf("[DeviceTools] %s rejected, %d calls waiting\n", toolName, DEVICE_TOOL_QUEUE_SLOTS);
+        result = "{\"error\":\"Device busy, try again\"}";
+        return -1;
+    }
+    slot->ownedName = std::move(name);
+    slot->ownedInput = std::move(input);
+    slot->state = SlotState::Staged;
+    slot->toolName = slot->ownedName.c_str();
+    slot->input = slot->ownedInput.c_str();
+    slot->arguments = JsonObjectConst();
+    slot->stagedMs = millis();
+    slot->result = "";
+    slot->detached = true;
+    slot->cancelled = false;
+    stagedCount++;
+    stats.queued++;
+    stats.staged++;
+    xSemaphoreGive(mutex);
+    return slot - slots;
+}
+
+bool DeviceToolQueue::poll(int ticket, String& result) {
+    if (ticket < 0 || ticket >= DEVICE_TOOL_QUEUE_SLOTS) return false;
+    Slot& slot = slots[ticket];
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool ready = false;
+    if (slot.state == SlotState::Done) {
+        result = std::move(slot.result);
+        release(slot);
+        ready = true;
+    } else if (slot.state == SlotState::Staged && millis() - slot.stagedMs >= DEVICE_TOOL_TIMEOUT_MS) {
+        // Not started in time: withdrawn, as a waiting call() would be
+        stagedCount--;
+        stats.timeouts++;
+        Serial.printf("[DeviceTools] %s timed out waiting for the main loop\n", slot.toolName);
+        release(slot);
+        result = "{\"error\":\"Device did not respond\"}";
+        ready = true;
+    }
+    xSemaphoreGive(mutex);
+    return ready;
+}
+
+void DeviceToolQueue::cancel(int ticket) {
+    if (ticket < 0 || ticket >= DEVICE_TOOL_QUEUE_SLOTS) return;
+    Slot& slot = slots[ticket];
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (slot.state == SlotState::Staged) {
+        stagedCount--;
+        release(slot);
+    } else if (slot.state == SlotState::Done) {
+        release(slot);
+    } else if (slot.state == SlotState::Running) {
+        slot.cancelled = true;      // update() frees it when the tool returns
+    }
+    stats.cancelled++;
+    xSemaphoreGive(mutex);
+}
+
+void DeviceToolQueue::release(Slot& slot) {
+    slot.state = SlotState::Free;
+    slot.detached = false;
+    slot.cancelled = false;
+    slot.ownedName = String();
+    slot.ownedInput = String();
+    slot.result = String();
+}
+
+//=============================================================================
+// Execution (main loop)
+//=============================================================================
+
+void DeviceToolQueue::update() {
+    if (stagedCount == 0) return;
+
+    for (Slot& slot : slots) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        bool start = (slot.state == SlotState::Staged);
+        if (start) {
+            slot.state = SlotState::Running;
+            stagedCount--;
+            uint32_t waited = millis() - slot.stagedMs;
+            if (waited > stats.maxWaitMs) stats.maxWaitMs = waited;
+        }
+        xSemaphoreGive(mutex);
+        if (!start) continue;
+
+        String result = run(slot.toolName, slot.input, slot.arguments);
+
+        // A detached call is picked up by poll(); nobody waits on done
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        bool detached = slot.detached;
+        if (slot.cancelled) {
+            release(slot);
+        } else {
+            slot.result = std::move(result);
+            slot.state = SlotState::Done;
+        }
+        xSemaphoreGive(mutex);
+        if (!detached) xSemaphoreGive(slot.done);
+    }
+}
@@ -0,0 +1,160 @@
+/**
+ * @file device_tool_queue.h
+ * @brief Hands device tool calls from other tasks to the main loop
+ *
+ * Device tool handlers touch the renderer, the timers, the audio player
+ * and the settings menu, all owned by the main loop on core 1. LLM tool
+ * rounds run on the "llm_request" task and MCP tools/call on the MCP
+ * server task, both on core 0, so they must not call the handlers
+ * directly.
+ *
+ * call() stages the call in a slot under a mutex and waits; update(),
+ * called by the main loop, runs staged calls and wakes the caller with
+ * the result JSON. Called from the main loop itself, call() runs the tool
+ * inline. A call the main loop has not picked up within
+ * DEVICE_TOOL_TIMEOUT_MS is withdrawn and answered with an error; one it
+ * has started is always waited for, since it uses the caller's arguments.
+ *
+ * A task that must not block (the MCP server, which services every
+ * client from one select() loop) uses stage() instead: the slot keeps
+ * its own copy of the call, and poll() picks up the result later.
+ */
+
+#ifndef DEVICE_TOOL_QUEUE_H
+#define DEVICE_TOOL_QUEUE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Calls waiting for the main loop at once (LLM round + MCP sessions) */
+#define DEVICE_TOOL_QUEUE_SLOTS 4
+
+/** Longest wait for the main loop to start a call (ms) */
+#define DEVICE_TOOL_TIMEOUT_MS 5000
+
+//=============================================================================
+// Types
+//=============================================================================
+
+/**
+ * @struct DeviceToolQueueStats
+ * @brief Hand-over counters since boot
+ */
+struct DeviceToolQueueStats {
+    uint32_t queued;            ///< Calls handed to the main loop
+    uint32_t inlineCalls;       ///< Calls made on the main loop itself
+    uint32_t busy;              ///< Rejected, every slot in use
+    uint32_t timeouts;          ///< Withdrawn before the main loop started them
+    uint32_t staged;            ///< Of queued, handed over by stage() (nobody waits)
+    uint32_t cancelled;         ///< Staged calls dropped by cancel()
+    uint32_t maxWaitMs;         ///< Longest stage-to-start delay
+};
+
+//=============================================================================
+// DeviceToolQueue Class
+//=============================================================================
+
+class DeviceToolQueue {
+public:
+    DeviceToolQueue();
+
+    /**
+     * @brief Create the slots (main loop, in setup())
+     *
+     * The calling task becomes the one update() is expected on.
+     */
+    void begin();
+
+    /**
+     * @brief Run a device tool on the main loop (any task)
+     * @param toolName Device tool name
+     * @param input JSON arguments as text
+     * @return Result JSON
+     */
+    String call(const char* toolName, const char* input);
+
+    /**
+     * @brief Run a device tool with parsed arguments on the main loop (any task)
+     */
+    String call(const char* toolName, JsonObjectConst arguments);
+
+    /**
+     * @brief Hand a device tool call to the main loop without waiting (any task)
+     *
+     * The name and arguments are copied, so they may go away once this
+     * returns. On the main loop, before begin(), or with every slot in
+     * use, there is nothing to wait for: the result is set at once.
+     *
+     * @param result Set when no ticket is returned
+     * @return Ticket for poll(), or -1 with result set
+     */
+    int stage(const char* toolName, JsonObjectConst arguments, String& result);
+
+    /**
+     * @brief Collect a staged call's result (the task that staged it)
+     *
+     * A call the main loop has not started within DEVICE_TOOL_TIMEOUT_MS
+     * is withdrawn and completes with an error. The ticket is spent once
+     * this returns true.
+     *
+     * @return true with result set once the call is done
+     */
+    bool poll(int ticket, String& result);
+
+    /**
+     * @brief Drop a staged call whose result is no longer wanted
+     *
+     * One the main loop is running finishes, and its slot is freed then.
+     */
+    void cancel(int ticket);
+
+    /**
+     * @brief Run staged calls (main loop, every iteration)
+     */
+    void update();
+
+    const DeviceToolQueueStats& getStats() const { return stats; }
+
+private:
+    enum class SlotState : uint8_t { Free, Staged, Running, Done };
+
+    struct Slot {
+        SlotState state;
+        const char* toolName;
+        const char* input;          ///< Text arguments, or nullptr
+        JsonObjectConst arguments;  ///< Parsed arguments when input is nullptr
+        uint32_t stagedMs;
+        String result;
+        SemaphoreHandle_t done;
+        bool detached;              ///< From stage(): polled, not waited on
+        bool cancelled;             ///< Detached and no longer wanted
+        String ownedName;           ///< Copies toolName and input point into
+        String ownedInput;
+    };
+
+    String dispatch(const char* toolName, const char* input, JsonObjectConst arguments);
+    static String run(const char* toolName, const char* input, JsonObjectConst arguments);
+
+    /** First free slot, or nullptr (mutex held) */
+    Slot* freeSlot();
+
+    /** Free a detached slot (mutex held) */
+    static void release(Slot& slot);
+
+    Slot slots[DEVICE_TOOL_QUEUE_SLOTS];
+    SemaphoreHandle_t mutex;
+    TaskHandle_t mainTask;
+    volatile uint8_t stagedCount;
+    DeviceToolQueueStats stats;
+};
+
+extern DeviceToolQueue deviceToolQueue;
+
+#endif // DEVICE_TOOL_QUEUE_H
@@ -1,9 +1,750 @@
 /**
  * @file device_tools.cpp
- * @brief Device tool callbacks implementation
+ * @brief Device tool table, lookup and dispatch
  */
 
 #include "device_tools.h"
 
 // Global callbacks instance
 DeviceToolCallbacks deviceToolCallbacks;
+
+//=============================================================================
+// Tool JSON Schemas
+//=============================================================================
+
+// JSON schema for set_expression tool
+static constexpr const char* SET_EXPRESSION_SCHEMA = R"({
+    "type": "object",
+    "properties": {
+        "expression": {
+            "type": "string",
+            "description": "The expression to show. Valid values: neutral, happy, sad, surprised, angry, suspicious, sleepy, scared, content, focused, confused, curious, thinking, alert, listening, love, excited, relaxed"
+        },
+        "duration_ms": {
+            "type": "integer",
+            "description": "How long to show the expression in milliseconds. 0 for indefinite.",
+            "default": 0
+        }
+    },
+    "required": ["expression"]
+})";
+
+// JSON schema for play_sequence tool
+static constexpr const char* PLAY_SEQUENCE_SCHEMA = R"({
+    "type": "object",
+    "properties": {
+        "steps": {
+            "type": "array",
+            "description": "Timeline played in order. Each step can set an expression, a gaze direction and a sound at once, then holds for duration_ms before the next step.",
+            "maxItems": 32,
+            "items": {
+                "type": "object",
+                "properties": {
+                    "expression": {
+                        "type": "string",
+                        "description": "Expression as for set_expression, or wink"
+                    },
+                    "look": {
+                        "type": "string",
+                        "enum": ["center", "left", "right", "up", "down"],
+                        "description": "Where to look; gaze_x/gaze_y give finer control"
+                    },
+                    "gaze_x": {
+                        "type": "number",
+                        "minimum": -1,
+                        "maximum": 1,
+                        "description": "Horizontal gaze, -1 left to 1 right"
+                    },
+                    "gaze_y": {
+                        "type": "number",
+                        "minimum": -1,
+                        "maximum": 1,
+                        "description": "Vertical gaze, -1 up to 1 down"
+                    },
+                    "sound": {
+                        "type": "string",
+                        "enum": ["happy", "sad", "alert", "confirm", "error"]
+                    },
+                    "duration_ms": {
+                        "type": "integer",
+                        "minimum": 0,
+                        "maximum": 10000,
+                        "description": "How long to hold this step",
+                        "default": 0
+                    }
+                }
+            }
+        }
+    },
+    "required": ["steps"]
+})";
+
+// JSON schema for set_timer tool
+static constexpr const char* SET_TIMER_SCHEMA = R"({
+    "type": "object",
+    "properties": {
+        "duration_seconds": {
+            "type": "integer",
+            "description": "Timer duration in seconds"
+        },
+        "name": {
+            "type": "string",
+            "description": "Optional name for the timer",
+            "default": "Timer"
+        }
+    },
+    "required": ["duration_seconds"]
+})";
+
+// JSON schema for start_pomodoro tool
+static constexpr const char* START_POMODORO_SCHEMA = R"({
+    "type": "object",
+    "properties": {
+        "work_minutes": {
+            "type": "integer",
+            "description": "Work duration in minutes",
+            "default": 25
+        },
+        "break_minutes": {
+            "type": "integer",
+            "description": "Short break duration in minutes",
+            "default": 5
+        }
+    }
+})";
+
+// JSON schema for tools without parameters
+static constexpr const char* EMPTY_SCHEMA = R"({
+    "type": "object",
+    "properties": {}
+})";
+
+// JSON schema for play_sound tool
+static constexpr const char* PLAY_SOUND_SCHEMA = R"({
+    "type": "object",
+    "properties": {
+        "sound": {
+            "type": "string",
+            "description": "Sound to play: happy, sad, alert, confirm, error"
+        }
+    },
+    "required": ["sound"]
+})";
+
+// JSON schema for set_reminder tool
+static constexpr const char* SET_REMINDER_SCHEMA = R"({
+    "type": "object",
+    "properties": {
+        "hour": {
+            "type": "integer",
+            "description": "Hour (0-23) to trigger the reminder"
+        },
+        "minute": {
+            "type": "integer",
+            "description": "Minute (0-59) to trigger the reminder"
+        },
+        "message": {
+            "type": "string",
+            "description": "Reminder message (max 48 chars), shown on screen in large text"
+        },
+        "recurring": {
+            "type": "boolean",
+            "description": "If true, reminder repeats daily. Default false (one-shot).",
+            "default": false
+        }
+    },
+    "required": ["hour", "minute", "message"]
+})";
+
+// JSON schema for cancel_reminder tool
+static constexpr const char* CANCEL_REMINDER_SCHEMA = R"({
+    "type": "object",
+    "properties": {
+        "message": {
+            "type": "string",
+            "description": "Partial text match to find and remove the reminder"
+        }
+    },
+    "required": ["message"]
+})";
+
+// JSON schema for set_volume tool
+static constexpr const char* SET_VOLUME_SCHEMA = R"json({
+    "type": "object",
+    "properties": {
+        "volume": {
+            "type": "integer",
+            "description": "Volume level (0-100)",
+            "minimum": 0,
+            "maximum": 100
+        }
+    },
+    "required": ["volume"]
+})json";
+
+// JSON schema for set_brightness tool
+static constexpr const char* SET_BRIGHTNESS_SCHEMA = R"json({
+    "type": "object",
+    "properties": {
+        "brightness": {
+            "type": "integer",
+            "description": "Screen brightness (0-100)",
+            "minimum": 0,
+            "maximum": 100
+        }
+    },
+    "required": ["brightness"]
+})json";
+
+// JSON schema for set_eye_color tool
+static constexpr const char* SET_EYE_COLOR_SCHEMA = R"({
+    "type": "object",
+    "properties": {
+        "color": {
+            "type": "string",
+            "description": "Eye color name: cyan, pink, green, orange, purple, white, red, blue"
+        }
+    },
+    "required": ["color"]
+})";
+
+
+//=============================================================================
+// Tool Handlers
+//=============================================================================
+// Argument indices follow the ToolArgSpec order of the tool's table entry.
+
+static void setExpressionTool(const ToolArgs& args, JsonObject result) {
+    const char* expression = args.string(0);
+    if (!deviceToolCallbacks.onSetExpression) {
+        result["error"] = "Expression control not available";
+        return;
+    }
+    deviceToolCallbacks.onSetExpression(expression, args.integer(1));
+    result["success"] = true;
+    result["expression"] = expression;
+}
+
+static void playSequenceTool(const ToolArgs& args, JsonObject result) {
+    if (!deviceToolCallbacks.onPlaySequence) {
+        result["error"] = "Sequence playback not available";
+        return;
+    }
+
+    // The whole timeline is checked before any of it plays
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    String error;
+    int count = ExpressionSequence::parse(args.array(0), steps, error);
+    if (count < 0) {
+        result["error"] = error;
+        return;
+    }
+    if (!deviceToolCallbacks.onPlaySequence(steps, count)) {
+        result["error"] = "Sequence player not ready";
+        return;
+    }
+    result["success"] = true;
+    result["steps"] = count;
+    result["duration_ms"] = ExpressionSequence::totalMs(steps, count);
+}
+
+static void setTimerTool(const ToolArgs& args, JsonObject result) {
+    int seconds = args.integer(0);
+    const char* name = args.string(1);
+    if (!deviceToolCallbacks.onSetTimer) {
+        result["error"] = "Timer not available";
+        return;
+    }
+    deviceToolCallbacks.onSetTimer(seconds, name);
+    result["success"] = true;
+    result["timer_name"] = name;
+    result["duration_seconds"] = seconds;
+}
+
+static void cancelTimerTool(const ToolArgs& args, JsonObject result) {
+    if (!deviceToolCallbacks.onCancelTimer) {
+        result["error"] = "Timer not available";
+        return;
+    }
+    deviceToolCallbacks.onCancelTimer();
+    result["success"] = true;
+}
+
+static void startPomodoroTool(const ToolArgs& args, JsonObject result) {
+    int workMin = args.integer(0);
+    int breakMin = args.integer(1);
+    if (!deviceToolCallbacks.onStartPomodoro) {
+        result["error"] = "Pomodoro not available";
+        return;
+    }
+    deviceToolCallbacks.onStartPomodoro(workMin, breakMin);
+    result["success"] = true;
+    result["work_minutes"] = workMin;
+    result["break_minutes"] = breakMin;
+}
+
+static void stopPomodoroTool(const ToolArgs& args, JsonObject result) {
+    if (!deviceToolCallbacks.onStopPomodoro) {
+        result["error"] = "Pomodoro not available";
+        return;
+    }
+    deviceToolCallbacks.onStopPomodoro();
+    result["success"] = true;
+}
+
+static void getDeviceInfoTool(const ToolArgs& args, JsonObject result) {
+    if (!deviceToolCallbacks.onGetDeviceInfo) {
+        result["error"] = "Device info not available";
+        return;
+    }
+    // Already JSON - embedded as is instead of parsed and re-serialized
+    String info = deviceToolCallbacks.onGetDeviceInfo();
+    if (info.length() > 0) result["device_info"] = serialized(info);
+    result["success"] = true;
+}
+
+static void playSoundTool(const ToolArgs& args, JsonObject result) {
+    const char* sound = args.string(0);
+    if (!deviceToolCallbacks.onPlaySound) {
+        result["error"] = "Sound playback not available";
+        return;
+    }
+    deviceToolCallbacks.onPlaySound(sound);
+    result["success"] = true;
+    result["sound"] = sound;
+}
+
+static void setReminderTool(const ToolArgs& args, JsonObject result) {
+    int hour = args.integer(0);
+    int minute = args.integer(1);
+    const char* message = args.string(2);
+    bool recurring = args.boolean(3);
+    if (!deviceToolCallbacks.onSetReminder) {
+        result["error"] = "Reminders not available";
+        return;
+    }
+    if (!deviceToolCallbacks.onSetReminder(hour, minute, message, recurring)) {
+        result["error"] = "Failed to add reminder (max 20 reached or invalid)";
+        return;
+    }
+    result["success"] = true;
+    result["hour"] = hour;
+    result["minute"] = minute;
+    result["message"] = message;
+    result["recurring"] = recurring;
+}
+
+static void cancelReminderTool(const ToolArgs& args, JsonObject result) {
+    if (!deviceToolCallbacks.onCancelReminder) {
+        result["error"] = "Reminders not available";
+        return;
+    }
+    if (!deviceToolCallbacks.onCancelReminder(args.string(0))) {
+        result["error"] = "No matching reminder found";
+        return;
+    }
+    result["success"] = true;
+}
+
+static void listRemindersTool(const ToolArgs& args, JsonObject result) {
+    if (!deviceToolCallbacks.onListReminders) {
+        result["error"] = "Reminders not available";
+        return;
+    }
+    String list = deviceToolCallbacks.onListReminders();
+    if (list.length() > 0) result["reminders"] = serialized(list);
+    result["success"] = true;
+}
+
+static void startBreathingTool(const ToolArgs& args, JsonObject result) {
+    if (!deviceToolCallbacks.onStartBreathing) {
+        result["error"] = "Breathing exercise not available";
+        return;
+    }
+    deviceToolCallbacks.onStartBreathing();
+    result["success"] = true;
+    result["exercise"] = "box_breathing";
+    result["duration_seconds"] = 60;
+}
+
+static void setVolumeTool(const ToolArgs& args, JsonObject result) {
+    int volume = args.integer(0);
+    if (!deviceToolCallbacks.onSetVolume) {
+        result["error"] = "Volume control not available";
+        return;
+    }
+    deviceToolCallbacks.onSetVolume(volume);
+    result["success"] = true;
+    result["volume"] = volume;
+}
+
+static void setBrightnessTool(const ToolArgs& args, JsonObject result) {
+    int brightness = args.integer(0);
+    if (!deviceToolCallbacks.onSetBrightness) {
+        result["error"] = "Brightness control not available";
+        return;
+    }
+    deviceToolCallbacks.onSetBrightness(brightness);
+    result["success"] = true;
+    result["brightness"] = brightness;
+}
+
+static void setEyeColorTool(const ToolArgs& args, JsonObject result) {
+    const char* color = args.string(0);
+    if (!deviceToolCallbacks.onSetEyeColor) {
+        result["error"] = "Eye color control not available";
+        return;
+    }
+    if (!deviceToolCallbacks.onSetEyeColor(color)) {
+        result["error"] = "Unknown color. Use: cyan, pink, green, orange, purple, white, red, blue";
+        return;
+    }
+    result["success"] = true;
+    result["color"] = color;
+}
+
+//=============================================================================
+// Tool Table
+//=============================================================================
+// Defaults are what a call gets for a missing or mistyped argument.
+
+static constexpr DeviceToolDescriptor DEVICE_TOOLS[] = {
+    {
+        "set_expression",
+        "Change the robot's facial expression. Use this to show emotions "
+        "that match your response, or to react to what the user says. "
+        "For example, show 'happy' when giving good news, 'thinking' when "
+        "processing a complex question, or 'curious' when asking questions.",
+        "Change the robot's facial expression. Valid expressions: neutral, happy, sad, "
+        "surprised, angry, suspicious, sleepy, scared, content, focused, confused, "
+        "curious, thinking, alert, listening, love, excited, relaxed",
+        SET_EXPRESSION_SCHEMA, setExpressionTool,
+        { stringArg("expression", "neutral"), intArg("duration_ms", 0) }
+    },
+    {
+        "play_sequence",
+        "Play a timed sequence of expressions, gaze directions and sounds, "
+        "e.g. look left, then surprised, then wink, then happy for 3 seconds. "
+        "Use this instead of several set_expression calls when the timing "
+        "matters; the device plays it on its own clock.",
+        "Play a timeline of expressions, gaze directions (look or gaze_x/gaze_y) and "
+        "sounds with per-step durations, timed on the device. Up to 32 steps, 60 s.",
+        PLAY_SEQUENCE_SCHEMA, playSequenceTool,
+        { arrayArg("steps") }
+    },
+    {
+        "set_timer",
+        "Set a countdown timer. The robot will display the countdown and "
+        "alert the user when time is up. Useful for reminders, cooking timers, "
+        "or any timed activity.",
+        "Set a countdown timer. The robot will display the countdown on screen with a "
+        "progress bar, tick in the last 60 seconds, and celebrate with a happy animation when done.",
+        SET_TIMER_SCHEMA, setTimerTool,
+        { intArg("duration_seconds", 60), stringArg("name", "Timer") }
+    },
+    {
+        "cancel_timer",
+        "Cancel the currently running countdown timer.",
+        "Cancel the currently running countdown timer.",
+        EMPTY_SCHEMA, cancelTimerTool, {}
+    },
+    {
+        "start_pomodoro",
+        "Start a Pomodoro productivity timer. This begins a work session "
+        "followed by a short break. The robot will show focused expression "
+        "during work and relaxed expression during breaks.",
+        "Start a Pomodoro productivity timer with work and break sessions.",
+        START_POMODORO_SCHEMA, startPomodoroTool,
+        { intArg("work_minutes", 25), intArg("break_minutes", 5) }
+    },
+    {
+        "stop_pomodoro",
+        "Stop the current Pomodoro session. Use when the user wants to "
+        "cancel their productivity timer.",
+        "Stop the current Pomodoro session.",
+        EMPTY_SCHEMA, stopPomodoroTool, {}
+    },
+    {
+        "get_device_info",
+        "Get information about the device's current state including "
+        "battery level, WiFi status, current expression, and active timers.",
+        "Get device status: current expression, WiFi, active timers, uptime.",
+        EMPTY_SCHEMA, getDeviceInfoTool, {}
+    },
+    {
+        "play_sound",
+        "Play a sound effect. Use for audio feedback like confirmations, "
+        "alerts, or emotional expressions.",
+        "Play a sound effect: happy, sad, alert, confirm, error.",
+        PLAY_SOUND_SCHEMA, playSoundTool,
+        { stringArg("sound", "confirm") }
+    },
+    {
+        "set_reminder",
+        "Set a timed reminder. The robot will show the message on screen "
+        "and play an alert sound at the specified time. Message max 48 characters. "
+        "Use recurring=true for daily reminders.",
+        "Set a timed reminder. Shows message on screen with alert sound at the specified time. "
+        "Message max 48 characters. Set recurring=true for daily reminders.",
+        SET_REMINDER_SCHEMA, setReminderTool,
+        { intArg("hour", 0), intArg("minute", 0), stringArg("message", ""),
+          boolArg("recurring", false) }
+    },
+    {
+        "cancel_reminder",
+        "Cancel a reminder by matching part of its message text.",
+        "Cancel a reminder by matching part of its message text.",
+        CANCEL_REMINDER_SCHEMA, cancelReminderTool,
+        { stringArg("message", "") }
+    },
+    {
+        "list_reminders",
+        "List all active reminders with their times and messages.",
+        "List all active reminders with their times and messages.",
+        EMPTY_SCHEMA, listRemindersTool, {}
+    },
+    {
+        "start_breathing",
+        "Start a guided box breathing exercise (5s inhale, 5s hold, 5s exhale, "
+        "5s hold, 3 cycles = 60 seconds). Use when the user seems stressed or "
+        "asks to relax.",
+        "Start a guided box breathing exercise (5s inhale, 5s hold, 5s exhale, 5s hold, 3 cycles).",
+        EMPTY_SCHEMA, startBreathingTool, {}
+    },
+    {
+        "set_volume",
+        "Set the device speaker volume (0-100).",
+        "Set the device speaker volume (0-100).",
+        SET_VOLUME_SCHEMA, setVolumeTool,
+        { intArg("volume", 50, 0, 100) }
+    },
+    {
+        "set_brightness",
+        "Set the screen brightness (0-100).",
+        "Set the screen brightness (0-100).",
+        SET_BRIGHTNESS_SCHEMA, setBrightnessTool,
+        { intArg("brightness", 50, 0, 100) }
+    },
+    {
+        "set_eye_color",
+        "Change the eye color. Available colors: cyan, pink, green, orange, "
+        "purple, white, red, blue.",
+        "Change the eye color: cyan, pink, green, orange, purple, white, red, blue.",
+        SET_EYE_COLOR_SCHEMA, setEyeColorTool,
+        { stringArg("color", "cyan") }
+    },
+};
+
+static constexpr size_t DEVICE_TOOL_COUNT = sizeof(DEVICE_TOOLS) / sizeof(DEVICE_TOOLS[0]);
+
+static_assert(DEVICE_TOOL_COUNT <= LLM_MAX_DEVICE_TOOLS,
+              "Raise LLM_MAX_DEVICE_TOOLS, the LLM would drop device tools");
+
+//=============================================================================
+// Perfect Hash Lookup
+//=============================================================================
+// A seed for FNV-1a is searched at compile time so that every tool name
+// lands in its own slot; a lookup is then one hash, one slot read and one
+// strcmp to reject names that are not tools.
+
+/** Lookup slots (power of two, comfortably above the tool count) */
+#define DEVICE_TOOL_HASH_SLOTS 32
+
+static constexpr uint8_t NO_TOOL = 0xFF;
+
+static_assert(DEVICE_TOOL_COUNT < NO_TOOL && DEVICE_TOOL_COUNT <= DEVICE_TOOL_HASH_SLOTS,
+              "Too many device tools for the lookup table");
+
+static constexpr uint32_t toolNameSlot(const char* name, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return (hash ^ (hash >> 16)) & (DEVICE_TOOL_HASH_SLOTS - 1);
+}
+
+static constexpr bool seedIsPerfect(uint32_t seed) {
+    bool used[DEVICE_TOOL_HASH_SLOTS] = {};
+    for (size_t i = 0; i < DEVICE_TOOL_COUNT; i++) {
+        uint32_t slot = toolNameSlot(DEVICE_TOOLS[i].name, seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+static constexpr uint32_t findToolSeed() {
+    for (uint32_t seed = 0; seed < 4096; seed++) {
+        if (seedIsPerfect(seed)) return seed;
+    }
+    return UINT32_MAX;
+}
+
+static constexpr uint32_t TOOL_HASH_SEED = findToolSeed();
+static_assert(TOOL_HASH_SEED != UINT32_MAX,
+              "No perfect hash seed for the device tool names; raise DEVICE_TOOL_HASH_SLOTS");
+
+struct ToolSlotTable {
+    uint8_t index[DEVICE_TOOL_HASH_SLOTS];
+};
+
+static constexpr ToolSlotTable buildToolSlots() {
+    ToolSlotTable table = {};
+    for (size_t s = 0; s < DEVICE_TOOL_HASH_SLOTS; s++) table.index[s] = NO_TOOL;
+    for (size_t i = 0; i < DEVICE_TOOL_COUNT; i++) {
+        table.index[toolNameSlot(DEVICE_TOOLS[i].name, TOOL_HASH_SEED)] = (uint8_t)i;
+    }
+    return table;
+}
+
+static constexpr ToolSlotTable TOOL_SLOTS = buildToolSlots();
+
+size_t getDeviceToolCount() {
+    return DEVICE_TOOL_COUNT;
+}
+
+const DeviceToolDescriptor& getDeviceTool(size_t index) {
+    return DEVICE_TOOLS[index];
+}
+
+const DeviceToolDescriptor* findDeviceTool(const char* name) {
+    if (!name) return nullptr;
+    uint8_t index = TOOL_SLOTS.index[toolNameSlot(name, TOOL_HASH_SEED)];
+    if (index == NO_TOOL || strcmp(DEVICE_TOOLS[index].name, name) != 0) return nullptr;
+    return &DEVICE_TOOLS[index];
+}
+
+//=============================================================================
+// Registration
+//=============================================================================
+
+void registerDeviceTools(LLMClient& llm) {
+    for (const DeviceToolDescriptor& tool : DEVICE_TOOLS) {
+        llm.addTool(tool.name, tool.llmDescription, tool.schema);
+    }
+}
+
+void registerMcpDeviceTools(MCPServer& mcp) {
+    for (const DeviceToolDescriptor& tool : DEVICE_TOOLS) {
+        mcp.addTool(tool.name, tool.mcpDescription, tool.schema);
+    }
+}
+
+//=============================================================================
+// Execution
+//=============================================================================
+
+/**
+ * @brief Convert arguments to the tool's types, applying defaults
+ */
+static void bindToolArgs(const DeviceToolDescriptor& tool, JsonObjectConst arguments,
+                         ToolArgs& args) {
+    for (size_t i = 0; i < DEVICE_TOOL_MAX_ARGS && tool.args[i].name; i++) {
+        const ToolArgSpec& spec = tool.args[i];
+        JsonVariantConst value = arguments[spec.name];
+
+        switch (spec.type) {
+            case ToolArgType::Int: {
+                int32_t n = value | spec.defaultInt;
+                if (spec.min <= spec.max) n = constrain(n, spec.min, spec.max);
+                args.values[i].i = n;
+                break;
+            }
+            case ToolArgType::String:
+                args.values[i].s = value | spec.defaultString;
+                break;
+            case ToolArgType::Bool:
+                args.values[i].b = value | (spec.defaultInt != 0);
+                break;
+            case ToolArgType::Array:
+                args.arrays[i] = value.as<JsonArrayConst>();
+                break;
+        }
+    }
+}
+
+String executeDeviceTool(const char* toolName, JsonObjectConst arguments) {
+    JsonDocument result;
+    JsonObject root = result.to<JsonObject>();
+
+    const DeviceToolDescriptor* tool = findDeviceTool(toolName);
+    if (tool) {
+        ToolArgs args;
+        bindToolArgs(*tool, arguments, args);
+        tool->handler(args, root);
+    } else {
+        root["error"] = "Unknown tool";
+        root["tool_name"] = toolName;
+    }
+
+    String output;
+    serializeJson(result, output);
+    return output;
+}
+
+String executeDeviceTool(const char* toolName, const char* input) {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, input);
+    if (error) {
+        JsonDocument result;
+        result["error"] = "Invalid JSON input";
+        String output;
+        serializeJson(result, output);
+        return output;
+    }
+    return executeDeviceTool(toolName, doc.as<JsonObjectConst>());
+}
+
+//=============================================================================
+// State Resources
+//=============================================================================
+
+struct DeviceResourceDescriptor {
+    const char* uri;
+    const char* name;
+    const char* description;
+};
+
+static constexpr DeviceResourceDescriptor DEVICE_RESOURCES[] = {
+    { "deskbuddy://state/expression", "Expression",
+      "Expression currently shown on the display" },
+    { "deskbuddy://state/timer", "Countdown timer",
+      "Countdown timer state, name and remaining time; updated on start, finish and cancel" },
+    { "deskbuddy://state/pomodoro", "Pomodoro",
+      "Pomodoro phase, session number and remaining time; updated on phase changes" },
+    { "deskbuddy://state/assistant", "Assistant",
+      "Voice assistant state (idle, listening, processing, speaking)" },
+    { "deskbuddy://state/sensors", "Sensors",
+      "Orientation, whether the device is held or flipped, and tilt; updated on orientation changes" },
+    { "deskbuddy://state/settings", "Settings",
+      "Volume, brightness and eye color" },
+};
+
+static_assert(sizeof(DEVICE_RESOURCES) / sizeof(DEVICE_RESOURCES[0]) == (size_t)DeviceResource::Count,
+              "DEVICE_RESOURCES must follow the DeviceResource enum");
+static_assert((size_t)DeviceResource::Count <= MCP_MAX_RESOURCES,
+              "Raise MCP_MAX_RESOURCES");
+
+void registerMcpDeviceResources(MCPServer& mcp) {
+    for (size_t i = 0; i < (size_t)DeviceResource::Count; i++) {
+        const DeviceResourceDescriptor& resource = DEVICE_RESOURCES[i];
+        DeviceResource which = (DeviceResource)i;
+
+        mcp.addResource(resource.uri, resource.name, resource.description, [which]() -> String {
+            JsonDocument doc;
+            JsonObject state = doc.to<JsonObject>();
+            if (deviceToolCallbacks.onReadResource) {
+                deviceToolCallbacks.onReadResource(which, state);
+            }
+            String output;
+            serializeJson(doc, output);
+            return output;
+        });
+    }
+}
+
+void notifyDeviceResource(DeviceResource resource) {
+    if (resource >= DeviceResource::Count) return;
+    mcpServer.notifyResourceUpdated(DEVICE_RESOURCES[(size_t)resource].uri);
+}
@@ -0,0 +1,778 @@
+/**
+ * @file intent_matcher.cpp
+ * @brief On-device intent matching implementation
+ */
+
+#include "intent_matcher.h"
+#include <ArduinoJson.h>
+#include <time.h>
+
+//=============================================================================
+// Grammar
+//=============================================================================
+
+/**
+ * @enum SlotType
+ * @brief Typed value a rule extracts from the utterance
+ */
+enum class SlotType {
+    None,
+    Duration,           ///< Required duration in seconds
+    OptionalMinutes,    ///< Optional duration, reported in minutes
+    Percent,            ///< 0-100 level
+    Expression,         ///< Expression name (with synonyms)
+    Color,              ///< Eye color name
+    Sound,              ///< Sound effect name
+    ReminderTime,       ///< Time of day + free-text message
+    Text                ///< Free text after the keyword
+};
+
+/**
+ * @struct IntentRule
+ * @brief One grammar rule (word lists are space-separated)
+ */
+struct IntentRule {
+    IntentId id;
+    const char* tool;
+    const char* required[2];    ///< Each group: one of its words must appear
+    const char* optional;       ///< Words the rule understands but doesn't need
+    SlotType slot;
+};
+
+static const IntentRule RULES[] = {
+    { IntentId::CancelTimer, "cancel_timer",
+      { "cancel stop clear end kill delete", "timer countdown" },
+      "the my a", SlotType::None },
+    { IntentId::SetTimer, "set_timer",
+      { "timer countdown", nullptr },
+      "set start a an new make create put on of", SlotType::Duration },
+    { IntentId::StopPomodoro, "stop_pomodoro",
+      { "cancel stop end quit finish", "pomodoro" },
+      "the my session timer", SlotType::None },
+    { IntentId::StartPomodoro, "start_pomodoro",
+      { "pomodoro", nullptr },
+      "start begin a session timer lets do with of", SlotType::OptionalMinutes },
+    { IntentId::StartBreathing, "start_breathing",
+      { "breathing breathe breath", nullptr },
+      "start begin a an exercise lets do help session some guided box take deep", SlotType::None },
+    { IntentId::SetVolume, "set_volume",
+      { "volume", nullptr },
+      "set the to your change turn at put make percent", SlotType::Percent },
+    { IntentId::SetBrightness, "set_brightness",
+      { "brightness", nullptr },
+      "set the screen display to your change turn at put make percent", SlotType::Percent },
+    { IntentId::SetEyeColor, "set_eye_color",
+      { "eye eyes", nullptr },
+      "set change make turn your the color colour to", SlotType::Color },
+    { IntentId::PlaySound, "play_sound",
+      { "play", nullptr },
+      "a an the sound noise effect", SlotType::Sound },
+    { IntentId::SetExpression, "set_expression",
+      { nullptr, nullptr },
+      "be look act show make a an face expression feel get so very set to", SlotType::Expression },
+    { IntentId::CancelReminder, "cancel_reminder",
+      { "cancel delete remove clear", "reminder" },
+      "the my about for to that called", SlotType::Text },
+    { IntentId::ListReminders, "list_reminders",
+      { "reminders", nullptr },
+      "list what whats are my show read do i have any all the tell", SlotType::None },
+    { IntentId::SetReminder, "set_reminder",
+      { "remind reminder", nullptr },
+      "set a to that about", SlotType::ReminderTime },
+    { IntentId::DeviceInfo, "get_device_info",
+      { "status", nullptr },
+      "whats what is your device system the show tell", SlotType::None },
+    { IntentId::TellTime, nullptr,
+      { "time", nullptr },
+      "what whats is it the tell current do have", SlotType::None },
+};
+
+static const int RULE_COUNT = sizeof(RULES) / sizeof(RULES[0]);
+
+/** Politeness and wake words that never count for or against a rule */
+static const char* FILLER_WORDS =
+    "please hey hi hello buddy deskbuddy desk can could would will you for me "
+    "now right thanks thank okay ok um uh just quickly";
+
+/** Words that flip the meaning of a command - always left to the LLM */
+static const char* NEGATION_WORDS = "dont not never no";
+
+static const char* ONES[] = {
+    "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine",
+    "ten", "eleven", "twelve", "thirteen", "fourteen", "fifteen", "sixteen",
+    "seventeen", "eighteen", "nineteen"
+};
+
+static const char* TENS[] = {
+    "", "", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety"
+};
+
+static const char* EXPRESSIONS =
+    "neutral happy sad surprised angry suspicious sleepy scared content focused "
+    "confused curious thinking alert listening love excited relaxed";
+
+/** Spoken synonyms -> expression name */
+static const char* EXPRESSION_SYNONYMS[][2] = {
+    { "mad", "angry" }, { "tired", "sleepy" }, { "afraid", "scared" },
+    { "smile", "happy" }, { "surprise", "surprised" }, { "think", "thinking" },
+    { "calm", "relaxed" }, { "normal", "neutral" }, { "curiosity", "curious" }
+};
+
+static const char* COLORS = "cyan pink green orange purple white red blue";
+
+static const char* SOUNDS = "happy sad alert confirm error";
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+/**
+ * @brief Format seconds as "1 hour 30 minutes"
+ */
+static String describeDuration(int seconds) {
+    int h = seconds / 3600;
+    int m = (seconds % 3600) / 60;
+    int s = seconds % 60;
+
+    String out;
+    if (h > 0) out += String(h) + (h == 1 ? " hour" : " hours");
+    if (m > 0) {
+        if (out.length()) out += " ";
+        out += String(m) + (m == 1 ? " minute" : " minutes");
+    }
+    if (s > 0 || out.length() == 0) {
+        if (out.length()) out += " ";
+        out += String(s) + (s == 1 ? " second" : " seconds");
+    }
+    return out;
+}
+
+/**
+ * @brief Format a time of day as "3:05 PM"
+ */
+static String describeClock(int hour, int minute) {
+    char buf[12];
+    int h12 = hour % 12;
+    if (h12 == 0) h12 = 12;
+    snprintf(buf, sizeof(buf), "%d:%02d %s", h12, minute, hour < 12 ? "AM" : "PM");
+    return String(buf);
+}
+
+/**
+ * @brief Seconds per unit word, 0 if not a unit
+ */
+static int unitSeconds(const char* word) {
+    if (!strcmp(word, "second") || !strcmp(word, "seconds") ||
+        !strcmp(word, "sec") || !strcmp(word, "secs")) return 1;
+    if (!strcmp(word, "minute") || !strcmp(word, "minutes") ||
+        !strcmp(word, "min") || !strcmp(word, "mins")) return 60;
+    if (!strcmp(word, "hour") || !strcmp(word, "hours") ||
+        !strcmp(word, "hr") || !strcmp(word, "hrs")) return 3600;
+    return 0;
+}
+
+static bool isArticle(const char* word) {
+    return !strcmp(word, "a") || !strcmp(word, "an");
+}
+
+//=============================================================================
+// Constructor
+//=============================================================================
+
+IntentMatcher::IntentMatcher()
+    : tokenCount(0)
+    , overflow(false)
+{
+    memset(tokens, 0, sizeof(tokens));
+    memset(used, 0, sizeof(used));
+    memset(&stats, 0, sizeof(stats));
+}
+
+//=============================================================================
+// Matching
+//=============================================================================
+
+bool IntentMatcher::match(const char* transcript, IntentMatch& out) {
+    uint32_t t0 = micros();
+    stats.utterances++;
+
+    out.id = IntentId::None;
+    out.tool = nullptr;
+    out.confidence = 0;
+
+    tokenize(transcript ? transcript : "");
+
+    bool candidate = tokenCount > 0 && !overflow;
+    for (int i = 0; i < tokenCount && candidate; i++) {
+        if (inList(NEGATION_WORDS, tokens[i])) candidate = false;
+    }
+
+    float best = 0;
+    if (candidate) {
+        for (int r = 0; r < RULE_COUNT; r++) {
+            IntentMatch m;
+            m.id = RULES[r].id;
+            m.tool = RULES[r].tool;
+            m.number = 0;
+            m.hour = 0;
+            m.minute = 0;
+
+            float score = scoreRule(r, m);
+            if (score > best) {
+                best = score;
+                m.confidence = score;
+                out = m;
+            }
+        }
+    }
+
+    stats.matchTimeUs += micros() - t0;
+
+    if (best < INTENT_MIN_CONFIDENCE) {
+        if (best >= 0.5f) stats.nearMisses++;
+        out.id = IntentId::None;
+        out.tool = nullptr;
+        return false;
+    }
+
+    stats.matches++;
+    Serial.printf("[Intent] %s (%.0f%%) in %lu us\n",
+                  out.tool ? out.tool : "local", out.confidence * 100, micros() - t0);
+    return true;
+}
+
+void IntentMatcher::tokenize(const char* text) {
+    tokenCount = 0;
+    overflow = false;
+
+    char cur[INTENT_MAX_TOKEN_LENGTH];
+    size_t len = 0;
+    int curType = 0;    // 0 = none, 1 = letters, 2 = digits
+
+    auto flush = [&]() {
+        if (len == 0) return;
+        if (tokenCount >= INTENT_MAX_TOKENS) {
+            overflow = true;
+        } else {
+            cur[len] = '\0';
+            strcpy(tokens[tokenCount++], cur);
+        }
+        len = 0;
+        curType = 0;
+    };
+
+    for (const char* p = text; *p; p++) {
+        char c = tolower((unsigned char)*p);
+
+        // "what's" -> "whats", "let's" -> "lets"
+        if (c == '\'') continue;
+
+        int type = isdigit((unsigned char)c) ? 2 : (isalpha((unsigned char)c) ? 1 : 0);
+        if (type == 0) {
+            flush();
+            if (c == '%') {
+                strcpy(cur, "percent");
+                len = 7;
+                flush();
+            }
+            continue;
+        }
+
+        // "5pm" -> "5" "pm"
+        if (curType != 0 && type != curType) flush();
+        if (len < INTENT_MAX_TOKEN_LENGTH - 1) cur[len++] = c;
+        curType = type;
+    }
+    flush();
+}
+
+float IntentMatcher::scoreRule(int ruleIndex, IntentMatch& m) {
+    const IntentRule& rule = RULES[ruleIndex];
+    memset(used, 0, sizeof(used));
+
+    int keywordIndex = -1;
+    for (int g = 0; g < 2; g++) {
+        if (!rule.required[g]) continue;
+        int idx = findWord(rule.required[g]);
+        if (idx < 0) return 0;
+        used[idx] = true;
+        if (keywordIndex < 0) keywordIndex = idx;
+    }
+
+    JsonDocument input;
+
+    switch (rule.slot) {
+        case SlotType::None:
+            // Without a synced clock there's nothing to answer locally
+            if (rule.id == IntentId::TellTime) {
+                struct tm now;
+                if (!getLocalTime(&now, 0)) return 0;
+            }
+            break;
+
+        case SlotType::Duration: {
+            int seconds;
+            if (!parseDuration(seconds) || seconds <= 0) return 0;
+            m.number = seconds;
+            input["duration_seconds"] = seconds;
+            input["name"] = "Timer";
+            break;
+        }
+
+        case SlotType::OptionalMinutes: {
+            int seconds;
+            m.number = parseDuration(seconds) ? max(1, seconds / 60) : 25;
+            input["work_minutes"] = m.number;
+            input["break_minutes"] = 5;
+            break;
+        }
+
+        case SlotType::Percent: {
+            int value;
+            if (!parsePercent(value)) return 0;
+            m.number = value;
+            input[rule.id == IntentId::SetVolume ? "volume" : "brightness"] = value;
+            break;
+        }
+
+        case SlotType::Expression: {
+            int idx = findWord(EXPRESSIONS);
+            const char* name = idx >= 0 ? tokens[idx] : nullptr;
+            for (const auto& syn : EXPRESSION_SYNONYMS) {
+                if (name) break;
+                idx = findWord(syn[0]);
+                if (idx >= 0) name = syn[1];
+            }
+            if (!name) return 0;
+            used[idx] = true;
+            m.text = name;
+            input["expression"] = name;
+            break;
+        }
+
+        case SlotType::Color:
+        case SlotType::Sound: {
+            int idx = findWord(rule.slot == SlotType::Color ? COLORS : SOUNDS);
+            if (idx < 0) return 0;
+            used[idx] = true;
+            m.text = tokens[idx];
+            input[rule.slot == SlotType::Color ? "color" : "sound"] = tokens[idx];
+            break;
+        }
+
+        case SlotType::ReminderTime: {
+            if (!parseTimeOfDay(m.hour, m.minute)) return 0;
+            m.text = collectText(keywordIndex + 1);
+            if (m.text.length() == 0) return 0;
+            m.text.setCharAt(0, toupper(m.text[0]));
+            input["hour"] = m.hour;
+            input["minute"] = m.minute;
+            input["message"] = m.text;
+            break;
+        }
+
+        case SlotType::Text:
+            m.text = collectText(keywordIndex + 1);
+            if (m.text.length() == 0) return 0;
+            input["message"] = m.text;
+            break;
+    }
+
+    // Mark the words this rule understands
+    for (int i = 0; i < tokenCount; i++) {
+        if (!used[i] && inList(rule.optional, tokens[i])) used[i] = true;
+    }
+
+    int meaningful = 0;
+    int covered = 0;
+    for (int i = 0; i < tokenCount; i++) {
+        if (inList(FILLER_WORDS, tokens[i])) continue;
+        meaningful++;
+        if (used[i]) covered++;
+    }
+    if (meaningful == 0) return 0;
+
+    m.input = "";
+    if (input.isNull()) {
+        m.input = "{}";
+    } else {
+        serializeJson(input, m.input);
+    }
+    return (float)covered / meaningful;
+}
+
+//=============================================================================
+// Slot Parsers
+//=============================================================================
+
+int IntentMatcher::parseNumber(int i, int& value) const {
+    if (i >= tokenCount) return 0;
+    const char* t = tokens[i];
+
+    if (isdigit((unsigned char)t[0])) {
+        if (strlen(t) > 5) return 0;
+        value = atoi(t);
+        return 1;
+    }
+
+    // "a hundred" / "one hundred" / "hundred"
+    if (i + 1 < tokenCount && !strcmp(tokens[i + 1], "hundred") &&
+        (isArticle(t) || !strcmp(t, "one"))) {
+        value = 100;
+        return 2;
+    }
+    if (!strcmp(t, "hundred")) {
+        value = 100;
+        return 1;
+    }
+
+    for (int n = 0; n < 20; n++) {
+        if (!strcmp(t, ONES[n])) {
+            value = n;
+            return 1;
+        }
+    }
+
+    for (int n = 2; n < 10; n++) {
+        if (strcmp(t, TENS[n]) != 0) continue;
+        value = n * 10;
+        // "twenty five"
+        if (i + 1 < tokenCount) {
+            for (int u = 1; u < 10; u++) {
+                if (!strcmp(tokens[i + 1], ONES[u])) {
+                    value += u;
+                    return 2;
+                }
+            }
+        }
+        return 1;
+    }
+    return 0;
+}
+
+bool IntentMatcher::parseDuration(int& seconds) {
+    for (int start = 0; start < tokenCount; start++) {
+        if (used[start]) continue;
+
+        int total = 0;
+        int i = start;
+        bool any = false;
+
+        while (i < tokenCount) {
+            int resume = i;
+            if (any) {
+                // "an hour and 30 minutes" - only consume "and" if more follows
+                if (strcmp(tokens[i], "and") != 0) break;
+                i++;
+            }
+
+            int unit;
+            if (i + 2 < tokenCount && !strcmp(tokens[i], "half") &&
+                isArticle(tokens[i + 1]) && (unit = unitSeconds(tokens[i + 2])) > 0) {
+                // "half an hour"
+                total += unit / 2;
+                i += 3;
+                any = true;
+                continue;
+            }
+
+            int value = 0;
+            int n = parseNumber(i, value);
+            if (n == 0 && i < tokenCount && isArticle(tokens[i])) {
+                value = 1;
+                n = 1;
+            }
+            if (n == 0) {
+                i = resume;
+                break;
+            }
+
+            int j = i + n;
+            bool half = false;
+            // "one and a half hours"
+            if (j + 2 < tokenCount && !strcmp(tokens[j], "and") &&
+                isArticle(tokens[j + 1]) && !strcmp(tokens[j + 2], "half")) {
+                half = true;
+                j += 3;
+            }
+
+            unit = j < tokenCount ? unitSeconds(tokens[j]) : 0;
+            if (unit == 0) {
+                i = resume;
+                break;
+            }
+            total += value * unit + (half ? unit / 2 : 0);
+            j++;
+
+            // "a minute and a half"
+            if (!half && j + 2 < tokenCount && !strcmp(tokens[j], "and") &&
+                isArticle(tokens[j + 1]) && !strcmp(tokens[j + 2], "half")) {
+                total += unit / 2;
+                j += 3;
+            }
+
+            i = j;
+            any = true;
+        }
+
+        if (any) {
+            for (int k = start; k < i; k++) used[k] = true;
+            seconds = total;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IntentMatcher::parsePercent(int& value) {
+    for (int i = 0; i < tokenCount; i++) {
+        if (used[i]) continue;
+
+        int n = parseNumber(i, value);
+        if (n > 0) {
+            if (value > 100) return false;
+            for (int k = i; k < i + n; k++) used[k] = true;
+            return true;
+        }
+
+        const char* t = tokens[i];
+        if (inList("max maximum full", t)) {
+            value = 100;
+        } else if (inList("mute off silent minimum", t)) {
+            value = 0;
+        } else if (!strcmp(t, "half")) {
+            value = 50;
+        } else {
+            continue;
+        }
+        used[i] = true;
+        return true;
+    }
+    return false;
+}
+
+bool IntentMatcher::parseTimeOfDay(int& hour, int& minute) {
+    struct tm now;
+    bool haveClock = getLocalTime(&now, 0);
+
+    for (int i = 0; i + 1 < tokenCount; i++) {
+        if (used[i]) continue;
+
+        // "in 20 minutes" - relative to the synced clock
+        if (!strcmp(tokens[i], "in") && haveClock) {
+            bool savedUsed[INTENT_MAX_TOKENS];
+            memcpy(savedUsed, used, sizeof(used));
+
+            int seconds;
+            if (parseDuration(seconds) && used[i + 1] && !savedUsed[i + 1]) {
+                used[i] = true;
+                int total = now.tm_hour * 60 + now.tm_min + (seconds + 59) / 60;
+                hour = (total / 60) % 24;
+                minute = total % 60;
+                return true;
+            }
+            memcpy(used, savedUsed, sizeof(used));
+            continue;
+        }
+
+        // "at 3 pm", or "for 3 pm" when the meridiem rules out a duration
+        bool isFor = !strcmp(tokens[i], "for");
+        if (strcmp(tokens[i], "at") != 0 && !isFor) continue;
+        int j = i + 1;
+
+        if (!isFor && (!strcmp(tokens[j], "noon") || !strcmp(tokens[j], "midnight"))) {
+            hour = tokens[j][0] == 'n' ? 12 : 0;
+            minute = 0;
+            used[i] = used[j] = true;
+            return true;
+        }
+
+        int h;
+        int n = parseNumber(j, h);
+        if (n == 0 || h > 23) continue;
+        j += n;
+
+        // "3 30", "3 oh 5", "3 oclock"
+        int m = 0;
+        if (j < tokenCount && (!strcmp(tokens[j], "oh") || !strcmp(tokens[j], "o"))) {
+            int k = parseNumber(j + 1, m);
+            if (k > 0 && m < 10) j += 1 + k;
+            else m = 0;
+        } else if (j < tokenCount) {
+            int k = parseNumber(j, m);
+            if (k > 0 && m < 60 && (j + k >= tokenCount || unitSeconds(tokens[j + k]) == 0)) j += k;
+            else m = 0;
+        }
+        if (j < tokenCount && !strcmp(tokens[j], "oclock")) j++;
+
+        // "pm", "p m" (from "p.m.")
+        int meridiem = 0;     // 1 = am, 2 = pm
+        if (j < tokenCount && (!strcmp(tokens[j], "am") || !strcmp(tokens[j], "pm"))) {
+            meridiem = tokens[j][0] == 'a' ? 1 : 2;
+            j++;
+        } else if (j + 1 < tokenCount && !strcmp(tokens[j + 1], "m") &&
+                   (!strcmp(tokens[j], "a") || !strcmp(tokens[j], "p"))) {
+            meridiem = tokens[j][0] == 'a' ? 1 : 2;
+            j += 2;
+        }
+
+        if (isFor && meridiem == 0) continue;
+        if (meridiem != 0 && (h < 1 || h > 12)) continue;
+        if (meridiem == 2 && h < 12) h += 12;
+        if (meridiem == 1 && h == 12) h = 0;
+
+        // "at 3" - the next 3 o'clock, morning or afternoon
+        if (meridiem == 0 && h >= 1 && h < 12 && haveClock) {
+            int target = h * 60 + m;
+            int current = now.tm_hour * 60 + now.tm_min;
+            if (target <= current && target + 720 > current) h += 12;
+        }
+
+        for (int k = i; k < j; k++) used[k] = true;
+        hour = h;
+        minute = m;
+        return true;
+    }
+    return false;
+}
+
+int IntentMatcher::findWord(const char* list) const {
+    for (int i = 0; i < tokenCount; i++) {
+        if (!used[i] && inList(list, tokens[i])) return i;
+    }
+    return -1;
+}
+
+String IntentMatcher::collectText(int start) {
+    String text;
+    bool leading = true;
+
+    // Skip connective words ("remind me to ...", "reminder about ...")
+    static const char* LEADING = "me to that about for called the my a";
+
+    for (int i = max(start, 0); i < tokenCount; i++) {
+        if (used[i]) continue;
+        if (leading && inList(LEADING, tokens[i])) {
+            used[i] = true;
+            continue;
+        }
+        leading = false;
+
+        if (text.length() + strlen(tokens[i]) + 1 > INTENT_MAX_REMINDER_TEXT) break;
+        if (text.length()) text += " ";
+        text += tokens[i];
+        used[i] = true;
+    }
+
+    // Drop a trailing "please"/"thanks"
+    int lastSpace = text.lastIndexOf(' ');
+    if (lastSpace > 0 && inList(FILLER_WORDS, text.c_str() + lastSpace + 1)) {
+        text.remove(lastSpace);
+    }
+    return text;
+}
+
+bool IntentMatcher::inList(const char* list, const char* word) {
+    if (!list || !word || !*word) return false;
+    size_t len = strlen(word);
+
+    const char* p = list;
+    while (*p) {
+        const char* end = strchr(p, ' ');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        if (n == len && strncmp(p, word, len) == 0) return true;
+        if (!end) break;
+        p = end + 1;
+    }
+    return false;
+}
+
+//=============================================================================
+// Replies
+//=============================================================================
+
+String IntentMatcher::formatReply(const IntentMatch& m, const String& toolResult) {
+    JsonDocument result;
+    if (m.tool) {
+        if (deserializeJson(result, toolResult) || result["error"].is<const char*>()) {
+            if (m.id == IntentId::CancelReminder) return "I couldn't find that reminder.";
+            return "Sorry, that didn't work.";
+        }
+    }
+
+    char buf[160];
+
+    switch (m.id) {
+        case IntentId::SetTimer:
+            return "Timer set for " + describeDuration(m.number) + ".";
+
+        case IntentId::CancelTimer:
+            return "Timer cancelled.";
+
+        case IntentId::StartPomodoro:
+            snprintf(buf, sizeof(buf), "Starting a %d minute pomodoro. Time to focus!", m.number);
+            return buf;
+
+        case IntentId::StopPomodoro:
+            return "Pomodoro stopped.";
+
+        case IntentId::SetReminder:
+            return "Okay, I'll remind you at " + describeClock(m.hour, m.minute) + ".";
+
+        case IntentId::CancelReminder:
+            return "Reminder removed.";
+
+        case IntentId::ListReminders: {
+            JsonArray list = result["reminders"];
+            int count = list.size();
+            if (count == 0) return "You don't have any reminders.";
+
+            String reply = "You have " + String(count) + (count == 1 ? " reminder: " : " reminders: ");
+            int spoken = 0;
+            for (JsonObject r : list) {
+                if (spoken == 3) break;
+                if (spoken > 0) reply += ", ";
+                reply += r["message"] | "";
+                reply += " at " + describeClock(r["hour"] | 0, r["minute"] | 0);
+                spoken++;
+            }
+            if (count > spoken) reply += ", and " + String(count - spoken) + " more";
+            return reply + ".";
+        }
+
+        case IntentId::StartBreathing:
+            return "Let's breathe together. Follow my eyes.";
+
+        case IntentId::SetVolume:
+            snprintf(buf, sizeof(buf), "Volume set to %d.", m.number);
+            return buf;
+
+        case IntentId::SetBrightness:
+            snprintf(buf, sizeof(buf), "Brightness set to %d.", m.number);
+            return buf;
+
+        case IntentId::SetEyeColor:
+            return "How do I look in " + m.text + "?";
+
+        case IntentId::DeviceInfo: {
+            JsonObject info = result["device_info"];
+            snprintf(buf, sizeof(buf),
+                     "Volume %d, brightness %d, %s eyes, WiFi signal %d dBm, up %lu minutes.",
+                     info["volume"] | 0, info["brightness"] | 0, info["eye_color"] | "cyan",
+                     info["wifi_rssi"] | 0, (unsigned long)(info["uptime_seconds"] | 0UL) / 60);
+            return buf;
+        }
+
+        case IntentId::TellTime: {
+            struct tm now;
+            if (!getLocalTime(&now, 0)) return "I don't know the time yet.";
+            return "It's " + describeClock(now.tm_hour, now.tm_min) + ".";
+        }
+
+        // The face or the sound is the answer
+        case IntentId::SetExpression:
+        case IntentId::PlaySound:
+        default:
+            return "";
+    }
+}
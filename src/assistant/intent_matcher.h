@@ -0,0 +1,192 @@
+/**
+ * @file intent_matcher.h
+ * @brief On-device intent matching for common voice commands
+ *
+ * Short commands like "set a timer for five minutes", "volume 50" or
+ * "be happy" map one-to-one onto a device tool. Matching them locally
+ * against the STT transcript skips the LLM round trip (and the second
+ * LLM call after the tool result) entirely; only utterances that don't
+ * match with high confidence are sent to LLMClient.
+ *
+ * Grammar: each rule names keyword groups that must all be present, a
+ * list of optional words it understands, and a typed slot (duration,
+ * percentage, time of day, enum word, free text). Confidence is the
+ * fraction of meaningful words the rule accounts for, so "set a timer
+ * for my pasta for ten minutes" (unknown "pasta") falls through to the
+ * LLM, which can do something smarter with it.
+ */
+
+#ifndef INTENT_MATCHER_H
+#define INTENT_MATCHER_H
+
+#include <Arduino.h>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Minimum share of words a rule must account for to run locally */
+#define INTENT_MIN_CONFIDENCE 0.8f
+
+/** Longest utterance considered (tokens); longer ones go to the LLM */
+#define INTENT_MAX_TOKENS 24
+
+/** Longest token kept (chars, including terminator) */
+#define INTENT_MAX_TOKEN_LENGTH 16
+
+/** Maximum reminder message length (matches ReminderManager) */
+#define INTENT_MAX_REMINDER_TEXT 48
+
+//=============================================================================
+// Intent Types
+//=============================================================================
+
+/**
+ * @enum IntentId
+ * @brief Locally handled intents
+ */
+enum class IntentId {
+    None,
+    SetTimer,
+    CancelTimer,
+    StartPomodoro,
+    StopPomodoro,
+    SetExpression,
+    PlaySound,
+    SetReminder,
+    CancelReminder,
+    ListReminders,
+    StartBreathing,
+    SetVolume,
+    SetBrightness,
+    SetEyeColor,
+    DeviceInfo,
+    TellTime            ///< Answered from the RTC, no tool call
+};
+
+/**
+ * @struct IntentMatch
+ * @brief Result of matching one utterance
+ */
+struct IntentMatch {
+    IntentId id;
+    const char* tool;       ///< Device tool to execute (nullptr = answered locally)
+    String input;           ///< Tool arguments (JSON)
+    float confidence;       ///< Share of words the rule accounted for
+
+    // Slot values for the spoken reply
+    int number;             ///< Seconds, percentage or minutes depending on intent
+    int hour;
+    int minute;
+    String text;            ///< Expression/color/sound name or reminder text
+};
+
+/**
+ * @struct IntentStats
+ * @brief Matching counters since boot
+ */
+struct IntentStats {
+    uint32_t utterances;    ///< Transcripts checked
+    uint32_t matches;       ///< Handled locally
+    uint32_t nearMisses;    ///< Best rule scored >= 0.5 but below threshold
+    uint32_t matchTimeUs;   ///< Total time spent matching
+    uint32_t savedMs;       ///< Estimated LLM latency avoided
+};
+
+//=============================================================================
+// IntentMatcher Class
+//=============================================================================
+
+/**
+ * @class IntentMatcher
+ * @brief Rule-based matcher over normalized transcript tokens
+ */
+class IntentMatcher {
+public:
+    IntentMatcher();
+
+    /**
+     * @brief Match a transcript against the rule table
+     * @param transcript Raw STT text
+     * @param match Filled on success
+     * @return true if a rule matched with at least INTENT_MIN_CONFIDENCE
+     */
+    bool match(const char* transcript, IntentMatch& match);
+
+    /**
+     * @brief Build the spoken reply for an executed match
+     * @param match The match that was executed
+     * @param toolResult JSON returned by executeDeviceTool ("" for local intents)
+     * @return Reply text ("" if the action speaks for itself)
+     */
+    String formatReply(const IntentMatch& match, const String& toolResult);
+
+    /**
+     * @brief Credit latency avoided by a local match
+     */
+    void recordSaved(uint32_t ms) { stats.savedMs += ms; }
+
+    /**
+     * @brief Matching counters
+     */
+    const IntentStats& getStats() const { return stats; }
+
+private:
+    /**
+     * @brief Lowercase, strip punctuation and split into tokens
+     */
+    void tokenize(const char* text);
+
+    /**
+     * @brief Score one rule and extract its slot
+     * @return Confidence in [0,1], 0 if required words or slot are missing
+     */
+    float scoreRule(int ruleIndex, IntentMatch& match);
+
+    /**
+     * @brief Parse a cardinal number ("25", "twenty five") at token i
+     * @return Tokens consumed, 0 if none
+     */
+    int parseNumber(int i, int& value) const;
+
+    /**
+     * @brief Parse a duration ("an hour and a half", "90 seconds") anywhere
+     * @return true if found; marks its tokens used
+     */
+    bool parseDuration(int& seconds);
+
+    /**
+     * @brief Parse a 0-100 level ("50", "fifty percent", "max", "mute")
+     */
+    bool parsePercent(int& value);
+
+    /**
+     * @brief Parse "at 3 pm" / "at 15:30" / "at noon"; marks tokens used
+     */
+    bool parseTimeOfDay(int& hour, int& minute);
+
+    /**
+     * @brief Find the first unused token present in a word list
+     * @return Token index, or -1
+     */
+    int findWord(const char* list) const;
+
+    /**
+     * @brief Join unused tokens after index start into free text
+     */
+    String collectText(int start);
+
+    /**
+     * @brief Check whether word appears in a space-separated list
+     */
+    static bool inList(const char* list, const char* word);
+
+    char tokens[INTENT_MAX_TOKENS][INTENT_MAX_TOKEN_LENGTH];
+    bool used[INTENT_MAX_TOKENS];
+    int tokenCount;
+    bool overflow;
+
+    IntentStats stats;
+};
+
+#endif // INTENT_MATCHER_H
@@ -4,7 +4,9 @@
  */
 
 #include "llm_client.h"
+#include "psram_allocator.h"
 #include <NetworkClientSecure.h>
+#include <algorithm>
 
 //=============================================================================
 // Default System Prompt
@@ -26,11 +28,25 @@ LLMClient::LLMClient()
     : initialized(false)
     , provider(LLMProvider::Claude)
     , contextTokens(0)
+    , systemTokens(0)
+    , claudeToolTokens(0)
+    , openaiToolTokens(0)
+    , requestEstimate(0)
+    , budgetScale(1.0f)
+    , fragmentsDirty(true)
     , toolExecutor(nullptr)
-    , secureClient(nullptr)
+    , toolBatchExecutor(nullptr)
+    , streaming(LLM_STREAM_DEFAULT)
+    , textDeltaCallback(nullptr)
+    , toolCallCallback(nullptr)
+    , usageCallback(nullptr)
+    , toolRoundCallback(nullptr)
+    , asyncBusy(false)
 {
     memset(apiKey, 0, sizeof(apiKey));
     memset(lastError, 0, sizeof(lastError));
+    memset(&cacheStats, 0, sizeof(cacheStats));
+    memset(&toolStats, 0, sizeof(toolStats));
     systemPrompt = DEFAULT_SYSTEM_PROMPT;
 }
 
@@ -53,15 +69,22 @@ bool LLMClient::begin(const char* key, LLMProvider prov) {
     setApiKey(key);
     provider = prov;
 
-    // Create secure client
-    secureClient = new NetworkClientSecure();
-    if (!secureClient) {
-        Serial.println("[LLM] ERROR: Failed to create secure client");
+    // Pre-serialized history lives in one arena (PSRAM when available)
+    if (!history.begin()) {
+        Serial.println("[LLM] ERROR: Failed to allocate history");
         return false;
     }
 
-    // Skip certificate verification
-    secureClient->setInsecure();
+    // Previous conversation is restored lazily, on the first request
+    if (LLM_PERSIST_HISTORY) {
+        historyLog.begin();
+    }
+
+    // TLS connections are shared with STT/TTS through the pool
+    if (!connectionManager.begin()) {
+        Serial.println("[LLM] ERROR: Failed to init connection pool");
+        return false;
+    }
 
     initialized = true;
     Serial.printf("[LLM] Initialized with %s\n",
@@ -72,13 +95,11 @@ bool LLMClient::begin(const char* key, LLMProvider prov) {
 void LLMClient::end() {
     if (!initialized) return;
 
-    clearHistory();
+    // The persisted log is kept for the next session
+    history.clear();
+    contextTokens = 0;
     clearTools();
-
-    if (secureClient) {
-        delete secureClient;
-        secureClient = nullptr;
-    }
+    history.end();
 
     initialized = false;
     Serial.println("[LLM] Shutdown");
@@ -94,6 +115,7 @@ void LLMClient::setApiKey(const char* key) {
 void LLMClient::setSystemPrompt(const char* prompt) {
     if (prompt) {
         systemPrompt = prompt;
+        fragmentsDirty = true;
     }
 }
 
@@ -117,34 +139,20 @@ LLMResponse LLMClient::send(const char* text) {
 
     Serial.printf("[LLM] User: %s\n", text);
 
-    // Build request based on provider
-    String body;
-    if (provider == LLMProvider::Claude) {
-        body = buildClaudeRequest(text);
-    } else {
-        body = buildOpenAIRequest(text);
-    }
-
-    // Make request
-    response = makeRequest(body);
+    // Build request from pre-serialized fragments and send
+    buildRequest(text, requestBody);
+    response = makeRequest(requestBody);
 
     if (response.success) {
-        // Add user message to history
+        // Add user message and assistant response to history
         addMessage(MessageRole::User, text);
-
-        // Add assistant response to history
-        if (!response.toolCalls.empty()) {
-            for (const auto& tc : response.toolCalls) {
-                addMessage(MessageRole::Assistant, response.text.c_str(),
-                          tc.id.c_str(), tc.name.c_str(), tc.input.c_str());
-            }
-        } else {
-            addMessage(MessageRole::Assistant, response.text.c_str());
-        }
+        addResponse(response);
 
         // Extract emotion hint
         response.emotion = extractEmotion(response.text.c_str());
 
+        response = resolveToolCalls(response);
+
         Serial.printf("[LLM] Response: %.100s%s\n",
                      response.text.c_str(),
                      response.text.length() > 100 ? "..." : "");
@@ -157,14 +165,77 @@ LLMResponse LLMClient::send(const char* text) {
     return response;
 }
 
+/**
+ * @struct LLMAsyncRequest
+ * @brief Heap-allocated hand-off from sendAsync to the worker task
+ */
+struct LLMAsyncRequest {
+    LLMClient* client;
+    String text;
+    ResponseCallback callback;
+    bool ownTask;           // Running in its own FreeRTOS task
+};
+
 void LLMClient::sendAsync(const char* text, ResponseCallback callback) {
-    LLMResponse response = send(text);
-    if (callback) {
-        callback(response);
+    if (asyncBusy) {
+        LLMResponse response;
+        response.success = false;
+        response.error = "Request already in progress";
+        if (callback) callback(response);
+        return;
+    }
+
+    LLMAsyncRequest* req = new LLMAsyncRequest();
+    req->client = this;
+    req->text = text ? text : "";
+    req->callback = callback;
+    req->ownTask = true;
+
+    asyncBusy = true;
+    BaseType_t created = xTaskCreatePinnedToCore(
+        asyncTask,
+        "llm_request",
+        LLM_ASYNC_TASK_STACK_SIZE,
+        req,
+        1,
+        nullptr,
+        0                   // Core 0 - keep the render loop on core 1 free
+    );
+
+    if (created != pdPASS) {
+        // Fall back to a blocking call rather than dropping the message
+        Serial.println("[LLM] Failed to start async task, sending inline");
+        req->ownTask = false;
+        asyncTask(req);
+    }
+}
+
+void LLMClient::asyncTask(void* param) {
+    LLMAsyncRequest* req = (LLMAsyncRequest*)param;
+    LLMClient* self = req->client;
+    bool ownTask = req->ownTask;
+
+    LLMResponse response = self->send(req->text.c_str());
+    self->asyncBusy = false;
+
+    if (req->callback) {
+        req->callback(response);
+    }
+    delete req;
+
+    if (ownTask) {
+        vTaskDelete(NULL);
     }
 }
 
 LLMResponse LLMClient::addToolResult(const char* toolUseId, const char* result) {
+    std::vector<ToolResult> results(1);
+    results[0].id = toolUseId ? toolUseId : "";
+    results[0].content = result ? result : "";
+    return addToolResults(results);
+}
+
+LLMResponse LLMClient::addToolResults(const std::vector<ToolResult>& results) {
     LLMResponse response;
     response.success = false;
 
@@ -173,21 +244,29 @@ LLMResponse LLMClient::addToolResult(const char* toolUseId, const char* result)
         return response;
     }
 
-    // Add tool result to history
-    addMessage(MessageRole::Tool, result, toolUseId, nullptr, nullptr);
+    if (results.empty()) {
+        response.error = "No tool results";
+        return response;
+    }
 
-    // Build and send request
-    String body;
-    if (provider == LLMProvider::Claude) {
-        body = buildClaudeRequest(nullptr);
-    } else {
-        body = buildOpenAIRequest(nullptr);
+    // Every result goes back in one message - Claude rejects a turn that
+    // answers only some of the previous turn's tool_use blocks
+    std::vector<HistoryToolResult> batch(results.size());
+    for (size_t i = 0; i < results.size(); i++) {
+        batch[i].id = results[i].id.c_str();
+        batch[i].content = results[i].content.c_str();
+    }
+    if (history.addToolResults(batch.data(), batch.size())) {
+        historyLog.appendNewest(history);
     }
 
-    response = makeRequest(body);
+    // Build and send request
+    buildRequest(nullptr, requestBody);
+    response = makeRequest(requestBody);
+    toolStats.roundTrips++;
 
     if (response.success) {
-        addMessage(MessageRole::Assistant, response.text.c_str());
+        addResponse(response);
         response.emotion = extractEmotion(response.text.c_str());
     }
 
@@ -196,14 +275,209 @@ LLMResponse LLMClient::addToolResult(const char* toolUseId, const char* result)
 
 void LLMClient::clearHistory() {
     history.clear();
+    historyLog.clear();
     contextTokens = 0;
 }
 
+void LLMClient::restoreHistory() {
+    if (historyLog.isRestored()) return;
+    historyLog.restore(history);
+}
+
+void LLMClient::recordExchange(const char* userMessage, const char* assistantReply) {
+    if (!userMessage || !*userMessage) return;
+    restoreHistory();
+    addMessage(MessageRole::User, userMessage);
+    addMessage(MessageRole::Assistant, assistantReply && *assistantReply ? assistantReply : "Done.");
+    pruneHistory();
+}
+
+//=============================================================================
+// Tool Execution
+//=============================================================================
+
+LLMResponse LLMClient::resolveToolCalls(LLMResponse response) {
+    int rounds = 0;
+
+    while (response.success && !response.toolCalls.empty() && toolExecutor) {
+        if (rounds >= LLM_MAX_TOOL_ROUNDS) {
+            Serial.printf("[LLM] Tool round limit reached, %u calls not executed\n",
+                          response.toolCalls.size());
+            break;
+        }
+        rounds++;
+
+        std::vector<ToolResult> results;
+        executeToolCalls(response.toolCalls, results);
+
+        if (toolRoundCallback) toolRoundCallback(results.size());
+
+        LLMResponse next = addToolResults(results);
+        if (!next.success) {
+            // Keep what was already said; the tools did run
+            response.toolCalls.clear();
+            response.error = next.error;
+            break;
+        }
+
+        // Later rounds continue the same answer - drop their emotion tag
+        const char* nextText = next.text.c_str();
+        if (!next.emotion.isEmpty()) {
+            nextText = strchr(nextText, ']') + 1;
+            while (*nextText == ' ') nextText++;
+        }
+        if (*nextText) {
+            if (response.text.length() > 0) response.text += " ";
+            response.text += nextText;
+        }
+        if (response.emotion.isEmpty()) response.emotion = next.emotion;
+
+        response.toolCalls = next.toolCalls;
+        response.inputTokens += next.inputTokens;
+        response.outputTokens += next.outputTokens;
+        response.cacheReadTokens += next.cacheReadTokens;
+        response.cacheWriteTokens += next.cacheWriteTokens;
+    }
+
+    return response;
+}
+
+/**
+ * @struct LLMToolJob
+ * @brief One remote tool call handed to a worker task
+ */
+struct LLMToolJob {
+    const ToolExecutor* executor;
+    const ToolCall* call;
+    String* result;
+    uint32_t elapsedMs;
+    SemaphoreHandle_t done;     // Counting semaphore shared by the batch
+};
+
+void LLMClient::toolTask(void* param) {
+    LLMToolJob* job = (LLMToolJob*)param;
+
+    uint32_t startTime = millis();
+    *job->result = (*job->executor)(job->call->name.c_str(), job->call->input.c_str());
+    job->elapsedMs = millis() - startTime;
+
+    xSemaphoreGive(job->done);
+    vTaskDelete(NULL);
+}
+
+void LLMClient::executeToolCalls(const std::vector<ToolCall>& calls, std::vector<ToolResult>& results) {
+    size_t n = calls.size();
+    results.clear();
+    results.resize(n);
+    if (n == 0 || !toolExecutor) return;
+
+    uint32_t startTime = millis();
+    uint32_t serialMs = 0;
+    uint32_t parallel = 0;
+
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(LLM_MAX_PARALLEL_TOOLS, 0);
+    LLMToolJob jobs[LLM_MAX_PARALLEL_TOOLS];
+    std::vector<size_t> batched;
+
+    size_t i = 0;
+    while (i < n) {
+        // One stage: everything up to the next ordered call
+        int inflight = 0;
+        batched.clear();
+
+        for (; i < n; i++) {
+            const ToolCall& call = calls[i];
+            results[i].id = call.id;
+            uint8_t flags = getToolFlags(call.name.c_str());
+
+            // An ordered call starts only after everything before it is done
+            if ((flags & LLM_TOOL_ORDERED) && (inflight > 0 || !batched.empty())) break;
+
+            if ((flags & LLM_TOOL_REMOTE) && !(flags & LLM_TOOL_ORDERED) && toolBatchExecutor) {
+                batched.push_back(i);
+                continue;
+            }
+
+            if ((flags & LLM_TOOL_REMOTE) && !(flags & LLM_TOOL_ORDERED) &&
+                done && inflight < LLM_MAX_PARALLEL_TOOLS) {
+                LLMToolJob& job = jobs[inflight];
+                job.executor = &toolExecutor;
+                job.call = &call;
+                job.result = &results[i].content;
+                job.elapsedMs = 0;
+                job.done = done;
+
+                if (xTaskCreatePinnedToCore(toolTask, "llm_tool", LLM_TOOL_TASK_STACK_SIZE,
+                                            &job, 1, nullptr, 0) == pdPASS) {
+                    Serial.printf("[LLM] Tool call (parallel): %s\n", call.name.c_str());
+                    inflight++;
+                    parallel++;
+                    continue;
+                }
+            }
+
+            // Local tools touch device state - run them here, in call order
+            Serial.printf("[LLM] Tool call: %s\n", call.name.c_str());
+            uint32_t t0 = millis();
+            results[i].content = toolExecutor(call.name.c_str(), call.input.c_str());
+            serialMs += millis() - t0;
+
+            if (flags & LLM_TOOL_ORDERED) {
+                i++;
+                break;      // Nothing after it starts until it is done
+            }
+        }
+
+        // The stage's remote calls go out together, after the local ones
+        if (!batched.empty()) {
+            std::vector<const ToolCall*> batchCalls;
+            std::vector<String> batchResults(batched.size());
+            for (size_t index : batched) batchCalls.push_back(&calls[index]);
+
+            Serial.printf("[LLM] Tool calls (together): %u\n", batched.size());
+            uint32_t t0 = millis();
+            toolBatchExecutor(batchCalls, batchResults);
+            serialMs += millis() - t0;
+            parallel += batched.size();
+
+            for (size_t j = 0; j < batched.size(); j++) {
+                results[batched[j]].content = std::move(batchResults[j]);
+            }
+        }
+
+        // Remote calls are bounded by their own HTTP timeouts
+        for (int j = 0; j < inflight; j++) {
+            xSemaphoreTake(done, portMAX_DELAY);
+        }
+        for (int j = 0; j < inflight; j++) {
+            serialMs += jobs[j].elapsedMs;
+        }
+    }
+
+    if (done) vSemaphoreDelete(done);
+
+    for (auto& result : results) {
+        if (result.content.isEmpty()) result.content = "{\"error\":\"No result\"}";
+    }
+
+    uint32_t wallMs = millis() - startTime;
+    toolStats.rounds++;
+    toolStats.calls += n;
+    toolStats.parallelCalls += parallel;
+    toolStats.savedRoundTrips += n - 1;
+    toolStats.wallMs += wallMs;
+    toolStats.serialMs += serialMs;
+
+    Serial.printf("[LLM] Executed %u tool calls (%lu parallel) in %lu ms (%lu ms sequential), 1 follow-up\n",
+                  n, parallel, wallMs, serialMs);
+}
+
 //=============================================================================
 // Tool Management
 //=============================================================================
 
-bool LLMClient::addTool(const char* name, const char* description, const char* inputSchema) {
+bool LLMClient::addTool(const char* name, const char* description, const char* inputSchema,
+                        uint8_t flags) {
     if (tools.size() >= LLM_MAX_TOOLS) {
         Serial.println("[LLM] Max tools reached");
         return false;
@@ -220,8 +494,10 @@ bool LLMClient::addTool(const char* name, const char* description, const char* i
     tool.name = name;
     tool.description = description;
     tool.inputSchema = inputSchema;
+    tool.flags = flags;
 
     tools.push_back(tool);
+    fragmentsDirty = true;
     Serial.printf("[LLM] Added tool: %s\n", name);
     return true;
 }
@@ -230,190 +506,249 @@ void LLMClient::removeTool(const char* name) {
     for (auto it = tools.begin(); it != tools.end(); ++it) {
         if (it->name == name) {
             tools.erase(it);
+            fragmentsDirty = true;
             Serial.printf("[LLM] Removed tool: %s\n", name);
             return;
         }
     }
 }
 
+void LLMClient::removeTools(uint8_t flags) {
+    size_t before = tools.size();
+    tools.erase(std::remove_if(tools.begin(), tools.end(),
+                               [flags](const ToolDefinition& t) { return (t.flags & flags) != 0; }),
+                tools.end());
+    if (tools.size() != before) fragmentsDirty = true;
+}
+
+uint8_t LLMClient::getToolFlags(const char* name) const {
+    for (const auto& t : tools) {
+        if (t.name == name) return t.flags;
+    }
+    return 0;
+}
+
 void LLMClient::clearTools() {
     tools.clear();
+    fragmentsDirty = true;
 }
 
 //=============================================================================
-// Claude Request Building
+// Request Building
 //=============================================================================
 
-String LLMClient::buildClaudeRequest(const char* newUserMessage) {
-    JsonDocument doc;
-
-    doc["model"] = CLAUDE_MODEL;
-    doc["max_tokens"] = LLM_MAX_TOKENS;
-    doc["system"] = systemPrompt;
-
-    JsonArray messages = doc["messages"].to<JsonArray>();
-
-    // Add history
-    for (const auto& msg : history) {
-        JsonObject msgObj = messages.add<JsonObject>();
-
-        if (msg.role == MessageRole::User) {
-            msgObj["role"] = "user";
-            msgObj["content"] = msg.content;
-        } else if (msg.role == MessageRole::Tool) {
-            msgObj["role"] = "user";
-            JsonArray content = msgObj["content"].to<JsonArray>();
-            JsonObject toolResult = content.add<JsonObject>();
-            toolResult["type"] = "tool_result";
-            toolResult["tool_use_id"] = msg.toolUseId;
-            toolResult["content"] = msg.content;
-        } else {
-            msgObj["role"] = "assistant";
-
-            if (!msg.toolName.isEmpty()) {
-                JsonArray content = msgObj["content"].to<JsonArray>();
-                if (!msg.content.isEmpty()) {
-                    JsonObject textBlock = content.add<JsonObject>();
-                    textBlock["type"] = "text";
-                    textBlock["text"] = msg.content;
-                }
-                JsonObject toolUse = content.add<JsonObject>();
-                toolUse["type"] = "tool_use";
-                toolUse["id"] = msg.toolUseId;
-                toolUse["name"] = msg.toolName;
-                JsonDocument inputDoc;
-                deserializeJson(inputDoc, msg.toolInput);
-                toolUse["input"] = inputDoc;
-            } else {
-                msgObj["content"] = msg.content;
-            }
-        }
+void LLMClient::refreshFragments() {
+    if (!fragmentsDirty) return;
+
+    // System prompt as a JSON string literal
+    JsonDocument promptDoc;
+    promptDoc.set(systemPrompt.c_str());
+    systemFragment = "";
+    serializeJson(promptDoc, systemFragment);
+
+    // Provider prompt caches match on an exact prefix, so tools are emitted
+    // in name order - MCP rediscovery can re-register them in any order
+    std::vector<const ToolDefinition*> ordered;
+    ordered.reserve(tools.size());
+    for (const auto& tool : tools) ordered.push_back(&tool);
+    std::sort(ordered.begin(), ordered.end(),
+              [](const ToolDefinition* a, const ToolDefinition* b) { return a->name < b->name; });
+
+    // Tool schemas are validated once here and embedded raw afterwards
+    JsonDocument claudeDoc;
+    JsonDocument openaiDoc;
+    JsonArray claudeTools = claudeDoc.to<JsonArray>();
+    JsonArray openaiTools = openaiDoc.to<JsonArray>();
+
+    for (const ToolDefinition* toolPtr : ordered) {
+        const ToolDefinition& tool = *toolPtr;
+        JsonDocument check;
+        const char* schema = deserializeJson(check, tool.inputSchema) ? "{}" : tool.inputSchema.c_str();
+
+        JsonObject toolObj = claudeTools.add<JsonObject>();
+        toolObj["name"] = tool.name;
+        toolObj["description"] = tool.description;
+        toolObj["input_schema"] = serialized(schema);
+
+        JsonObject fnObj = openaiTools.add<JsonObject>();
+        fnObj["type"] = "function";
+        JsonObject func = fnObj["function"].to<JsonObject>();
+        func["name"] = tool.name;
+        func["description"] = tool.description;
+        func["parameters"] = serialized(schema);
     }
 
-    // Add new user message
-    if (newUserMessage && strlen(newUserMessage) > 0) {
-        JsonObject userMsg = messages.add<JsonObject>();
-        userMsg["role"] = "user";
-        userMsg["content"] = newUserMessage;
+    // Cache breakpoint on the last tool covers the whole tools block
+    if (LLM_PROMPT_CACHE && claudeTools.size() > 0) {
+        claudeTools[claudeTools.size() - 1]["cache_control"]["type"] = "ephemeral";
     }
 
-    // Add tools
+    claudeToolsFragment = "";
+    openaiToolsFragment = "";
     if (!tools.empty()) {
-        JsonArray toolsArray = doc["tools"].to<JsonArray>();
-        for (const auto& tool : tools) {
-            JsonObject toolObj = toolsArray.add<JsonObject>();
-            toolObj["name"] = tool.name;
-            toolObj["description"] = tool.description;
-            JsonDocument schemaDoc;
-            deserializeJson(schemaDoc, tool.inputSchema);
-            toolObj["input_schema"] = schemaDoc;
-        }
+        serializeJson(claudeDoc, claudeToolsFragment);
+        serializeJson(openaiDoc, openaiToolsFragment);
     }
 
-    String body;
-    serializeJson(doc, body);
-    return body;
+    systemTokens = TokenEstimator::estimate(systemFragment);
+    claudeToolTokens = TokenEstimator::estimate(claudeToolsFragment);
+    openaiToolTokens = TokenEstimator::estimate(openaiToolsFragment);
+
+    fragmentsDirty = false;
 }
 
-//=============================================================================
-// OpenAI Request Building
-//=============================================================================
+void LLMClient::buildRequest(const char* newUserMessage, FragmentStream& body) {
+    uint32_t heapBefore = ESP.getFreeHeap();
+    uint32_t t0 = micros();
 
-String LLMClient::buildOpenAIRequest(const char* newUserMessage) {
-    JsonDocument doc;
+    refreshFragments();
+    restoreHistory();
 
-    doc["model"] = OPENAI_MODEL;
-    doc["max_tokens"] = LLM_MAX_TOKENS;
+    requestUser = "";
+    if (newUserMessage && strlen(newUserMessage) > 0) {
+        JsonDocument userDoc;
+        userDoc["role"] = "user";
+        userDoc["content"] = newUserMessage;
+        serializeJson(userDoc, requestUser);
+    }
 
-    JsonArray messages = doc["messages"].to<JsonArray>();
+    uint32_t pendingTokens = TokenEstimator::estimate(requestUser);
+    pruneHistory(pendingTokens);
+    requestEstimate = fixedPromptTokens() + history.tokens() + pendingTokens;
 
-    // Add system message
-    JsonObject sysMsg = messages.add<JsonObject>();
-    sysMsg["role"] = "system";
-    sysMsg["content"] = systemPrompt;
+    body.clear();
+    if (provider == LLMProvider::Claude) {
+        buildClaudeRequest(newUserMessage, body);
+    } else {
+        buildOpenAIRequest(newUserMessage, body);
+    }
 
-    // Add history
-    for (const auto& msg : history) {
-        JsonObject msgObj = messages.add<JsonObject>();
+    Serial.printf("[LLM] Request body %u bytes, %u fragments, ~%lu tokens, %lu us, heap %d\n",
+                  body.size(), body.pieceCount(), (uint32_t)(requestEstimate * budgetScale),
+                  micros() - t0, (int)ESP.getFreeHeap() - (int)heapBefore);
+}
 
-        if (msg.role == MessageRole::User) {
-            msgObj["role"] = "user";
-            msgObj["content"] = msg.content;
-        } else if (msg.role == MessageRole::Tool) {
-            msgObj["role"] = "tool";
-            msgObj["tool_call_id"] = msg.toolUseId;
-            msgObj["content"] = msg.content;
-        } else {
-            msgObj["role"] = "assistant";
-            if (!msg.toolName.isEmpty()) {
-                // For tool calls, content can be null or empty
-                if (!msg.content.isEmpty()) {
-                    msgObj["content"] = msg.content;
-                } else {
-                    msgObj["content"] = nullptr;
-                }
-                JsonArray toolCalls = msgObj["tool_calls"].to<JsonArray>();
-                JsonObject tc = toolCalls.add<JsonObject>();
-                tc["id"] = msg.toolUseId;
-                tc["type"] = "function";
-                JsonObject func = tc["function"].to<JsonObject>();
-                func["name"] = msg.toolName;
-                func["arguments"] = msg.toolInput;
-            } else {
-                msgObj["content"] = msg.content;
-            }
-        }
+void LLMClient::buildClaudeRequest(const char* newUserMessage, FragmentStream& body) {
+    char head[160];
+    snprintf(head, sizeof(head),
+             "{\"model\":\"%s\",\"max_tokens\":%d,%s",
+             CLAUDE_MODEL, LLM_MAX_TOKENS, streaming ? "\"stream\":true," : "");
+    requestHead = head;
+
+    body.add(requestHead);
+
+    // Emitted in the provider's cache prefix order: tools, system, messages.
+    // The breakpoint on system caches tools + system together.
+    if (claudeToolsFragment.length() > 0) {
+        body.add("\"tools\":");
+        body.add(claudeToolsFragment);
+        body.add(",");
+    }
+    if (LLM_PROMPT_CACHE) {
+        body.add("\"system\":[{\"type\":\"text\",\"text\":");
+        body.add(systemFragment);
+        body.add(",\"cache_control\":{\"type\":\"ephemeral\"}}]");
+    } else {
+        body.add("\"system\":");
+        body.add(systemFragment);
+    }
+    body.add(",\"messages\":[");
+
+    // History fragments are referenced in place from the arena
+    bool first = true;
+    for (size_t i = 0; i < history.size(); i++) {
+        size_t len;
+        const uint8_t* frag = history.claudeFragment(i, len);
+        if (!first) body.add(",");
+        body.add(frag, len);
+        first = false;
     }
 
-    // Add new user message
-    if (newUserMessage && strlen(newUserMessage) > 0) {
-        JsonObject userMsg = messages.add<JsonObject>();
-        userMsg["role"] = "user";
-        userMsg["content"] = newUserMessage;
+    if (requestUser.length() > 0) {
+        if (!first) body.add(",");
+        body.add(requestUser);
     }
+    body.add("]}");
+}
 
-    // Add tools (OpenAI format)
-    if (!tools.empty()) {
-        JsonArray toolsArray = doc["tools"].to<JsonArray>();
-        for (const auto& tool : tools) {
-            JsonObject toolObj = toolsArray.add<JsonObject>();
-            toolObj["type"] = "function";
-            JsonObject func = toolObj["function"].to<JsonObject>();
-            func["name"] = tool.name;
-            func["description"] = tool.description;
-            JsonDocument schemaDoc;
-            deserializeJson(schemaDoc, tool.inputSchema);
-            func["parameters"] = schemaDoc;
-        }
+void LLMClient::buildOpenAIRequest(const char* newUserMessage, FragmentStream& body) {
+    char head[200];
+    snprintf(head, sizeof(head),
+             "{\"model\":\"%s\",\"max_tokens\":%d,%s"
+             "\"messages\":[{\"role\":\"system\",\"content\":",
+             OPENAI_MODEL, LLM_MAX_TOKENS,
+             streaming ? "\"stream\":true,\"stream_options\":{\"include_usage\":true}," : "");
+    requestHead = head;
+
+    // OpenAI caches identical prompt prefixes automatically; keeping the
+    // system prompt first and the tools in a fixed order makes every turn
+    // share the same prefix
+    body.add(requestHead);
+    body.add(systemFragment);
+    body.add("}");
+
+    for (size_t i = 0; i < history.size(); i++) {
+        size_t len;
+        const uint8_t* frag = history.openaiFragment(i, len);
+        body.add(",");
+        body.add(frag, len);
     }
 
-    String body;
-    serializeJson(doc, body);
-    return body;
+    if (requestUser.length() > 0) {
+        body.add(",");
+        body.add(requestUser);
+    }
+    body.add("]");
+
+    if (openaiToolsFragment.length() > 0) {
+        body.add(",\"tools\":");
+        body.add(openaiToolsFragment);
+    }
+    body.add("}");
 }
 
 //=============================================================================
 // Request Execution
 //=============================================================================
 
-LLMResponse LLMClient::makeRequest(const String& body) {
+LLMResponse LLMClient::makeRequest(FragmentStream& body) {
     LLMResponse response;
     response.success = false;
     response.inputTokens = 0;
     response.outputTokens = 0;
-
+    response.cacheReadTokens = 0;
+    response.cacheWriteTokens = 0;
+    response.firstTokenMs = -1;
+
+#ifdef LLM_STANDIN_HOST
+    const char* host = LLM_STANDIN_HOST;
+    uint16_t port = LLM_STANDIN_PORT;
+#else
+    const char* host = (provider == LLMProvider::Claude) ? CLAUDE_API_HOST : OPENAI_API_HOST;
+    uint16_t port = 443;
+#endif
     String url = "https://";
-    if (provider == LLMProvider::Claude) {
-        url += CLAUDE_API_HOST;
-        url += CLAUDE_API_PATH;
-    } else {
-        url += OPENAI_API_HOST;
-        url += OPENAI_API_PATH;
+    url += host;
+    if (port != 443) url += ":" + String(port);
+    url += (provider == LLMProvider::Claude) ? CLAUDE_API_PATH : OPENAI_API_PATH;
+
+    NetworkClientSecure* conn = connectionManager.acquire(host, port);
+    if (!conn) {
+        snprintf(lastError, sizeof(lastError), "Connection failed");
+        response.error = lastError;
+        return response;
     }
 
-    http.begin(*secureClient, url);
+    // HTTP/1.1 keep-alive; streamed bodies are de-chunked while reading
+    static const char* headerKeys[] = {"Transfer-Encoding"};
+    http.setReuse(true);
+    http.begin(*conn, url);
+    http.collectHeaders(headerKeys, 1);
     http.setTimeout(LLM_HTTP_TIMEOUT_MS);
     http.addHeader("Content-Type", "application/json");
+    if (streaming) {
+        http.addHeader("Accept", "text/event-stream");
+    }
 
     if (provider == LLMProvider::Claude) {
         http.addHeader("x-api-key", apiKey);
@@ -424,7 +759,9 @@ LLMResponse LLMClient::makeRequest(const String& body) {
         http.addHeader("Authorization", authHeader);
     }
 
-    int httpCode = http.POST(body);
+    // Body goes from the history arena to the socket piece by piece
+    body.rewind();
+    int httpCode = http.sendRequest("POST", &body, body.size());
 
     if (httpCode != HTTP_CODE_OK) {
         Serial.printf("[LLM] HTTP error: %d\n", httpCode);
@@ -434,36 +771,345 @@ LLMResponse LLMClient::makeRequest(const String& body) {
         snprintf(lastError, sizeof(lastError), "HTTP %d", httpCode);
         response.error = lastError;
         http.end();
+        connectionManager.release(conn, httpCode > 0);
+        return response;
+    }
+
+    if (streaming) {
+        bool bodyComplete = false;
+        response = readStreamingResponse(bodyComplete);
+        http.end();
+        connectionManager.release(conn, bodyComplete);
         return response;
     }
 
-    String responseBody = http.getString();
+    // Parse straight off the socket; the filter drops everything but the
+    // fields read below, and the document's pool lives in PSRAM
+    bool chunked = http.header("Transfer-Encoding").indexOf("chunked") >= 0;
+    HttpBodyStream bodyStream(http.getStreamPtr(), chunked, http.getSize(), LLM_HTTP_TIMEOUT_MS);
+
+    JsonDocument filter;
+    buildResponseFilter(filter);
+
+    uint32_t parseStart = millis();
+    JsonDocument doc(&PsramAllocator::instance());
+    DeserializationError error = deserializeJson(doc, bodyStream,
+                                                 DeserializationOption::Filter(filter));
+    bool bodyComplete = !error && bodyStream.drain(LLM_STREAM_DRAIN_MS);
     http.end();
+    connectionManager.release(conn, bodyComplete);
+
+    if (error) {
+        Serial.printf("[LLM] JSON parse error: %s\n", error.c_str());
+        response.error = "JSON parse error";
+        return response;
+    }
+    Serial.printf("[LLM] Parsed response in %lums\n", millis() - parseStart);
+
+    if (provider == LLMProvider::Claude) {
+        return parseClaudeResponse(doc);
+    } else {
+        return parseOpenAIResponse(doc);
+    }
+}
+
+void LLMClient::buildResponseFilter(JsonDocument& filter) {
+    filter["error"]["message"] = true;
 
     if (provider == LLMProvider::Claude) {
-        return parseClaudeResponse(responseBody.c_str());
+        filter["usage"] = true;
+        // A filter on [0] applies to every element of the array
+        JsonObject block = filter["content"][0].to<JsonObject>();
+        block["type"] = true;
+        block["text"] = true;
+        block["id"] = true;
+        block["name"] = true;
+        block["input"] = true;
     } else {
-        return parseOpenAIResponse(responseBody.c_str());
+        filter["usage"] = true;
+        JsonObject message = filter["choices"][0]["message"].to<JsonObject>();
+        message["content"] = true;
+        message["tool_calls"] = true;
     }
 }
 
 //=============================================================================
-// Claude Response Parsing
+// Streaming Response
 //=============================================================================
 
-LLMResponse LLMClient::parseClaudeResponse(const char* json) {
+LLMResponse LLMClient::readStreamingResponse(bool& bodyComplete) {
     LLMResponse response;
     response.success = false;
+    response.inputTokens = 0;
+    response.outputTokens = 0;
+    response.cacheReadTokens = 0;
+    response.cacheWriteTokens = 0;
+    response.firstTokenMs = -1;
+
+    LLMStreamState st;
+    st.response = &response;
+    st.startTime = millis();
+    st.done = false;
+    st.failed = false;
+
+    NetworkClient* stream = http.getStreamPtr();
+    if (!stream) {
+        response.error = "Stream unavailable";
+        return response;
+    }
 
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, json);
+    sseParser.reset();
+    sseParser.onEvent([this, &st](const char* event, const char* data) {
+        if (provider == LLMProvider::Claude) {
+            handleClaudeEvent(data, st);
+        } else {
+            handleOpenAIEvent(data, st);
+        }
+    });
+
+    bool chunked = http.header("Transfer-Encoding").indexOf("chunked") >= 0;
+    chunkDecoder.reset();
+    bodyComplete = false;
+
+    uint8_t buf[LLM_STREAM_READ_SIZE];
+    uint32_t lastDataTime = millis();
+
+    while (true) {
+        size_t available = stream->available();
+        if (available > 0) {
+            size_t toRead = min(available, sizeof(buf));
+            int bytesRead = stream->read(buf, toRead);
+            if (bytesRead > 0) {
+                size_t payload = chunked ? chunkDecoder.decode(buf, bytesRead) : bytesRead;
+                if (chunkDecoder.hasError()) {
+                    Serial.println("[LLM] Malformed chunked stream");
+                    break;
+                }
+                sseParser.feed(buf, payload);
+                lastDataTime = millis();
 
-    if (error) {
-        Serial.printf("[LLM] JSON parse error: %s\n", error.c_str());
-        response.error = "JSON parse error";
+                // Terminating chunk read - socket is clean for the next request
+                if (chunkDecoder.isComplete()) {
+                    bodyComplete = true;
+                    break;
+                }
+            }
+            continue;
+        }
+
+        // Without chunking the only end marker is the socket closing
+        if (!chunked && st.done) break;
+
+        if (!stream->connected()) break;
+
+        uint32_t idleLimit = st.done ? LLM_STREAM_DRAIN_MS : LLM_HTTP_TIMEOUT_MS;
+        if (millis() - lastDataTime > idleLimit) {
+            if (!st.done) {
+                Serial.println("[LLM] Stream timeout");
+                snprintf(lastError, sizeof(lastError), "Stream timeout");
+                response.error = lastError;
+                st.failed = true;
+            }
+            break;
+        }
+
+        delay(1);
+    }
+
+    sseParser.finish();
+    sseParser.onEvent(nullptr);
+
+    // Anything still open at the end of the stream is as complete as it gets
+    finishToolBlocks(st, -1);
+
+    if (sseParser.getDroppedCount() > 0) {
+        Serial.printf("[LLM] Dropped %u oversized stream events\n", sseParser.getDroppedCount());
+    }
+
+    if (st.failed) {
         return response;
     }
 
+    if (!st.done && response.text.isEmpty() && response.toolCalls.empty()) {
+        response.error = "Stream ended without content";
+        return response;
+    }
+
+    recordUsage(response);
+    if (usageCallback) {
+        usageCallback(response.inputTokens, response.outputTokens);
+    }
+
+    Serial.printf("[LLM] Streamed %u events, first token %d ms, total %lu ms\n",
+                  sseParser.getEventCount(), response.firstTokenMs,
+                  millis() - st.startTime);
+
+    response.success = true;
+    return response;
+}
+
+void LLMClient::handleClaudeEvent(const char* data, LLMStreamState& st) {
+    JsonDocument doc;
+    if (deserializeJson(doc, data)) return;
+
+    const char* type = doc["type"] | "";
+
+    if (strcmp(type, "content_block_delta") == 0) {
+        JsonObject delta = doc["delta"];
+        const char* deltaType = delta["type"] | "";
+
+        if (strcmp(deltaType, "text_delta") == 0) {
+            const char* text = delta["text"];
+            if (text) emitTextDelta(text, st);
+        } else if (strcmp(deltaType, "input_json_delta") == 0) {
+            int index = doc["index"] | -1;
+            const char* partial = delta["partial_json"];
+            for (auto& block : st.pendingTools) {
+                if (block.index == index && partial) {
+                    block.call.input += partial;
+                    break;
+                }
+            }
+        }
+    } else if (strcmp(type, "content_block_start") == 0) {
+        JsonObject block = doc["content_block"];
+        if (strcmp(block["type"] | "", "tool_use") == 0) {
+            LLMStreamBlock pending;
+            pending.index = doc["index"] | -1;
+            pending.call.id = block["id"] | "";
+            pending.call.name = block["name"] | "";
+            st.pendingTools.push_back(pending);
+        }
+    } else if (strcmp(type, "content_block_stop") == 0) {
+        finishToolBlocks(st, doc["index"] | -1);
+    } else if (strcmp(type, "message_start") == 0) {
+        JsonObject usage = doc["message"]["usage"];
+        st.response->inputTokens = usage["input_tokens"] | 0;
+        st.response->cacheReadTokens = usage["cache_read_input_tokens"] | 0;
+        st.response->cacheWriteTokens = usage["cache_creation_input_tokens"] | 0;
+    } else if (strcmp(type, "message_delta") == 0) {
+        st.response->outputTokens = doc["usage"]["output_tokens"] | st.response->outputTokens;
+    } else if (strcmp(type, "message_stop") == 0) {
+        st.done = true;
+    } else if (strcmp(type, "error") == 0) {
+        const char* errMsg = doc["error"]["message"];
+        snprintf(lastError, sizeof(lastError), "%s", errMsg ? errMsg : "API error");
+        st.response->error = lastError;
+        st.failed = true;
+        st.done = true;
+    }
+    // "ping" events need no handling
+}
+
+void LLMClient::handleOpenAIEvent(const char* data, LLMStreamState& st) {
+    if (strcmp(data, "[DONE]") == 0) {
+        finishToolBlocks(st, -1);
+        st.done = true;
+        return;
+    }
+
+    JsonDocument doc;
+    if (deserializeJson(doc, data)) return;
+
+    if (doc["error"].is<JsonObject>()) {
+        const char* errMsg = doc["error"]["message"];
+        snprintf(lastError, sizeof(lastError), "%s", errMsg ? errMsg : "API error");
+        st.response->error = lastError;
+        st.failed = true;
+        st.done = true;
+        return;
+    }
+
+    // Final chunk carries usage with an empty choices array
+    if (doc["usage"].is<JsonObject>()) {
+        st.response->inputTokens = doc["usage"]["prompt_tokens"] | 0;
+        st.response->outputTokens = doc["usage"]["completion_tokens"] | 0;
+        st.response->cacheReadTokens = doc["usage"]["prompt_tokens_details"]["cached_tokens"] | 0;
+    }
+
+    JsonObject choice = doc["choices"][0];
+    if (!choice) return;
+
+    JsonObject delta = choice["delta"];
+    const char* content = delta["content"];
+    if (content && content[0] != '\0') {
+        emitTextDelta(content, st);
+    }
+
+    JsonArray toolCalls = delta["tool_calls"];
+    for (JsonObject tc : toolCalls) {
+        int index = tc["index"] | 0;
+
+        LLMStreamBlock* block = nullptr;
+        for (auto& pending : st.pendingTools) {
+            if (pending.index == index) {
+                block = &pending;
+                break;
+            }
+        }
+        if (!block) {
+            LLMStreamBlock pending;
+            pending.index = index;
+            st.pendingTools.push_back(pending);
+            block = &st.pendingTools.back();
+        }
+
+        const char* id = tc["id"];
+        if (id) block->call.id = id;
+        const char* name = tc["function"]["name"];
+        if (name) block->call.name += name;
+        const char* args = tc["function"]["arguments"];
+        if (args) block->call.input += args;
+    }
+
+    if (!choice["finish_reason"].isNull()) {
+        finishToolBlocks(st, -1);
+    }
+}
+
+void LLMClient::emitTextDelta(const char* delta, LLMStreamState& st) {
+    if (st.response->firstTokenMs < 0) {
+        st.response->firstTokenMs = millis() - st.startTime;
+    }
+    st.response->text += delta;
+    if (textDeltaCallback) {
+        textDeltaCallback(delta);
+    }
+}
+
+void LLMClient::finishToolBlocks(LLMStreamState& st, int index) {
+    for (auto it = st.pendingTools.begin(); it != st.pendingTools.end(); ) {
+        if (index >= 0 && it->index != index) {
+            ++it;
+            continue;
+        }
+
+        if (it->call.input.isEmpty()) {
+            it->call.input = "{}";
+        }
+        if (st.response->firstTokenMs < 0) {
+            st.response->firstTokenMs = millis() - st.startTime;
+        }
+
+        st.response->toolCalls.push_back(it->call);
+        if (toolCallCallback) {
+            toolCallCallback(it->call);
+        }
+        it = st.pendingTools.erase(it);
+    }
+}
+
+//=============================================================================
+// Claude Response Parsing
+//=============================================================================
+
+LLMResponse LLMClient::parseClaudeResponse(JsonDocument& doc) {
+    LLMResponse response;
+    response.success = false;
+    response.cacheReadTokens = 0;
+    response.cacheWriteTokens = 0;
+    response.firstTokenMs = -1;
+
     if (doc["error"].is<JsonObject>()) {
         const char* errMsg = doc["error"]["message"];
         snprintf(lastError, sizeof(lastError), "%s", errMsg ? errMsg : "API error");
@@ -473,7 +1119,9 @@ LLMResponse LLMClient::parseClaudeResponse(const char* json) {
 
     response.inputTokens = doc["usage"]["input_tokens"] | 0;
     response.outputTokens = doc["usage"]["output_tokens"] | 0;
-    contextTokens += response.inputTokens + response.outputTokens;
+    response.cacheReadTokens = doc["usage"]["cache_read_input_tokens"] | 0;
+    response.cacheWriteTokens = doc["usage"]["cache_creation_input_tokens"] | 0;
+    recordUsage(response);
 
     JsonArray content = doc["content"];
     if (!content) {
@@ -497,7 +1145,6 @@ LLMResponse LLMClient::parseClaudeResponse(const char* json) {
     }
 
     response.success = true;
-    pruneHistory();
     return response;
 }
 
@@ -505,18 +1152,12 @@ LLMResponse LLMClient::parseClaudeResponse(const char* json) {
 // OpenAI Response Parsing
 //=============================================================================
 
-LLMResponse LLMClient::parseOpenAIResponse(const char* json) {
+LLMResponse LLMClient::parseOpenAIResponse(JsonDocument& doc) {
     LLMResponse response;
     response.success = false;
-
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, json);
-
-    if (error) {
-        Serial.printf("[LLM] JSON parse error: %s\n", error.c_str());
-        response.error = "JSON parse error";
-        return response;
-    }
+    response.cacheReadTokens = 0;
+    response.cacheWriteTokens = 0;
+    response.firstTokenMs = -1;
 
     if (doc["error"].is<JsonObject>()) {
         const char* errMsg = doc["error"]["message"];
@@ -527,7 +1168,8 @@ LLMResponse LLMClient::parseOpenAIResponse(const char* json) {
 
     response.inputTokens = doc["usage"]["prompt_tokens"] | 0;
     response.outputTokens = doc["usage"]["completion_tokens"] | 0;
-    contextTokens += response.inputTokens + response.outputTokens;
+    response.cacheReadTokens = doc["usage"]["prompt_tokens_details"]["cached_tokens"] | 0;
+    recordUsage(response);
 
     JsonArray choices = doc["choices"];
     if (!choices || choices.size() == 0) {
@@ -558,37 +1200,109 @@ LLMResponse LLMClient::parseOpenAIResponse(const char* json) {
     }
 
     response.success = true;
-    pruneHistory();
     return response;
 }
 
+//=============================================================================
+// Usage Accounting
+//=============================================================================
+
+void LLMClient::recordUsage(const LLMResponse& response) {
+    // Claude reports cached prompt tokens separately from input_tokens;
+    // OpenAI's prompt_tokens already includes its cached_tokens
+    int promptTokens = response.inputTokens;
+    if (provider == LLMProvider::Claude) {
+        promptTokens += response.cacheReadTokens + response.cacheWriteTokens;
+    }
+
+    contextTokens = promptTokens + response.outputTokens;
+
+    // Calibrate the estimator against the provider's tokenizer
+    if (promptTokens > 0 && requestEstimate > 0) {
+        float ratio = (float)promptTokens / requestEstimate;
+        ratio = constrain(ratio, 0.5f, 2.0f);
+        budgetScale = budgetScale * 0.8f + ratio * 0.2f;
+    }
+
+    cacheStats.requests++;
+    cacheStats.promptTokens += promptTokens;
+    cacheStats.cacheReadTokens += response.cacheReadTokens;
+    cacheStats.cacheWriteTokens += response.cacheWriteTokens;
+    if (response.cacheReadTokens > 0) cacheStats.hits++;
+
+    Serial.printf("[LLM] Tokens: %d prompt (%d cached, %d written), %d output\n",
+                  promptTokens, response.cacheReadTokens, response.cacheWriteTokens,
+                  response.outputTokens);
+}
+
 //=============================================================================
 // History Management
 //=============================================================================
 
+void LLMClient::addResponse(const LLMResponse& response) {
+    if (response.toolCalls.empty()) {
+        addMessage(MessageRole::Assistant, response.text.c_str());
+        return;
+    }
+
+    // All tool_use blocks of a response belong to one assistant message
+    std::vector<HistoryToolCall> calls(response.toolCalls.size());
+    for (size_t i = 0; i < calls.size(); i++) {
+        const ToolCall& tc = response.toolCalls[i];
+        calls[i].id = tc.id.c_str();
+        calls[i].name = tc.name.c_str();
+        calls[i].input = tc.input.c_str();
+    }
+    if (history.addToolCalls(response.text.c_str(), calls.data(), calls.size())) {
+        historyLog.appendNewest(history);
+    }
+}
+
 void LLMClient::addMessage(MessageRole role, const char* content,
                            const char* toolUseId, const char* toolName,
                            const char* toolInput) {
-    Message msg;
-    msg.role = role;
-    msg.content = content ? content : "";
-    msg.toolUseId = toolUseId ? toolUseId : "";
-    msg.toolName = toolName ? toolName : "";
-    msg.toolInput = toolInput ? toolInput : "";
+    if (history.add(role, content, toolUseId, toolName, toolInput)) {
+        historyLog.appendNewest(history);
+    }
+}
 
-    history.push_back(msg);
+uint32_t LLMClient::fixedPromptTokens() const {
+    return systemTokens + (provider == LLMProvider::Claude ? claudeToolTokens : openaiToolTokens);
 }
 
-void LLMClient::pruneHistory() {
-    while (history.size() > LLM_MAX_HISTORY) {
-        history.erase(history.begin());
-    }
+TokenBudget LLMClient::getBudget() const {
+    TokenBudget budget;
+    budget.system = systemTokens * budgetScale;
+    budget.tools = (fixedPromptTokens() - systemTokens) * budgetScale;
+    budget.history = history.tokens() * budgetScale;
+    budget.pending = 0;
+    budget.limit = LLM_PROMPT_BUDGET_TOKENS;
+    budget.scale = budgetScale;
+    return budget;
+}
 
-    if (contextTokens > LLM_MAX_CONTEXT_TOKENS) {
-        while (history.size() > 2 && contextTokens > LLM_MAX_CONTEXT_TOKENS / 2) {
-            contextTokens -= history[0].content.length() / 4;
-            history.erase(history.begin());
+void LLMClient::pruneHistory(uint32_t pendingTokens) {
+    uint32_t fixed = fixedPromptTokens() + pendingTokens;
+    size_t dropped = 0;
+
+    while (history.size() > 0) {
+        uint32_t estimate = (fixed + history.tokens()) * budgetScale;
+        if (history.size() <= LLM_MAX_HISTORY && estimate <= LLM_PROMPT_BUDGET_TOKENS) break;
+
+        // Whole turns only - a tool_result without its tool_use is rejected
+        size_t n = history.dropOldestTurn();
+        if (n == 0) {
+            // One turn left: it can go only if a new one is about to start
+            if (pendingTokens == 0) break;
+            n = history.size();
+            history.clear();
         }
+        dropped += n;
+    }
+
+    if (dropped > 0) {
+        Serial.printf("[LLM] Pruned %u messages, ~%lu prompt tokens remain\n",
+                      dropped, (uint32_t)((fixed + history.tokens()) * budgetScale));
     }
 }
 
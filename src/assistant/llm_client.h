@@ -15,6 +15,12 @@
 #include <NetworkClientSecure.h>
 #include <functional>
 #include <vector>
+#include "sse_parser.h"
+#include "conversation_history.h"
+#include "conversation_log.h"
+#include "token_budget.h"
+#include "mcp_client.h"
+#include "../network/connection_manager.h"
 
 //=============================================================================
 // Configuration
@@ -31,20 +37,68 @@
 #define OPENAI_API_PATH "/v1/chat/completions"
 #define OPENAI_MODEL "gpt-4o"
 
+/**
+ * Send LLM requests for either provider to scripts/llm_standin.py instead,
+ * e.g. build_flags = -DLLM_STANDIN_HOST=\"192.168.1.10\"
+ */
+#ifndef LLM_STANDIN_PORT
+#define LLM_STANDIN_PORT 8444
+#endif
+
 /** Maximum tokens in response */
 #define LLM_MAX_TOKENS 1024
 
 /** Maximum context tokens to maintain */
 #define LLM_MAX_CONTEXT_TOKENS 8000
 
+/** Prompt budget: the context limit less room for the answer */
+#define LLM_PROMPT_BUDGET_TOKENS (LLM_MAX_CONTEXT_TOKENS - LLM_MAX_TOKENS)
+
 /** HTTP timeout (ms) */
 #define LLM_HTTP_TIMEOUT_MS 60000
 
 /** Maximum message history */
 #define LLM_MAX_HISTORY 20
 
-/** Maximum tool definitions */
-#define LLM_MAX_TOOLS 16
+/** Device tools that fit (checked against the table in device_tools.cpp) */
+#define LLM_MAX_DEVICE_TOOLS 24
+
+/** Maximum tool definitions: every device tool and every MCP tool */
+#define LLM_MAX_TOOLS (LLM_MAX_DEVICE_TOOLS + MCP_MAX_SERVERS * MCP_MAX_TOOLS_PER_SERVER)
+
+/** Stream responses via SSE by default */
+#define LLM_STREAM_DEFAULT true
+
+/** Bytes read from the socket per iteration while streaming */
+#define LLM_STREAM_READ_SIZE 512
+
+/** After message_stop, wait this long for the terminating chunk (ms) */
+#define LLM_STREAM_DRAIN_MS 500
+
+/** Keep the conversation on LittleFS so it survives a reboot */
+#define LLM_PERSIST_HISTORY true
+
+/** Mark the system prompt and tools as a cacheable prefix (Claude) */
+#define LLM_PROMPT_CACHE true
+
+/** Stack size for the sendAsync worker task */
+#define LLM_ASYNC_TASK_STACK_SIZE 12288
+
+/** Remote tool calls from one response executed concurrently */
+#define LLM_MAX_PARALLEL_TOOLS 3
+
+/** Stack size for a remote tool worker task (TLS request) */
+#define LLM_TOOL_TASK_STACK_SIZE 8192
+
+/** Follow-up requests allowed per turn before tool calls are dropped */
+#define LLM_MAX_TOOL_ROUNDS 4
+
+/** Tool flag: I/O-bound (MCP), runs on a worker task alongside others */
+#define LLM_TOOL_REMOTE 0x01
+
+/** Tool flag: depends on earlier calls - runs alone, in call order
+ *  (MCP tools annotated destructiveHint) */
+#define LLM_TOOL_ORDERED 0x02
 
 //=============================================================================
 // Provider Enum
@@ -63,28 +117,6 @@ enum class LLMProvider {
 // Message Types
 //=============================================================================
 
-/**
- * @enum MessageRole
- * @brief Role of a conversation message
- */
-enum class MessageRole {
-    User,
-    Assistant,
-    Tool        // For tool results
-};
-
-/**
- * @struct Message
- * @brief A conversation message
- */
-struct Message {
-    MessageRole role;
-    String content;
-    String toolUseId;       // For tool results
-    String toolName;        // For tool use
-    String toolInput;       // For tool use (JSON)
-};
-
 /**
  * @struct ToolDefinition
  * @brief Definition of an available tool
@@ -93,6 +125,7 @@ struct ToolDefinition {
     String name;
     String description;
     String inputSchema;     // JSON schema
+    uint8_t flags;          // LLM_TOOL_* execution hints
 };
 
 /**
@@ -105,6 +138,15 @@ struct ToolCall {
     String input;           // JSON
 };
 
+/**
+ * @struct ToolResult
+ * @brief Result of one executed tool call
+ */
+struct ToolResult {
+    String id;              // Matches ToolCall::id
+    String content;         // JSON
+};
+
 /**
  * @struct LLMResponse
  * @brief Response from LLM API
@@ -117,6 +159,56 @@ struct LLMResponse {
     String error;
     int inputTokens;
     int outputTokens;
+    int cacheReadTokens;    // Prompt tokens served from the provider cache
+    int cacheWriteTokens;   // Prompt tokens written to the cache (Claude only)
+    int firstTokenMs;       // Time to first streamed delta (-1 if not streamed)
+};
+
+/**
+ * @struct LLMCacheStats
+ * @brief Provider prompt-cache counters since boot
+ */
+struct LLMCacheStats {
+    uint32_t requests;          ///< Responses with usage reported
+    uint32_t hits;              ///< Responses that read from the cache
+    uint32_t promptTokens;      ///< All prompt tokens (cached or not)
+    uint32_t cacheReadTokens;   ///< Prompt tokens served from the cache
+    uint32_t cacheWriteTokens;  ///< Prompt tokens written to the cache
+};
+
+/**
+ * @struct LLMToolStats
+ * @brief Tool execution counters since boot
+ */
+struct LLMToolStats {
+    uint32_t rounds;            ///< Responses whose tool calls were executed
+    uint32_t calls;             ///< Tool calls executed
+    uint32_t parallelCalls;     ///< Calls run on worker tasks
+    uint32_t roundTrips;        ///< Follow-up requests carrying tool results
+    uint32_t savedRoundTrips;   ///< Follow-ups avoided by batching results
+    uint32_t wallMs;            ///< Time spent executing tools
+    uint32_t serialMs;          ///< Sum of individual call durations
+};
+
+/**
+ * @struct LLMStreamBlock
+ * @brief Tool call being assembled from streamed deltas
+ */
+struct LLMStreamBlock {
+    int index;              // Provider content block / tool_calls index
+    ToolCall call;
+};
+
+/**
+ * @struct LLMStreamState
+ * @brief Accumulator for one streamed response
+ */
+struct LLMStreamState {
+    LLMResponse* response;
+    std::vector<LLMStreamBlock> pendingTools;
+    uint32_t startTime;
+    bool done;
+    bool failed;
 };
 
 //=============================================================================
@@ -131,12 +223,45 @@ struct LLMResponse {
  */
 using ToolExecutor = std::function<String(const char* toolName, const char* input)>;
 
+/**
+ * @brief Callback for running several remote tool calls at once
+ * @param calls Remote calls that may run concurrently
+ * @param results One per call, to be filled in
+ */
+using ToolBatchExecutor = std::function<void(const std::vector<const ToolCall*>& calls,
+                                             std::vector<String>& results)>;
+
 /**
  * @brief Callback for response ready
  * @param response The LLM response
  */
 using ResponseCallback = std::function<void(const LLMResponse& response)>;
 
+/**
+ * @brief Callback for each streamed text delta
+ * @param delta New text fragment (not null-terminated across calls)
+ */
+using TextDeltaCallback = std::function<void(const char* delta)>;
+
+/**
+ * @brief Callback for a tool call whose input JSON is complete
+ * @param call The completed tool call
+ */
+using ToolCallReadyCallback = std::function<void(const ToolCall& call)>;
+
+/**
+ * @brief Callback before the follow-up request of a tool round
+ * @param calls Number of tool results being sent
+ */
+using ToolRoundCallback = std::function<void(size_t calls)>;
+
+/**
+ * @brief Callback for final token usage of a response
+ * @param inputTokens Prompt tokens
+ * @param outputTokens Completion tokens
+ */
+using UsageCallback = std::function<void(int inputTokens, int outputTokens)>;
+
 //=============================================================================
 // LLMClient Class
 //=============================================================================
@@ -171,18 +296,32 @@ public:
 
     /**
      * @brief Send a message and get response
+     *
+     * If a tool executor is set, tool calls in the response are executed
+     * and their results sent back (one request per round) until the model
+     * answers without tools or LLM_MAX_TOOL_ROUNDS is reached.
+     *
      * @param text User message text
-     * @return LLM response
+     * @return Final LLM response (toolCalls holds any left unexecuted)
      */
     LLMResponse send(const char* text);
 
     /**
      * @brief Send a message asynchronously
+     *
+     * Runs send() in a worker task on core 0. Streaming callbacks and the
+     * response callback are invoked from that task.
+     *
      * @param text User message text
      * @param callback Response callback
      */
     void sendAsync(const char* text, ResponseCallback callback);
 
+    /**
+     * @brief Check if an async request is in flight
+     */
+    bool isBusy() const { return asyncBusy; }
+
     /**
      * @brief Add tool result and continue conversation
      * @param toolUseId Tool use ID from LLM
@@ -192,15 +331,62 @@ public:
     LLMResponse addToolResult(const char* toolUseId, const char* result);
 
     /**
-     * @brief Clear conversation history
+     * @brief Add the results of every tool call of a response in one turn
+     * @param results One entry per tool call, in call order
+     * @return LLM response after the tool results
+     */
+    LLMResponse addToolResults(const std::vector<ToolResult>& results);
+
+    /**
+     * @brief Run tool calls through the executor, remote ones concurrently
+     *
+     * Local tools run in call order through the executor, which hands
+     * device tools to the main loop. LLM_TOOL_REMOTE calls run on
+     * up to LLM_MAX_PARALLEL_TOOLS worker tasks meanwhile. An
+     * LLM_TOOL_ORDERED call waits for everything before it and finishes
+     * before anything after it starts.
+     *
+     * @param calls Tool calls from one response
+     * @param results Filled with one result per call, in call order
+     */
+    void executeToolCalls(const std::vector<ToolCall>& calls, std::vector<ToolResult>& results);
+
+    /**
+     * @brief Clear conversation history (including the persisted log)
      */
     void clearHistory();
 
     /**
-     * @brief Get conversation token count estimate
+     * @brief Record a turn answered without the LLM (e.g. a local intent)
+     *        so follow-up questions still have the context
+     */
+    void recordExchange(const char* userMessage, const char* assistantReply);
+
+    /**
+     * @brief Context size of the last exchange (reported prompt + output)
      */
     int getContextTokens() const { return contextTokens; }
 
+    /**
+     * @brief Estimated composition of the next prompt (calibrated)
+     */
+    TokenBudget getBudget() const;
+
+    /**
+     * @brief Prompt-cache hit counters
+     */
+    const LLMCacheStats& getCacheStats() const { return cacheStats; }
+
+    /**
+     * @brief Tool execution counters
+     */
+    const LLMToolStats& getToolStats() const { return toolStats; }
+
+    /**
+     * @brief Persisted history log (for stats)
+     */
+    const ConversationLog& getHistoryLog() const { return historyLog; }
+
     //-------------------------------------------------------------------------
     // Configuration
     //-------------------------------------------------------------------------
@@ -235,6 +421,46 @@ public:
      */
     void setToolExecutor(ToolExecutor executor) { toolExecutor = executor; }
 
+    /**
+     * @brief Run the remote calls of a round together instead of one
+     *        worker task each (e.g. to batch them per server)
+     */
+    void setToolBatchExecutor(ToolBatchExecutor executor) { toolBatchExecutor = executor; }
+
+    /**
+     * @brief Enable/disable streamed (SSE) responses
+     */
+    void setStreaming(bool enable) { streaming = enable; }
+
+    /**
+     * @brief Check if streamed responses are enabled
+     */
+    bool isStreaming() const { return streaming; }
+
+    //-------------------------------------------------------------------------
+    // Streaming Callbacks
+    //-------------------------------------------------------------------------
+
+    /**
+     * @brief Set callback for each text delta (streaming only)
+     */
+    void onTextDelta(TextDeltaCallback callback) { textDeltaCallback = callback; }
+
+    /**
+     * @brief Set callback for each completed tool call (streaming only)
+     */
+    void onToolCall(ToolCallReadyCallback callback) { toolCallCallback = callback; }
+
+    /**
+     * @brief Set callback for final usage of each response
+     */
+    void onUsage(UsageCallback callback) { usageCallback = callback; }
+
+    /**
+     * @brief Set callback invoked before each tool-result follow-up
+     */
+    void onToolRound(ToolRoundCallback callback) { toolRoundCallback = callback; }
+
     //-------------------------------------------------------------------------
     // Tool Management
     //-------------------------------------------------------------------------
@@ -244,9 +470,11 @@ public:
      * @param name Tool name
      * @param description Tool description
      * @param inputSchema JSON schema for input
+     * @param flags LLM_TOOL_* execution hints
      * @return true if added
      */
-    bool addTool(const char* name, const char* description, const char* inputSchema);
+    bool addTool(const char* name, const char* description, const char* inputSchema,
+                 uint8_t flags = 0);
 
     /**
      * @brief Remove a tool
@@ -254,6 +482,11 @@ public:
      */
     void removeTool(const char* name);
 
+    /**
+     * @brief Remove every tool carrying any of the given flags
+     */
+    void removeTools(uint8_t flags);
+
     /**
      * @brief Clear all tools
      */
@@ -280,29 +513,100 @@ public:
 
 private:
     /**
-     * @brief Build request JSON for Claude API
+     * @brief Assemble a Claude request body from pre-serialized fragments
+     * @param newUserMessage Message not yet in history (may be null)
+     * @param body Stream to fill (references history and cached fragments)
      */
-    String buildClaudeRequest(const char* newUserMessage);
+    void buildClaudeRequest(const char* newUserMessage, FragmentStream& body);
 
     /**
-     * @brief Build request JSON for OpenAI API
+     * @brief Assemble an OpenAI request body from pre-serialized fragments
      */
-    String buildOpenAIRequest(const char* newUserMessage);
+    void buildOpenAIRequest(const char* newUserMessage, FragmentStream& body);
 
     /**
-     * @brief Parse Claude response JSON
+     * @brief Build the request body for the current provider and log its cost
      */
-    LLMResponse parseClaudeResponse(const char* json);
+    void buildRequest(const char* newUserMessage, FragmentStream& body);
 
     /**
-     * @brief Parse OpenAI response JSON
+     * @brief Re-serialize the tools array and system prompt if they changed
      */
-    LLMResponse parseOpenAIResponse(const char* json);
+    void refreshFragments();
 
     /**
-     * @brief Make API request
+     * @brief Parse a (filtered) Claude response document
      */
-    LLMResponse makeRequest(const String& body);
+    LLMResponse parseClaudeResponse(JsonDocument& doc);
+
+    /**
+     * @brief Parse a (filtered) OpenAI response document
+     */
+    LLMResponse parseOpenAIResponse(JsonDocument& doc);
+
+    /**
+     * @brief Build the deserialization filter for the current provider
+     */
+    void buildResponseFilter(JsonDocument& filter);
+
+    /**
+     * @brief Make API request, streaming the body to the socket
+     */
+    LLMResponse makeRequest(FragmentStream& body);
+
+    /**
+     * @brief Read an SSE response body into a response
+     * @param bodyComplete Set true if the body was read to its end, so the
+     *        connection can be kept alive
+     */
+    LLMResponse readStreamingResponse(bool& bodyComplete);
+
+    /**
+     * @brief Apply one Claude stream event to the accumulator
+     */
+    void handleClaudeEvent(const char* data, LLMStreamState& st);
+
+    /**
+     * @brief Apply one OpenAI stream chunk to the accumulator
+     */
+    void handleOpenAIEvent(const char* data, LLMStreamState& st);
+
+    /**
+     * @brief Append streamed text and notify
+     */
+    void emitTextDelta(const char* delta, LLMStreamState& st);
+
+    /**
+     * @brief Complete pending tool call(s) and notify
+     * @param index Block index to complete, or -1 for all
+     */
+    void finishToolBlocks(LLMStreamState& st, int index);
+
+    /**
+     * @brief Worker task for sendAsync
+     */
+    static void asyncTask(void* param);
+
+    /**
+     * @brief Execute tool calls and send results until the model stops
+     *        calling tools
+     */
+    LLMResponse resolveToolCalls(LLMResponse response);
+
+    /**
+     * @brief Execution flags of a registered tool (0 if unknown)
+     */
+    uint8_t getToolFlags(const char* name) const;
+
+    /**
+     * @brief Worker task running one remote tool call
+     */
+    static void toolTask(void* param);
+
+    /**
+     * @brief Add an assistant response (text and tool calls) to history
+     */
+    void addResponse(const LLMResponse& response);
 
     /**
      * @brief Add message to history
@@ -313,9 +617,26 @@ private:
                     const char* toolInput = nullptr);
 
     /**
-     * @brief Prune history if too long
+     * @brief Load the previous session's conversation on first use
      */
-    void pruneHistory();
+    void restoreHistory();
+
+    /**
+     * @brief Drop the oldest turns until the prompt fits the budget
+     * @param pendingTokens Estimate for the message about to be sent; when
+     *        non-zero every stored turn may go, otherwise the newest stays
+     */
+    void pruneHistory(uint32_t pendingTokens = 0);
+
+    /**
+     * @brief Raw estimate of the fixed prompt part (system + tools)
+     */
+    uint32_t fixedPromptTokens() const;
+
+    /**
+     * @brief Account a finished response's token usage
+     */
+    void recordUsage(const LLMResponse& response);
 
     /**
      * @brief Extract emotion from response text
@@ -327,18 +648,49 @@ private:
     char apiKey[128];
     String systemPrompt;
 
-    // Conversation history
-    std::vector<Message> history;
+    // Conversation history (pre-serialized, arena-backed)
+    ConversationHistory history;
+    ConversationLog historyLog;
     int contextTokens;
+    LLMCacheStats cacheStats;
+
+    // Token budgeting (raw estimates, scaled by budgetScale)
+    uint32_t systemTokens;
+    uint32_t claudeToolTokens;
+    uint32_t openaiToolTokens;
+    uint32_t requestEstimate;       ///< Raw estimate of the last request's prompt
+    float budgetScale;              ///< Reported / estimated prompt tokens (EMA)
+    LLMToolStats toolStats;
+
+    // Cached request fragments - rebuilt only when tools/prompt change
+    String systemFragment;          ///< JSON-quoted system prompt
+    String claudeToolsFragment;     ///< Claude "tools" array
+    String openaiToolsFragment;     ///< OpenAI "tools" array
+    bool fragmentsDirty;
+
+    // Per-request scratch referenced by the FragmentStream during send
+    String requestHead;
+    String requestUser;
+    FragmentStream requestBody;
     char lastError[256];
 
     // Tools
     std::vector<ToolDefinition> tools;
     ToolExecutor toolExecutor;
-
-    // HTTP client
-    NetworkClientSecure* secureClient;
+    ToolBatchExecutor toolBatchExecutor;
+
+    // Streaming
+    bool streaming;
+    SSEParser sseParser;
+    TextDeltaCallback textDeltaCallback;
+    ToolCallReadyCallback toolCallCallback;
+    UsageCallback usageCallback;
+    ToolRoundCallback toolRoundCallback;
+    volatile bool asyncBusy;
+
+    // HTTP client (connection leased from connectionManager per request)
     HTTPClient http;
+    HttpChunkDecoder chunkDecoder;
 };
 
 #endif // LLM_CLIENT_H
@@ -5,7 +5,14 @@
 
 #include "mcp_client.h"
 #include <Preferences.h>
-#include <NetworkClientSecure.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <esp_rom_crc.h>
+#include <algorithm>
+#include <atomic>
+#include <time.h>
+#include "../network/connection_manager.h"
+#include "psram_allocator.h"
 
 // Global instance
 MCPClient mcpClient;
@@ -13,13 +20,83 @@ MCPClient mcpClient;
 // Preferences namespace
 static const char* PREFS_NAMESPACE = "mcp_client";
 
+//=============================================================================
+// Discovery Jobs
+//=============================================================================
+
+/**
+ * @struct MCPDiscoveryJob
+ * @brief One server's tools/list, fetched by a discovery worker
+ *
+ * Holds copies of the server settings so workers never touch servers or
+ * tools; mergeJob() applies the result on the owning task.
+ */
+struct MCPDiscoveryJob {
+    int serverIndex;
+    uint32_t configHash;
+    uint32_t cachedAt;          ///< toolsFetchedAt of a cached list, else 0
+    String name;
+    String url;
+    String apiKey;
+    bool skip;                  ///< Not fetched (disabled, offline or fresh)
+    bool fresh;                 ///< Skipped because the cached list is within TTL
+    MCPBatchSupport batch;      ///< As known before the fetch, updated by it
+    String sessionId;           ///< Mcp-Session-Id the batched initialize returned
+    bool ok;
+    String error;
+    std::vector<MCPRemoteTool> tools;
+    uint32_t elapsedMs;
+
+    MCPDiscoveryJob()
+        : serverIndex(-1), configHash(0), cachedAt(0)
+        , skip(false), fresh(false), batch(MCPBatchSupport::Unknown)
+        , ok(false), elapsedMs(0) {}
+};
+
+/**
+ * @struct MCPCallGroup
+ * @brief executeTools() calls bound for one server
+ */
+struct MCPCallGroup {
+    int serverIndex;
+    String url;
+    String apiKey;
+    MCPBatchSupport batch;      ///< As known before the calls, updated by them
+    String sessionId;           ///< Sent with JSON-RPC requests to /mcp
+    std::vector<MCPToolCall*> calls;
+    bool batched;               ///< Went out as one batch
+    bool fellBack;              ///< Batch refused, sent one by one
+
+    MCPCallGroup()
+        : serverIndex(-1), batch(MCPBatchSupport::Unknown), batched(false), fellBack(false) {}
+};
+
+/**
+ * @struct MCPParallelRun
+ * @brief Work items shared by the workers of one runParallel()
+ */
+struct MCPParallelRun {
+    const std::function<void(int)>* work;
+    int count;
+    std::atomic<int> next;
+    SemaphoreHandle_t done;     // Counting semaphore given by each helper task
+};
+
 //=============================================================================
 // Constructor / Destructor
 //=============================================================================
 
 MCPClient::MCPClient()
     : initialized(false)
+    , discoveryMutex(nullptr)
+    , refreshJobs(nullptr)
+    , refreshJobCount(0)
+    , refreshDone(false)
+    , httpMutex(nullptr)
 {
+    memset(httpBusy, 0, sizeof(httpBusy));
+    memset(&stats, 0, sizeof(stats));
+    memset(&callStats, 0, sizeof(callStats));
 }
 
 MCPClient::~MCPClient() {
@@ -33,8 +110,16 @@ MCPClient::~MCPClient() {
 bool MCPClient::begin() {
     if (initialized) return true;
 
-    // Load saved server configurations
+    if (!httpMutex) {
+        httpMutex = xSemaphoreCreateMutex();
+    }
+    if (!discoveryMutex) {
+        discoveryMutex = xSemaphoreCreateMutex();
+    }
+
+    // Load saved server configurations and their last known tools
     loadConfig();
+    loadToolCache();
 
     initialized = true;
     Serial.println("[MCP Client] Initialized");
@@ -45,6 +130,14 @@ void MCPClient::end() {
     if (!initialized) return;
 
     saveConfig();
+
+    // A running refresh task still owns its jobs
+    if (refreshJobs && refreshDone) {
+        delete[] refreshJobs;
+        refreshJobs = nullptr;
+        refreshJobCount = 0;
+    }
+
     servers.clear();
     tools.clear();
 
@@ -135,21 +228,45 @@ const MCPServerConfig* MCPClient::getServer(int index) const {
 // Tool Discovery
 //=============================================================================
 
+/** Wall clock is set (NTP synced), so cache ages can be judged */
+static bool clockValid(time_t now) {
+    return now > 1700000000;
+}
+
 int MCPClient::discoverTools() {
-    tools.clear();
-    int totalTools = 0;
+    uint32_t startTime = millis();
+    if (discoveryMutex) xSemaphoreTake(discoveryMutex, portMAX_DELAY);
+
+    // Anything a finished background refresh found is superseded
+    if (refreshJobs && refreshDone) {
+        delete[] refreshJobs;
+        refreshJobs = nullptr;
+        refreshJobCount = 0;
+    }
 
+    std::vector<MCPDiscoveryJob> jobs;
     for (int i = 0; i < (int)servers.size(); i++) {
-        if (servers[i].enabled) {
-            if (discoverServerTools(i)) {
-                totalTools += countToolsForServer(i);
-            }
-        }
+        if (!servers[i].enabled) continue;
+        jobs.emplace_back();
+        prepareJob(i, jobs.back());
     }
 
-    Serial.printf("[MCP Client] Discovered %d tools from %d servers\n",
-                  totalTools, servers.size());
-    return totalTools;
+    runJobs(jobs.data(), jobs.size());
+
+    bool fetched = false;
+    for (auto& job : jobs) {
+        mergeJob(job);
+        fetched |= job.ok;
+    }
+    if (fetched) saveToolCache();
+
+    stats.runs++;
+    stats.lastRunMs = millis() - startTime;
+    if (discoveryMutex) xSemaphoreGive(discoveryMutex);
+
+    Serial.printf("[MCP Client] Discovered %d tools from %d servers in %lu ms\n",
+                  tools.size(), jobs.size(), stats.lastRunMs);
+    return tools.size();
 }
 
 // Helper to count tools for a server
@@ -163,92 +280,343 @@ int MCPClient::countToolsForServer(int index) const {
 
 bool MCPClient::discoverServerTools(int index) {
     if (index < 0 || index >= (int)servers.size()) return false;
+    if (!servers[index].enabled) return false;
 
-    MCPServerConfig& server = servers[index];
-    if (!server.enabled) return false;
+    MCPDiscoveryJob job;
+    prepareJob(index, job);
 
-    Serial.printf("[MCP Client] Discovering tools from %s...\n", server.name.c_str());
+    if (discoveryMutex) xSemaphoreTake(discoveryMutex, portMAX_DELAY);
+    fetchServerTools(job);
+    mergeJob(job);
+    if (job.ok) saveToolCache();
+    if (discoveryMutex) xSemaphoreGive(discoveryMutex);
 
-    // Build tools/list request
-    JsonDocument reqDoc;
-    reqDoc["jsonrpc"] = "2.0";
-    reqDoc["id"] = 1;
-    reqDoc["method"] = "tools/list";
-    reqDoc["params"] = JsonObject();
-
-    String body;
-    serializeJson(reqDoc, body);
+    return job.ok;
+}
 
-    // Make request
-    String url = server.url + "/mcp/tools/list";
-    String response = makeRequest(url.c_str(), "POST", body.c_str(),
-                                   server.apiKey.length() > 0 ? server.apiKey.c_str() : nullptr);
+void MCPClient::prepareJob(int index, MCPDiscoveryJob& job) const {
+    const MCPServerConfig& server = servers[index];
+    job.serverIndex = index;
+    job.configHash = configHash(server);
+    job.cachedAt = server.toolsCached ? server.toolsFetchedAt : 0;
+    job.name = server.name;
+    job.url = server.url;
+    job.apiKey = server.apiKey;
+    job.skip = !server.enabled;
+    job.batch = server.batch;
+}
 
-    if (response.length() == 0) {
-        server.connected = false;
-        server.lastError = "No response from server";
-        return false;
+void MCPClient::fetchServerTools(MCPDiscoveryJob& job) {
+    if (job.skip) return;
+    uint32_t startTime = millis();
+
+    Serial.printf("[MCP Client] Discovering tools from %s...\n", job.name.c_str());
+
+    static const char* body = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/list\",\"params\":{}}";
+
+    // initialize and tools/list in one round trip; id 2 is the list
+    static const char* batchBody =
+        "[{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":{"
+        "\"protocolVersion\":\"2025-03-26\",\"capabilities\":{},"
+        "\"clientInfo\":{\"name\":\"DeskBuddy\",\"version\":\"1.0.0\"}}},"
+        "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"},"
+        "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/list\",\"params\":{}}]";
+
+    // Parse the tool list straight off the socket, keeping only the fields
+    // parseTools() reads; schemas can be large so the pool goes to PSRAM
+    JsonDocument filter;
+    filter["error"]["message"] = true;
+    JsonObject toolFilter = filter["result"]["tools"][0].to<JsonObject>();
+    toolFilter["name"] = true;
+    toolFilter["description"] = true;
+    toolFilter["inputSchema"] = true;
+    toolFilter["annotations"]["destructiveHint"] = true;
+    toolFilter["annotations"]["readOnlyHint"] = true;
+    filter["tools"] = filter["result"]["tools"];    // Alternative format
+
+    const char* apiKey = job.apiKey.length() > 0 ? job.apiKey.c_str() : nullptr;
+    JsonDocument respDoc(&PsramAllocator::instance());
+    int httpCode = 0;
+    int listIndex = -1;     // Position of the tools/list reply in a batch reply
+
+    if (job.batch != MCPBatchSupport::No) {
+        // The same filter for every entry of the reply array
+        JsonDocument batchFilter;
+        batchFilter[0] = filter;
+        batchFilter[0]["id"] = true;
+
+        String url = job.url + "/mcp";
+        httpCode = makeJsonRequest(url.c_str(), batchBody, apiKey,
+                                   respDoc, batchFilter, MCP_DISCOVERY_TIMEOUT_MS, &job.sessionId);
+        if (httpCode > 0 && respDoc.is<JsonArray>()) {
+            job.batch = MCPBatchSupport::Yes;
+            JsonArray replies = respDoc.as<JsonArray>();
+            for (size_t i = 0; i < replies.size(); i++) {
+                if (replies[i]["id"] == 2) listIndex = i;
+            }
+        } else if (httpCode > 0) {
+            // Answered, but not with a batch reply - ask the old way
+            job.batch = MCPBatchSupport::No;
+            Serial.printf("[MCP Client] %s does not take batches\n", job.name.c_str());
+        }
+    }
+    if (job.batch == MCPBatchSupport::No) {
+        String url = job.url + "/mcp/tools/list";
+        httpCode = makeJsonRequest(url.c_str(), body, apiKey,
+                                   respDoc, filter, MCP_DISCOVERY_TIMEOUT_MS);
     }
 
-    // Parse response
-    JsonDocument respDoc;
-    DeserializationError error = deserializeJson(respDoc, response);
+    JsonVariant response = job.batch != MCPBatchSupport::Yes ? respDoc.as<JsonVariant>()
+                         : listIndex >= 0 ? respDoc[listIndex].as<JsonVariant>()
+                         : JsonVariant();
 
-    if (error) {
-        server.connected = false;
-        server.lastError = "Invalid JSON response";
-        return false;
+    if (httpCode <= 0) {
+        job.error = "No response from server";
+    } else if (response.isNull()) {
+        job.error = "Invalid JSON response";
+    } else if (response["error"].is<JsonObject>()) {
+        job.error = response["error"]["message"].as<String>();
+    } else {
+        parseTools(job, response);
+        job.ok = true;
     }
+    job.elapsedMs = millis() - startTime;
 
-    // Check for error
-    if (respDoc["error"].is<JsonObject>()) {
-        server.connected = false;
-        server.lastError = respDoc["error"]["message"].as<String>();
-        return false;
+    if (job.ok) {
+        Serial.printf("[MCP Client] Found %d tools from %s in %lu ms%s\n",
+                      job.tools.size(), job.name.c_str(), job.elapsedMs,
+                      job.batch == MCPBatchSupport::Yes ? " (batched)" : "");
+    } else {
+        Serial.printf("[MCP Client] %s failed after %lu ms: %s\n",
+                      job.name.c_str(), job.elapsedMs, job.error.c_str());
     }
-
-    // Parse tools
-    parseTools(index, response.c_str());
-    server.connected = true;
-    server.lastError = "";
-
-    return true;
 }
 
-void MCPClient::parseTools(int serverIndex, const char* response) {
-    JsonDocument doc;
-    deserializeJson(doc, response);
-
-    JsonArray toolsArray = doc["result"]["tools"];
+void MCPClient::parseTools(MCPDiscoveryJob& job, JsonVariant response) {
+    JsonArray toolsArray = response["result"]["tools"];
     if (!toolsArray) {
         // Try alternative format
-        toolsArray = doc["tools"];
+        toolsArray = response["tools"];
     }
 
     if (!toolsArray) return;
 
-    int toolCount = 0;
     for (JsonObject t : toolsArray) {
-        if (tools.size() >= MCP_MAX_SERVERS * MCP_MAX_TOOLS_PER_SERVER) break;
+        if (job.tools.size() >= MCP_MAX_TOOLS_PER_SERVER) break;
 
         MCPRemoteTool tool;
-        tool.name = t["name"].as<String>();
         tool.description = t["description"].as<String>();
 
         // Serialize input schema back to string
         serializeJson(t["inputSchema"], tool.inputSchema);
 
-        tool.serverIndex = serverIndex;
+        tool.serverIndex = job.serverIndex;
+
+        // Only an explicit destructiveHint orders a call; the spec's default
+        // of true for unannotated tools would serialize every server
+        JsonObject annotations = t["annotations"];
+        tool.ordered = annotations["destructiveHint"] == true &&
+                       annotations["readOnlyHint"] != true;
 
         // Prefix tool name with server name to avoid collisions
-        tool.name = servers[serverIndex].name + "_" + tool.name;
+        tool.name = job.name + "_" + t["name"].as<String>();
+
+        job.tools.push_back(tool);
+    }
+}
+
+void MCPClient::parallelWorker(void* param) {
+    MCPParallelRun* run = (MCPParallelRun*)param;
+
+    for (int i; (i = run->next++) < run->count; ) {
+        (*run->work)(i);
+    }
+
+    xSemaphoreGive(run->done);
+    vTaskDelete(NULL);
+}
+
+void MCPClient::runJobs(MCPDiscoveryJob* jobs, int count) {
+    std::vector<MCPDiscoveryJob*> pending;
+    for (int i = 0; i < count; i++) {
+        if (!jobs[i].skip) pending.push_back(&jobs[i]);
+    }
+
+    runParallel(pending.size(), [this, &pending](int i) {
+        fetchServerTools(*pending[i]);
+    });
+}
+
+void MCPClient::runParallel(int count, const std::function<void(int)>& work) {
+    if (count == 0) return;
+
+    MCPParallelRun run;
+    run.work = &work;
+    run.count = count;
+    run.next = 0;
+    run.done = xSemaphoreCreateCounting(MCP_MAX_PARALLEL_REQUESTS, 0);
+
+    // One worker per HTTP slot; the caller is one of them. A dead server
+    // ties up only the worker waiting on it.
+    int helpers = 0;
+    int wanted = min(count, MCP_MAX_PARALLEL_REQUESTS) - 1;
+    while (run.done && helpers < wanted) {
+        if (xTaskCreatePinnedToCore(parallelWorker, "mcp_worker", MCP_DISCOVERY_TASK_STACK_SIZE,
+                                    &run, 1, nullptr, 0) != pdPASS) {
+            break;
+        }
+        helpers++;
+    }
+
+    for (int i; (i = run.next++) < count; ) {
+        work(i);
+    }
+
+    // Bounded by the helpers' own request deadlines
+    for (int i = 0; i < helpers; i++) {
+        xSemaphoreTake(run.done, portMAX_DELAY);
+    }
+    if (run.done) vSemaphoreDelete(run.done);
+}
+
+bool MCPClient::mergeJob(MCPDiscoveryJob& job) {
+    if (job.fresh) stats.serversFresh++;
+    if (job.skip) return false;
+
+    // The server was removed, edited or disabled while it was queried
+    if (job.serverIndex < 0 || job.serverIndex >= (int)servers.size()) return false;
+    MCPServerConfig& server = servers[job.serverIndex];
+    if (!server.enabled || configHash(server) != job.configHash) return false;
+    if (job.batch != MCPBatchSupport::Unknown) server.batch = job.batch;
+    if (job.batch == MCPBatchSupport::Yes) server.sessionId = job.sessionId;
+
+    if (!job.ok) {
+        // Tools already listed (e.g. cached) stay, but aren't called
+        stats.serversFailed++;
+        server.connected = false;
+        server.lastError = job.error;
+        return false;
+    }
+
+    stats.serversFetched++;
+    if (job.batch == MCPBatchSupport::Yes) stats.batchedLists++;
+    bool changed = hashTools(job.tools, job.serverIndex) != hashTools(tools, job.serverIndex);
+    if (changed) {
+        tools.erase(std::remove_if(tools.begin(), tools.end(),
+                                   [&job](const MCPRemoteTool& t) { return t.serverIndex == job.serverIndex; }),
+                    tools.end());
+        for (auto& tool : job.tools) {
+            tools.push_back(std::move(tool));
+        }
+    } else {
+        stats.unchangedLists++;
+    }
+
+    time_t now = time(nullptr);
+    server.connected = true;
+    server.lastError = "";
+    server.toolsCached = false;
+    server.toolsFetchedAt = clockValid(now) ? (uint32_t)now : 0;
+    return changed;
+}
+
+//=============================================================================
+// Background Refresh
+//=============================================================================
+
+bool MCPClient::startBackgroundRefresh() {
+    if (!initialized || refreshJobs || servers.empty()) return false;
+
+    refreshJobs = new MCPDiscoveryJob[servers.size()];
+    if (!refreshJobs) return false;
+    refreshJobCount = servers.size();
+    refreshDone = false;
+
+    for (int i = 0; i < refreshJobCount; i++) {
+        prepareJob(i, refreshJobs[i]);
+    }
+
+    if (xTaskCreatePinnedToCore(refreshTask, "mcp_refresh", MCP_DISCOVERY_TASK_STACK_SIZE,
+                                this, 1, nullptr, 0) != pdPASS) {
+        delete[] refreshJobs;
+        refreshJobs = nullptr;
+        refreshJobCount = 0;
+        Serial.println("[MCP Client] Failed to start tool refresh");
+        return false;
+    }
+    return true;
+}
+
+void MCPClient::refreshTask(void* param) {
+    MCPClient* self = (MCPClient*)param;
+    MCPDiscoveryJob* jobs = self->refreshJobs;
+    int count = self->refreshJobCount;
+
+    uint32_t waitStart = millis();
+    while (!WiFi.isConnected() && millis() - waitStart < MCP_REFRESH_WIFI_WAIT_MS) {
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+    bool online = WiFi.isConnected();
+
+    // NTP usually follows WiFi within a few seconds; without it every
+    // cached list counts as stale
+    waitStart = millis();
+    while (online && !clockValid(time(nullptr)) && millis() - waitStart < MCP_REFRESH_CLOCK_WAIT_MS) {
+        vTaskDelay(pdMS_TO_TICKS(200));
+    }
+    time_t now = time(nullptr);
+
+    int stale = 0;
+    for (int i = 0; i < count; i++) {
+        MCPDiscoveryJob& job = jobs[i];
+        if (job.skip) continue;
+        if (job.cachedAt && clockValid(now) && now - job.cachedAt < MCP_TOOL_CACHE_TTL_S) {
+            job.skip = true;
+            job.fresh = true;
+        } else if (!online) {
+            job.skip = true;
+        } else {
+            stale++;
+        }
+    }
+
+    if (stale > 0) {
+        uint32_t startTime = millis();
+        if (self->discoveryMutex) xSemaphoreTake(self->discoveryMutex, portMAX_DELAY);
+        self->runJobs(jobs, count);
+        self->stats.runs++;
+        self->stats.lastRunMs = millis() - startTime;
+        if (self->discoveryMutex) xSemaphoreGive(self->discoveryMutex);
+    }
+
+    Serial.printf("[MCP Client] Background refresh: %d of %d servers fetched%s\n",
+                  stale, count, online ? "" : " (no WiFi)");
+
+    self->refreshDone = true;
+    vTaskDelete(NULL);
+}
+
+bool MCPClient::applyBackgroundRefresh() {
+    if (!refreshJobs || !refreshDone) return false;
+    if (discoveryMutex && xSemaphoreTake(discoveryMutex, 0) != pdTRUE) return false;
 
-        tools.push_back(tool);
-        toolCount++;
+    bool changed = false;
+    bool fetched = false;
+    for (int i = 0; i < refreshJobCount; i++) {
+        changed |= mergeJob(refreshJobs[i]);
+        fetched |= refreshJobs[i].ok;
     }
+    if (fetched) saveToolCache();
 
-    Serial.printf("[MCP Client] Found %d tools from %s\n",
-                  toolCount, servers[serverIndex].name.c_str());
+    delete[] refreshJobs;
+    refreshJobs = nullptr;
+    refreshJobCount = 0;
+    if (discoveryMutex) xSemaphoreGive(discoveryMutex);
+
+    if (changed) {
+        Serial.printf("[MCP Client] Tool list updated: %d tools\n", tools.size());
+    }
+    return changed;
 }
 
 const MCPRemoteTool* MCPClient::findTool(const char* name) const {
@@ -264,7 +632,8 @@ const MCPRemoteTool* MCPClient::findTool(const char* name) const {
 // Tool Execution
 //=============================================================================
 
-String MCPClient::executeTool(const char* toolName, const char* arguments) {
+const char* MCPClient::prepareToolCall(const char* toolName, const char* arguments,
+                                       JsonObject request, int& serverIndex) const {
     const MCPRemoteTool* tool = findTool(toolName);
     if (!tool) {
         return "{\"error\":\"Tool not found\"}";
@@ -278,6 +647,8 @@ String MCPClient::executeTool(const char* toolName, const char* arguments) {
     if (!server.enabled || !server.connected) {
         return "{\"error\":\"Server not connected\"}";
     }
+    serverIndex = tool->serverIndex;
+    if (request.isNull()) return nullptr;
 
     // Extract original tool name (remove server prefix)
     String originalName = tool->name;
@@ -287,26 +658,43 @@ String MCPClient::executeTool(const char* toolName, const char* arguments) {
     }
 
     // Build tools/call request
-    JsonDocument reqDoc;
-    reqDoc["jsonrpc"] = "2.0";
-    reqDoc["id"] = millis();  // Use timestamp as ID
-    reqDoc["method"] = "tools/call";
+    request["jsonrpc"] = "2.0";
+    request["id"] = millis();  // Use timestamp as ID
+    request["method"] = "tools/call";
 
-    JsonObject params = reqDoc["params"].to<JsonObject>();
+    JsonObject params = request["params"].to<JsonObject>();
     params["name"] = originalName;
 
     // Parse arguments
     JsonDocument argsDoc;
     deserializeJson(argsDoc, arguments);
     params["arguments"] = argsDoc;
+    return nullptr;
+}
+
+String MCPClient::executeTool(const char* toolName, const char* arguments) {
+    const MCPRemoteTool* tool = findTool(toolName);
+    const MCPServerConfig* server = tool ? getServer(tool->serverIndex) : nullptr;
+    bool jsonRpc = server && server->batch == MCPBatchSupport::Yes;
+    return sendToolCall(toolName, arguments, jsonRpc, jsonRpc ? server->sessionId : String());
+}
+
+String MCPClient::sendToolCall(const char* toolName, const char* arguments, bool jsonRpc,
+                               String sessionId) {
+    JsonDocument reqDoc;
+    int serverIndex;
+    const char* error = prepareToolCall(toolName, arguments, reqDoc.to<JsonObject>(), serverIndex);
+    if (error) return error;
+    const MCPServerConfig& server = servers[serverIndex];
 
     String body;
     serializeJson(reqDoc, body);
 
-    // Make request
-    String url = server.url + "/mcp/tools/call";
+    // Streamable HTTP servers may only serve /mcp, not the per-method paths
+    String url = server.url + (jsonRpc ? "/mcp" : "/mcp/tools/call");
     String response = makeRequest(url.c_str(), "POST", body.c_str(),
-                                   server.apiKey.length() > 0 ? server.apiKey.c_str() : nullptr);
+                                   server.apiKey.length() > 0 ? server.apiKey.c_str() : nullptr,
+                                   nullptr, jsonRpc ? &sessionId : nullptr);
 
     Serial.printf("[MCP Client] Executed %s: %s\n", toolName,
                   response.length() > 100 ? (response.substring(0, 100) + "...").c_str() : response.c_str());
@@ -314,13 +702,124 @@ String MCPClient::executeTool(const char* toolName, const char* arguments) {
     return response;
 }
 
+void MCPClient::executeTools(MCPToolCall* calls, int count) {
+    // Group by server, in call order; a full group starts another
+    std::vector<MCPCallGroup> groups;
+    for (int i = 0; i < count; i++) {
+        int serverIndex;
+        const char* error = prepareToolCall(calls[i].name, calls[i].arguments,
+                                            JsonObject(), serverIndex);
+        if (error) {
+            calls[i].result = error;
+            continue;
+        }
+
+        MCPCallGroup* group = nullptr;
+        for (auto& g : groups) {
+            if (g.serverIndex == serverIndex && g.calls.size() < MCP_MAX_BATCH_CALLS) group = &g;
+        }
+        if (!group) {
+            const MCPServerConfig& server = servers[serverIndex];
+            groups.emplace_back();
+            group = &groups.back();
+            group->serverIndex = serverIndex;
+            group->url = server.url;
+            group->apiKey = server.apiKey;
+            group->batch = server.batch;
+            group->sessionId = server.sessionId;
+        }
+        group->calls.push_back(&calls[i]);
+    }
+
+    // Servers are called concurrently, each group on one worker
+    runParallel(groups.size(), [this, &groups](int i) {
+        runCallGroup(groups[i]);
+    });
+
+    for (const auto& group : groups) {
+        callStats.calls += group.calls.size();
+        if (group.batch != MCPBatchSupport::Unknown) servers[group.serverIndex].batch = group.batch;
+        if (group.batch == MCPBatchSupport::Yes) servers[group.serverIndex].sessionId = group.sessionId;
+        if (group.batched) {
+            callStats.batches++;
+            callStats.batchedCalls += group.calls.size();
+            callStats.savedRequests += group.calls.size() - 1;
+        }
+        if (group.fellBack) callStats.fallbacks++;
+    }
+}
+
+void MCPClient::runCallGroup(MCPCallGroup& group) {
+    size_t n = group.calls.size();
+
+    if (n > 1 && group.batch != MCPBatchSupport::No) {
+        // Ids are positions in the group, so replies match in any order
+        JsonDocument batchDoc;
+        JsonArray batch = batchDoc.to<JsonArray>();
+        for (size_t i = 0; i < n; i++) {
+            int serverIndex;
+            JsonObject request = batch.add<JsonObject>();
+            prepareToolCall(group.calls[i]->name, group.calls[i]->arguments, request, serverIndex);
+            request["id"] = i + 1;
+        }
+        String body;
+        serializeJson(batchDoc, body);
+        batchDoc.clear();
+
+        uint32_t startTime = millis();
+        String url = group.url + "/mcp";
+        int status;
+        String response = makeRequest(url.c_str(), "POST", body.c_str(),
+                                      group.apiKey.length() > 0 ? group.apiKey.c_str() : nullptr,
+                                      &status, &group.sessionId);
+
+        JsonDocument respDoc(&PsramAllocator::instance());
+        bool isBatch = status > 0 && !deserializeJson(respDoc, response) && respDoc.is<JsonArray>();
+
+        if (isBatch) {
+            group.batch = MCPBatchSupport::Yes;
+            group.batched = true;
+            for (JsonObject reply : respDoc.as<JsonArray>()) {
+                size_t id = reply["id"] | 0;
+                if (id >= 1 && id <= n) serializeJson(reply, group.calls[id - 1]->result);
+            }
+            for (size_t i = 0; i < n; i++) {
+                if (group.calls[i]->result.isEmpty()) group.calls[i]->result = "{\"error\":\"No result\"}";
+            }
+            Serial.printf("[MCP Client] Executed %u calls in one batch in %lu ms\n",
+                          n, millis() - startTime);
+            return;
+        }
+        if (status <= 0) {
+            // The calls may have run - sending them again could repeat them
+            for (size_t i = 0; i < n; i++) {
+                group.calls[i]->result = "{\"error\":\"No response from server\"}";
+            }
+            return;
+        }
+
+        // Answered, but not with a batch reply - nothing ran
+        Serial.printf("[MCP Client] Server at %s does not take batches (HTTP %d)\n",
+                      group.url.c_str(), status);
+        group.batch = MCPBatchSupport::No;
+        group.fellBack = true;
+    }
+
+    // A lone call to a batching server still goes to /mcp
+    bool jsonRpc = group.batch == MCPBatchSupport::Yes;
+    for (size_t i = 0; i < n; i++) {
+        group.calls[i]->result = sendToolCall(group.calls[i]->name, group.calls[i]->arguments,
+                                              jsonRpc, group.sessionId);
+    }
+}
+
 //=============================================================================
 // LLM Integration
 //=============================================================================
 
-void MCPClient::registerToolsWithLLM(std::function<bool(const char*, const char*, const char*)> addToolFunc) {
+void MCPClient::registerToolsWithLLM(std::function<bool(const char*, const char*, const char*, bool)> addToolFunc) {
     for (const auto& tool : tools) {
-        addToolFunc(tool.name.c_str(), tool.description.c_str(), tool.inputSchema.c_str());
+        addToolFunc(tool.name.c_str(), tool.description.c_str(), tool.inputSchema.c_str(), tool.ordered);
     }
     Serial.printf("[MCP Client] Registered %d tools with LLM\n", tools.size());
 }
@@ -329,26 +828,71 @@ void MCPClient::registerToolsWithLLM(std::function<bool(const char*, const char*
 // HTTP Request
 //=============================================================================
 
-String MCPClient::makeRequest(const char* url, const char* method, const char* body, const char* apiKey) {
-    HTTPClient http;
-    NetworkClientSecure* secureClient = nullptr;
+int MCPClient::leaseHttp() {
+    if (!httpMutex) {
+        // Not started - single caller, use the first slot
+        return 0;
+    }
+
+    uint32_t startTime = millis();
+    while (true) {
+        xSemaphoreTake(httpMutex, portMAX_DELAY);
+        for (int i = 0; i < MCP_MAX_PARALLEL_REQUESTS; i++) {
+            if (!httpBusy[i]) {
+                httpBusy[i] = true;
+                xSemaphoreGive(httpMutex);
+                return i;
+            }
+        }
+        xSemaphoreGive(httpMutex);
+
+        if (millis() - startTime > MCP_HTTP_TIMEOUT) {
+            Serial.println("[MCP Client] All request slots busy");
+            return -1;
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+
+void MCPClient::releaseHttp(int slot) {
+    if (!httpMutex || slot < 0) return;
 
-    // Check if HTTPS
-    bool isHttps = String(url).startsWith("https://");
+    xSemaphoreTake(httpMutex, portMAX_DELAY);
+    httpBusy[slot] = false;
+    xSemaphoreGive(httpMutex);
+}
+
+int MCPClient::beginRequest(HTTPClient& http, const char* url, const char* method, const char* body,
+                            const char* apiKey, NetworkClientSecure*& conn, uint32_t timeoutMs,
+                            String* sessionId) {
+    conn = nullptr;
+
+    // HTTPS goes through the shared keep-alive pool
+    bool isHttps = strncmp(url, "https://", 8) == 0;
     if (isHttps) {
-        secureClient = new NetworkClientSecure();
-        secureClient->setInsecure();  // Skip cert verification
-        http.begin(*secureClient, url);
+        conn = connectionManager.acquireForUrl(url);
+        if (!conn) {
+            Serial.printf("[MCP Client] Connection failed: %s\n", url);
+            return HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+        http.setReuse(true);
+        http.begin(*conn, url);
     } else {
         http.begin(url);
     }
 
-    http.setTimeout(MCP_HTTP_TIMEOUT);
+    static const char* headerKeys[] = {"Transfer-Encoding", "Mcp-Session-Id"};
+    http.collectHeaders(headerKeys, 2);
+    http.setConnectTimeout(timeoutMs);
+    http.setTimeout(timeoutMs);
     http.addHeader("Content-Type", "application/json");
 
     if (apiKey && strlen(apiKey) > 0) {
         http.addHeader("Authorization", String("Bearer ") + apiKey);
     }
+    if (sessionId && sessionId->length() > 0) {
+        http.addHeader("Mcp-Session-Id", *sessionId);
+    }
 
     int httpCode;
     if (strcmp(method, "POST") == 0) {
@@ -357,22 +901,73 @@ String MCPClient::makeRequest(const char* url, const char* method, const char* b
         httpCode = http.GET();
     }
 
-    String response;
-    if (httpCode > 0) {
-        response = http.getString();
-    } else {
+    if (httpCode <= 0) {
         Serial.printf("[MCP Client] HTTP error: %d\n", httpCode);
+    } else if (sessionId && http.hasHeader("Mcp-Session-Id")) {
+        *sessionId = http.header("Mcp-Session-Id");
     }
+    return httpCode;
+}
 
+void MCPClient::endRequest(HTTPClient& http, NetworkClientSecure* conn, bool keepAlive) {
     http.end();
 
-    if (secureClient) {
-        delete secureClient;
+    if (conn) {
+        connectionManager.release(conn, keepAlive);
+    }
+}
+
+String MCPClient::makeRequest(const char* url, const char* method, const char* body, const char* apiKey,
+                              int* status, String* sessionId) {
+    if (status) *status = HTTPC_ERROR_CONNECTION_REFUSED;
+    int slot = leaseHttp();
+    if (slot < 0) return "";
+    HTTPClient& http = httpSlots[slot];
+
+    NetworkClientSecure* conn;
+    int httpCode = beginRequest(http, url, method, body, apiKey, conn, MCP_HTTP_TIMEOUT, sessionId);
+    if (status) *status = httpCode;
+
+    String response;
+    if (httpCode > 0) {
+        response = http.getString();
     }
 
+    endRequest(http, conn, httpCode > 0);
+    releaseHttp(slot);
     return response;
 }
 
+int MCPClient::makeJsonRequest(const char* url, const char* body, const char* apiKey,
+                               JsonDocument& doc, JsonDocument& filter, uint32_t timeoutMs,
+                               String* sessionId) {
+    int slot = leaseHttp();
+    if (slot < 0) return HTTPC_ERROR_CONNECTION_REFUSED;
+    HTTPClient& http = httpSlots[slot];
+
+    NetworkClientSecure* conn;
+    int httpCode = beginRequest(http, url, "POST", body, apiKey, conn, timeoutMs, sessionId);
+    if (httpCode <= 0) {
+        endRequest(http, conn, false);
+        releaseHttp(slot);
+        return httpCode;
+    }
+
+    bool chunked = http.header("Transfer-Encoding").indexOf("chunked") >= 0;
+    HttpBodyStream bodyStream(http.getStreamPtr(), chunked, http.getSize(), timeoutMs);
+
+    DeserializationError error = deserializeJson(doc, bodyStream,
+                                                 DeserializationOption::Filter(filter));
+    if (error) {
+        Serial.printf("[MCP Client] JSON parse error: %s\n", error.c_str());
+        doc.clear();
+    }
+
+    endRequest(http, conn, !error && bodyStream.drain(MCP_BODY_DRAIN_MS));
+    releaseHttp(slot);
+    return httpCode;
+}
+
 //=============================================================================
 // Persistence
 //=============================================================================
@@ -420,3 +1015,207 @@ void MCPClient::loadConfig() {
     Serial.printf("[MCP Client] Loaded %d server configs\n", servers.size());
 }
 
+//=============================================================================
+// Tool Cache
+//=============================================================================
+// File: CacheFileHeader, then per server a CacheEntryHeader and its tools,
+// each as u16 name/description/schema lengths, the bytes and a flags byte
+// (bit 0: ordered). The entry's contentHash is the CRC of those tool
+// records, which doubles as the integrity check and as the "did the list
+// change" test after a fetch.
+
+struct __attribute__((packed)) CacheFileHeader {
+    uint16_t magic;
+    uint16_t entryCount;
+};
+
+struct __attribute__((packed)) CacheEntryHeader {
+    uint32_t configHash;
+    uint32_t fetchedAt;
+    uint32_t contentHash;
+    uint16_t toolCount;
+    uint32_t payloadLength;
+};
+
+/** Tools with a field too long for the record format are not cached */
+static bool cacheable(const MCPRemoteTool& tool) {
+    return tool.name.length() <= UINT16_MAX && tool.description.length() <= UINT16_MAX &&
+           tool.inputSchema.length() <= UINT16_MAX;
+}
+
+uint32_t MCPClient::configHash(const MCPServerConfig& server) {
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)server.name.c_str(), server.name.length() + 1);
+    return esp_rom_crc32_le(crc, (const uint8_t*)server.url.c_str(), server.url.length());
+}
+
+uint32_t MCPClient::hashTools(const std::vector<MCPRemoteTool>& list, int serverIndex) {
+    uint32_t crc = 0;
+    for (const auto& tool : list) {
+        if (tool.serverIndex != serverIndex || !cacheable(tool)) continue;
+        uint16_t lengths[3] = {
+            (uint16_t)tool.name.length(),
+            (uint16_t)tool.description.length(),
+            (uint16_t)tool.inputSchema.length()
+        };
+        crc = esp_rom_crc32_le(crc, (const uint8_t*)lengths, sizeof(lengths));
+        crc = esp_rom_crc32_le(crc, (const uint8_t*)tool.name.c_str(), lengths[0]);
+        crc = esp_rom_crc32_le(crc, (const uint8_t*)tool.description.c_str(), lengths[1]);
+        crc = esp_rom_crc32_le(crc, (const uint8_t*)tool.inputSchema.c_str(), lengths[2]);
+        uint8_t flags = tool.ordered ? 1 : 0;
+        crc = esp_rom_crc32_le(crc, &flags, 1);
+    }
+    return crc;
+}
+
+void MCPClient::loadToolCache() {
+    uint32_t t0 = micros();
+
+    // Usually already mounted by the audio player
+    if (!LittleFS.begin(true) || !LittleFS.exists(MCP_TOOL_CACHE_PATH)) return;
+
+    File file = LittleFS.open(MCP_TOOL_CACHE_PATH, "r");
+    if (!file) return;
+
+    CacheFileHeader header;
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != MCP_TOOL_CACHE_MAGIC) {
+        file.close();
+        return;
+    }
+
+    uint8_t* payload = nullptr;
+    size_t payloadCap = 0;
+    int serversLoaded = 0;
+
+    for (int e = 0; e < header.entryCount; e++) {
+        CacheEntryHeader entry;
+        if (file.read((uint8_t*)&entry, sizeof(entry)) != sizeof(entry)) break;
+
+        if (entry.payloadLength > payloadCap) {
+            uint8_t* grown = (uint8_t*)realloc(payload, entry.payloadLength);
+            if (!grown) break;
+            payload = grown;
+            payloadCap = entry.payloadLength;
+        }
+        if (file.read(payload, entry.payloadLength) != entry.payloadLength ||
+            esp_rom_crc32_le(0, payload, entry.payloadLength) != entry.contentHash) {
+            Serial.println("[MCP Client] Tool cache corrupt, ignoring the rest");
+            break;
+        }
+
+        // Only for a server still configured the same way
+        int index = -1;
+        for (int i = 0; i < (int)servers.size(); i++) {
+            if (servers[i].enabled && !servers[i].toolsCached &&
+                configHash(servers[i]) == entry.configHash) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) continue;
+
+        std::vector<MCPRemoteTool> cached;
+        const uint8_t* p = payload;
+        const uint8_t* end = payload + entry.payloadLength;
+        for (int t = 0; t < entry.toolCount; t++) {
+            uint16_t lengths[3];
+            if ((size_t)(end - p) < sizeof(lengths)) break;
+            memcpy(lengths, p, sizeof(lengths));
+            p += sizeof(lengths);
+            if ((size_t)(end - p) < (size_t)lengths[0] + lengths[1] + lengths[2] + 1) break;
+
+            MCPRemoteTool tool;
+            tool.name = String((const char*)p, lengths[0]);
+            p += lengths[0];
+            tool.description = String((const char*)p, lengths[1]);
+            p += lengths[1];
+            tool.inputSchema = String((const char*)p, lengths[2]);
+            p += lengths[2];
+            tool.ordered = (*p++ & 1) != 0;
+            tool.serverIndex = index;
+            cached.push_back(tool);
+        }
+        if ((int)cached.size() != entry.toolCount) continue;
+
+        for (auto& tool : cached) {
+            tools.push_back(std::move(tool));
+        }
+        MCPServerConfig& server = servers[index];
+        server.connected = true;
+        server.toolsCached = true;
+        server.toolsFetchedAt = entry.fetchedAt;
+        stats.cachedTools += entry.toolCount;
+        serversLoaded++;
+    }
+
+    file.close();
+    free(payload);
+
+    stats.cacheLoadUs = micros() - t0;
+    Serial.printf("[MCP Client] Loaded %lu cached tools from %d servers (%lu us)\n",
+                  stats.cachedTools, serversLoaded, stats.cacheLoadUs);
+}
+
+void MCPClient::saveToolCache() {
+    File file = LittleFS.open(MCP_TOOL_CACHE_TEMP_PATH, "w");
+    if (!file) {
+        Serial.println("[MCP Client] Failed to open tool cache");
+        return;
+    }
+
+    // Servers whose tools are listed, fetched or still from the cache
+    std::vector<int> entries;
+    for (int i = 0; i < (int)servers.size(); i++) {
+        if (servers[i].enabled && (servers[i].connected || countToolsForServer(i) > 0)) {
+            entries.push_back(i);
+        }
+    }
+
+    CacheFileHeader header = { MCP_TOOL_CACHE_MAGIC, (uint16_t)entries.size() };
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+
+    for (int index : entries) {
+        if (!ok) break;
+
+        CacheEntryHeader entry;
+        entry.configHash = configHash(servers[index]);
+        entry.fetchedAt = servers[index].toolsFetchedAt;
+        entry.contentHash = hashTools(tools, index);
+        entry.toolCount = 0;
+        entry.payloadLength = 0;
+        for (const auto& tool : tools) {
+            if (tool.serverIndex != index || !cacheable(tool)) continue;
+            entry.toolCount++;
+            entry.payloadLength += 3 * sizeof(uint16_t) + tool.name.length() +
+                                   tool.description.length() + tool.inputSchema.length() + 1;
+        }
+        ok = file.write((const uint8_t*)&entry, sizeof(entry)) == sizeof(entry);
+
+        for (const auto& tool : tools) {
+            if (!ok) break;
+            if (tool.serverIndex != index || !cacheable(tool)) continue;
+            uint16_t lengths[3] = {
+                (uint16_t)tool.name.length(),
+                (uint16_t)tool.description.length(),
+                (uint16_t)tool.inputSchema.length()
+            };
+            uint8_t flags = tool.ordered ? 1 : 0;
+            size_t expected = sizeof(lengths) + lengths[0] + lengths[1] + lengths[2] + 1;
+            size_t written = file.write((const uint8_t*)lengths, sizeof(lengths));
+            written += file.write((const uint8_t*)tool.name.c_str(), lengths[0]);
+            written += file.write((const uint8_t*)tool.description.c_str(), lengths[1]);
+            written += file.write((const uint8_t*)tool.inputSchema.c_str(), lengths[2]);
+            written += file.write(&flags, 1);
+            ok = written == expected;
+        }
+    }
+    file.close();
+
+    // The rename replaces the old cache atomically
+    if (!ok || !LittleFS.rename(MCP_TOOL_CACHE_TEMP_PATH, MCP_TOOL_CACHE_PATH)) {
+        LittleFS.remove(MCP_TOOL_CACHE_TEMP_PATH);
+        Serial.println("[MCP Client] Failed to write tool cache");
+        return;
+    }
+    stats.cacheWrites++;
+}
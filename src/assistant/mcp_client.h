@@ -11,6 +11,20 @@
  * - Discover available tools
  * - Execute remote tools via Claude tool calls
  * - Configurable via web UI
+ *
+ * Discovery queries the servers concurrently (bounded by the HTTP slot
+ * pool), each with its own deadline, so a dead server costs one
+ * MCP_DISCOVERY_TIMEOUT_MS on one worker instead of stalling the rest.
+ * Tool lists are cached on LittleFS with their fetch time and a CRC of
+ * the content: at boot the cached tools are available immediately and
+ * only lists older than MCP_TOOL_CACHE_TTL_S are re-fetched, in the
+ * background.
+ *
+ * Servers that take JSON-RPC batches at POST /mcp get initialize and
+ * tools/list in one request, and several tools/calls from one LLM
+ * response in one request. A server that answers a batch with anything
+ * but an array is remembered as not batching and gets one request per
+ * call on the per-method paths (/mcp/tools/list, /mcp/tools/call).
  */
 
 #ifndef MCP_CLIENT_H
@@ -18,7 +32,11 @@
 
 #include <Arduino.h>
 #include <HTTPClient.h>
+#include <NetworkClientSecure.h>
 #include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <vector>
 
 //=============================================================================
@@ -34,10 +52,53 @@
 /** HTTP timeout for MCP requests (ms) */
 #define MCP_HTTP_TIMEOUT 10000
 
+/** Wait for trailing body bytes after a streamed parse (ms) */
+#define MCP_BODY_DRAIN_MS 200
+
+/** Concurrent requests (parallel tool calls from one LLM response) */
+#define MCP_MAX_PARALLEL_REQUESTS 3
+
+/** Per-server discovery deadline, for connecting and for the response (ms) */
+#define MCP_DISCOVERY_TIMEOUT_MS 4000
+
+/** Stack for discovery workers (TLS handshake) */
+#define MCP_DISCOVERY_TASK_STACK_SIZE 8192
+
+/** Background refresh gives up if WiFi isn't up by then (ms) */
+#define MCP_REFRESH_WIFI_WAIT_MS 60000
+
+/** Background refresh waits this long for NTP to judge cache age (ms) */
+#define MCP_REFRESH_CLOCK_WAIT_MS 5000
+
+/** Tool list cache file */
+#define MCP_TOOL_CACHE_PATH "/mcp_tools.bin"
+
+/** Temporary file used while rewriting the cache */
+#define MCP_TOOL_CACHE_TEMP_PATH "/mcp_tools.tmp"
+
+/** Cached tool lists younger than this are not re-fetched at boot (s) */
+#define MCP_TOOL_CACHE_TTL_S (24 * 3600)
+
+/** Cache file marker (bumped when the record format changes) */
+#define MCP_TOOL_CACHE_MAGIC 0x7C02
+
+/** Most tools/call requests sent to one server in one batch */
+#define MCP_MAX_BATCH_CALLS 8
+
 //=============================================================================
 // Server and Tool Structures
 //=============================================================================
 
+/**
+ * @enum MCPBatchSupport
+ * @brief Whether a server takes JSON-RPC batches, learned on first use
+ */
+enum class MCPBatchSupport : uint8_t {
+    Unknown,
+    Yes,
+    No
+};
+
 /**
  * @struct MCPRemoteTool
  * @brief Tool discovered from an MCP server
@@ -47,6 +108,7 @@ struct MCPRemoteTool {
     String description;
     String inputSchema;
     int serverIndex;  // Which server this tool belongs to
+    bool ordered;     // Annotated destructive: must not overlap other calls
 };
 
 /**
@@ -60,10 +122,58 @@ struct MCPServerConfig {
     bool enabled;         ///< Whether this server is active
     bool connected;       ///< Whether we successfully connected
     String lastError;     ///< Last error message if any
+    bool toolsCached;     ///< Tool list came from the cache, not yet re-fetched
+    uint32_t toolsFetchedAt;  ///< Unix time the list was fetched (0 = unknown)
+    MCPBatchSupport batch;    ///< Not persisted, probed again after boot
+    String sessionId;         ///< Mcp-Session-Id from the batched initialize, if any
+
+    MCPServerConfig()
+        : enabled(true), connected(false), toolsCached(false), toolsFetchedAt(0)
+        , batch(MCPBatchSupport::Unknown) {}
+};
 
-    MCPServerConfig() : enabled(true), connected(false) {}
+/**
+ * @struct MCPToolCall
+ * @brief One call of a group passed to executeTools()
+ */
+struct MCPToolCall {
+    const char* name;
+    const char* arguments;  ///< JSON
+    String result;          ///< Filled in, as executeTool() returns it
+};
+
+/**
+ * @struct MCPDiscoveryStats
+ * @brief Discovery and tool cache counters since boot
+ */
+struct MCPDiscoveryStats {
+    uint32_t runs;              ///< Discovery rounds (explicit and background)
+    uint32_t lastRunMs;         ///< Wall time of the last round
+    uint32_t serversFetched;    ///< Successful tools/list requests
+    uint32_t serversFailed;     ///< Failed or timed out requests
+    uint32_t serversFresh;      ///< Skipped at boot, cached list within TTL
+    uint32_t unchangedLists;    ///< Fetched lists identical to the cached one
+    uint32_t cachedTools;       ///< Tools loaded from the cache at boot
+    uint32_t cacheLoadUs;       ///< Time to load the cache
+    uint32_t cacheWrites;       ///< Cache file rewrites
+    uint32_t batchedLists;      ///< Lists fetched with initialize in one batch
+};
+
+/**
+ * @struct MCPCallStats
+ * @brief Remote tool call counters since boot
+ */
+struct MCPCallStats {
+    uint32_t calls;             ///< tools/call requests made
+    uint32_t batches;           ///< Batch POSTs carrying two or more calls
+    uint32_t batchedCalls;      ///< Calls that went out in a batch
+    uint32_t fallbacks;         ///< Batches refused, re-sent one call per POST
+    uint32_t savedRequests;     ///< HTTP round trips avoided by batching
 };
 
+struct MCPDiscoveryJob;
+struct MCPCallGroup;
+
 //=============================================================================
 // MCPClient Class
 //=============================================================================
@@ -132,6 +242,11 @@ public:
 
     /**
      * @brief Connect to all enabled servers and discover tools
+     *
+     * Servers are queried concurrently, each within
+     * MCP_DISCOVERY_TIMEOUT_MS. A server that fails keeps the tools it
+     * had (e.g. from the cache) but is marked not connected.
+     *
      * @return Number of tools discovered
      */
     int discoverTools();
@@ -143,6 +258,35 @@ public:
      */
     bool discoverServerTools(int index);
 
+    /**
+     * @brief Re-fetch missing or stale tool lists in a background task
+     *
+     * Waits for WiFi first. Results are merged by applyBackgroundRefresh().
+     *
+     * @return true if the task was started
+     */
+    bool startBackgroundRefresh();
+
+    /**
+     * @brief Merge a finished background refresh
+     *
+     * Call from the task that uses the tools (e.g. the main loop while
+     * the assistant is idle); does nothing until the refresh is done.
+     *
+     * @return true if the tool list changed
+     */
+    bool applyBackgroundRefresh();
+
+    /**
+     * @brief True while a background refresh is running or unmerged
+     */
+    bool isRefreshing() const { return refreshJobs != nullptr; }
+
+    /**
+     * @brief Discovery and cache counters
+     */
+    const MCPDiscoveryStats& getDiscoveryStats() const { return stats; }
+
     /**
      * @brief Get all discovered tools
      */
@@ -165,21 +309,40 @@ public:
 
     /**
      * @brief Execute a tool on its server
+     *
+     * Thread-safe: up to MCP_MAX_PARALLEL_REQUESTS calls run concurrently,
+     * each on its own pooled connection.
+     *
      * @param toolName Name of the tool
      * @param arguments JSON string with arguments
      * @return JSON result string
      */
     String executeTool(const char* toolName, const char* arguments);
 
+    /**
+     * @brief Execute several tools, one request per server where possible
+     *
+     * Calls to the same batching server go out as one JSON-RPC batch;
+     * different servers are called concurrently. Results are the same as
+     * executeTool() would give.
+     */
+    void executeTools(MCPToolCall* calls, int count);
+
+    /**
+     * @brief Remote tool call counters
+     */
+    const MCPCallStats& getCallStats() const { return callStats; }
+
     //-------------------------------------------------------------------------
     // LLM Integration
     //-------------------------------------------------------------------------
 
     /**
      * @brief Register all discovered tools with an LLM client
-     * @param addToolFunc Function to add tools (LLMClient::addTool)
+     * @param addToolFunc Function to add tools: name, description, schema
+     *        and whether the tool must run alone, in call order
      */
-    void registerToolsWithLLM(std::function<bool(const char*, const char*, const char*)> addToolFunc);
+    void registerToolsWithLLM(std::function<bool(const char*, const char*, const char*, bool)> addToolFunc);
 
     //-------------------------------------------------------------------------
     // Persistence
@@ -197,14 +360,135 @@ public:
 
 private:
     /**
-     * @brief Make HTTP request to MCP server
+     * @brief Claim a free HTTPClient slot, waiting if all are busy
+     * @return Slot index, or -1 on timeout
      */
-    String makeRequest(const char* url, const char* method, const char* body, const char* apiKey);
+    int leaseHttp();
 
     /**
-     * @brief Parse tools from server response
+     * @brief Return an HTTPClient slot
      */
-    void parseTools(int serverIndex, const char* response);
+    void releaseHttp(int slot);
+
+    /**
+     * @brief Send a request; the response is left unread on http
+     * @param conn Set to the pooled connection (nullptr for plain HTTP)
+     * @param timeoutMs Connect and response timeout
+     * @param sessionId Sent as Mcp-Session-Id unless empty; replaced by the
+     *        one in the response, if it carries one
+     * @return HTTP status code, or a negative HTTPClient error
+     */
+    int beginRequest(HTTPClient& http, const char* url, const char* method, const char* body,
+                     const char* apiKey, NetworkClientSecure*& conn,
+                     uint32_t timeoutMs = MCP_HTTP_TIMEOUT, String* sessionId = nullptr);
+
+    /**
+     * @brief Finish a request and return its connection to the pool
+     */
+    void endRequest(HTTPClient& http, NetworkClientSecure* conn, bool keepAlive);
+
+    /**
+     * @brief Make HTTP request to MCP server, returning the whole body
+     * @param status Set to the HTTP status code, or a negative HTTPClient error
+     * @param sessionId Mcp-Session-Id to send and update (see beginRequest)
+     */
+    String makeRequest(const char* url, const char* method, const char* body, const char* apiKey,
+                       int* status = nullptr, String* sessionId = nullptr);
+
+    /**
+     * @brief POST and deserialize the response directly from the socket
+     * @param doc Receives the filtered response (null on parse failure)
+     * @param filter ArduinoJson filter selecting the fields to keep
+     * @param timeoutMs Connect and response timeout
+     * @param sessionId Mcp-Session-Id to send and update (see beginRequest)
+     * @return HTTP status code, or a negative HTTPClient error
+     */
+    int makeJsonRequest(const char* url, const char* body, const char* apiKey,
+                        JsonDocument& doc, JsonDocument& filter, uint32_t timeoutMs,
+                        String* sessionId = nullptr);
+
+    //-------------------------------------------------------------------------
+    // Discovery internals
+    //-------------------------------------------------------------------------
+
+    /**
+     * @brief Copy what a worker needs from servers[index] into job
+     */
+    void prepareJob(int index, MCPDiscoveryJob& job) const;
+
+    /**
+     * @brief Run tools/list for one job (any task; touches only the job)
+     */
+    void fetchServerTools(MCPDiscoveryJob& job);
+
+    /**
+     * @brief Fetch the jobs that aren't skipped, in parallel
+     */
+    void runJobs(MCPDiscoveryJob* jobs, int count);
+
+    /**
+     * @brief Run work(0..count-1) on up to MCP_MAX_PARALLEL_REQUESTS
+     *        workers, caller included
+     */
+    void runParallel(int count, const std::function<void(int)>& work);
+
+    /**
+     * @brief Apply a finished job to servers and tools
+     * @return true if the tool list changed
+     */
+    bool mergeJob(MCPDiscoveryJob& job);
+
+    /**
+     * @brief Parse tools from a tools/list response into the job
+     */
+    void parseTools(MCPDiscoveryJob& job, JsonVariant response);
+
+    static void parallelWorker(void* param);
+    static void refreshTask(void* param);
+
+    //-------------------------------------------------------------------------
+    // Tool call internals
+    //-------------------------------------------------------------------------
+
+    /**
+     * @brief Fill in the tools/call request for a tool
+     * @param serverIndex Set to the tool's server
+     * @return nullptr, or the error result if the call can't be made
+     */
+    const char* prepareToolCall(const char* toolName, const char* arguments,
+                                JsonObject request, int& serverIndex) const;
+
+    /**
+     * @brief POST one tools/call (any task)
+     * @param jsonRpc Send it to /mcp with the session id, as servers that
+     *        took the batched initialize expect, else to /mcp/tools/call
+     */
+    String sendToolCall(const char* toolName, const char* arguments, bool jsonRpc, String sessionId);
+
+    /**
+     * @brief Run one server's share of executeTools() (any task)
+     */
+    void runCallGroup(MCPCallGroup& group);
+
+    //-------------------------------------------------------------------------
+    // Tool cache
+    //-------------------------------------------------------------------------
+
+    /**
+     * @brief Load cached tool lists of the configured servers
+     */
+    void loadToolCache();
+
+    /**
+     * @brief Rewrite the cache from the current tool lists
+     */
+    void saveToolCache();
+
+    /** Identifies a server configuration in the cache */
+    static uint32_t configHash(const MCPServerConfig& server);
+
+    /** CRC of a tool list as stored in the cache */
+    static uint32_t hashTools(const std::vector<MCPRemoteTool>& list, int serverIndex);
 
     /**
      * @brief Count tools belonging to a specific server
@@ -214,6 +498,21 @@ private:
     bool initialized;
     std::vector<MCPServerConfig> servers;
     std::vector<MCPRemoteTool> tools;
+    MCPDiscoveryStats stats;
+    MCPCallStats callStats;
+
+    // Held while servers are being queried, so rounds don't overlap
+    SemaphoreHandle_t discoveryMutex;
+
+    // Background refresh: jobs owned by the task until refreshDone
+    MCPDiscoveryJob* refreshJobs;
+    int refreshJobCount;
+    volatile bool refreshDone;
+
+    // Long-lived so their destructors don't close pooled keep-alive sockets
+    HTTPClient httpSlots[MCP_MAX_PARALLEL_REQUESTS];
+    bool httpBusy[MCP_MAX_PARALLEL_REQUESTS];
+    SemaphoreHandle_t httpMutex;
 };
 
 // Global MCP client instance
@@ -10,10 +10,34 @@
  * 1. Client GETs /sse -> receives endpoint event with message URL
  * 2. Client POSTs JSON-RPC to /mcp/message?sessionId=xxx
  * 3. Server sends JSON-RPC responses as SSE events on the open SSE stream
+ *
+ * Streamable HTTP clients instead POST to /mcp and get the response in the
+ * HTTP reply, on a connection that stays open for the next call.
+ *
+ * The task sleeps in select() on the listening socket and every open
+ * connection, so requests are handled as soon as they arrive and the
+ * task costs nothing while idle.
+ *
+ * Each SSE stream is a session in a fixed table. Responses are framed into
+ * the session's queue and written with non-blocking sends from the server
+ * task, so a stalled client only backs up its own queue.
+ *
+ * Resource changes are flagged in an atomic bitmask by whichever task
+ * notices them, plus a byte to a loopback socket in the select() set so
+ * the server task wakes at once. The task turns flags into per-session
+ * pending bits at most once per update interval and resource, and queues
+ * the notifications as queue space allows - a flag raised many times
+ * before that is one notification.
+ *
+ * A lone tools/call is staged with the deferred executor and parked in
+ * pendingCalls; while any is pending select() waits at most
+ * MCP_PENDING_POLL_MS, and each pass sends the replies of those done.
  */
 
 #include "mcp_server.h"
+#include "psram_allocator.h"
 #include <esp_random.h>
+#include <lwip/sockets.h>
 
 // Global instance
 MCPServer mcpServer;
@@ -24,13 +48,55 @@ MCPServer mcpServer;
 
 MCPServer::MCPServer()
     : taskHandle(nullptr)
-    , tcpServer(nullptr)
-    , lastKeepAlive(0)
+    , listenFd(-1)
     , port(MCP_SERVER_PORT)
     , enabled(true)
     , running(false)
     , toolExecutor(nullptr)
+    , toolsVersion(1)
+    , subscribedResources(0)
+    , changedResources(0)
+    , resourceUpdateInterval(MCP_RESOURCE_UPDATE_INTERVAL_MS)
+    , wakeFd(-1)
+    , wakeSendFd(-1)
+    , cacheVersion(0)
 {
+    toolsListCache = {nullptr, 0};
+    resourcesListCache = {nullptr, 0};
+    initializeCache = {nullptr, 0};
+    initializeStreamableCache = {nullptr, 0};
+    for (int i = 0; i < MCP_MAX_PENDING_CALLS; i++) {
+        pendingCalls[i].active = false;
+    }
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        sessions[i].active = false;
+        sessions[i].id[0] = '\0';
+        sessions[i].subscriptions = 0;
+        sessions[i].pendingUpdates = 0;
+    }
+    for (int i = 0; i < MCP_MAX_HTTP_CONNECTIONS; i++) {
+        MCPConnection& conn = connections[i];
+        conn.active = false;
+        conn.body = nullptr;
+        conn.bodyLength = 0;
+        conn.keepAlive = false;
+        conn.awaitingTool = false;
+
+        // The parser handles framing headers itself; Accept picks the reply format
+        conn.parser.onHeader([&conn](const char* name, size_t nameLength,
+                                     const char* value, size_t valueLength) {
+            if (!HttpRequestParser::equalsIgnoreCase(name, nameLength, "accept")) return;
+            conn.acceptsJson = HttpRequestParser::containsIgnoreCase(value, valueLength, "application/json") ||
+                               HttpRequestParser::containsIgnoreCase(value, valueLength, "*/*");
+            conn.acceptsEventStream = HttpRequestParser::containsIgnoreCase(value, valueLength, "text/event-stream");
+        });
+        // prepareBody() has checked Content-Length against the buffer
+        conn.parser.onBody([&conn](const uint8_t* data, size_t length) {
+            memcpy(conn.body + conn.bodyLength, data, length);
+            conn.bodyLength += length;
+        });
+    }
+    memset(&stats, 0, sizeof(stats));
 }
 
 MCPServer::~MCPServer() {
@@ -46,10 +112,45 @@ bool MCPServer::begin(uint16_t p) {
 
     port = p;
 
-    // Create WiFiServer with backlog of 4 pending connections
-    tcpServer = new WiFiServer(port, 4);
-    tcpServer->begin();
-    tcpServer->setNoDelay(true);
+    // Raw listening socket so the task can wait on it with select()
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        Serial.println("[MCP] Failed to create socket");
+        return false;
+    }
+
+    int enable = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    // Backlog of 4 pending connections
+    if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 4) < 0) {
+        Serial.printf("[MCP] Failed to listen on port %d (errno=%d)\n", port, errno);
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+
+    if (!openWakeSocket()) {
+        Serial.println("[MCP] No wake socket, resource updates wait for the next wakeup");
+    }
+
+    // Body buffers live as long as the server, so a request allocates
+    // nothing for its body. A slot without one answers bodies with 503.
+    for (int i = 0; i < MCP_MAX_HTTP_CONNECTIONS; i++) {
+        MCPConnection& conn = connections[i];
+        if (!conn.body) conn.body = (uint8_t*)PsramAllocator::instance().allocate(MCP_MAX_BODY_SIZE);
+        if (!conn.body) Serial.printf("[MCP] No memory for connection %d's body buffer\n", i);
+    }
+
+    // Tools are registered by now; the task rebuilds if they change later
+    rebuildCache();
 
     running = true;
 
@@ -61,11 +162,12 @@ bool MCPServer::begin(uint16_t p) {
         this,
         2,                  // Priority (slightly above idle)
         &taskHandle,
-        1                   // Run on core 1 (same as Arduino loop)
+        0                   // Core 0 - keep the render loop on core 1 free
     );
 
-    Serial.printf("[MCP] SSE server started on port %d (dedicated task)\n", port);
-    Serial.printf("[MCP] %d tools registered\n", tools.size());
+    Serial.printf("[MCP] SSE server started on port %d (dedicated task, %d sessions)\n",
+                  port, MCP_MAX_SESSIONS);
+    Serial.printf("[MCP] %d tools, %d resources registered\n", tools.size(), resources.size());
     return true;
 }
 
@@ -73,18 +175,37 @@ void MCPServer::end() {
     if (!running) return;
     running = false;
 
-    // Wait for task to finish
-    if (taskHandle) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        taskHandle = nullptr;
+    // Wait for the task to leave select() and exit
+    uint32_t start = millis();
+    while (taskHandle && millis() - start < MCP_SELECT_MAX_WAIT_MS + 100) {
+        vTaskDelay(pdMS_TO_TICKS(10));
     }
 
-    closeSSEConnection();
-    if (tcpServer) {
-        tcpServer->end();
-        delete tcpServer;
-        tcpServer = nullptr;
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        if (sessions[i].active) closeSession(sessions[i]);
+    }
+    for (int i = 0; i < MCP_MAX_HTTP_CONNECTIONS; i++) {
+        if (connections[i].active) closeConnection(connections[i]);
+        PsramAllocator::instance().deallocate(connections[i].body);
+        connections[i].body = nullptr;
     }
+    if (listenFd >= 0) {
+        close(listenFd);
+        listenFd = -1;
+    }
+    if (wakeFd >= 0) {
+        int fd = wakeSendFd;
+        wakeSendFd = -1;    // Notifying tasks stop sending first
+        close(fd);
+        close(wakeFd);
+        wakeFd = -1;
+    }
+
+    freeCache(toolsListCache);
+    freeCache(resourcesListCache);
+    freeCache(initializeCache);
+    freeCache(initializeStreamableCache);
+    cacheVersion = 0;
     Serial.println("[MCP] Server stopped");
 }
 
@@ -94,34 +215,147 @@ void MCPServer::end() {
 
 void MCPServer::serverTask(void* param) {
     MCPServer* self = (MCPServer*)param;
+    self->stats.taskStartMs = millis();
 
     while (self->running) {
-        // Accept and handle all pending connections
-        WiFiClient client;
-        while (self->running && (client = self->tcpServer->accept())) {
-            self->handleNewConnection(client);
+        // Sleep until a socket is ready or the next keepalive/idle deadline
+        fd_set readSet, writeSet;
+        int maxFd = self->buildFdSets(readSet, writeSet);
+        uint32_t waitMs = self->nextDeadlineMs();
+
+        struct timeval tv;
+        tv.tv_sec = waitMs / 1000;
+        tv.tv_usec = (waitMs % 1000) * 1000;
+        int ready = select(maxFd + 1, &readSet, &writeSet, nullptr, &tv);
+
+        uint32_t busyStart = micros();
+        self->stats.wakeups++;
+
+        if (ready < 0 && errno != EINTR) {
+            Serial.printf("[MCP] select failed (errno=%d)\n", errno);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        if (ready > 0 && self->wakeFd >= 0 && FD_ISSET(self->wakeFd, &readSet)) {
+            self->drainWakeSocket();
         }
 
-        // Send keepalive on SSE connection
-        if (self->sseClient && self->sseClient.connected()) {
-            if (millis() - self->lastKeepAlive >= MCP_KEEPALIVE_INTERVAL_MS) {
-                self->sendKeepAlive();
-                self->lastKeepAlive = millis();
+        // Accept and handle all pending connections
+        if (ready > 0 && FD_ISSET(self->listenFd, &readSet)) {
+            int fd;
+            while (self->running && (fd = accept(self->listenFd, nullptr, nullptr)) >= 0) {
+                int enable = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                self->handleNewConnection(WiFiClient(fd));
             }
-        } else if (self->sessionId.length() > 0) {
-            Serial.printf("[MCP] SSE connection lost (client=%d, connected=%d)\n",
-                         (bool)self->sseClient, self->sseClient ? self->sseClient.connected() : 0);
-            self->sessionId = "";
         }
 
-        // Small delay to avoid busy-waiting
-        vTaskDelay(pdMS_TO_TICKS(10));
+        // Requests on kept-alive /mcp connections
+        self->serviceConnections();
+
+        // Replies to tool calls the main loop has finished
+        self->servicePendingCalls();
+
+        // Changed resources to their subscribers
+        self->publishResourceUpdates();
+
+        // Drain queues, keepalives, drop disconnected sessions
+        self->serviceSessions();
+
+        self->stats.busyUs += micros() - busyStart;
     }
 
     Serial.println("[MCP] Server task exiting");
+    self->taskHandle = nullptr;
     vTaskDelete(NULL);
 }
 
+int MCPServer::buildFdSets(fd_set& readSet, fd_set& writeSet) {
+    FD_ZERO(&readSet);
+    FD_ZERO(&writeSet);
+    FD_SET(listenFd, &readSet);
+    int maxFd = listenFd;
+
+    if (wakeFd >= 0) {
+        FD_SET(wakeFd, &readSet);
+        if (wakeFd > maxFd) maxFd = wakeFd;
+    }
+
+    // Connections held for a tool result are not read until it is sent
+    for (int i = 0; i < MCP_MAX_HTTP_CONNECTIONS; i++) {
+        if (!connections[i].active || connections[i].awaitingTool) continue;
+        int fd = connections[i].client.fd();
+        if (fd < 0) continue;
+        FD_SET(fd, &readSet);
+        if (fd > maxFd) maxFd = fd;
+    }
+
+    // SSE clients never send, so readable means closed; writable matters
+    // only while frames are waiting
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        if (!sessions[i].active) continue;
+        int fd = sessions[i].client.fd();
+        if (fd < 0) continue;
+        FD_SET(fd, &readSet);
+        if (sessions[i].queueCount > 0) FD_SET(fd, &writeSet);
+        if (fd > maxFd) maxFd = fd;
+    }
+    return maxFd;
+}
+
+uint32_t MCPServer::nextDeadlineMs() {
+    uint32_t now = millis();
+    uint32_t wait = MCP_SELECT_MAX_WAIT_MS;
+
+    for (int i = 0; i < MCP_MAX_PENDING_CALLS; i++) {
+        if (pendingCalls[i].active) wait = MCP_PENDING_POLL_MS;
+    }
+
+    for (int i = 0; i < MCP_MAX_HTTP_CONNECTIONS; i++) {
+        const MCPConnection& conn = connections[i];
+        if (!conn.active || conn.awaitingTool) continue;
+        // Bytes already pulled into the client's buffer won't wake select()
+        if (connections[i].client.available() > 0) return 0;
+        uint32_t idle = now - conn.lastActivity;
+        uint32_t left = idle < MCP_HTTP_IDLE_TIMEOUT_MS ? MCP_HTTP_IDLE_TIMEOUT_MS - idle : 0;
+        if (left < wait) wait = left;
+        // A request still arriving is dropped at its deadline
+        if (!conn.parser.isIdle()) {
+            uint32_t taken = (micros() - conn.startUs) / 1000;
+            left = taken < MCP_REQUEST_TIMEOUT_MS ? MCP_REQUEST_TIMEOUT_MS - taken : 0;
+            if (left < wait) wait = left;
+        }
+    }
+
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        const MCPSession& session = sessions[i];
+        if (!session.active) continue;
+        // Notifications held back by a full queue that has room again
+        if (session.pendingUpdates && session.queueCount < MCP_SESSION_QUEUE_DEPTH) return 0;
+        if (session.queueCount > 0) continue;
+        uint32_t idle = now - session.lastWrite;
+        uint32_t left = idle < MCP_KEEPALIVE_INTERVAL_MS ? MCP_KEEPALIVE_INTERVAL_MS - idle : 0;
+        if (left < wait) wait = left;
+    }
+
+    // Changed resources still inside their update interval
+    uint32_t changed = changedResources.load();
+    for (size_t i = 0; i < resources.size() && changed; i++) {
+        if (!(changed & (1u << i))) continue;
+        uint32_t since = now - resources[i].lastNotify;
+        uint32_t left = since < resourceUpdateInterval ? resourceUpdateInterval - since : 0;
+        if (left < wait) wait = left;
+    }
+    return wait;
+}
+
+float MCPServer::getCpuUsage() const {
+    uint32_t elapsedMs = millis() - stats.taskStartMs;
+    if (!running || elapsedMs == 0) return 0.0f;
+    return (float)stats.busyUs / (elapsedMs * 10.0f);
+}
+
 //=============================================================================
 // Tool Management
 //=============================================================================
@@ -136,6 +370,7 @@ void MCPServer::addTool(const char* name, const char* description, const char* i
     tool.description = description;
     tool.inputSchema = inputSchema;
     tools.push_back(tool);
+    toolsVersion++;
     Serial.printf("[MCP] Registered tool: %s\n", name);
 }
 
@@ -143,6 +378,7 @@ void MCPServer::removeTool(const char* name) {
     for (auto it = tools.begin(); it != tools.end(); ++it) {
         if (it->name == name) {
             tools.erase(it);
+            toolsVersion++;
             return;
         }
     }
@@ -150,86 +386,418 @@ void MCPServer::removeTool(const char* name) {
 
 void MCPServer::clearTools() {
     tools.clear();
+    toolsVersion++;
 }
 
 //=============================================================================
-// Connection Handling
+// Resources
 //=============================================================================
 
-void MCPServer::handleNewConnection(WiFiClient client) {
-    client.setTimeout(1000);  // 1 second timeout for reading
+bool MCPServer::addResource(const char* uri, const char* name, const char* description,
+                            MCPResourceReader reader) {
+    if (findResource(uri) >= 0 || resources.size() >= MCP_MAX_RESOURCES) return false;
+
+    MCPResource resource;
+    resource.uri = uri;
+    resource.name = name;
+    resource.description = description;
+    resource.reader = reader;
+    resource.lastNotify = 0;
+    resources.push_back(resource);
+    toolsVersion++;
+    Serial.printf("[MCP] Registered resource: %s\n", uri);
+    return true;
+}
 
-    // Read request line: "GET /sse HTTP/1.1"
-    String requestLine = client.readStringUntil('\n');
-    requestLine.trim();
+int MCPServer::findResource(const char* uri) const {
+    for (size_t i = 0; i < resources.size(); i++) {
+        if (resources[i].uri == uri) return i;
+    }
+    return -1;
+}
 
-    int sp1 = requestLine.indexOf(' ');
-    int sp2 = requestLine.indexOf(' ', sp1 + 1);
-    if (sp1 < 0 || sp2 < 0) {
-        client.stop();
+void MCPServer::notifyResourceUpdated(const char* uri) {
+    int index = findResource(uri);
+    if (index < 0) return;
+    uint32_t bit = 1u << index;
+    if (!(subscribedResources.load() & bit)) return;
+
+    stats.resourceChanges++;
+    if (changedResources.fetch_or(bit) & bit) {
+        // Still waiting for its interval - goes out with the pending update
+        stats.resourceCoalesced++;
         return;
     }
 
-    String method = requestLine.substring(0, sp1);
-    String uri = requestLine.substring(sp1 + 1, sp2);
+    int fd = wakeSendFd;
+    if (fd >= 0) {
+        uint8_t byte = 1;
+        sendto(fd, &byte, 1, MSG_DONTWAIT, (struct sockaddr*)&wakeAddr, sizeof(wakeAddr));
+    }
+}
+
+void MCPServer::publishResourceUpdates() {
+    uint32_t changed = changedResources.load();
+    if (changed == 0) return;
+
+    uint32_t now = millis();
+    uint32_t due = 0;
+    for (size_t i = 0; i < resources.size(); i++) {
+        uint32_t bit = 1u << i;
+        if (!(changed & bit) || now - resources[i].lastNotify < resourceUpdateInterval) continue;
+        resources[i].lastNotify = now;
+        due |= bit;
+    }
+    if (due == 0) return;
+
+    // Changes flagged from here on start a new interval
+    changedResources.fetch_and(~due);
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        if (sessions[i].active) sessions[i].pendingUpdates |= due & sessions[i].subscriptions;
+    }
+}
+
+void MCPServer::queueResourceUpdates(MCPSession& session) {
+    while (session.pendingUpdates && session.queueCount < MCP_SESSION_QUEUE_DEPTH) {
+        int index = __builtin_ctz(session.pendingUpdates);
+        session.pendingUpdates &= session.pendingUpdates - 1;
+
+        JsonDocument doc;
+        doc["jsonrpc"] = "2.0";
+        doc["method"] = "notifications/resources/updated";
+        doc["params"]["uri"] = resources[index].uri;
+
+        String notification;
+        serializeJson(doc, notification);
+        if (queueEvent(session, notification)) stats.resourceUpdates++;
+    }
+}
+
+void MCPServer::updateSubscribedResources() {
+    uint32_t mask = 0;
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        if (sessions[i].active) mask |= sessions[i].subscriptions;
+    }
+    subscribedResources.store(mask);
+}
+
+bool MCPServer::openWakeSocket() {
+    wakeFd = socket(AF_INET, SOCK_DGRAM, 0);
+    wakeSendFd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    memset(&wakeAddr, 0, sizeof(wakeAddr));
+    wakeAddr.sin_family = AF_INET;
+    wakeAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    wakeAddr.sin_port = 0;      // Any free port, read back below
+    socklen_t length = sizeof(wakeAddr);
+
+    if (wakeFd < 0 || wakeSendFd < 0 ||
+        bind(wakeFd, (struct sockaddr*)&wakeAddr, sizeof(wakeAddr)) < 0 ||
+        getsockname(wakeFd, (struct sockaddr*)&wakeAddr, &length) < 0) {
+        if (wakeFd >= 0) close(wakeFd);
+        if (wakeSendFd >= 0) close(wakeSendFd);
+        wakeFd = -1;
+        wakeSendFd = -1;
+        return false;
+    }
+    fcntl(wakeFd, F_SETFL, fcntl(wakeFd, F_GETFL, 0) | O_NONBLOCK);
+    fcntl(wakeSendFd, F_SETFL, fcntl(wakeSendFd, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
 
-    // Read headers
-    int contentLength = 0;
-    while (client.connected()) {
-        String header = client.readStringUntil('\n');
-        header.trim();
-        if (header.length() == 0) break;  // Empty line = end of headers
+void MCPServer::drainWakeSocket() {
+    uint8_t buf[16];
+    while (recv(wakeFd, buf, sizeof(buf), MSG_DONTWAIT) > 0) {}
+}
+
+//=============================================================================
+// Connection Handling
+//=============================================================================
 
-        // Case-insensitive Content-Length check
-        String headerLower = header;
-        headerLower.toLowerCase();
-        if (headerLower.startsWith("content-length:")) {
-            contentLength = header.substring(header.indexOf(':') + 1).toInt();
+void MCPServer::handleNewConnection(WiFiClient client) {
+    stats.connectionsAccepted++;
+
+    MCPConnection* conn = freeConnectionSlot();
+    if (!conn) {
+        // Make room by closing the connection that has been idle longest
+        uint32_t now = millis();
+        for (int i = 0; i < MCP_MAX_HTTP_CONNECTIONS; i++) {
+            MCPConnection& c = connections[i];
+            if (!c.parser.isIdle() || c.awaitingTool) continue;
+            if (!conn || now - c.lastActivity > now - conn->lastActivity) conn = &c;
+        }
+        if (!conn) {
+            sendStatus(client, 503);
+            return;
         }
+        closeConnection(*conn);
     }
 
-    // Route request - only read body for message endpoint
-    if (method == "GET" && uri == "/sse") {
-        handleSSERequest(client);
-    } else if (method == "POST" && uri.startsWith("/mcp/message")) {
-        // Read body only for message requests
-        String body;
-        if (contentLength > 0 && contentLength < 4096) {
-            char* buf = (char*)malloc(contentLength + 1);
-            if (buf) {
-                int bytesRead = 0;
-                unsigned long start = millis();
-                while (bytesRead < contentLength && client.connected() && (millis() - start < 2000)) {
-                    int avail = client.available();
-                    if (avail > 0) {
-                        int toRead = min(avail, contentLength - bytesRead);
-                        int r = client.read((uint8_t*)(buf + bytesRead), toRead);
-                        if (r > 0) bytesRead += r;
-                    } else {
-                        vTaskDelay(1);
-                    }
-                }
-                buf[bytesRead] = '\0';
-                body = String(buf);
-                free(buf);
+    conn->client = client;
+    conn->active = true;
+    conn->lastActivity = millis();
+    conn->requests = 0;
+    conn->parser.reset();
+
+    // The request usually arrives together with the connection
+    serviceConnection(*conn);
+}
+
+void MCPServer::serviceConnection(MCPConnection& conn) {
+    uint8_t buf[MCP_READ_CHUNK_SIZE];
+
+    while (conn.active && !conn.awaitingTool && conn.client.available() > 0) {
+        int n = conn.client.read(buf, sizeof(buf));
+        if (n <= 0) break;
+        conn.lastActivity = millis();
+
+        size_t offset = 0;
+        while (conn.active && !conn.awaitingTool && offset < (size_t)n) {
+            if (conn.parser.isIdle()) {
+                conn.startUs = micros();
+                conn.acceptsJson = false;
+                conn.acceptsEventStream = false;
+                conn.bodyLength = 0;
+            }
+            bool hadHeaders = conn.parser.headersComplete();
+            offset += conn.parser.feed(buf + offset, n - offset);
+
+            if (conn.parser.hasError()) {
+                Serial.printf("[MCP] Bad request (%u)\n", conn.parser.getErrorStatus());
+                sendStatus(conn.client, conn.parser.getErrorStatus());
+                closeConnection(conn);
+                return;
+            }
+            if (!hadHeaders && conn.parser.headersComplete() && !prepareBody(conn)) return;
+
+            // Body bytes still to come arrive on a later wakeup
+            if (conn.parser.getState() != HttpParserState::Complete) continue;
+
+            bool keep = serveRequest(conn);
+            if (keep) {
+                conn.parser.reset();
+            } else {
+                // Closed by the handler, or handed over to an SSE session
+                conn.bodyLength = 0;
+                conn.active = false;
             }
         }
-        handleMessageRequest(client, uri, body);
-    } else if (method == "OPTIONS") {
+    }
+}
+
+bool MCPServer::prepareBody(MCPConnection& conn) {
+    uint32_t length = conn.parser.getContentLength();
+    if (length > MCP_MAX_BODY_SIZE) {
+        sendStatus(conn.client, 413);
+        closeConnection(conn);
+        return false;
+    }
+    if (length > 0 && !conn.body) {
+        sendStatus(conn.client, 503);
+        closeConnection(conn);
+        return false;
+    }
+    return true;
+}
+
+bool MCPServer::serveRequest(MCPConnection& conn) {
+    if (conn.requests++ > 0) stats.connectionsReused++;
+
+    bool keep = handleRequest(conn);
+
+    uint32_t elapsed = micros() - conn.startUs;
+    stats.requests++;
+    stats.requestUs += elapsed;
+    if (elapsed > stats.maxRequestUs) stats.maxRequestUs = elapsed;
+    return keep;
+}
+
+bool MCPServer::handleRequest(MCPConnection& conn) {
+    HttpRequestParser& req = conn.parser;
+    WiFiClient& client = conn.client;
+
+    // Route request
+    if (req.isPath("/mcp")) {
+        return handleStreamableRequest(conn);
+    } else if (req.isMethod("GET") && req.isPath("/sse")) {
+        handleSSERequest(client);
+    } else if (req.isMethod("POST") && req.isPath("/mcp/message")) {
+        handleMessageRequest(conn);
+    } else if (req.isMethod("OPTIONS")) {
         // CORS preflight
         client.print(
             "HTTP/1.1 204 No Content\r\n"
             "Access-Control-Allow-Origin: *\r\n"
             "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-            "Access-Control-Allow-Headers: Content-Type\r\n"
+            "Access-Control-Allow-Headers: Content-Type, Accept, Mcp-Session-Id, Mcp-Protocol-Version\r\n"
             "\r\n"
         );
         client.stop();
     } else {
-        Serial.printf("[MCP] 404: %s %s\n", method.c_str(), uri.c_str());
-        client.print("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
-        client.stop();
+        Serial.printf("[MCP] 404: %s %s\n", req.getMethod(), req.getUri());
+        sendStatus(client, 404);
+    }
+    return false;
+}
+
+void MCPServer::sendStatus(WiFiClient& client, uint16_t status) {
+    const char* reason;
+    switch (status) {
+        case 400: reason = "Bad Request"; break;
+        case 404: reason = "Not Found"; break;
+        case 408: reason = "Request Timeout"; break;
+        case 413: reason = "Content Too Large"; break;
+        case 414: reason = "URI Too Long"; break;
+        case 431: reason = "Request Header Fields Too Large"; break;
+        case 501: reason = "Not Implemented"; break;
+        case 503: reason = "Service Unavailable"; break;
+        case 505: reason = "HTTP Version Not Supported"; break;
+        default:  reason = "Error"; break;
+    }
+    client.printf("HTTP/1.1 %u %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                  status, reason);
+    client.stop();
+}
+
+//=============================================================================
+// Streamable HTTP Handler - POST /mcp
+//=============================================================================
+
+bool MCPServer::handleStreamableRequest(MCPConnection& conn) {
+    HttpRequestParser& req = conn.parser;
+    WiFiClient& client = conn.client;
+    bool keepAlive = req.isKeepAlive();
+    const char* connection = keepAlive ? "keep-alive" : "close";
+
+    if (!req.isMethod("POST")) {
+        // No server-initiated stream on this transport (GET) and no session
+        // state to terminate (DELETE)
+        client.printf(
+            "HTTP/1.1 405 Method Not Allowed\r\n"
+            "Allow: POST, OPTIONS\r\n"
+            "Content-Length: 0\r\n"
+            "Connection: %s\r\n"
+            "Access-Control-Allow-Origin: *\r\n"
+            "\r\n", connection);
+        if (!keepAlive) client.stop();
+        return keepAlive;
+    }
+
+    if (!enabled || req.getContentLength() == 0) {
+        sendStatus(client, enabled ? 400 : 503);
+        return false;
+    }
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, (const char*)conn.body, conn.bodyLength);
+    MCPResponse response;
+    if (error || !deferToolCall(doc, &conn, nullptr, response)) {
+        response = processJsonRpc(doc, error, nullptr);
+    }
+
+    conn.keepAlive = keepAlive;
+    if (conn.awaitingTool) {
+        // servicePendingCalls() answers once the tool is done
+        return true;
+    }
+    return sendStreamableResponse(conn, response);
+}
+
+bool MCPServer::sendStreamableResponse(MCPConnection& conn, const MCPResponse& response) {
+    WiFiClient& client = conn.client;
+    bool keepAlive = conn.keepAlive;
+    const char* connection = keepAlive ? "keep-alive" : "close";
+
+    // Result goes back on this connection: plain JSON unless the client
+    // only takes an event stream. Content-Length keeps the connection usable.
+    bool hasBody = !response.isEmpty();
+    bool eventStream = hasBody && conn.acceptsEventStream && !conn.acceptsJson;
+    static const char EVENT_PREFIX[] = "event: message\ndata: ";
+    static const char EVENT_SUFFIX[] = "\n\n";
+
+    size_t contentLength = response.length();
+    if (eventStream) contentLength += sizeof(EVENT_PREFIX) - 1 + sizeof(EVENT_SUFFIX) - 1;
+
+    String head;
+    head.reserve(192 + response.json.length());
+    head = hasBody ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 202 Accepted\r\n";
+    if (hasBody) {
+        head += "Content-Type: ";
+        head += eventStream ? "text/event-stream" : "application/json";
+        head += "\r\n";
+    }
+    head += "Content-Length: ";
+    head += contentLength;
+    head += "\r\nConnection: ";
+    head += connection;
+    head += "\r\nAccess-Control-Allow-Origin: *\r\n\r\n";
+    if (eventStream) head += EVENT_PREFIX;
+
+    // Headers and envelope in one write; a cached result follows straight
+    // from PSRAM without being copied
+    head += response.json;
+    client.write((const uint8_t*)head.c_str(), head.length());
+    if (response.result) client.write((const uint8_t*)response.result, response.resultLength);
+    if (eventStream) client.print(EVENT_SUFFIX);
+
+    stats.httpCalls++;
+    stats.httpCallUs += micros() - conn.startUs;
+
+    if (!keepAlive) client.stop();
+    return keepAlive;
+}
+
+//=============================================================================
+// Keep-Alive Connections
+//=============================================================================
+
+MCPConnection* MCPServer::freeConnectionSlot() {
+    for (int i = 0; i < MCP_MAX_HTTP_CONNECTIONS; i++) {
+        if (!connections[i].active) return &connections[i];
+    }
+    return nullptr;
+}
+
+void MCPServer::closeConnection(MCPConnection& conn) {
+    if (conn.awaitingTool) cancelPendingCalls(&conn, nullptr);
+    conn.awaitingTool = false;
+    conn.client.stop();
+    conn.active = false;
+    conn.bodyLength = 0;
+}
+
+void MCPServer::serviceConnections() {
+    uint32_t now = millis();
+
+    for (int i = 0; i < MCP_MAX_HTTP_CONNECTIONS; i++) {
+        MCPConnection& conn = connections[i];
+        if (!conn.active) continue;
+
+        if (conn.awaitingTool) {
+            // Held for its tool result; only a hang-up is noticed meanwhile
+            if (!conn.client.connected()) closeConnection(conn);
+            continue;
+        }
+
+        if (!conn.parser.isIdle() && (micros() - conn.startUs) / 1000 >= MCP_REQUEST_TIMEOUT_MS) {
+            // A request still incomplete this long is dropped, not waited for
+            Serial.println("[MCP] Request timed out");
+            sendStatus(conn.client, 408);
+            closeConnection(conn);
+        } else if (conn.client.available() > 0) {
+            serviceConnection(conn);
+        } else if (!conn.client.connected() || now - conn.lastActivity >= MCP_HTTP_IDLE_TIMEOUT_MS) {
+            closeConnection(conn);
+        }
+    }
+}
+
+int MCPServer::getConnectionCount() const {
+    int count = 0;
+    for (int i = 0; i < MCP_MAX_HTTP_CONNECTIONS; i++) {
+        if (connections[i].active) count++;
     }
+    return count;
 }
 
 //=============================================================================
@@ -243,14 +811,23 @@ void MCPServer::handleSSERequest(WiFiClient& client) {
         return;
     }
 
-    // Close any existing SSE connection
-    closeSSEConnection();
-
-    // Generate new session ID
-    sessionId = generateSessionId();
-    lastKeepAlive = millis();
+    MCPSession* session = openSession(client);
+    if (!session) {
+        stats.sessionsRejected++;
+        Serial.printf("[MCP] Session table full (%d), rejecting SSE client\n", MCP_MAX_SESSIONS);
+        client.print(
+            "HTTP/1.1 503 Service Unavailable\r\n"
+            "Retry-After: 5\r\n"
+            "Content-Length: 0\r\n"
+            "Connection: close\r\n"
+            "\r\n"
+        );
+        client.stop();
+        return;
+    }
 
-    Serial.printf("[MCP] SSE client connected (session=%s)\n", sessionId.c_str());
+    Serial.printf("[MCP] SSE client connected (session=%s, %d/%d)\n",
+                  session->id, getSessionCount(), MCP_MAX_SESSIONS);
 
     // Send SSE headers + endpoint event
     String response =
@@ -261,77 +838,87 @@ void MCPServer::handleSSERequest(WiFiClient& client) {
         "Access-Control-Allow-Origin: *\r\n"
         "\r\n"
         "event: endpoint\n"
-        "data: /mcp/message?sessionId=" + sessionId + "\n\n";
+        "data: /mcp/message?sessionId=" + String(session->id) + "\n\n";
 
     // Disable Nagle's algorithm so keepalives are sent immediately
-    client.setNoDelay(true);
-
-    client.print(response);
-    client.flush();
+    session->client.setNoDelay(true);
 
-    // Store client - DON'T call client.stop(), keep the connection open
-    sseClient = client;
+    // Goes through the queue like every other write on this stream
+    pushFrame(*session, response);
+    flushSession(*session);
 }
 
 //=============================================================================
 // Message Handler - POST /mcp/message?sessionId=xxx
 //=============================================================================
 
-void MCPServer::handleMessageRequest(WiFiClient& client, const String& uri, const String& body) {
+void MCPServer::handleMessageRequest(MCPConnection& conn) {
+    WiFiClient& client = conn.client;
     if (!enabled) {
-        client.print("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
-        client.stop();
+        sendStatus(client, 503);
         return;
     }
 
-    // Extract sessionId from query string
-    int qPos = uri.indexOf("sessionId=");
-    if (qPos >= 0) {
-        String paramSession = uri.substring(qPos + 10);
-        int ampPos = paramSession.indexOf('&');
-        if (ampPos >= 0) paramSession = paramSession.substring(0, ampPos);
-
-        if (sessionId.length() > 0 && sessionId != paramSession) {
-            client.print(
-                "HTTP/1.1 400 Bad Request\r\n"
-                "Content-Type: application/json\r\n"
-                "Content-Length: 27\r\n"
-                "Connection: close\r\n"
-                "Access-Control-Allow-Origin: *\r\n"
-                "\r\n"
-                "{\"error\":\"Invalid session\"}"
-            );
-            client.stop();
-            return;
+    // Route by sessionId; clients that omit it are only accepted when the
+    // session they mean is unambiguous
+    MCPSession* session = nullptr;
+    const char* param = strstr(conn.parser.getUri(), "sessionId=");
+    if (param) {
+        param += 10;
+        session = findSession(param, strcspn(param, "&"));
+    } else if (getSessionCount() == 1) {
+        for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+            if (sessions[i].active) session = &sessions[i];
         }
     }
 
-    // Check SSE connection is alive
-    if (!sseClient || !sseClient.connected()) {
+    if (!session || !session->client.connected()) {
+        stats.unknownSession++;
         client.print(
-            "HTTP/1.1 400 Bad Request\r\n"
+            "HTTP/1.1 404 Not Found\r\n"
             "Content-Type: application/json\r\n"
-            "Content-Length: 28\r\n"
+            "Content-Length: 29\r\n"
             "Connection: close\r\n"
             "Access-Control-Allow-Origin: *\r\n"
             "\r\n"
-            "{\"error\":\"No SSE connection\"}"
+            "{\"error\":\"Session not found\"}"
         );
         client.stop();
         return;
     }
 
-    Serial.printf("[MCP] Message: %.100s%s\n", body.c_str(), (body.length() > 100) ? "..." : "");
+    // Backpressure: don't run a request whose response has nowhere to go
+    if (session->queueCount >= MCP_SESSION_QUEUE_DEPTH && !flushSession(*session)) {
+        session = nullptr;
+    }
+    if (!session || session->queueCount >= MCP_SESSION_QUEUE_DEPTH) {
+        stats.backpressured++;
+        client.print(
+            "HTTP/1.1 429 Too Many Requests\r\n"
+            "Retry-After: 1\r\n"
+            "Content-Length: 0\r\n"
+            "Connection: close\r\n"
+            "Access-Control-Allow-Origin: *\r\n"
+            "\r\n"
+        );
+        client.stop();
+        return;
+    }
 
     // Process JSON-RPC and get response
-    String response = processJsonRpc(body.c_str());
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, (const char*)conn.body, conn.bodyLength);
+    MCPResponse response;
+    if (error || !deferToolCall(doc, nullptr, session, response)) {
+        response = processJsonRpc(doc, error, session);
+    }
 
-    // Send response via SSE (if there is one - notifications have no response)
-    if (response.length() > 0) {
-        if (!sendSSEEvent(response)) {
-            Serial.println("[MCP] Failed to send SSE response");
-        }
+    // Queue response on this session's stream (notifications have no response)
+    if (!response.isEmpty() && queueEvent(*session, response)) {
+        flushSession(*session);
     }
+    stats.sseCalls++;
+    stats.sseCallUs += micros() - conn.startUs;
 
     // Drain any unread data to prevent RST on close
     while (client.available()) client.read();
@@ -354,40 +941,94 @@ void MCPServer::handleMessageRequest(WiFiClient& client, const String& uri, cons
 // JSON-RPC Processing
 //=============================================================================
 
-String MCPServer::processJsonRpc(const char* body) {
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, body);
+MCPResponse MCPServer::processJsonRpc(JsonDocument& doc, DeserializationError error,
+                                      MCPSession* session) {
     if (error) {
         return makeErrorResponse(0, -32700, "Parse error");
     }
+    if (doc.is<JsonArray>()) {
+        return processBatch(doc.as<JsonArray>(), session);
+    }
+    return processMessage(doc.as<JsonObject>(), session);
+}
 
-    const char* method = doc["method"];
-    if (!method) {
-        return makeErrorResponse(doc["id"] | 0, -32600, "Missing method");
+MCPResponse MCPServer::processBatch(JsonArray batch, MCPSession* session) {
+    size_t count = batch.size();
+    if (count == 0) {
+        return makeErrorResponse(0, -32600, "Empty batch");
+    }
+    if (count > MCP_MAX_BATCH_SIZE) {
+        return makeErrorResponse(0, -32600, "Batch too large");
+    }
+    stats.batches++;
+    stats.batchEntries += count;
+    Serial.printf("[MCP] Batch of %u messages\n", count);
+
+    // Entries run in order; a cached result is copied here since the
+    // replies share one body
+    MCPResponse combined;
+    combined.json = "[";
+    int replies = 0;
+    for (JsonVariant entry : batch) {
+        MCPResponse reply = processMessage(entry.as<JsonObject>(), session);
+        if (reply.isEmpty()) continue;     // Notification
+
+        combined.json.reserve(combined.json.length() + reply.length() + 2);
+        if (replies++ > 0) combined.json += ',';
+        combined.json += reply.json;
+        if (reply.result) combined.json.concat(reply.result, reply.resultLength);
     }
 
-    int id = doc["id"] | 0;
+    if (replies == 0) return MCPResponse();
+    combined.json += ']';
+    return combined;
+}
 
-    // Notifications (no id) - no response needed
-    if (strcmp(method, "notifications/initialized") == 0) {
-        Serial.println("[MCP] Client initialized");
-        return "";
+MCPResponse MCPServer::processMessage(JsonObject msg, MCPSession* session) {
+    // Notifications (no id) never get a response, not even an error
+    bool notification = msg["id"].isNull();
+    const char* method = msg["method"];
+    if (!method) {
+        return notification ? MCPResponse() : makeErrorResponse(msg["id"] | 0, -32600, "Missing method");
     }
-    if (strcmp(method, "notifications/cancelled") == 0) {
-        return "";
+
+    int id = msg["id"] | 0;
+    Serial.printf("[MCP] Request: %s\n", method);
+
+    if (notification) {
+        if (strcmp(method, "notifications/initialized") == 0) {
+            Serial.println("[MCP] Client initialized");
+        }
+        return MCPResponse();
     }
 
     // Methods that require a response
     if (strcmp(method, "initialize") == 0) {
-        return handleInitialize(id);
+        return handleInitialize(id, msg["params"]["protocolVersion"] | "");
     }
     if (strcmp(method, "tools/list") == 0) {
-        return handleToolsList(id);
+        uint32_t startUs = micros();
+        MCPResponse response = handleToolsList(id);
+        stats.toolsListCalls++;
+        stats.toolsListUs += micros() - startUs;
+        return response;
     }
     if (strcmp(method, "tools/call") == 0) {
-        JsonObject params = doc["params"];
+        JsonObject params = msg["params"];
         return handleToolsCall(id, params);
     }
+    if (strcmp(method, "resources/list") == 0) {
+        return cachedResponse(id, resourcesListCache);
+    }
+    if (strcmp(method, "resources/read") == 0) {
+        return handleResourcesRead(id, msg["params"]["uri"] | "");
+    }
+    if (strcmp(method, "resources/subscribe") == 0) {
+        return handleResourcesSubscribe(id, msg["params"]["uri"] | "", session, true);
+    }
+    if (strcmp(method, "resources/unsubscribe") == 0) {
+        return handleResourcesSubscribe(id, msg["params"]["uri"] | "", session, false);
+    }
     if (strcmp(method, "ping") == 0) {
         return handlePing(id);
     }
@@ -395,101 +1036,204 @@ String MCPServer::processJsonRpc(const char* body) {
     return makeErrorResponse(id, -32601, "Method not found");
 }
 
-String MCPServer::handleInitialize(int id) {
-    JsonDocument doc;
-    doc["jsonrpc"] = "2.0";
-    doc["id"] = id;
+MCPResponse MCPServer::handleInitialize(int id, const char* requestedVersion) {
+    // Streamable HTTP clients ask for the newer revision; everything else
+    // (mcp-remote over SSE) gets the original one
+    bool streamable = strcmp(requestedVersion, MCP_PROTOCOL_VERSION_STREAMABLE) == 0;
 
-    JsonObject result = doc["result"].to<JsonObject>();
-    result["protocolVersion"] = MCP_PROTOCOL_VERSION;
+    Serial.println("[MCP] Initialize handshake complete");
+    return cachedResponse(id, streamable ? initializeStreamableCache : initializeCache);
+}
 
-    JsonObject caps = result["capabilities"].to<JsonObject>();
-    caps["tools"].to<JsonObject>();  // Empty object = tools supported
+MCPResponse MCPServer::handleToolsList(int id) {
+    Serial.printf("[MCP] Listed %d tools\n", tools.size());
+    return cachedResponse(id, toolsListCache);
+}
 
-    JsonObject serverInfo = result["serverInfo"].to<JsonObject>();
-    serverInfo["name"] = MCP_SERVER_NAME;
-    serverInfo["version"] = MCP_SERVER_VERSION;
+String MCPServer::handleToolsCall(int id, JsonObject& params) {
+    String error = checkToolCall(id, params);
+    if (error.length() > 0) return error;
 
-    String response;
-    serializeJson(doc, response);
+    // Execute tool on the already parsed arguments
+    const char* toolName = params["name"];
+    String result;
+    if (toolExecutor) {
+        result = toolExecutor(toolName, params["arguments"].as<JsonObjectConst>());
+    } else {
+        result = "{\"error\":\"No tool executor configured\"}";
+    }
 
-    Serial.println("[MCP] Initialize handshake complete");
-    return response;
+    Serial.printf("[MCP] Tool called: %s\n", toolName);
+    return makeToolResult(id, result);
+}
+
+String MCPServer::checkToolCall(int id, JsonObject& params) {
+    const char* toolName = params["name"];
+    if (!toolName) {
+        return makeErrorResponse(id, -32602, "Missing tool name");
+    }
+
+    // Verify tool exists
+    for (const auto& t : tools) {
+        if (t.name == toolName) return String();
+    }
+    return makeErrorResponse(id, -32602, "Unknown tool");
 }
 
-String MCPServer::handleToolsList(int id) {
+String MCPServer::makeToolResult(int id, const String& result) {
     JsonDocument doc;
     doc["jsonrpc"] = "2.0";
     doc["id"] = id;
 
-    JsonArray toolsArray = doc["result"]["tools"].to<JsonArray>();
-
-    for (const auto& tool : tools) {
-        JsonObject t = toolsArray.add<JsonObject>();
-        t["name"] = tool.name;
-        t["description"] = tool.description;
-
-        // Parse schema string into JSON object
-        JsonDocument schemaDoc;
-        deserializeJson(schemaDoc, tool.inputSchema);
-        t["inputSchema"] = schemaDoc;
-    }
+    JsonArray content = doc["result"]["content"].to<JsonArray>();
+    JsonObject textBlock = content.add<JsonObject>();
+    textBlock["type"] = "text";
+    textBlock["text"] = result;
 
     String response;
     serializeJson(doc, response);
-
-    Serial.printf("[MCP] Listed %d tools\n", tools.size());
     return response;
 }
 
-String MCPServer::handleToolsCall(int id, JsonObject& params) {
-    const char* toolName = params["name"];
-    if (!toolName) {
-        return makeErrorResponse(id, -32602, "Missing tool name");
+//=============================================================================
+// Deferred Tool Calls
+//=============================================================================
+
+bool MCPServer::deferToolCall(JsonDocument& doc, MCPConnection* conn, MCPSession* session,
+                              MCPResponse& response) {
+    if (!deferredExecutor.start || !doc.is<JsonObject>()) return false;
+    JsonObject msg = doc.as<JsonObject>();
+    const char* method = msg["method"];
+    if (msg["id"].isNull() || !method || strcmp(method, "tools/call") != 0) return false;
+
+    int id = msg["id"] | 0;
+    JsonObject params = msg["params"];
+    String error = checkToolCall(id, params);
+    if (error.length() > 0) {
+        response = error;
+        return true;
     }
 
-    // Verify tool exists
-    bool found = false;
-    for (const auto& t : tools) {
-        if (t.name == toolName) { found = true; break; }
+    MCPPendingCall* call = nullptr;
+    for (int i = 0; i < MCP_MAX_PENDING_CALLS; i++) {
+        if (!pendingCalls[i].active) {
+            call = &pendingCalls[i];
+            break;
+        }
     }
-    if (!found) {
-        return makeErrorResponse(id, -32602, "Unknown tool");
+    if (!call) {
+        response = makeToolResult(id, "{\"error\":\"Device busy, try again\"}");
+        return true;
     }
 
-    // Get arguments
-    String arguments;
-    if (params["arguments"].is<JsonObject>()) {
-        serializeJson(params["arguments"], arguments);
-    } else {
-        arguments = "{}";
+    const char* toolName = params["name"];
+    String result;
+    int ticket = deferredExecutor.start(toolName, params["arguments"].as<JsonObjectConst>(), result);
+    Serial.printf("[MCP] Tool called: %s%s\n", toolName, ticket >= 0 ? " (deferred)" : "");
+    if (ticket < 0) {
+        response = makeToolResult(id, result);
+        return true;
     }
 
-    // Execute tool
-    String result;
-    if (toolExecutor) {
-        result = toolExecutor(toolName, arguments);
-    } else {
-        result = "{\"error\":\"No tool executor configured\"}";
+    call->active = true;
+    call->ticket = ticket;
+    call->id = id;
+    call->conn = conn;
+    call->session = session;
+    call->startMs = millis();
+    if (conn) conn->awaitingTool = true;
+    stats.toolCallsDeferred++;
+    return true;
+}
+
+void MCPServer::servicePendingCalls() {
+    for (int i = 0; i < MCP_MAX_PENDING_CALLS; i++) {
+        MCPPendingCall& call = pendingCalls[i];
+        if (!call.active) continue;
+
+        String result;
+        if (!deferredExecutor.poll(call.ticket, result)) continue;
+        call.active = false;
+
+        uint32_t waited = millis() - call.startMs;
+        if (waited > stats.maxToolWaitMs) stats.maxToolWaitMs = waited;
+
+        MCPResponse response = makeToolResult(call.id, result);
+        if (call.conn) {
+            MCPConnection& conn = *call.conn;
+            conn.awaitingTool = false;
+            if (sendStreamableResponse(conn, response)) {
+                // Ready for the next request, which may already be waiting
+                conn.lastActivity = millis();
+            } else {
+                conn.active = false;
+                conn.bodyLength = 0;
+            }
+        } else if (call.session && queueEvent(*call.session, response)) {
+            flushSession(*call.session);
+        }
     }
+}
+
+void MCPServer::cancelPendingCalls(const MCPConnection* conn, const MCPSession* session) {
+    for (int i = 0; i < MCP_MAX_PENDING_CALLS; i++) {
+        MCPPendingCall& call = pendingCalls[i];
+        if (!call.active) continue;
+        if ((conn && call.conn == conn) || (session && call.session == session)) {
+            deferredExecutor.cancel(call.ticket);
+            call.active = false;
+            stats.toolCallsCancelled++;
+        }
+    }
+}
+
+String MCPServer::handleResourcesRead(int id, const char* uri) {
+    int index = findResource(uri);
+    if (index < 0) {
+        return makeErrorResponse(id, -32002, "Resource not found");
+    }
+    const MCPResource& resource = resources[index];
+    stats.resourceReads++;
 
-    // Build MCP response
     JsonDocument doc;
     doc["jsonrpc"] = "2.0";
     doc["id"] = id;
 
-    JsonArray content = doc["result"]["content"].to<JsonArray>();
-    JsonObject textBlock = content.add<JsonObject>();
-    textBlock["type"] = "text";
-    textBlock["text"] = result;
+    JsonObject content = doc["result"]["contents"].to<JsonArray>().add<JsonObject>();
+    content["uri"] = resource.uri;
+    content["mimeType"] = "application/json";
+    content["text"] = resource.reader ? resource.reader() : String("{}");
 
     String response;
     serializeJson(doc, response);
-
-    Serial.printf("[MCP] Tool called: %s\n", toolName);
     return response;
 }
 
+String MCPServer::handleResourcesSubscribe(int id, const char* uri, MCPSession* session,
+                                           bool subscribe) {
+    int index = findResource(uri);
+    if (index < 0) {
+        return makeErrorResponse(id, -32002, "Resource not found");
+    }
+    if (!session) {
+        // Streamable HTTP replies carry one response and nothing after it
+        return makeErrorResponse(id, -32600, "Subscriptions need the SSE transport");
+    }
+
+    uint32_t bit = 1u << index;
+    if (subscribe) {
+        session->subscriptions |= bit;
+    } else {
+        session->subscriptions &= ~bit;
+        session->pendingUpdates &= ~bit;
+    }
+    updateSubscribedResources();
+
+    Serial.printf("[MCP] Session %.8s %s %s\n", session->id,
+                  subscribe ? "subscribed to" : "unsubscribed from", uri);
+    return handlePing(id);  // Empty result
+}
+
 String MCPServer::handlePing(int id) {
     JsonDocument doc;
     doc["jsonrpc"] = "2.0";
@@ -514,50 +1258,341 @@ String MCPServer::makeErrorResponse(int id, int code, const char* message) {
 }
 
 //=============================================================================
-// SSE Helpers
+// Response Cache
 //=============================================================================
 
-bool MCPServer::sendSSEEvent(const String& json) {
-    if (!sseClient || !sseClient.connected()) return false;
+/**
+ * Counts what a rebuild allocates - the same churn an uncached tools/list
+ * used to cause on every call.
+ */
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+    uint32_t allocations = 0;
+    uint32_t bytes = 0;
+
+    void* allocate(size_t size) override {
+        allocations++;
+        bytes += size;
+        return PsramAllocator::instance().allocate(size);
+    }
 
-    String event = "event: message\ndata: " + json + "\n\n";
+    void deallocate(void* ptr) override {
+        PsramAllocator::instance().deallocate(ptr);
+    }
 
-    size_t written = sseClient.print(event);
-    if (written == 0) {
-        Serial.println("[MCP] SSE send failed - client disconnected?");
-        closeSSEConnection();
-        return false;
+    void* reallocate(void* ptr, size_t newSize) override {
+        allocations++;
+        bytes += newSize;
+        return PsramAllocator::instance().reallocate(ptr, newSize);
     }
+};
+
+void MCPServer::freeCache(MCPCachedResult& cache) {
+    if (cache.json) heap_caps_free(cache.json);
+    cache.json = nullptr;
+    cache.length = 0;
+}
+
+bool MCPServer::storeCache(MCPCachedResult& cache, JsonDocument& doc) {
+    size_t length = measureJson(doc);
+
+    // Result, envelope's closing brace, terminator
+    char* buf = (char*)heap_caps_malloc(length + 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) buf = (char*)malloc(length + 2);
+    if (!buf) return false;
+
+    serializeJson(doc, buf, length + 1);
+    buf[length] = '}';
+    buf[length + 1] = '\0';
 
-    sseClient.flush();
+    freeCache(cache);
+    cache.json = buf;
+    cache.length = length + 1;
     return true;
 }
 
-void MCPServer::sendKeepAlive() {
-    if (!sseClient || !sseClient.connected()) return;
+void MCPServer::rebuildCache() {
+    uint32_t startUs = micros();
+    uint32_t version = toolsVersion;
+    CountingAllocator allocator;
+    bool ok = true;
+
+    // tools/list result
+    {
+        JsonDocument doc(&allocator);
+        JsonArray toolsArray = doc["tools"].to<JsonArray>();
+
+        for (const auto& tool : tools) {
+            JsonObject t = toolsArray.add<JsonObject>();
+            t["name"] = tool.name;
+            t["description"] = tool.description;
+
+            // Parse schema string into JSON object
+            JsonDocument schemaDoc(&allocator);
+            deserializeJson(schemaDoc, tool.inputSchema);
+            t["inputSchema"] = schemaDoc;
+        }
+        ok &= storeCache(toolsListCache, doc);
+    }
+
+    // resources/list result
+    {
+        JsonDocument doc(&allocator);
+        JsonArray list = doc["resources"].to<JsonArray>();
+
+        for (const auto& resource : resources) {
+            JsonObject r = list.add<JsonObject>();
+            r["uri"] = resource.uri;
+            r["name"] = resource.name;
+            r["description"] = resource.description;
+            r["mimeType"] = "application/json";
+        }
+        ok &= storeCache(resourcesListCache, doc);
+    }
 
-    size_t written = sseClient.print(": keepalive\n\n");
-    if (written == 0) {
-        Serial.println("[MCP] Keepalive failed - closing SSE");
-        closeSSEConnection();
+    // initialize result, once per protocol revision
+    const char* versions[] = { MCP_PROTOCOL_VERSION, MCP_PROTOCOL_VERSION_STREAMABLE };
+    MCPCachedResult* caches[] = { &initializeCache, &initializeStreamableCache };
+    for (int i = 0; i < 2; i++) {
+        JsonDocument doc(&allocator);
+        doc["protocolVersion"] = versions[i];
+
+        JsonObject caps = doc["capabilities"].to<JsonObject>();
+        caps["tools"].to<JsonObject>();  // Empty object = tools supported
+        if (!resources.empty()) {
+            JsonObject res = caps["resources"].to<JsonObject>();
+            res["subscribe"] = true;
+            res["listChanged"] = false;
+        }
+
+        JsonObject serverInfo = doc["serverInfo"].to<JsonObject>();
+        serverInfo["name"] = MCP_SERVER_NAME;
+        serverInfo["version"] = MCP_SERVER_VERSION;
+        ok &= storeCache(*caches[i], doc);
+    }
+
+    if (!ok) {
+        Serial.println("[MCP] Out of memory building response cache");
         return;
     }
-    sseClient.flush();
+
+    cacheVersion = version;
+    stats.cacheBuilds++;
+    stats.cacheBuildUs = micros() - startUs;
+    stats.cacheBuildAllocs = allocator.allocations;
+    stats.cacheBuildBytes = allocator.bytes;
+    stats.cacheBytes = toolsListCache.length + resourcesListCache.length +
+                       initializeCache.length + initializeStreamableCache.length;
+
+    Serial.printf("[MCP] Cached tools/list (%d tools, %u bytes) in %lu us, %lu allocations\n",
+                  tools.size(), toolsListCache.length, stats.cacheBuildUs,
+                  stats.cacheBuildAllocs);
+}
+
+MCPResponse MCPServer::cachedResponse(int id, const MCPCachedResult& cache) {
+    if (cacheVersion != toolsVersion) rebuildCache();
+    if (!cache.json) return makeErrorResponse(id, -32603, "Internal error");
+
+    MCPResponse response;
+    response.json.reserve(48);
+    response.json = "{\"jsonrpc\":\"2.0\",\"id\":";
+    response.json += id;
+    response.json += ",\"result\":";
+    response.result = cache.json;
+    response.resultLength = cache.length;
+    stats.cachedResponses++;
+    return response;
+}
+
+//=============================================================================
+// Sessions
+//=============================================================================
+
+MCPSession* MCPServer::openSession(WiFiClient& client) {
+    MCPSession* slot = nullptr;
+    for (int i = 0; i < MCP_MAX_SESSIONS && !slot; i++) {
+        // A slot whose client went away is reused before serviceSessions() reaps it
+        if (sessions[i].active && !sessions[i].client.connected()) {
+            closeSession(sessions[i]);
+        }
+        if (!sessions[i].active) slot = &sessions[i];
+    }
+    if (!slot) return nullptr;
+
+    slot->client = client;
+    generateSessionId(slot->id);
+    slot->active = true;
+    slot->connectedAt = millis();
+    slot->lastWrite = slot->connectedAt;
+    slot->queueHead = 0;
+    slot->queueCount = 0;
+    slot->sendOffset = 0;
+    slot->eventsSent = 0;
+    slot->eventsDropped = 0;
+    slot->subscriptions = 0;
+    slot->pendingUpdates = 0;
+    stats.sessionsOpened++;
+    return slot;
 }
 
-void MCPServer::closeSSEConnection() {
-    if (sseClient && sseClient.connected()) {
-        Serial.println("[MCP] Closing SSE connection");
-        sseClient.stop();
+MCPSession* MCPServer::findSession(const char* id, size_t length) {
+    if (length != MCP_SESSION_ID_LENGTH) return nullptr;
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        if (sessions[i].active && memcmp(id, sessions[i].id, length) == 0) return &sessions[i];
     }
-    sessionId = "";
+    return nullptr;
+}
+
+void MCPServer::closeSession(MCPSession& session) {
+    if (!session.active) return;
+
+    // Tool results with nowhere to go
+    cancelPendingCalls(nullptr, &session);
+
+    // Events that never reached the client
+    if (session.queueCount > 0) {
+        session.eventsDropped += session.queueCount;
+        stats.eventsDropped += session.queueCount;
+    }
+    for (int i = 0; i < MCP_SESSION_QUEUE_DEPTH; i++) {
+        session.queue[i] = String();
+    }
+    session.queueCount = 0;
+    session.sendOffset = 0;
+
+    Serial.printf("[MCP] Session %.8s closed (sent=%lu, dropped=%lu)\n",
+                  session.id, session.eventsSent, session.eventsDropped);
+    session.client.stop();
+    session.active = false;
+    session.id[0] = '\0';
+    session.subscriptions = 0;
+    session.pendingUpdates = 0;
+    updateSubscribedResources();
+    stats.sessionsClosed++;
+}
+
+bool MCPServer::pushFrame(MCPSession& session, const String& frame) {
+    if (session.queueCount >= MCP_SESSION_QUEUE_DEPTH) return false;
+
+    uint8_t tail = (session.queueHead + session.queueCount) % MCP_SESSION_QUEUE_DEPTH;
+    session.queue[tail] = frame;
+    session.queueCount++;
+    if (session.queueCount > stats.maxQueueDepth) stats.maxQueueDepth = session.queueCount;
+    return true;
+}
+
+bool MCPServer::queueEvent(MCPSession& session, const MCPResponse& response) {
+    // The frame is the only copy of a cached result, sized up front
+    String frame;
+    frame.reserve(response.length() + 24);
+    frame = "event: message\ndata: ";
+    frame += response.json;
+    if (response.result) frame.concat(response.result, response.resultLength);
+    frame += "\n\n";
+
+    if (!pushFrame(session, frame)) {
+        session.eventsDropped++;
+        stats.eventsDropped++;
+        Serial.printf("[MCP] Session %.8s queue full, event dropped\n", session.id);
+        return false;
+    }
+    stats.eventsQueued++;
+    return true;
+}
+
+bool MCPServer::flushSession(MCPSession& session) {
+    int fd = session.client.fd();
+
+    while (session.queueCount > 0) {
+        String& frame = session.queue[session.queueHead];
+        size_t remaining = frame.length() - session.sendOffset;
+
+        // Write what the socket buffer takes now; the rest waits for the next pass
+        int sent = send(fd, frame.c_str() + session.sendOffset, remaining, MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            Serial.printf("[MCP] Session %.8s send failed (errno=%d)\n", session.id, errno);
+            closeSession(session);
+            return false;
+        }
+
+        session.lastWrite = millis();
+        session.sendOffset += sent;
+        if (session.sendOffset < frame.length()) return true;
+
+        // Headers and keepalive comments are not counted as events
+        if (frame.startsWith("event: message")) {
+            session.eventsSent++;
+            stats.eventsSent++;
+        }
+        frame = String();
+        session.sendOffset = 0;
+        session.queueHead = (session.queueHead + 1) % MCP_SESSION_QUEUE_DEPTH;
+        session.queueCount--;
+    }
+    return true;
+}
+
+void MCPServer::serviceSessions() {
+    uint32_t now = millis();
+
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        MCPSession& session = sessions[i];
+        if (!session.active) continue;
+
+        while (session.client.available() > 0) session.client.read();
+
+        if (!session.client.connected()) {
+            Serial.printf("[MCP] SSE connection lost (session=%.8s)\n", session.id);
+            closeSession(session);
+            continue;
+        }
+
+        queueResourceUpdates(session);
+
+        // Only idle streams need a keepalive
+        if (session.queueCount == 0 && now - session.lastWrite >= MCP_KEEPALIVE_INTERVAL_MS) {
+            pushFrame(session, ": keepalive\n\n");
+        }
+
+        flushSession(session);
+    }
+}
+
+int MCPServer::getSessionCount() const {
+    int count = 0;
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        if (sessions[i].active) count++;
+    }
+    return count;
+}
+
+int MCPServer::getQueueDepth() const {
+    int depth = 0;
+    for (int i = 0; i < MCP_MAX_SESSIONS; i++) {
+        if (sessions[i].active) depth += sessions[i].queueCount;
+    }
+    return depth;
+}
+
+bool MCPServer::getSessionInfo(int slot, MCPSessionInfo& info) const {
+    if (slot < 0 || slot >= MCP_MAX_SESSIONS) return false;
+    const MCPSession& session = sessions[slot];
+    if (!session.active) return false;
+
+    strncpy(info.id, session.id, sizeof(info.id) - 1);
+    info.id[sizeof(info.id) - 1] = '\0';
+    info.ageMs = millis() - session.connectedAt;
+    info.queued = session.queueCount;
+    info.eventsSent = session.eventsSent;
+    info.eventsDropped = session.eventsDropped;
+    info.subscriptions = __builtin_popcount(session.subscriptions);
+    return true;
 }
 
-String MCPServer::generateSessionId() {
-    char id[33];
-    for (int i = 0; i < 32; i++) {
-        id[i] = "0123456789abcdef"[esp_random() % 16];
+void MCPServer::generateSessionId(char* out) {
+    for (int i = 0; i < MCP_SESSION_ID_LENGTH; i++) {
+        out[i] = "0123456789abcdef"[esp_random() % 16];
     }
-    id[32] = '\0';
-    return String(id);
+    out[MCP_SESSION_ID_LENGTH] = '\0';
 }
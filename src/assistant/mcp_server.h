@@ -5,13 +5,40 @@
  * Exposes DeskBuddy tools via the Model Context Protocol using
  * the legacy HTTP+SSE transport (compatible with mcp-remote).
  *
- * Runs a dedicated TCP server in its own FreeRTOS task on a separate
- * port (default 3001). This ensures fast response times regardless
- * of main loop timing.
+ * Runs a dedicated TCP server in its own FreeRTOS task on core 0 on a
+ * separate port (default 3001). The task blocks in select() until a
+ * socket is ready or a keepalive is due, so it neither adds polling
+ * latency nor competes with the render loop.
  *
- * Transport:
- * - GET  /sse             - SSE stream (sends endpoint event, keeps alive)
- * - POST /mcp/message     - JSON-RPC messages from client
+ * Transports:
+ * - POST /mcp             - Streamable HTTP: JSON-RPC in, response in the
+ *                           reply (JSON or a single SSE event), keep-alive
+ * - GET  /sse             - Legacy SSE stream (sends endpoint event, keeps alive)
+ * - POST /mcp/message     - Legacy JSON-RPC messages, responses go to the stream
+ *
+ * Several clients can be connected at once (MCP_MAX_SESSIONS). Each GET
+ * /sse opens its own session with a private SSE stream, outbound event
+ * queue and keepalive timer; POSTs are routed by their sessionId. Events
+ * are written without blocking, so one slow client cannot stall the
+ * others - when its queue is full further POSTs get 429 until it drains.
+ *
+ * Resources: device state is also exposed as MCP resources. An SSE
+ * session can resources/subscribe to them; the firmware marks a resource
+ * changed with notifyResourceUpdated() from any task, and the server task
+ * pushes notifications/resources/updated to subscribers. Changes closer
+ * together than the update interval are coalesced into one notification.
+ *
+ * Batches: both transports accept a JSON-RPC batch array. Its entries are
+ * run in one pass and the replies go back together as one array - one
+ * HTTP body or one SSE event.
+ *
+ * Tool calls: a tools/call on its own is handed to the deferred executor
+ * and the task goes back to select(); the reply is sent when a later
+ * pass finds the call done, on the same connection or session stream.
+ * Meanwhile that /mcp connection is held and not read. A tools/call
+ * inside a batch runs through the blocking executor instead, so a batch
+ * that calls a tool stalls every client until the tool returns (up to the
+ * executor's own timeout).
  */
 
 #ifndef MCP_SERVER_H
@@ -20,6 +47,9 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <ArduinoJson.h>
+#include <lwip/sockets.h>
+#include "../network/http_request_parser.h"
+#include <atomic>
 #include <functional>
 #include <vector>
 
@@ -28,6 +58,7 @@
 //=============================================================================
 
 #define MCP_PROTOCOL_VERSION "2024-11-05"
+#define MCP_PROTOCOL_VERSION_STREAMABLE "2025-03-26"
 #define MCP_SERVER_NAME "DeskBuddy"
 #define MCP_SERVER_VERSION "1.0.0"
 
@@ -40,6 +71,51 @@
 /** Stack size for MCP server task */
 #define MCP_TASK_STACK_SIZE 8192
 
+/** Concurrent SSE sessions (clients beyond this get 503) */
+#define MCP_MAX_SESSIONS 4
+
+/** Outbound events buffered per session before backpressure applies */
+#define MCP_SESSION_QUEUE_DEPTH 8
+
+/** Session ID length (hex characters) */
+#define MCP_SESSION_ID_LENGTH 32
+
+/** Open HTTP connections (in-flight and kept-alive) */
+#define MCP_MAX_HTTP_CONNECTIONS 4
+
+/** Close a kept-alive connection after this long without a request */
+#define MCP_HTTP_IDLE_TIMEOUT_MS 15000
+
+/** Longest time from a request's first byte to its last body byte */
+#define MCP_REQUEST_TIMEOUT_MS 5000
+
+/** Longest select() wait, bounds how long end() waits for the task */
+#define MCP_SELECT_MAX_WAIT_MS 1000
+
+/**
+ * Largest accepted JSON-RPC request body (bytes) - bounds the parsed
+ * document. Each connection slot holds a buffer this size in PSRAM.
+ */
+#define MCP_MAX_BODY_SIZE (64 * 1024)
+
+/** Bytes read from a socket per parser pass */
+#define MCP_READ_CHUNK_SIZE 256
+
+/** Most resources (one bit each in the subscription masks) */
+#define MCP_MAX_RESOURCES 16
+
+/** Default minimum time between update notifications for one resource */
+#define MCP_RESOURCE_UPDATE_INTERVAL_MS 250
+
+/** Most entries in one JSON-RPC batch */
+#define MCP_MAX_BATCH_SIZE 16
+
+/** Tool calls waiting for their result at once (more are answered busy) */
+#define MCP_MAX_PENDING_CALLS 4
+
+/** Longest select() wait while a tool call is pending (ms) */
+#define MCP_PENDING_POLL_MS 10
+
 //=============================================================================
 // Tool Definition
 //=============================================================================
@@ -50,7 +126,210 @@ struct MCPTool {
     String inputSchema;  ///< JSON schema string
 };
 
-using MCPToolExecutor = std::function<String(const String& toolName, const String& arguments)>;
+//=============================================================================
+// Resource Definition
+//=============================================================================
+
+/** Returns the resource's current contents as JSON text (server task) */
+using MCPResourceReader = std::function<String()>;
+
+struct MCPResource {
+    String uri;
+    String name;
+    String description;
+    MCPResourceReader reader;
+    uint32_t lastNotify;        ///< millis() of the last update notification
+};
+
+//=============================================================================
+// Sessions
+//=============================================================================
+
+/**
+ * @struct MCPSession
+ * @brief One connected SSE client
+ *
+ * Owned by the server task; other tasks only read counters through
+ * getSessionInfo().
+ */
+struct MCPSession {
+    WiFiClient client;
+    char id[MCP_SESSION_ID_LENGTH + 1];
+    bool active;
+    uint32_t connectedAt;                       ///< millis() at GET /sse
+    uint32_t lastWrite;                         ///< Last event or keepalive sent
+    String queue[MCP_SESSION_QUEUE_DEPTH];      ///< Framed SSE events, ring buffer
+    uint8_t queueHead;
+    uint8_t queueCount;
+    size_t sendOffset;                          ///< Bytes of the head frame already sent
+    uint32_t eventsSent;
+    uint32_t eventsDropped;
+    uint32_t subscriptions;                     ///< Bit per subscribed resource
+    uint32_t pendingUpdates;                    ///< Notifications not yet queued
+};
+
+/**
+ * @struct MCPConnection
+ * @brief HTTP connection with its own incremental request parser
+ *
+ * A request may arrive over several select() wakeups; the parser keeps
+ * the partial state and the body collects in the slot's buffer until
+ * Content-Length bytes are in, so the server task never waits on one
+ * client's socket. The buffer is allocated once per slot in begin() and
+ * reused by every request and connection that lands in the slot.
+ */
+struct MCPConnection {
+    WiFiClient client;
+    HttpRequestParser parser;
+    uint8_t* body;                  ///< MCP_MAX_BODY_SIZE bytes (PSRAM), from begin() to end()
+    uint32_t bodyLength;
+    bool active;
+    bool acceptsJson;               ///< From the Accept header
+    bool acceptsEventStream;
+    uint32_t lastActivity;
+    uint32_t startUs;               ///< First byte of the current request
+    uint32_t requests;              ///< Requests served on this connection
+    bool keepAlive;                 ///< The current request keeps the connection
+    bool awaitingTool;              ///< Held for a deferred tools/call reply
+};
+
+/**
+ * @struct MCPPendingCall
+ * @brief A deferred tools/call and where its reply goes
+ */
+struct MCPPendingCall {
+    bool active;
+    int ticket;                     ///< From the deferred executor's start()
+    int id;                         ///< JSON-RPC id to answer
+    MCPConnection* conn;            ///< Streamable HTTP: reply on this connection
+    MCPSession* session;            ///< SSE: reply on this session's stream
+    uint32_t startMs;
+};
+
+/**
+ * @struct MCPSessionInfo
+ * @brief Snapshot of one session for status reporting
+ */
+struct MCPSessionInfo {
+    char id[9];                 ///< First 8 characters of the session ID
+    uint32_t ageMs;
+    uint8_t queued;
+    uint32_t eventsSent;
+    uint32_t eventsDropped;
+    uint8_t subscriptions;      ///< Resources subscribed to
+};
+
+/**
+ * @struct MCPServerStats
+ * @brief Session and queue counters since boot
+ */
+struct MCPServerStats {
+    uint32_t sessionsOpened;
+    uint32_t sessionsClosed;
+    uint32_t sessionsRejected;  ///< GET /sse refused, table full
+    uint32_t unknownSession;    ///< POSTs for a session that does not exist
+    uint32_t eventsQueued;
+    uint32_t eventsSent;
+    uint32_t eventsDropped;     ///< Discarded: queue full or session closed with events pending
+    uint32_t backpressured;     ///< POSTs refused with 429 while their queue was full
+    uint8_t maxQueueDepth;      ///< Deepest any session queue has been
+
+    // Per-call cost by transport: request line read to response written
+    uint32_t connectionsAccepted;
+    uint32_t connectionsReused; ///< Requests served on a kept-alive connection
+    uint32_t sseCalls;          ///< POST /mcp/message
+    uint64_t sseCallUs;
+    uint32_t httpCalls;         ///< POST /mcp
+    uint64_t httpCallUs;
+
+    // tools/call answered after the server task went back to select()
+    uint32_t toolCallsDeferred;
+    uint32_t toolCallsCancelled;    ///< Client gone before the result
+    uint32_t maxToolWaitMs;         ///< Longest hand-over to result
+
+    // Server task
+    uint32_t requests;          ///< HTTP requests of any kind
+    uint64_t requestUs;         ///< Total time handling them
+    uint32_t maxRequestUs;
+    uint32_t wakeups;           ///< Returns from select()
+    uint64_t busyUs;            ///< Time spent outside select()
+    uint32_t taskStartMs;
+
+    // Pre-serialized responses
+    uint32_t cacheBuilds;       ///< Rebuilds after the tool set changed
+    uint32_t cacheBuildUs;      ///< Last rebuild: cost of one uncached tools/list + initialize
+    uint32_t cacheBuildAllocs;  ///< Last rebuild: heap allocations it made
+    uint32_t cacheBuildBytes;   ///< Last rebuild: bytes allocated
+    uint32_t cacheBytes;        ///< PSRAM held by the caches
+    uint32_t cachedResponses;   ///< Replies served from cache
+    uint32_t toolsListCalls;
+    uint64_t toolsListUs;       ///< Time producing tools/list replies
+
+    // Resources
+    uint32_t resourceReads;
+    uint32_t resourceChanges;   ///< notifyResourceUpdated() calls for subscribed resources
+    uint32_t resourceCoalesced; ///< Changes folded into an update already pending
+    uint32_t resourceUpdates;   ///< notifications/resources/updated queued
+
+    // JSON-RPC batches
+    uint32_t batches;
+    uint32_t batchEntries;      ///< Requests and notifications they carried
+};
+
+//=============================================================================
+// Responses
+//=============================================================================
+
+/**
+ * @struct MCPCachedResult
+ * @brief Pre-serialized JSON-RPC result in PSRAM
+ *
+ * Holds the result object followed by the closing brace of the response
+ * envelope, so a reply is the envelope head plus these bytes as-is.
+ */
+struct MCPCachedResult {
+    char* json;
+    size_t length;
+};
+
+/**
+ * @struct MCPResponse
+ * @brief JSON-RPC response, optionally ending in a cached result
+ *
+ * A cached result is not copied: the envelope head is written and then
+ * the cache bytes. Valid only until the cache is rebuilt, i.e.
+ * within the server task's handling of one request.
+ */
+struct MCPResponse {
+    String json;                ///< Whole response, or the envelope up to "result":
+    const char* result;         ///< Cached result bytes (not owned)
+    size_t resultLength;
+
+    MCPResponse() : result(nullptr), resultLength(0) {}
+    MCPResponse(const String& s) : json(s), result(nullptr), resultLength(0) {}
+    MCPResponse(const char* s) : json(s), result(nullptr), resultLength(0) {}
+
+    bool isEmpty() const { return json.length() == 0; }
+    size_t length() const { return json.length() + (result ? resultLength : 0); }
+};
+
+/** Runs a tool on the arguments parsed with the request (null object for none) */
+using MCPToolExecutor = std::function<String(const char* toolName, JsonObjectConst arguments)>;
+
+/**
+ * @struct MCPDeferredToolExecutor
+ * @brief Runs a tool without holding up the server task
+ *
+ * start() hands the call over (copying what it needs) and returns a
+ * ticket, or -1 with the result already set. poll() sets the result and
+ * returns true once the call is done; cancel() drops a call whose client
+ * went away. All three are called on the server task.
+ */
+struct MCPDeferredToolExecutor {
+    std::function<int(const char* toolName, JsonObjectConst arguments, String& result)> start;
+    std::function<bool(int ticket, String& result)> poll;
+    std::function<void(int ticket)> cancel;
+};
 
 //=============================================================================
 // MCPServer Class
@@ -82,8 +361,44 @@ public:
     void addTool(const char* name, const char* description, const char* inputSchema);
     void removeTool(const char* name);
     void clearTools();
+    /** Called on the server task; hand the work to the main loop if it needs it */
     void setToolExecutor(MCPToolExecutor executor) { toolExecutor = executor; }
 
+    /** Used for tools/calls outside a batch when set (see the file comment) */
+    void setDeferredToolExecutor(const MCPDeferredToolExecutor& executor) { deferredExecutor = executor; }
+
+    //-------------------------------------------------------------------------
+    // Resources
+    //-------------------------------------------------------------------------
+
+    /**
+     * @brief Expose a resource (before begin())
+     * @return false if the URI exists or MCP_MAX_RESOURCES is reached
+     */
+    bool addResource(const char* uri, const char* name, const char* description,
+                     MCPResourceReader reader);
+
+    /**
+     * @brief Mark a resource changed - callable from any task
+     *
+     * Cheap when nobody subscribes. Otherwise subscribers get one
+     * notification per update interval however often this is called.
+     */
+    void notifyResourceUpdated(const char* uri);
+
+    /**
+     * @brief Minimum time between notifications for one resource (ms)
+     */
+    void setResourceUpdateInterval(uint32_t ms) { resourceUpdateInterval = ms; }
+    uint32_t getResourceUpdateInterval() const { return resourceUpdateInterval; }
+
+    int getResourceCount() const { return resources.size(); }
+
+    /**
+     * @brief Resources with at least one subscriber (bit per resource)
+     */
+    uint32_t getSubscribedResources() const { return subscribedResources.load(); }
+
     //-------------------------------------------------------------------------
     // State
     //-------------------------------------------------------------------------
@@ -91,9 +406,47 @@ public:
     bool isEnabled() const { return enabled; }
     void setEnabled(bool enable) { enabled = enable; }
     int getToolCount() const { return tools.size(); }
-    bool hasSSEClient() { return sseClient && sseClient.connected(); }
+    bool hasSSEClient() const { return getSessionCount() > 0; }
     uint16_t getPort() const { return port; }
 
+    //-------------------------------------------------------------------------
+    // Sessions
+    //-------------------------------------------------------------------------
+
+    /**
+     * @brief Number of connected SSE sessions
+     */
+    int getSessionCount() const;
+
+    /**
+     * @brief Events waiting to be written, across all sessions
+     */
+    int getQueueDepth() const;
+
+    /**
+     * @brief Snapshot of a session slot
+     * @param slot 0 .. MCP_MAX_SESSIONS-1
+     * @return false if the slot is free
+     */
+    bool getSessionInfo(int slot, MCPSessionInfo& info) const;
+
+    const MCPServerStats& getStats() const { return stats; }
+
+    /**
+     * @brief Bumped on every tool or resource set change; the caches follow it
+     */
+    uint32_t getToolsVersion() const { return toolsVersion; }
+
+    /**
+     * @brief Idle /mcp keep-alive connections currently held
+     */
+    int getConnectionCount() const;
+
+    /**
+     * @brief Share of wall time the server task spent working (percent)
+     */
+    float getCpuUsage() const;
+
 private:
     //-------------------------------------------------------------------------
     // FreeRTOS Task
@@ -102,39 +455,211 @@ private:
     static void serverTask(void* param);
     TaskHandle_t taskHandle;
 
+    /**
+     * @brief Fill select() sets for the listener and open connections
+     * @return Highest descriptor added
+     */
+    int buildFdSets(fd_set& readSet, fd_set& writeSet);
+
+    /**
+     * @brief Time until the next keepalive or idle timeout is due (ms)
+     */
+    uint32_t nextDeadlineMs();
+
     //-------------------------------------------------------------------------
     // Connection Handling
     //-------------------------------------------------------------------------
 
     void handleNewConnection(WiFiClient client);
+
+    /**
+     * @brief Feed available bytes to the connection's parser and answer
+     *        every request completed by them
+     */
+    void serviceConnection(MCPConnection& conn);
+
+    /**
+     * @brief Check the body of a request whose headers are parsed fits
+     * @return false if it was refused (413/503 sent, connection closed)
+     */
+    bool prepareBody(MCPConnection& conn);
+
+    /**
+     * @brief handleRequest() with latency accounting
+     */
+    bool serveRequest(MCPConnection& conn);
+
+    /**
+     * @brief Route one request that has arrived whole (body in conn.body)
+     * @return true if the connection stays open for another request
+     */
+    bool handleRequest(MCPConnection& conn);
+
     void handleSSERequest(WiFiClient& client);
-    void handleMessageRequest(WiFiClient& client, const String& queryString, const String& body);
+    void handleMessageRequest(MCPConnection& conn);
+    bool handleStreamableRequest(MCPConnection& conn);
+
+    /**
+     * @brief Write a POST /mcp reply, closing unless keep-alive
+     * @return true if the connection stays open for another request
+     */
+    bool sendStreamableResponse(MCPConnection& conn, const MCPResponse& response);
+
+    MCPConnection* freeConnectionSlot();
+    void closeConnection(MCPConnection& conn);
+    void serviceConnections();
+
+    /**
+     * @brief Answer with an empty-bodied status and close
+     */
+    static void sendStatus(WiFiClient& client, uint16_t status);
 
     //-------------------------------------------------------------------------
     // JSON-RPC Method Handlers
     //-------------------------------------------------------------------------
 
-    String processJsonRpc(const char* body);
-    String handleInitialize(int id);
-    String handleToolsList(int id);
+    /**
+     * @param session SSE session the request came in on, nullptr for
+     *                Streamable HTTP (which cannot receive notifications)
+     */
+    MCPResponse processJsonRpc(JsonDocument& doc, DeserializationError error,
+                               MCPSession* session);
+
+    /**
+     * @brief Run a batch and join the replies into one array
+     * @return Empty if the batch held only notifications
+     */
+    MCPResponse processBatch(JsonArray batch, MCPSession* session);
+
+    /**
+     * @brief Run one request or notification (a batch entry or a whole body)
+     */
+    MCPResponse processMessage(JsonObject msg, MCPSession* session);
+    MCPResponse handleInitialize(int id, const char* requestedVersion);
+    MCPResponse handleToolsList(int id);
     String handleToolsCall(int id, JsonObject& params);
+
+    /**
+     * @brief Error response if params don't name a registered tool
+     * @return Empty if the call can be made
+     */
+    String checkToolCall(int id, JsonObject& params);
+
+    /**
+     * @brief tools/call response wrapping a tool's result JSON
+     */
+    String makeToolResult(int id, const String& result);
+    String handleResourcesRead(int id, const char* uri);
+    String handleResourcesSubscribe(int id, const char* uri, MCPSession* session, bool subscribe);
     String handlePing(int id);
     String makeErrorResponse(int id, int code, const char* message);
 
     //-------------------------------------------------------------------------
-    // SSE Helpers
+    // Deferred Tool Calls
+    //-------------------------------------------------------------------------
+
+    /**
+     * @brief Hand a lone tools/call to the deferred executor
+     *
+     * Replies that are ready at once (bad tool, executor busy or inline)
+     * are set in response. Otherwise response stays empty, the call is
+     * pending and conn, if given, is marked awaitingTool.
+     *
+     * @param conn Streamable HTTP connection the reply goes to, or nullptr
+     * @param session SSE session the reply goes to, or nullptr
+     * @return false if doc is not a tools/call this handles
+     */
+    bool deferToolCall(JsonDocument& doc, MCPConnection* conn, MCPSession* session,
+                       MCPResponse& response);
+
+    /**
+     * @brief Send the replies of pending calls that are done
+     */
+    void servicePendingCalls();
+
+    /**
+     * @brief Drop the pending calls that reply to conn or session
+     */
+    void cancelPendingCalls(const MCPConnection* conn, const MCPSession* session);
+
+    //-------------------------------------------------------------------------
+    // Sessions
+    //-------------------------------------------------------------------------
+
+    MCPSession* openSession(WiFiClient& client);
+    MCPSession* findSession(const char* id, size_t length);
+    void closeSession(MCPSession& session);
+
+    /**
+     * @brief Queue a JSON-RPC message as an SSE event
+     * @return false if the queue was full and the event was dropped
+     */
+    bool queueEvent(MCPSession& session, const MCPResponse& response);
+
+    /**
+     * @brief Write queued frames until the socket would block
+     * @return false if the connection failed (session closed)
+     */
+    bool flushSession(MCPSession& session);
+
+    /**
+     * @brief Flush queues, send keepalives and reap dead sessions
+     */
+    void serviceSessions();
+
+    bool pushFrame(MCPSession& session, const String& frame);
+
+    static void generateSessionId(char* out);
+
+    //-------------------------------------------------------------------------
+    // Resource Updates
     //-------------------------------------------------------------------------
 
-    bool sendSSEEvent(const String& json);
-    void sendKeepAlive();
-    void closeSSEConnection();
+    int findResource(const char* uri) const;
+
+    /**
+     * @brief Hand changed resources whose interval has passed to their
+     *        subscribers' pending sets
+     */
+    void publishResourceUpdates();
+
+    /**
+     * @brief Queue a session's pending notifications while it has room
+     */
+    void queueResourceUpdates(MCPSession& session);
+
+    /**
+     * @brief Recompute subscribedResources from the session table
+     */
+    void updateSubscribedResources();
+
+    /**
+     * @brief Loopback socket that ends select() when a resource changes
+     */
+    bool openWakeSocket();
+    void drainWakeSocket();
+
+    //-------------------------------------------------------------------------
+    // Response Cache
+    //-------------------------------------------------------------------------
+
+    /**
+     * @brief Re-serialize tools/list and initialize results (server task)
+     */
+    void rebuildCache();
+
+    /**
+     * @brief Response whose result is a cache entry, rebuilt first if stale
+     */
+    MCPResponse cachedResponse(int id, const MCPCachedResult& cache);
 
-    static String generateSessionId();
+    static bool storeCache(MCPCachedResult& cache, JsonDocument& doc);
+    static void freeCache(MCPCachedResult& cache);
 
-    WiFiServer* tcpServer;
-    WiFiClient sseClient;
-    String sessionId;
-    uint32_t lastKeepAlive;
+    int listenFd;
+    MCPSession sessions[MCP_MAX_SESSIONS];
+    MCPConnection connections[MCP_MAX_HTTP_CONNECTIONS];
+    MCPServerStats stats;
     uint16_t port;
     bool enabled;
     volatile bool running;
@@ -142,6 +667,25 @@ private:
     // Tools
     std::vector<MCPTool> tools;
     MCPToolExecutor toolExecutor;
+    MCPDeferredToolExecutor deferredExecutor;
+    MCPPendingCall pendingCalls[MCP_MAX_PENDING_CALLS];
+    volatile uint32_t toolsVersion;
+
+    // Resources; the bitmasks are shared with notifying tasks
+    std::vector<MCPResource> resources;
+    std::atomic<uint32_t> subscribedResources;
+    std::atomic<uint32_t> changedResources;
+    uint32_t resourceUpdateInterval;
+    int wakeFd;                                 ///< Bound loopback UDP socket in readSet
+    int wakeSendFd;                             ///< Used by notifying tasks
+    struct sockaddr_in wakeAddr;
+
+    // Pre-serialized results, valid while cacheVersion == toolsVersion
+    MCPCachedResult toolsListCache;
+    MCPCachedResult resourcesListCache;
+    MCPCachedResult initializeCache;            ///< MCP_PROTOCOL_VERSION
+    MCPCachedResult initializeStreamableCache;  ///< MCP_PROTOCOL_VERSION_STREAMABLE
+    uint32_t cacheVersion;
 };
 
 // Global MCP server instance
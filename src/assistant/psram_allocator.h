@@ -0,0 +1,56 @@
+/**
+ * @file psram_allocator.h
+ * @brief ArduinoJson allocator that places JsonDocument storage in PSRAM
+ *
+ * LLM and MCP responses can run to tens of kilobytes. Parsing them into a
+ * JsonDocument backed by internal SRAM competes with the TLS contexts and
+ * audio buffers for the scarce on-chip heap; this allocator moves the
+ * document's pool to PSRAM and falls back to internal RAM when PSRAM is
+ * absent or exhausted.
+ *
+ * Usage:
+ *   JsonDocument doc(&PsramAllocator::instance());
+ */
+
+#ifndef PSRAM_ALLOCATOR_H
+#define PSRAM_ALLOCATOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+
+/**
+ * @class PsramAllocator
+ * @brief Stateless PSRAM-first allocator for JsonDocument
+ *
+ * heap_caps_free() and free() accept blocks from either heap, so memory
+ * from the internal fallback is released through the same path.
+ */
+class PsramAllocator : public ArduinoJson::Allocator {
+public:
+    void* allocate(size_t size) override {
+        void* p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!p) p = malloc(size);
+        return p;
+    }
+
+    void deallocate(void* ptr) override {
+        heap_caps_free(ptr);
+    }
+
+    void* reallocate(void* ptr, size_t newSize) override {
+        void* p = heap_caps_realloc(ptr, newSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!p) p = realloc(ptr, newSize);
+        return p;
+    }
+
+    /**
+     * @brief Shared instance (the allocator holds no state)
+     */
+    static PsramAllocator& instance() {
+        static PsramAllocator allocator;
+        return allocator;
+    }
+};
+
+#endif // PSRAM_ALLOCATOR_H
@@ -0,0 +1,140 @@
+/**
+ * @file sse_parser.cpp
+ * @brief Incremental Server-Sent Events parser implementation
+ *
+ * Follows the WHATWG event-stream rules that matter for API streams:
+ * - Lines end with LF, CR or CRLF (CRLF split across chunks is handled)
+ * - "event:" sets the event name, "data:" lines are joined with '\n'
+ * - Lines starting with ':' are comments (keepalives)
+ * - A blank line dispatches the pending event
+ */
+
+#include "sse_parser.h"
+
+//=============================================================================
+// Constructor
+//=============================================================================
+
+SSEParser::SSEParser()
+    : eventCallback(nullptr)
+{
+    reset();
+}
+
+void SSEParser::reset() {
+    lineLen = 0;
+    lineOverflow = false;
+    lastWasCR = false;
+    eventName[0] = '\0';
+    dataBuf[0] = '\0';
+    dataLen = 0;
+    hasData = false;
+    droppedCount = 0;
+    eventCount = 0;
+}
+
+//=============================================================================
+// Parsing
+//=============================================================================
+
+void SSEParser::feed(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        char c = (char)data[i];
+
+        if (c == '\n' && lastWasCR) {
+            // Second half of CRLF - line already processed on CR
+            lastWasCR = false;
+            continue;
+        }
+        lastWasCR = (c == '\r');
+
+        if (c == '\n' || c == '\r') {
+            if (lineOverflow) {
+                droppedCount++;
+                lineOverflow = false;
+                lineLen = 0;
+                continue;
+            }
+            lineBuf[lineLen] = '\0';
+            processLine();
+            lineLen = 0;
+            continue;
+        }
+
+        if (lineLen < sizeof(lineBuf) - 1) {
+            lineBuf[lineLen++] = c;
+        } else {
+            lineOverflow = true;
+        }
+    }
+}
+
+void SSEParser::finish() {
+    if (lineLen > 0 && !lineOverflow) {
+        lineBuf[lineLen] = '\0';
+        processLine();
+    }
+    lineLen = 0;
+    lineOverflow = false;
+    dispatch();
+}
+
+void SSEParser::processLine() {
+    // Blank line = dispatch
+    if (lineLen == 0) {
+        dispatch();
+        return;
+    }
+
+    // Comment / keepalive
+    if (lineBuf[0] == ':') return;
+
+    // Split "field: value"
+    char* colon = strchr(lineBuf, ':');
+    const char* value = "";
+    if (colon) {
+        *colon = '\0';
+        value = colon + 1;
+        if (*value == ' ') value++;
+    }
+
+    if (strcmp(lineBuf, "data") == 0) {
+        if (dataLen >= sizeof(dataBuf)) return;  // Already dropping this event
+
+        size_t valueLen = strlen(value);
+        size_t needed = valueLen + (hasData ? 1 : 0);
+
+        if (dataLen + needed >= sizeof(dataBuf)) {
+            // Event too large - drop it entirely rather than deliver truncated JSON
+            droppedCount++;
+            dataLen = sizeof(dataBuf);
+            return;
+        }
+
+        if (hasData) dataBuf[dataLen++] = '\n';
+        memcpy(dataBuf + dataLen, value, valueLen);
+        dataLen += valueLen;
+        dataBuf[dataLen] = '\0';
+        hasData = true;
+    } else if (strcmp(lineBuf, "event") == 0) {
+        strncpy(eventName, value, sizeof(eventName) - 1);
+        eventName[sizeof(eventName) - 1] = '\0';
+    }
+    // "id" and "retry" are not used by API streams
+}
+
+void SSEParser::dispatch() {
+    bool oversized = dataLen >= sizeof(dataBuf);
+
+    if (hasData && !oversized) {
+        eventCount++;
+        if (eventCallback) {
+            eventCallback(eventName[0] ? eventName : "message", dataBuf);
+        }
+    }
+
+    eventName[0] = '\0';
+    dataBuf[0] = '\0';
+    dataLen = 0;
+    hasData = false;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file sse_parser.h
+ * @brief Incremental Server-Sent Events parser
+ *
+ * Consumes raw bytes from a network stream in arbitrary chunk sizes and
+ * emits one callback per complete SSE event (event name + joined data
+ * lines). Uses fixed buffers only, so it can sit inside long-lived clients
+ * without heap churn per event.
+ *
+ * Used by LLMClient for streamed Claude / OpenAI completions.
+ */
+
+#ifndef SSE_PARSER_H
+#define SSE_PARSER_H
+
+#include <Arduino.h>
+#include <functional>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Maximum length of a single SSE line (longer lines are dropped) */
+#define SSE_MAX_LINE_LENGTH 1024
+
+/** Maximum size of an event's joined data payload */
+#define SSE_MAX_DATA_LENGTH 2048
+
+/** Maximum length of an event name */
+#define SSE_MAX_EVENT_NAME 32
+
+//=============================================================================
+// Callbacks
+//=============================================================================
+
+/**
+ * @brief Callback for a complete SSE event
+ * @param event Event name ("message" if the stream did not set one)
+ * @param data Event data, multiple data lines joined with '\n'
+ */
+using SSEEventCallback = std::function<void(const char* event, const char* data)>;
+
+//=============================================================================
+// SSEParser Class
+//=============================================================================
+
+/**
+ * @class SSEParser
+ * @brief Byte-at-a-time SSE line parser with fixed buffers
+ */
+class SSEParser {
+public:
+    SSEParser();
+
+    /**
+     * @brief Set event callback
+     */
+    void onEvent(SSEEventCallback callback) { eventCallback = callback; }
+
+    /**
+     * @brief Reset all parser state (call before each new stream)
+     */
+    void reset();
+
+    /**
+     * @brief Feed raw bytes from the stream
+     * @param data Bytes received
+     * @param length Number of bytes
+     */
+    void feed(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Flush a trailing event not terminated by a blank line
+     */
+    void finish();
+
+    /**
+     * @brief Number of lines or events dropped because they were too long
+     */
+    uint32_t getDroppedCount() const { return droppedCount; }
+
+    /**
+     * @brief Number of events dispatched since reset()
+     */
+    uint32_t getEventCount() const { return eventCount; }
+
+private:
+    /**
+     * @brief Handle a complete line in lineBuf
+     */
+    void processLine();
+
+    /**
+     * @brief Emit the pending event and clear event state
+     */
+    void dispatch();
+
+    char lineBuf[SSE_MAX_LINE_LENGTH];
+    size_t lineLen;
+    bool lineOverflow;
+    bool lastWasCR;
+
+    char eventName[SSE_MAX_EVENT_NAME];
+    char dataBuf[SSE_MAX_DATA_LENGTH];
+    size_t dataLen;
+    bool hasData;
+
+    uint32_t droppedCount;
+    uint32_t eventCount;
+
+    SSEEventCallback eventCallback;
+};
+
+#endif // SSE_PARSER_H
@@ -17,7 +17,6 @@ STTClient::STTClient()
     , audioBufferPos(0)
     , audioBufferSize(STT_MAX_AUDIO_BUFFER)
     , transcriptReady(false)
-    , secureClient(nullptr)
     , transcriptCallback(nullptr)
     , errorCallback(nullptr)
 {
@@ -52,17 +51,14 @@ bool STTClient::begin(const char* key) {
         return false;
     }
 
-    // Create secure client
-    secureClient = new NetworkClientSecure();
-    if (!secureClient) {
-        Serial.println("[STT] ERROR: Failed to create secure client");
+    // TLS connections are shared with LLM/TTS through the pool
+    if (!connectionManager.begin()) {
+        Serial.println("[STT] ERROR: Failed to init connection pool");
         free(audioBuffer);
         audioBuffer = nullptr;
         return false;
     }
 
-    secureClient->setInsecure();
-
     initialized = true;
     state = STTState::Idle;
     Serial.printf("[STT] Initialized with OpenAI Whisper (buffer: %d bytes)\n", audioBufferSize);
@@ -77,11 +73,6 @@ void STTClient::end() {
         audioBuffer = nullptr;
     }
 
-    if (secureClient) {
-        delete secureClient;
-        secureClient = nullptr;
-    }
-
     initialized = false;
     state = STTState::Idle;
     Serial.println("[STT] Shutdown");
@@ -192,8 +183,19 @@ bool STTClient::transcribe() {
     // Calculate total content length
     size_t contentLength = formStart.length() + 44 + wavDataSize + formModel.length() + formEnd.length();
 
-    // Start HTTP request
-    http.begin(*secureClient, url);
+    // Start HTTP request on a pooled (usually already open) connection
+    NetworkClientSecure* conn = connectionManager.acquire(WHISPER_API_HOST);
+    if (!conn) {
+        snprintf(lastError, sizeof(lastError), "Connection failed");
+        state = STTState::Error;
+        if (errorCallback) {
+            errorCallback(lastError);
+        }
+        return false;
+    }
+
+    http.setReuse(true);
+    http.begin(*conn, url);
     http.setTimeout(STT_HTTP_TIMEOUT_MS);
     http.addHeader("Authorization", String("Bearer ") + apiKey);
     http.addHeader("Content-Type", "multipart/form-data; boundary=" + boundary);
@@ -203,6 +205,8 @@ bool STTClient::transcribe() {
     uint8_t* requestBody = (uint8_t*)malloc(contentLength);
     if (!requestBody) {
         Serial.println("[STT] Failed to allocate request buffer");
+        http.end();
+        connectionManager.release(conn);
         snprintf(lastError, sizeof(lastError), "Memory allocation failed");
         state = STTState::Error;
         if (errorCallback) {
@@ -246,6 +250,7 @@ bool STTClient::transcribe() {
         snprintf(lastError, sizeof(lastError), "HTTP %d", httpCode);
         state = STTState::Error;
         http.end();
+        connectionManager.release(conn, httpCode > 0);
 
         if (errorCallback) {
             errorCallback(lastError);
@@ -256,6 +261,7 @@ bool STTClient::transcribe() {
     // Parse response
     String response = http.getString();
     http.end();
+    connectionManager.release(conn);
 
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, response);
@@ -13,6 +13,7 @@
 #include <HTTPClient.h>
 #include <NetworkClientSecure.h>
 #include <functional>
+#include "../network/connection_manager.h"
 
 //=============================================================================
 // Configuration
@@ -227,8 +228,7 @@ private:
     // Error handling
     char lastError[128];
 
-    // HTTP client
-    NetworkClientSecure* secureClient;
+    // HTTP client (connection leased from connectionManager per request)
     HTTPClient http;
 
     // Callbacks
@@ -0,0 +1,112 @@
+/**
+ * @file token_budget.cpp
+ * @brief Prompt token estimation implementation
+ */
+
+#include "token_budget.h"
+
+//=============================================================================
+// Letter Pair Table
+//=============================================================================
+
+/**
+ * Common within-word letter pairs: bit (b - 'a') of entry (a - 'a') is set
+ * if "ab" is among the 200 most frequent English bigrams (~93% of all
+ * pairs in running text). Words split into tokens at the rare ones.
+ * Const, so it stays in flash.
+ */
+static const uint32_t COMMON_PAIRS[26] = {
+    0x13EBD4E, 0x1100811, 0x01A5C91, 0x0044118,     // a b c d
+    0x0AEB87D, 0x01A4131, 0x0100190, 0x0084111,     // e f g h
+    0x08EF87D, 0x0000000, 0x0000010, 0x11C4919,     // i j k l
+    0x004D11B, 0x01C495D, 0x07EB82E, 0x01AC911,     // m n o p
+    0x0100000, 0x11E7D5D, 0x11EC195, 0x11E419D,     // q r s t
+    0x00EB931, 0x0000111, 0x0004181, 0x0088000,     // u v w x
+    0x000C000, 0x0000000                            // y z
+};
+
+bool TokenEstimator::isCommonPair(char a, char b) {
+    return (COMMON_PAIRS[a - 'a'] >> (b - 'a')) & 1;
+}
+
+//=============================================================================
+// Estimation
+//=============================================================================
+
+static inline bool isAsciiAlpha(uint8_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static inline bool isAsciiSpace(uint8_t c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+uint32_t TokenEstimator::estimateWord(const char* word, size_t length) {
+    if (length <= TOKEN_WHOLE_WORD_LENGTH) return 1;
+
+    uint32_t tokens = 1;
+    size_t pieceLen = 1;
+
+    for (size_t k = 1; k < length; k++) {
+        char a = word[k - 1];
+        char b = word[k];
+
+        // camelCase boundary
+        if (isupper(b) && islower(a)) {
+            tokens++;
+            pieceLen = 1;
+            continue;
+        }
+
+        // Very short pieces always merge; longer ones only on common pairs
+        if (pieceLen < TOKEN_MAX_PIECE_LENGTH &&
+            (pieceLen < 3 || isCommonPair(tolower(a), tolower(b)))) {
+            pieceLen++;
+        } else {
+            tokens++;
+            pieceLen = 1;
+        }
+    }
+    return tokens;
+}
+
+uint32_t TokenEstimator::estimate(const char* text, size_t length) {
+    if (!text) return 0;
+
+    const uint8_t* p = (const uint8_t*)text;
+    uint32_t tokens = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        uint8_t c = p[i];
+        size_t j = i + 1;
+
+        if (isAsciiAlpha(c)) {
+            while (j < length && isAsciiAlpha(p[j])) j++;
+            tokens += estimateWord(text + i, j - i);
+        } else if (isdigit(c)) {
+            while (j < length && isdigit(p[j])) j++;
+            tokens += (j - i + 2) / 3;
+        } else if (c == ' ' && j < length && isAsciiAlpha(p[j])) {
+            // A single space is merged into the following word
+        } else if (isAsciiSpace(c)) {
+            while (j < length && isAsciiSpace(p[j])) j++;
+            tokens++;
+        } else if (c >= 0x80) {
+            // One token per non-ASCII code point
+            while (j < length && (p[j] & 0xC0) == 0x80) j++;
+            tokens++;
+        } else {
+            while (j < length && p[j] == c) j++;
+            if (j - i > 1) {
+                tokens += (j - i + TOKEN_REPEAT_RUN - 1) / TOKEN_REPEAT_RUN;
+            } else {
+                // Mixed punctuation such as ":\"" or "\"}," merges in short runs
+                while (j < length && p[j] < 0x80 && ispunct(p[j])) j++;
+                tokens += (j - i + TOKEN_PUNCT_RUN - 1) / TOKEN_PUNCT_RUN;
+            }
+        }
+        i = j;
+    }
+    return tokens;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file token_budget.h
+ * @brief Prompt token estimation for context budgeting
+ *
+ * The conversation is pruned to fit LLM_MAX_CONTEXT_TOKENS before each
+ * request, so the size of every part of the prompt (system prompt, tool
+ * schemas, each history message with its tool inputs and results) has to
+ * be known without a round trip to the provider's tokenizer.
+ *
+ * TokenEstimator approximates a BPE tokenizer in a single pass:
+ * - Short words (with their leading space) are one token
+ * - Longer words split where a letter pair is not a common merge; the
+ *   pair table is a 26x26 bitmap in flash (104 bytes)
+ * - Digits go in groups of three, punctuation in runs of up to three,
+ *   non-ASCII characters count one token each
+ *
+ * LLMClient scales the estimate by the ratio of reported to estimated
+ * prompt tokens, so remaining error is calibrated away at runtime.
+ */
+
+#ifndef TOKEN_BUDGET_H
+#define TOKEN_BUDGET_H
+
+#include <Arduino.h>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Words up to this many letters are counted as a single token */
+#define TOKEN_WHOLE_WORD_LENGTH 6
+
+/** Longest piece of a long word merged into one token */
+#define TOKEN_MAX_PIECE_LENGTH 8
+
+/** Punctuation characters merged into one token */
+#define TOKEN_PUNCT_RUN 3
+
+/** Identical repeated characters ("-----") merged into one token */
+#define TOKEN_REPEAT_RUN 8
+
+//=============================================================================
+// TokenBudget
+//=============================================================================
+
+/**
+ * @struct TokenBudget
+ * @brief Estimated prompt composition (calibrated tokens)
+ */
+struct TokenBudget {
+    uint32_t system;        ///< System prompt
+    uint32_t tools;         ///< Tool definitions
+    uint32_t history;       ///< Stored messages
+    uint32_t pending;       ///< Message about to be sent
+    uint32_t limit;         ///< Prompt budget
+    float scale;            ///< Reported / estimated prompt tokens
+
+    uint32_t total() const { return system + tools + history + pending; }
+};
+
+//=============================================================================
+// TokenEstimator
+//=============================================================================
+
+/**
+ * @class TokenEstimator
+ * @brief Approximate BPE token counts for UTF-8 / JSON text
+ */
+class TokenEstimator {
+public:
+    /**
+     * @brief Estimate tokens in a buffer
+     * @param text UTF-8 text (need not be null-terminated)
+     * @param length Bytes to scan
+     */
+    static uint32_t estimate(const char* text, size_t length);
+
+    /**
+     * @brief Estimate tokens in a null-terminated string
+     */
+    static uint32_t estimate(const char* text) {
+        return text ? estimate(text, strlen(text)) : 0;
+    }
+
+    /**
+     * @brief Estimate tokens in a String
+     */
+    static uint32_t estimate(const String& text) {
+        return estimate(text.c_str(), text.length());
+    }
+
+private:
+    /**
+     * @brief Tokens in one run of ASCII letters
+     */
+    static uint32_t estimateWord(const char* word, size_t length);
+
+    /**
+     * @brief True if the lowercase letter pair is a common BPE merge
+     */
+    static bool isCommonPair(char a, char b);
+};
+
+#endif // TOKEN_BUDGET_H
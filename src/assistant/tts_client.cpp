@@ -15,8 +15,9 @@ TTSClient::TTSClient()
     : provider(TTSProvider::ElevenLabs)
     , state(TTSState::Idle)
     , initialized(false)
-    , secureClient(nullptr)
+    , connection(nullptr)
     , streamActive(false)
+    , chunked(false)
     , contentLength(0)
     , bytesReceived(0)
     , audioChunkCallback(nullptr)
@@ -47,17 +48,12 @@ bool TTSClient::begin(TTSProvider prov, const char* key) {
     provider = prov;
     setApiKey(key);
 
-    // Create secure client
-    secureClient = new NetworkClientSecure();
-    if (!secureClient) {
-        Serial.println("[TTS] ERROR: Failed to create secure client");
+    // TLS connections are shared with STT/LLM through the pool
+    if (!connectionManager.begin()) {
+        Serial.println("[TTS] ERROR: Failed to init connection pool");
         return false;
     }
 
-    // Skip certificate verification (for simplicity)
-    // In production, you'd want to verify certificates
-    secureClient->setInsecure();
-
     initialized = true;
     state = TTSState::Idle;
 
@@ -71,11 +67,6 @@ void TTSClient::end() {
 
     stop();
 
-    if (secureClient) {
-        delete secureClient;
-        secureClient = nullptr;
-    }
-
     initialized = false;
     Serial.println("[TTS] Shutdown");
 }
@@ -129,9 +120,9 @@ void TTSClient::stop() {
 
     Serial.println("[TTS] Stopping playback");
 
-    if (streamActive) {
-        http.end();
-        streamActive = false;
+    if (connection) {
+        // Body abandoned mid-stream - the socket can't be reused
+        closeConnection(false);
     }
 
     setState(TTSState::Idle);
@@ -156,13 +147,11 @@ void TTSClient::loop() {
 bool TTSClient::requestElevenLabs(const char* text) {
     setState(TTSState::Requesting);
 
-    // Build URL
-    String url = "https://";
-    url += ELEVENLABS_API_HOST;
-    url += ELEVENLABS_API_PATH;
-    url += "/";
-    url += voiceConfig.elevenLabsVoiceId;
-    url += "/stream";
+    // Build path
+    String path = ELEVENLABS_API_PATH;
+    path += "/";
+    path += voiceConfig.elevenLabsVoiceId;
+    path += "/stream";
 
     // Build request body
     JsonDocument doc;
@@ -177,8 +166,7 @@ bool TTSClient::requestElevenLabs(const char* text) {
     serializeJson(doc, body);
 
     // Make request
-    http.begin(*secureClient, url);
-    http.setTimeout(TTS_HTTP_TIMEOUT_MS);
+    if (!openConnection(ELEVENLABS_API_HOST, path)) return false;
     http.addHeader("Content-Type", "application/json");
     http.addHeader("xi-api-key", apiKey);
     http.addHeader("Accept", "audio/mpeg");
@@ -191,7 +179,7 @@ bool TTSClient::requestElevenLabs(const char* text) {
         Serial.printf("[TTS] Response: %s\n", response.c_str());
 
         snprintf(lastError, sizeof(lastError), "HTTP %d", httpCode);
-        http.end();
+        closeConnection(httpCode > 0);
         setState(TTSState::Error);
 
         if (errorCallback) {
@@ -200,12 +188,7 @@ bool TTSClient::requestElevenLabs(const char* text) {
         return false;
     }
 
-    // Get content length (may be -1 for chunked)
-    contentLength = http.getSize();
-    bytesReceived = 0;
-    streamActive = true;
-
-    Serial.printf("[TTS] Streaming audio (%d bytes)\n", contentLength);
+    beginStream();
     setState(TTSState::Streaming);
 
     return true;
@@ -218,11 +201,6 @@ bool TTSClient::requestElevenLabs(const char* text) {
 bool TTSClient::requestOpenAI(const char* text) {
     setState(TTSState::Requesting);
 
-    // Build URL
-    String url = "https://";
-    url += OPENAI_TTS_HOST;
-    url += OPENAI_TTS_PATH;
-
     // Build request body
     JsonDocument doc;
     doc["model"] = "tts-1";
@@ -235,8 +213,7 @@ bool TTSClient::requestOpenAI(const char* text) {
     serializeJson(doc, body);
 
     // Make request
-    http.begin(*secureClient, url);
-    http.setTimeout(TTS_HTTP_TIMEOUT_MS);
+    if (!openConnection(OPENAI_TTS_HOST, OPENAI_TTS_PATH)) return false;
     http.addHeader("Content-Type", "application/json");
     http.addHeader("Authorization", String("Bearer ") + apiKey);
 
@@ -248,7 +225,7 @@ bool TTSClient::requestOpenAI(const char* text) {
         Serial.printf("[TTS] Response: %s\n", response.c_str());
 
         snprintf(lastError, sizeof(lastError), "HTTP %d", httpCode);
-        http.end();
+        closeConnection(httpCode > 0);
         setState(TTSState::Error);
 
         if (errorCallback) {
@@ -257,15 +234,69 @@ bool TTSClient::requestOpenAI(const char* text) {
         return false;
     }
 
-    // Get content length
+    beginStream();
+    setState(TTSState::Streaming);
+
+    return true;
+}
+
+//=============================================================================
+// Connection Handling
+//=============================================================================
+
+bool TTSClient::openConnection(const char* host, const String& path) {
+#ifdef TTS_STANDIN_HOST
+    host = TTS_STANDIN_HOST;
+    uint16_t port = TTS_STANDIN_PORT;
+#else
+    uint16_t port = 443;
+#endif
+    String url = "https://";
+    url += host;
+    if (port != 443) url += ":" + String(port);
+    url += path;
+
+    connection = connectionManager.acquire(host, port);
+    if (!connection) {
+        snprintf(lastError, sizeof(lastError), "Connection failed");
+        setState(TTSState::Error);
+        if (errorCallback) {
+            errorCallback(lastError);
+        }
+        return false;
+    }
+
+    // HTTP/1.1 keep-alive; the chunked body is decoded in processStream()
+    static const char* headerKeys[] = {"Transfer-Encoding"};
+    http.setReuse(true);
+    http.begin(*connection, url);
+    http.collectHeaders(headerKeys, 1);
+    http.setTimeout(TTS_HTTP_TIMEOUT_MS);
+    return true;
+}
+
+void TTSClient::closeConnection(bool keepAlive) {
+    http.end();
+    streamActive = false;
+    if (connection) {
+        connectionManager.release(connection, keepAlive);
+        connection = nullptr;
+    }
+}
+
+void TTSClient::beginStream() {
+    // Content length is -1 for chunked responses
     contentLength = http.getSize();
+    chunked = http.header("Transfer-Encoding").indexOf("chunked") >= 0;
+    chunkDecoder.reset();
     bytesReceived = 0;
     streamActive = true;
 
-    Serial.printf("[TTS] Streaming audio (%d bytes)\n", contentLength);
-    setState(TTSState::Streaming);
-
-    return true;
+    if (chunked) {
+        Serial.println("[TTS] Streaming audio (chunked)");
+    } else {
+        Serial.printf("[TTS] Streaming audio (%d bytes)\n", contentLength);
+    }
 }
 
 //=============================================================================
@@ -276,21 +307,25 @@ void TTSClient::processStream() {
     NetworkClient* stream = http.getStreamPtr();
     if (!stream) {
         Serial.println("[TTS] Stream lost");
+        closeConnection(false);
         setState(TTSState::Error);
-        streamActive = false;
+        return;
+    }
+
+    // Body fully received - the connection stays open for the next request
+    bool bodyDone = chunked ? chunkDecoder.isComplete()
+                            : (contentLength > 0 && bytesReceived >= (size_t)contentLength);
+    if (bodyDone) {
+        Serial.printf("[TTS] Stream complete (%u bytes)\n", bytesReceived);
+        closeConnection(true);
+        setState(TTSState::Complete);
         return;
     }
 
     // Check if data available
     size_t available = stream->available();
     if (available == 0) {
-        // Check if transfer complete
-        if (contentLength > 0 && bytesReceived >= contentLength) {
-            Serial.printf("[TTS] Stream complete (%u bytes)\n", bytesReceived);
-            http.end();
-            streamActive = false;
-            setState(TTSState::Complete);
-        } else if (!stream->connected()) {
+        if (!stream->connected()) {
             // Connection closed
             if (bytesReceived > 0) {
                 Serial.printf("[TTS] Stream ended (%u bytes)\n", bytesReceived);
@@ -299,8 +334,7 @@ void TTSClient::processStream() {
                 Serial.println("[TTS] Stream disconnected");
                 setState(TTSState::Error);
             }
-            http.end();
-            streamActive = false;
+            closeConnection(false);
         }
         return;
     }
@@ -309,6 +343,16 @@ void TTSClient::processStream() {
     size_t toRead = min(available, sizeof(audioBuffer));
     size_t bytesRead = stream->readBytes(audioBuffer, toRead);
 
+    if (chunked && bytesRead > 0) {
+        bytesRead = chunkDecoder.decode(audioBuffer, bytesRead);
+        if (chunkDecoder.hasError()) {
+            Serial.println("[TTS] Malformed chunked stream");
+            closeConnection(false);
+            setState(bytesReceived > 0 ? TTSState::Complete : TTSState::Error);
+            return;
+        }
+    }
+
     if (bytesRead > 0) {
         bytesReceived += bytesRead;
 
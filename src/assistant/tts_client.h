@@ -13,6 +13,7 @@
 #include <HTTPClient.h>
 #include <NetworkClientSecure.h>
 #include <functional>
+#include "../network/connection_manager.h"
 
 //=============================================================================
 // Configuration
@@ -32,6 +33,14 @@ enum class TTSProvider {
 #define OPENAI_TTS_HOST "api.openai.com"
 #define OPENAI_TTS_PATH "/v1/audio/speech"
 
+/**
+ * Send TTS requests for either provider to scripts/tts_standin.py instead,
+ * e.g. build_flags = -DTTS_STANDIN_HOST=\"192.168.1.10\"
+ */
+#ifndef TTS_STANDIN_PORT
+#define TTS_STANDIN_PORT 8443
+#endif
+
 /** Audio buffer size for streaming */
 #define TTS_AUDIO_BUFFER_SIZE 4096
 
@@ -235,6 +244,25 @@ private:
      */
     bool requestOpenAI(const char* text);
 
+    /**
+     * @brief Lease a pooled connection and start the HTTP request
+     * @param host Provider API host (the stand-in's when TTS_STANDIN_HOST is set)
+     * @param path Request path
+     * @return true if a connection was obtained
+     */
+    bool openConnection(const char* host, const String& path);
+
+    /**
+     * @brief End the request and return the connection to the pool
+     * @param keepAlive true if the response body was fully read
+     */
+    void closeConnection(bool keepAlive);
+
+    /**
+     * @brief Record response framing after a successful POST
+     */
+    void beginStream();
+
     /**
      * @brief Process streaming response
      */
@@ -253,11 +281,13 @@ private:
     VoiceConfig voiceConfig;
     bool initialized;
 
-    // HTTP client for streaming
+    // HTTP client for streaming (connection leased from connectionManager)
     HTTPClient http;
-    NetworkClientSecure* secureClient;
+    NetworkClientSecure* connection;
     bool streamActive;
-    size_t contentLength;
+    bool chunked;
+    HttpChunkDecoder chunkDecoder;
+    int contentLength;
     size_t bytesReceived;
 
     // Audio buffer
@@ -0,0 +1,393 @@
+/**
+ * @file tts_pipeline.cpp
+ * @brief Sentence-pipelined text-to-speech implementation
+ *
+ * Segment lifecycle per slot file:
+ *   Free -> Writing (TTS request streaming into the file)
+ *        -> Ready   (synthesis complete, waiting for the player)
+ *        -> Handed  (playing or queued in AudioPlayer)
+ *        -> Free    (player has moved past it)
+ */
+
+#include "tts_pipeline.h"
+#include "../audio/audio_player.h"
+
+//=============================================================================
+// Constructor / Destructor
+//=============================================================================
+
+TTSPipeline::TTSPipeline()
+    : tts(nullptr)
+    , player(nullptr)
+    , textMutex(nullptr)
+    , finished(true)
+    , tagDone(false)
+    , tagLen(0)
+    , writingSlot(-1)
+    , synthStartTime(0)
+    , responseStartTime(0)
+    , lastSeenStartCount(0)
+    , statsLogged(true)
+{
+    memset(tagBuf, 0, sizeof(tagBuf));
+    for (int i = 0; i < TTS_PIPELINE_SLOTS; i++) {
+        slots[i].state = SlotState::Free;
+        slots[i].startSeq = 0;
+        snprintf(slots[i].path, sizeof(slots[i].path), "/tts_%d.mp3", i);
+    }
+}
+
+TTSPipeline::~TTSPipeline() {
+    if (textMutex) {
+        vSemaphoreDelete(textMutex);
+        textMutex = nullptr;
+    }
+}
+
+bool TTSPipeline::begin(TTSClient* ttsClient, AudioPlayer* audioPlayer) {
+    tts = ttsClient;
+    player = audioPlayer;
+
+    if (!textMutex) {
+        textMutex = xSemaphoreCreateMutex();
+        if (!textMutex) {
+            Serial.println("[TTSPipe] Failed to create mutex");
+            return false;
+        }
+    }
+
+    // Audio arrives from TTSClient::loop() on the main loop
+    tts->onAudioChunk([this](const uint8_t* data, size_t len) {
+        if (writingSlot >= 0 && slots[writingSlot].file) {
+            slots[writingSlot].file.write(data, len);
+        }
+    });
+
+    return true;
+}
+
+//=============================================================================
+// Text Input
+//=============================================================================
+
+void TTSPipeline::start() {
+    stop();
+
+    xSemaphoreTake(textMutex, portMAX_DELAY);
+    finished = false;
+    tagDone = false;
+    tagLen = 0;
+    xSemaphoreGive(textMutex);
+
+    stats.clear();
+    responseStartTime = millis();
+    lastSeenStartCount = player ? player->getStartCount() : 0;
+    statsLogged = false;
+}
+
+void TTSPipeline::append(const char* text) {
+    if (!text || !textMutex) return;
+
+    xSemaphoreTake(textMutex, portMAX_DELAY);
+    consumeText(text);
+    splitSegments(false);
+    xSemaphoreGive(textMutex);
+}
+
+void TTSPipeline::expectTag() {
+    if (!textMutex) return;
+
+    xSemaphoreTake(textMutex, portMAX_DELAY);
+    if (!tagDone && tagLen > 0) {
+        tagBuf[tagLen] = '\0';
+        pending += tagBuf;
+    }
+    // Keep the continuation from running into the previous sentence
+    if (pending.length() > 0) pending += ' ';
+    tagDone = false;
+    tagLen = 0;
+    xSemaphoreGive(textMutex);
+}
+
+void TTSPipeline::finish() {
+    if (!textMutex) return;
+
+    xSemaphoreTake(textMutex, portMAX_DELAY);
+    if (!tagDone && tagLen > 0) {
+        // Unterminated bracket - it was text after all
+        tagBuf[tagLen] = '\0';
+        pending += tagBuf;
+    }
+    tagDone = true;
+    splitSegments(true);
+    finished = true;
+    xSemaphoreGive(textMutex);
+}
+
+void TTSPipeline::stop() {
+    if (tts && writingSlot >= 0) {
+        tts->stop();
+    }
+    if (player && !handedOrder.empty()) {
+        player->stop();
+    }
+    resetSlots();
+
+    if (textMutex) {
+        xSemaphoreTake(textMutex, portMAX_DELAY);
+        pending = "";
+        segments.clear();
+        finished = true;
+        xSemaphoreGive(textMutex);
+    }
+}
+
+void TTSPipeline::consumeText(const char* text) {
+    const char* p = text;
+
+    // The response opens with an [emotion] tag that should not be spoken
+    while (!tagDone && *p) {
+        char c = *p;
+        if (tagLen == 0 && isspace((unsigned char)c)) {
+            p++;
+            continue;
+        }
+        if (tagLen == 0 && c != '[') {
+            tagDone = true;
+            break;
+        }
+        if (tagLen >= sizeof(tagBuf) - 1) {
+            // Too long to be a tag - speak what was held back
+            tagBuf[tagLen] = '\0';
+            pending += tagBuf;
+            tagDone = true;
+            break;
+        }
+        tagBuf[tagLen++] = c;
+        p++;
+        if (c == ']') {
+            tagDone = true;
+        }
+    }
+
+    if (*p) {
+        pending += p;
+    }
+}
+
+void TTSPipeline::splitSegments(bool flushAll) {
+    while (pending.length() > 0) {
+        const char* s = pending.c_str();
+        int len = pending.length();
+        int cut = -1;
+
+        for (int i = 0; i < len; i++) {
+            char c = s[i];
+            // Require whitespace after punctuation so "3.5" or "e.g" don't split
+            bool spaceNext = (i + 1 < len) && isspace((unsigned char)s[i + 1]);
+
+            if (c == '\n') {
+                cut = i + 1;
+                break;
+            }
+            if ((c == '.' || c == '!' || c == '?') && spaceNext &&
+                i + 1 >= TTS_PIPELINE_MIN_SENTENCE) {
+                cut = i + 1;
+                break;
+            }
+            if ((c == ',' || c == ';' || c == ':') && spaceNext &&
+                i + 1 >= TTS_PIPELINE_MIN_CLAUSE) {
+                cut = i + 1;
+                break;
+            }
+        }
+
+        if (cut < 0 && len > TTS_PIPELINE_MAX_SEGMENT) {
+            // No punctuation - break at the last word boundary
+            cut = TTS_PIPELINE_MAX_SEGMENT;
+            for (int i = TTS_PIPELINE_MAX_SEGMENT; i > 0; i--) {
+                if (s[i] == ' ') {
+                    cut = i;
+                    break;
+                }
+            }
+        }
+
+        if (cut < 0) {
+            if (!flushAll) break;
+            cut = len;
+        }
+
+        String segment = pending.substring(0, cut);
+        pending.remove(0, cut);
+        segment.trim();
+        if (segment.length() > 0) {
+            segments.push_back(segment);
+        }
+    }
+}
+
+//=============================================================================
+// Main Loop
+//=============================================================================
+
+void TTSPipeline::loop() {
+    if (!tts || !player) return;
+
+    trackPlayback();
+    checkSynthesis();
+    handoffReady();
+    startSynthesis();
+
+    if (!statsLogged && isIdle()) {
+        statsLogged = true;
+        if (stats.segmentsPlayed > 0) {
+            Serial.printf("[TTSPipe] Done: %u segments, first audio %dms, "
+                          "gap avg %ums max %ums, synth %ums\n",
+                          stats.segmentsPlayed, stats.timeToFirstAudioMs,
+                          stats.gapCount ? stats.totalGapMs / stats.gapCount : 0,
+                          stats.maxGapMs, stats.synthesisMs);
+        }
+    }
+}
+
+void TTSPipeline::trackPlayback() {
+    uint32_t seq = player->getStartCount();
+
+    // Record metrics for each of our segments that started since last loop
+    if (seq != lastSeenStartCount) {
+        for (int idx : handedOrder) {
+            Slot& slot = slots[idx];
+            if (slot.startSeq <= lastSeenStartCount || slot.startSeq > seq) continue;
+
+            if (stats.segmentsPlayed == 0) {
+                stats.timeToFirstAudioMs = (int32_t)(player->getLastStartTime() - responseStartTime);
+                Serial.printf("[TTSPipe] First audio after %dms\n", stats.timeToFirstAudioMs);
+            } else if (slot.startSeq == seq) {
+                uint32_t started = player->getLastStartTime();
+                uint32_t ended = player->getLastFinishTime();
+                uint32_t gap = (started >= ended) ? started - ended : 0;
+                stats.gapCount++;
+                stats.totalGapMs += gap;
+                if (gap > stats.maxGapMs) stats.maxGapMs = gap;
+            }
+            stats.segmentsPlayed++;
+        }
+        lastSeenStartCount = seq;
+    }
+
+    // Free slots the player is done with
+    bool playerIdle = !player->isPlaying() && !player->hasQueued();
+    while (!handedOrder.empty()) {
+        Slot& slot = slots[handedOrder[0]];
+        bool done = seq > slot.startSeq || (playerIdle && seq >= slot.startSeq);
+        if (!done) break;
+        slot.state = SlotState::Free;
+        handedOrder.erase(handedOrder.begin());
+    }
+}
+
+void TTSPipeline::checkSynthesis() {
+    if (writingSlot < 0) return;
+
+    TTSState ttsState = tts->getState();
+    if (ttsState == TTSState::Requesting || ttsState == TTSState::Streaming) return;
+
+    Slot& slot = slots[writingSlot];
+    slot.file.close();
+    stats.synthesisMs += millis() - synthStartTime;
+
+    if (ttsState == TTSState::Complete) {
+        slot.state = SlotState::Ready;
+        readyOrder.push_back(writingSlot);
+    } else {
+        Serial.printf("[TTSPipe] Segment synthesis failed: %s\n", tts->getError());
+        slot.state = SlotState::Free;
+    }
+    writingSlot = -1;
+}
+
+void TTSPipeline::handoffReady() {
+    while (!readyOrder.empty() && !player->hasQueued()) {
+        int idx = readyOrder[0];
+        Slot& slot = slots[idx];
+
+        uint32_t before = player->getStartCount();
+        if (!player->queueNext(slot.path)) break;
+        uint32_t after = player->getStartCount();
+
+        // Started now (idle player) or becomes the next file to start
+        slot.startSeq = (after != before) ? after : after + 1;
+        slot.state = SlotState::Handed;
+        handedOrder.push_back(idx);
+        readyOrder.erase(readyOrder.begin());
+    }
+}
+
+void TTSPipeline::startSynthesis() {
+    if (writingSlot >= 0) return;
+
+    int freeSlot = -1;
+    for (int i = 0; i < TTS_PIPELINE_SLOTS; i++) {
+        if (slots[i].state == SlotState::Free) {
+            freeSlot = i;
+            break;
+        }
+    }
+    if (freeSlot < 0) return;
+
+    String segment;
+    xSemaphoreTake(textMutex, portMAX_DELAY);
+    if (!segments.empty()) {
+        segment = segments[0];
+        segments.erase(segments.begin());
+    }
+    xSemaphoreGive(textMutex);
+    if (segment.length() == 0) return;
+
+    Slot& slot = slots[freeSlot];
+    slot.file = LittleFS.open(slot.path, "w");
+    if (!slot.file) {
+        Serial.printf("[TTSPipe] Failed to open %s\n", slot.path);
+        return;
+    }
+
+    slot.state = SlotState::Writing;
+    writingSlot = freeSlot;
+    synthStartTime = millis();
+
+    if (!tts->speak(segment.c_str())) {
+        slot.file.close();
+        slot.state = SlotState::Free;
+        writingSlot = -1;
+    }
+}
+
+//=============================================================================
+// State
+//=============================================================================
+
+bool TTSPipeline::isIdle() {
+    if (writingSlot >= 0 || !readyOrder.empty() || !handedOrder.empty()) {
+        return false;
+    }
+    if (!textMutex) return true;
+
+    xSemaphoreTake(textMutex, portMAX_DELAY);
+    bool idle = finished && segments.empty() && pending.length() == 0;
+    xSemaphoreGive(textMutex);
+    return idle;
+}
+
+void TTSPipeline::resetSlots() {
+    for (int i = 0; i < TTS_PIPELINE_SLOTS; i++) {
+        if (slots[i].file) {
+            slots[i].file.close();
+        }
+        slots[i].state = SlotState::Free;
+        slots[i].startSeq = 0;
+    }
+    writingSlot = -1;
+    readyOrder.clear();
+    handedOrder.clear();
+}
@@ -0,0 +1,218 @@
+/**
+ * @file tts_pipeline.h
+ * @brief Sentence-pipelined text-to-speech playback
+ *
+ * Splits a streamed LLM response into sentence/clause segments and
+ * synthesizes them one after another while earlier segments are already
+ * playing. Each segment is written to its own LittleFS slot file and
+ * handed to AudioPlayer's gapless queue, so the first words play as soon
+ * as the first sentence is synthesized instead of after the whole answer.
+ */
+
+#ifndef TTS_PIPELINE_H
+#define TTS_PIPELINE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "tts_client.h"
+
+class AudioPlayer;
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Number of segment files (playing + queued + synthesizing) */
+#define TTS_PIPELINE_SLOTS 3
+
+/** Minimum segment length before a sentence break is honored */
+#define TTS_PIPELINE_MIN_SENTENCE 12
+
+/** Minimum segment length before a clause break (, ; :) is honored */
+#define TTS_PIPELINE_MIN_CLAUSE 60
+
+/** Hard segment cap - split at the last space beyond this */
+#define TTS_PIPELINE_MAX_SEGMENT 240
+
+/** Longest leading [emotion] tag that is stripped from speech */
+#define TTS_PIPELINE_MAX_TAG 24
+
+//=============================================================================
+// Statistics
+//=============================================================================
+
+/**
+ * @struct TTSPipelineStats
+ * @brief Latency metrics for the current/last response
+ */
+struct TTSPipelineStats {
+    int32_t timeToFirstAudioMs;     ///< start() to first segment playing (-1 = none)
+    uint32_t segmentsPlayed;        ///< Segments that started playing
+    uint32_t gapCount;              ///< Segment transitions measured
+    uint32_t totalGapMs;            ///< Sum of silences between segments
+    uint32_t maxGapMs;              ///< Longest silence between segments
+    uint32_t synthesisMs;           ///< Total time spent in TTS requests
+
+    TTSPipelineStats() { clear(); }
+
+    void clear() {
+        timeToFirstAudioMs = -1;
+        segmentsPlayed = 0;
+        gapCount = 0;
+        totalGapMs = 0;
+        maxGapMs = 0;
+        synthesisMs = 0;
+    }
+};
+
+//=============================================================================
+// TTSPipeline Class
+//=============================================================================
+
+/**
+ * @class TTSPipeline
+ * @brief Overlaps TTS synthesis of segment N+1 with playback of segment N
+ *
+ * append() and finish() may be called from the LLM worker task; loop()
+ * drives synthesis and playback from the main loop.
+ */
+class TTSPipeline {
+public:
+    TTSPipeline();
+    ~TTSPipeline();
+
+    /**
+     * @brief Attach TTS client and audio player
+     * @return true if ready
+     */
+    bool begin(TTSClient* tts, AudioPlayer* player);
+
+    /**
+     * @brief Begin a new response (clears text and resets metrics)
+     */
+    void start();
+
+    /**
+     * @brief Add streamed response text (thread-safe)
+     */
+    void append(const char* text);
+
+    /**
+     * @brief Strip another leading [emotion] tag from the text that follows
+     *
+     * A response continued after tool results opens with its own tag.
+     * Thread-safe.
+     */
+    void expectTag();
+
+    /**
+     * @brief Mark the response complete and flush the remainder (thread-safe)
+     */
+    void finish();
+
+    /**
+     * @brief Abort synthesis and playback, drop all pending text
+     */
+    void stop();
+
+    /**
+     * @brief Drive synthesis and playback hand-off (call from loop)
+     */
+    void loop();
+
+    /**
+     * @brief True when nothing is pending, synthesizing or playing
+     */
+    bool isIdle();
+
+    /**
+     * @brief True once the first segment of this response is playing
+     */
+    bool hasStartedAudio() const { return stats.segmentsPlayed > 0; }
+
+    /**
+     * @brief Metrics for the current/last response
+     */
+    const TTSPipelineStats& getStats() const { return stats; }
+
+private:
+    enum class SlotState {
+        Free,           ///< Available for synthesis
+        Writing,        ///< TTS audio being written
+        Ready,          ///< Complete, waiting for the player
+        Handed          ///< Playing or queued in AudioPlayer
+    };
+
+    struct Slot {
+        SlotState state;
+        File file;
+        char path[16];
+        uint32_t startSeq;          ///< AudioPlayer start count when it plays
+    };
+
+    /**
+     * @brief Move complete segments from pending text to the queue (mutex held)
+     * @param flushAll Push the remainder even without a boundary
+     */
+    void splitSegments(bool flushAll);
+
+    /**
+     * @brief Strip the leading [emotion] tag and copy into pending (mutex held)
+     */
+    void consumeText(const char* text);
+
+    /**
+     * @brief Release slots the player has moved past, record gap metrics
+     */
+    void trackPlayback();
+
+    /**
+     * @brief Close the writing slot once the TTS request finishes
+     */
+    void checkSynthesis();
+
+    /**
+     * @brief Hand ready slots to the audio player queue
+     */
+    void handoffReady();
+
+    /**
+     * @brief Start synthesizing the next segment into a free slot
+     */
+    void startSynthesis();
+
+    /**
+     * @brief Clear slot bookkeeping and close any open file
+     */
+    void resetSlots();
+
+    TTSClient* tts;
+    AudioPlayer* player;
+    SemaphoreHandle_t textMutex;
+
+    // Text (guarded by textMutex)
+    String pending;
+    std::vector<String> segments;
+    bool finished;
+    bool tagDone;
+    char tagBuf[TTS_PIPELINE_MAX_TAG];
+    size_t tagLen;
+
+    // Slots (main loop only)
+    Slot slots[TTS_PIPELINE_SLOTS];
+    int writingSlot;
+    std::vector<int> readyOrder;
+    std::vector<int> handedOrder;
+    uint32_t synthStartTime;
+
+    // Metrics
+    TTSPipelineStats stats;
+    uint32_t responseStartTime;
+    uint32_t lastSeenStartCount;
+    bool statsLogged;
+};
+
+#endif // TTS_PIPELINE_H
@@ -67,7 +67,12 @@ AudioPlayer::AudioPlayer()
     , file(nullptr)
     , out(nullptr)
     , taskRunning(false)
-    , audioMutex(nullptr) {
+    , audioMutex(nullptr)
+    , startCount(0)
+    , lastStartTime(0)
+    , lastFinishTime(0) {
+    nextFile[0] = '\0';
+
     // Create mutex for thread-safe access to mp3/file between cores
     audioMutex = xSemaphoreCreateMutex();
 }
@@ -222,7 +227,55 @@ bool AudioPlayer::play(const char* filename) {
         return false;
     }
 
-    // Stop any current playback (mutex already held)
+    // Explicit play overrides anything queued
+    nextFile[0] = '\0';
+
+    bool started = startFile(filename);
+
+    xSemaphoreGive(audioMutex);
+    if (started) {
+        Serial.printf("AudioPlayer: Playing %s\n", filename);
+    }
+    return started;
+}
+
+/**
+ * @brief Queue an MP3 file to play right after the current one
+ * @param filename Path to MP3 file
+ * @return true if started or queued
+ */
+bool AudioPlayer::queueNext(const char* filename) {
+    if (!initialized) {
+        Serial.println("AudioPlayer: Not initialized");
+        return false;
+    }
+
+    if (xSemaphoreTake(audioMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        Serial.println("AudioPlayer: Failed to acquire mutex for queue");
+        return false;
+    }
+
+    bool ok;
+    if (!(mp3 && mp3->isRunning())) {
+        // Idle - start right away
+        ok = startFile(filename);
+    } else if (nextFile[0] != '\0') {
+        ok = false;  // Queue slot taken
+    } else {
+        strncpy(nextFile, filename, sizeof(nextFile) - 1);
+        nextFile[sizeof(nextFile) - 1] = '\0';
+        ok = true;
+    }
+
+    xSemaphoreGive(audioMutex);
+    return ok;
+}
+
+/**
+ * @brief Open a file and begin decoding (caller holds audioMutex)
+ */
+bool AudioPlayer::startFile(const char* filename) {
+    // Stop any current playback
     if (mp3 && mp3->isRunning()) {
         mp3->stop();
     }
@@ -237,7 +290,6 @@ bool AudioPlayer::play(const char* filename) {
         Serial.printf("AudioPlayer: Failed to open %s\n", filename);
         delete file;
         file = nullptr;
-        xSemaphoreGive(audioMutex);
         return false;
     }
 
@@ -246,12 +298,11 @@ bool AudioPlayer::play(const char* filename) {
         Serial.printf("AudioPlayer: Failed to start MP3 playback for %s\n", filename);
         delete file;
         file = nullptr;
-        xSemaphoreGive(audioMutex);
         return false;
     }
 
-    xSemaphoreGive(audioMutex);
-    Serial.printf("AudioPlayer: Playing %s\n", filename);
+    lastStartTime = millis();
+    startCount++;
     return true;
 }
 
@@ -265,6 +316,7 @@ void AudioPlayer::stop() {
         return;
     }
 
+    nextFile[0] = '\0';
     if (mp3 && mp3->isRunning()) {
         mp3->stop();
     }
@@ -310,7 +362,17 @@ void AudioPlayer::taskUpdate() {
                 delete file;
                 file = nullptr;
             }
-            Serial.println("AudioPlayer: Playback finished");
+            lastFinishTime = millis();
+
+            // Start the queued file without waiting for the main loop
+            if (nextFile[0] != '\0') {
+                char queued[sizeof(nextFile)];
+                strcpy(queued, nextFile);
+                nextFile[0] = '\0';
+                startFile(queued);
+            } else {
+                Serial.println("AudioPlayer: Playback finished");
+            }
         }
     }
 
@@ -65,7 +65,24 @@ public:
     bool play(const char* filename);
 
     /**
-     * @brief Stop current playback
+     * @brief Queue an MP3 file to start the moment current playback ends
+     *
+     * The audio task switches files without returning to the main loop,
+     * so consecutive clips play back-to-back. Starts immediately if
+     * nothing is playing. Only one file can be queued at a time.
+     *
+     * @param filename Path to MP3 file
+     * @return true if started or queued, false if a file is already queued
+     */
+    bool queueNext(const char* filename);
+
+    /**
+     * @brief Check if a file is waiting in the queue slot
+     */
+    bool hasQueued() const { return nextFile[0] != '\0'; }
+
+    /**
+     * @brief Stop current playback (and drop any queued file)
      */
     void stop();
 
@@ -115,7 +132,28 @@ public:
      */
     float getMicAttenuation() const { return micAttenuation; }
 
+    /**
+     * @brief Number of files started since boot (play or queued)
+     */
+    uint32_t getStartCount() const { return startCount; }
+
+    /**
+     * @brief millis() when the most recent file started
+     */
+    uint32_t getLastStartTime() const { return lastStartTime; }
+
+    /**
+     * @brief millis() when the most recent file finished on its own
+     */
+    uint32_t getLastFinishTime() const { return lastFinishTime; }
+
 private:
+    /**
+     * @brief Open a file and start the decoder (audioMutex must be held)
+     * @return true if playback started
+     */
+    bool startFile(const char* filename);
+
     /**
      * @brief Initialize the ES8311 audio codec
      * @return true if successful
@@ -134,6 +172,12 @@ private:
 
     // Thread synchronization
     SemaphoreHandle_t audioMutex;   ///< Mutex for mp3/file access between cores
+
+    // Gapless queue and timing
+    char nextFile[48];                  ///< File to start when current ends
+    volatile uint32_t startCount;       ///< Files started since boot
+    volatile uint32_t lastStartTime;    ///< millis() of last start
+    volatile uint32_t lastFinishTime;   ///< millis() of last natural finish
 };
 
 #endif // AUDIO_PLAYER_H
@@ -0,0 +1,285 @@
+/**
+ * @file expression_sequence.cpp
+ * @brief Timed expression/gaze/sound sequence implementation
+ */
+
+#include "expression_sequence.h"
+
+//=============================================================================
+// Vocabulary
+//=============================================================================
+
+/** Sounds on LittleFS that a step may play (as play_sound) */
+static const char* const SEQUENCE_SOUNDS[] = { "happy", "sad", "alert", "confirm", "error" };
+
+struct LookDirection {
+    const char* name;
+    float x;
+    float y;
+};
+
+static const LookDirection LOOK_DIRECTIONS[] = {
+    { "center", 0.0f, 0.0f },
+    { "left", -1.0f, 0.0f },
+    { "right", 1.0f, 0.0f },
+    { "up", 0.0f, -1.0f },
+    { "down", 0.0f, 1.0f },
+};
+
+/**
+ * parseExpression() falls back to Neutral for unknown words; a sequence
+ * rejects them instead. "wink" is accepted here too.
+ */
+static bool lookupExpression(const char* name, Expression& out) {
+    if (strcasecmp(name, "wink") == 0) {
+        out = Expression::Wink;
+        return true;
+    }
+    out = parseExpression(name);
+    return out != Expression::Neutral || strcasecmp(name, "neutral") == 0;
+}
+
+//=============================================================================
+// Constructor / Initialization
+//=============================================================================
+
+ExpressionSequence::ExpressionSequence()
+    : count(0)
+    , next(0)
+    , startMs(0)
+    , lengthMs(0)
+    , active(false)
+    , gazeActive(false)
+    , gazeX(0.0f)
+    , gazeY(0.0f)
+    , stagedCount(0)
+    , pending(false)
+    , stopRequested(false)
+    , mutex(nullptr)
+    , stepCallback(nullptr)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void ExpressionSequence::begin() {
+    if (!mutex) mutex = xSemaphoreCreateMutex();
+}
+
+//=============================================================================
+// Validation
+//=============================================================================
+
+int ExpressionSequence::parse(JsonArrayConst timeline, SequenceStep* steps, String& error) {
+    if (timeline.isNull() || timeline.size() == 0) {
+        error = "steps must be a non-empty array";
+        return -1;
+    }
+    if (timeline.size() > SEQUENCE_MAX_STEPS) {
+        error = "At most " + String(SEQUENCE_MAX_STEPS) + " steps";
+        return -1;
+    }
+
+    uint32_t at = 0;
+    int n = 0;
+    for (JsonVariantConst element : timeline) {
+        String where = "Step " + String(n + 1) + ": ";
+        JsonObjectConst item = element.as<JsonObjectConst>();
+        if (item.isNull()) {
+            error = where + "not an object";
+            return -1;
+        }
+
+        SequenceStep& step = steps[n];
+        memset(&step, 0, sizeof(step));
+        step.atMs = at;
+
+        const char* expression = item["expression"];
+        if (expression) {
+            if (!lookupExpression(expression, step.expression)) {
+                error = where + "unknown expression '" + expression + "'";
+                return -1;
+            }
+            step.setsExpression = true;
+        }
+
+        const char* look = item["look"];
+        JsonVariantConst gazeXValue = item["gaze_x"];
+        JsonVariantConst gazeYValue = item["gaze_y"];
+        bool hasGazeXY = !gazeXValue.isNull() || !gazeYValue.isNull();
+        if (look && hasGazeXY) {
+            error = where + "use either look or gaze_x/gaze_y";
+            return -1;
+        }
+        if (look) {
+            bool found = false;
+            for (const LookDirection& direction : LOOK_DIRECTIONS) {
+                if (strcasecmp(look, direction.name) == 0) {
+                    step.gazeX = direction.x;
+                    step.gazeY = direction.y;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                error = where + "look must be center, left, right, up or down";
+                return -1;
+            }
+            step.setsGaze = true;
+        } else if (hasGazeXY) {
+            if ((!gazeXValue.isNull() && !gazeXValue.is<float>()) ||
+                (!gazeYValue.isNull() && !gazeYValue.is<float>())) {
+                error = where + "gaze_x and gaze_y must be numbers";
+                return -1;
+            }
+            float x = gazeXValue | 0.0f;
+            float y = gazeYValue | 0.0f;
+            if (x < -1.0f || x > 1.0f || y < -1.0f || y > 1.0f) {
+                error = where + "gaze_x and gaze_y must be between -1 and 1";
+                return -1;
+            }
+            step.gazeX = x;
+            step.gazeY = y;
+            step.setsGaze = true;
+        }
+
+        const char* sound = item["sound"];
+        if (sound) {
+            bool found = false;
+            for (const char* name : SEQUENCE_SOUNDS) {
+                if (strcmp(sound, name) == 0) { found = true; break; }
+            }
+            if (!found) {
+                error = where + "sound must be happy, sad, alert, confirm or error";
+                return -1;
+            }
+            strncpy(step.sound, sound, sizeof(step.sound) - 1);
+        }
+
+        JsonVariantConst durationValue = item["duration_ms"];
+        if (!durationValue.isNull() && !durationValue.is<int32_t>()) {
+            error = where + "duration_ms must be an integer";
+            return -1;
+        }
+        int32_t duration = durationValue | 0;
+        if (duration < 0 || duration > SEQUENCE_MAX_STEP_MS) {
+            error = where + "duration_ms must be 0 to " + String(SEQUENCE_MAX_STEP_MS);
+            return -1;
+        }
+        if (!step.setsExpression && !step.setsGaze && !step.sound[0] && duration == 0) {
+            error = where + "does nothing";
+            return -1;
+        }
+        step.durationMs = duration;
+
+        at += duration;
+        if (at > SEQUENCE_MAX_TOTAL_MS) {
+            error = "Sequence longer than " + String(SEQUENCE_MAX_TOTAL_MS / 1000) + " s";
+            return -1;
+        }
+        n++;
+    }
+    return n;
+}
+
+uint32_t ExpressionSequence::totalMs(const SequenceStep* steps, size_t count) {
+    if (count == 0) return 0;
+    return steps[count - 1].atMs + steps[count - 1].durationMs;
+}
+
+//=============================================================================
+// Control (any task)
+//=============================================================================
+
+bool ExpressionSequence::play(const SequenceStep* newSteps, size_t newCount) {
+    if (!mutex || newCount == 0 || newCount > SEQUENCE_MAX_STEPS) return false;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    memcpy(staged, newSteps, newCount * sizeof(SequenceStep));
+    stagedCount = newCount;
+    stopRequested = false;
+    pending = true;
+    xSemaphoreGive(mutex);
+    return true;
+}
+
+void ExpressionSequence::stop() {
+    if (!mutex) return;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    pending = false;
+    stopRequested = true;
+    xSemaphoreGive(mutex);
+}
+
+bool ExpressionSequence::getGaze(float& x, float& y) const {
+    if (!gazeActive) return false;
+    x = gazeX;
+    y = gazeY;
+    return true;
+}
+
+//=============================================================================
+// Playback (main loop)
+//=============================================================================
+
+void ExpressionSequence::update(uint32_t nowMs) {
+    if (pending || stopRequested) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        bool start = pending;
+        bool stopNow = stopRequested;
+        if (start) {
+            memcpy(steps, staged, stagedCount * sizeof(SequenceStep));
+            count = stagedCount;
+        }
+        pending = false;
+        stopRequested = false;
+        xSemaphoreGive(mutex);
+
+        if (active && (start || stopNow)) finish(nowMs, false);
+        if (start) {
+            active = true;
+            next = 0;
+            startMs = nowMs;
+            lengthMs = totalMs(steps, count);
+            stats.played++;
+            Serial.printf("[Sequence] Playing %u steps (%lu ms)\n", count, lengthMs);
+        }
+    }
+    if (!active) return;
+
+    // Steps are due at fixed offsets from the start, so a late frame
+    // delays one step but never shifts the ones after it
+    uint32_t elapsed = nowMs - startMs;
+    while (next < count && steps[next].atMs <= elapsed) {
+        const SequenceStep& step = steps[next++];
+
+        uint32_t late = elapsed - step.atMs;
+        stats.stepsRun++;
+        stats.totalLateMs += late;
+        if (late > stats.maxLateMs) stats.maxLateMs = late;
+
+        if (step.setsGaze) {
+            gazeActive = true;
+            gazeX = step.gazeX;
+            gazeY = step.gazeY;
+        }
+        if (stepCallback) stepCallback(step);
+    }
+
+    if (next >= count && elapsed >= lengthMs) finish(nowMs, true);
+}
+
+void ExpressionSequence::finish(uint32_t nowMs, bool completed) {
+    uint32_t elapsed = nowMs - startMs;
+    active = false;
+    gazeActive = false;
+
+    if (completed) {
+        stats.lastEndErrorMs = elapsed - lengthMs;
+        Serial.printf("[Sequence] Done: %u steps in %lu ms (planned %lu ms)\n",
+                      count, elapsed, lengthMs);
+    } else {
+        stats.stopped++;
+        Serial.printf("[Sequence] Stopped after %u of %u steps\n", next, count);
+    }
+}
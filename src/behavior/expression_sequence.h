@@ -0,0 +1,164 @@
+/**
+ * @file expression_sequence.h
+ * @brief Timed expression/gaze/sound sequences played on the frame clock
+ *
+ * A sequence is a list of steps, each optionally setting an expression,
+ * a gaze target and a sound, then holding for a duration. It is validated
+ * as a whole before anything plays, so a bad step rejects the sequence
+ * instead of leaving the eyes halfway through it.
+ *
+ * Every step is scheduled at a fixed offset from the sequence start and
+ * fired by the first frame at or after that time. Lateness is therefore
+ * at most one frame and never accumulates over the sequence, unlike a
+ * chain of separate set_expression calls that each add network jitter.
+ *
+ * play() and stop() may be called from any task (MCP server, assistant);
+ * the sequence is handed over to update() on the main loop.
+ */
+
+#ifndef EXPRESSION_SEQUENCE_H
+#define EXPRESSION_SEQUENCE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <functional>
+#include "expressions.h"
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Most steps in one sequence */
+#define SEQUENCE_MAX_STEPS 32
+
+/** Longest single step (ms) */
+#define SEQUENCE_MAX_STEP_MS 10000
+
+/** Longest whole sequence (ms) */
+#define SEQUENCE_MAX_TOTAL_MS 60000
+
+/** Longest sound name, without the "/" and ".mp3" */
+#define SEQUENCE_SOUND_NAME_SIZE 12
+
+//=============================================================================
+// Types
+//=============================================================================
+
+/**
+ * @struct SequenceStep
+ * @brief One validated step of a sequence
+ */
+struct SequenceStep {
+    uint32_t atMs;              ///< Start, relative to the sequence start
+    uint16_t durationMs;        ///< Hold before the next step
+    bool setsExpression;
+    Expression expression;
+    bool setsGaze;
+    float gazeX;                ///< -1 (left) .. 1 (right)
+    float gazeY;                ///< -1 (up) .. 1 (down)
+    char sound[SEQUENCE_SOUND_NAME_SIZE];   ///< Empty for none
+};
+
+/**
+ * @struct SequenceStats
+ * @brief Timing accuracy since boot
+ */
+struct SequenceStats {
+    uint32_t played;
+    uint32_t stopped;           ///< Ended early by stop() or a newer sequence
+    uint32_t stepsRun;
+    uint32_t maxLateMs;         ///< Worst step start after its scheduled time
+    uint64_t totalLateMs;
+    uint32_t lastEndErrorMs;    ///< Last completed sequence: actual minus planned length
+};
+
+using SequenceStepCallback = std::function<void(const SequenceStep& step)>;
+
+//=============================================================================
+// ExpressionSequence Class
+//=============================================================================
+
+class ExpressionSequence {
+public:
+    ExpressionSequence();
+
+    /**
+     * @brief Create the hand-over mutex
+     */
+    void begin();
+
+    /**
+     * @brief Validate a JSON timeline into steps
+     *
+     * Each element: {"expression", "look" or "gaze_x"/"gaze_y", "sound",
+     * "duration_ms"}, all optional but at least one action or a duration.
+     *
+     * @param steps Output, SEQUENCE_MAX_STEPS entries
+     * @param error Reason when the timeline is rejected
+     * @return Number of steps, or -1 if invalid
+     */
+    static int parse(JsonArrayConst timeline, SequenceStep* steps, String& error);
+
+    /**
+     * @brief Start a sequence, replacing any running one (any task)
+     *
+     * Starts on the next update().
+     */
+    bool play(const SequenceStep* steps, size_t count);
+
+    /**
+     * @brief Stop the running sequence (any task)
+     */
+    void stop();
+
+    /**
+     * @brief Fire the steps that are due (main loop, every frame)
+     * @param nowMs Frame time
+     */
+    void update(uint32_t nowMs);
+
+    bool isActive() const { return active || pending; }
+
+    /**
+     * @brief Gaze target set by the sequence
+     * @return false if the sequence does not control the gaze
+     */
+    bool getGaze(float& x, float& y) const;
+
+    void onStep(SequenceStepCallback callback) { stepCallback = callback; }
+
+    const SequenceStats& getStats() const { return stats; }
+
+    /**
+     * @brief Length of a validated sequence (ms)
+     */
+    static uint32_t totalMs(const SequenceStep* steps, size_t count);
+
+private:
+    void finish(uint32_t nowMs, bool completed);
+
+    // Playing, owned by the main loop
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    size_t count;
+    size_t next;
+    uint32_t startMs;
+    uint32_t lengthMs;
+    bool active;
+    bool gazeActive;
+    float gazeX;
+    float gazeY;
+
+    // Handed over from other tasks
+    SequenceStep staged[SEQUENCE_MAX_STEPS];
+    size_t stagedCount;
+    volatile bool pending;
+    volatile bool stopRequested;
+    SemaphoreHandle_t mutex;
+
+    SequenceStepCallback stepCallback;
+    SequenceStats stats;
+};
+
+#endif // EXPRESSION_SEQUENCE_H
@@ -26,9 +26,14 @@
 #include "network/web_server.h"
 #include "network/captive_portal.h"
 #include "network/ota_manager.h"
+#include "network/connection_manager.h"
+#include "network/display_stream.h"
 #include "behavior/breathing_exercise.h"
+#include "behavior/expression_sequence.h"
 #include "assistant/mcp_server.h"
 #include "assistant/device_tools.h"
+#include "assistant/device_tool_queue.h"
+#include "assistant/assistant.h"
 
 #define SCREEN_WIDTH  368
 #define SCREEN_HEIGHT 448
@@ -77,6 +82,7 @@ AudioPlayer audioPlayer;
 SettingsMenu settingsMenu;
 PomodoroTimer pomodoroTimer;
 CountdownTimer countdownTimer;
+ExpressionSequence expressionSequence;
 WiFiManager wifiManager;
 WebServerManager webServer;
 CaptivePortal captivePortal;
@@ -621,9 +627,15 @@ void updateGaze() {
         gazeX.setTarget(constrain(targetX, -1.0f, 1.0f));
         gazeY.setTarget(constrain(targetY, -1.0f, 1.0f));
     } else if (millis() - lastTouchTime > 500) {
-        // When not touching, use idle gaze
-        gazeX.setTarget(idle.getIdleGazeX());
-        gazeY.setTarget(idle.getIdleGazeY());
+        // When not touching, a playing sequence directs the gaze, else idle gaze
+        float sequenceX, sequenceY;
+        if (expressionSequence.getGaze(sequenceX, sequenceY)) {
+            gazeX.setTarget(sequenceX);
+            gazeY.setTarget(sequenceY);
+        } else {
+            gazeX.setTarget(idle.getIdleGazeX());
+            gazeY.setTarget(idle.getIdleGazeY());
+        }
     }
 
     // Update tweeners
@@ -1458,6 +1470,145 @@ void renderBreathingBars() {
     gfx->endWrite();
 }
 
+//=============================================================================
+// MCP State Resources
+//=============================================================================
+
+static const char* const COUNTDOWN_STATE_NAMES[] = { "idle", "running", "celebration" };
+static const char* const POMODORO_STATE_NAMES[] = {
+    "idle", "working", "short_break", "long_break", "celebration", "waiting_for_tap"
+};
+static const char* const ASSISTANT_STATE_NAMES[] = {
+    "disabled", "idle", "listening", "processing", "speaking", "error"
+};
+static const char* const ORIENTATION_NAMES[] = { "normal", "face_down", "tilted_long" };
+
+/**
+ * @struct DeviceStateSnapshot
+ * @brief What the deskbuddy://state/ resources report, copied on the main loop
+ *
+ * The timers, IMU and settings are only safe to read from this loop, and
+ * the timer name is a String it may reassign at any time. The MCP task
+ * reads this copy instead, under deviceStateMutex.
+ */
+struct DeviceStateSnapshot {
+    Expression expression;
+    CountdownState countdown;
+    char timerName[48];
+    uint32_t timerRemaining;
+    PomodoroState pomodoro;
+    int pomodoroSession;
+    uint32_t pomodoroRemaining;
+    AssistantState assistantState;
+    Orientation orientation;
+    bool held, flipped;
+    float tiltX, tiltY;
+    int volume, brightness, colorIndex;
+};
+
+static DeviceStateSnapshot deviceState = {};
+static SemaphoreHandle_t deviceStateMutex = nullptr;
+
+static void captureDeviceState(DeviceStateSnapshot& snapshot) {
+    snapshot.expression = currentExpression;
+    snapshot.countdown = countdownTimer.getState();
+    strncpy(snapshot.timerName, countdownTimer.getTimerName(), sizeof(snapshot.timerName) - 1);
+    snapshot.timerName[sizeof(snapshot.timerName) - 1] = '\0';
+    snapshot.timerRemaining = countdownTimer.isActive() ? countdownTimer.getRemainingSeconds() : 0;
+    snapshot.pomodoro = pomodoroTimer.getState();
+    snapshot.pomodoroSession = pomodoroTimer.getSessionNumber();
+    snapshot.pomodoroRemaining = pomodoroTimer.isActive() ? pomodoroTimer.getRemainingSeconds() : 0;
+    snapshot.assistantState = assistant.getState();
+    snapshot.orientation = imu.getOrientation();
+    snapshot.held = imu.isBeingHeld();
+    snapshot.flipped = imu.isFlipped();
+    snapshot.tiltX = imu.getTiltX();
+    snapshot.tiltY = imu.getTiltY();
+    snapshot.volume = settingsMenu.getVolume();
+    snapshot.brightness = settingsMenu.getBrightness();
+    snapshot.colorIndex = settingsMenu.getColorIndex();
+}
+
+/**
+ * Contents of a deskbuddy://state/ resource (MCP server task), from the
+ * last frame's snapshot
+ */
+void readDeviceResource(DeviceResource resource, JsonObject state) {
+    DeviceStateSnapshot snapshot;
+    xSemaphoreTake(deviceStateMutex, portMAX_DELAY);
+    snapshot = deviceState;
+    xSemaphoreGive(deviceStateMutex);
+
+    switch (resource) {
+        case DeviceResource::Expression:
+            state["expression"] = getExpressionName(snapshot.expression);
+            break;
+        case DeviceResource::Timer:
+            state["state"] = COUNTDOWN_STATE_NAMES[(int)snapshot.countdown];
+            if (snapshot.countdown != CountdownState::Idle) {
+                state["name"] = snapshot.timerName;
+                state["remaining_seconds"] = snapshot.timerRemaining;
+            }
+            break;
+        case DeviceResource::Pomodoro:
+            state["state"] = POMODORO_STATE_NAMES[(int)snapshot.pomodoro];
+            state["session"] = snapshot.pomodoroSession;
+            if (snapshot.pomodoro != PomodoroState::Idle) {
+                state["remaining_seconds"] = snapshot.pomodoroRemaining;
+            }
+            break;
+        case DeviceResource::Assistant:
+            state["state"] = ASSISTANT_STATE_NAMES[(int)snapshot.assistantState];
+            break;
+        case DeviceResource::Sensors:
+            state["orientation"] = ORIENTATION_NAMES[(int)snapshot.orientation];
+            state["held"] = snapshot.held;
+            state["flipped"] = snapshot.flipped;
+            state["tilt_x"] = snapshot.tiltX;
+            state["tilt_y"] = snapshot.tiltY;
+            break;
+        case DeviceResource::Settings:
+            state["volume"] = snapshot.volume;
+            state["brightness"] = snapshot.brightness;
+            state["eye_color"] = COLOR_PRESET_NAMES[snapshot.colorIndex];
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Snapshot the published state for the MCP task, then notify subscribers
+ * of what changed since last frame. The snapshot is in place before the
+ * notification, so a client that reads on it sees the new state.
+ * Countdowns are not tracked per second - clients read remaining_seconds
+ * when the phase changes.
+ */
+void publishDeviceState() {
+    DeviceStateSnapshot previous = deviceState;
+    DeviceStateSnapshot current;
+    captureDeviceState(current);
+
+    xSemaphoreTake(deviceStateMutex, portMAX_DELAY);
+    deviceState = current;
+    xSemaphoreGive(deviceStateMutex);
+
+    if (current.expression != previous.expression) notifyDeviceResource(DeviceResource::Expression);
+    if (current.countdown != previous.countdown) notifyDeviceResource(DeviceResource::Timer);
+    if (current.pomodoro != previous.pomodoro || current.pomodoroSession != previous.pomodoroSession) {
+        notifyDeviceResource(DeviceResource::Pomodoro);
+    }
+    if (current.assistantState != previous.assistantState) notifyDeviceResource(DeviceResource::Assistant);
+    if (current.orientation != previous.orientation || current.held != previous.held ||
+        current.flipped != previous.flipped) {
+        notifyDeviceResource(DeviceResource::Sensors);
+    }
+    if (current.volume != previous.volume || current.brightness != previous.brightness ||
+        current.colorIndex != previous.colorIndex) {
+        notifyDeviceResource(DeviceResource::Settings);
+    }
+}
+
 void setup() {
     Serial.begin(115200);
     delay(500);
@@ -1579,20 +1730,32 @@ void setup() {
     // Initialize OTA manager (validates boot partition)
     otaManager.begin();
 
+    // Device tools asked for by the LLM and MCP tasks run on this loop
+    deviceToolQueue.begin();
+
+    // State the MCP task reads, and the baseline the first frame compares to
+    deviceStateMutex = xSemaphoreCreateMutex();
+    captureDeviceState(deviceState);
+
     // Start web server (works in both AP and STA mode)
     webServer.begin(&settingsMenu, &pomodoroTimer, &wifiManager, &otaManager);
     webServer.setExpressionCallback(onWebExpressionPreview);
     webServer.setAudioTestCallback(onWebAudioTest);
     webServer.setMoodGetterCallback(getCurrentMood);
+    webServer.setMicLevelCallback([]() { return audio.getSmoothedLevel(); });
     webServer.setBreathingExercise(&breathingExercise);
     webServer.setCountdownTimer(&countdownTimer);
     webServer.setReminderManager(&reminderManager);
 
     // Wire up MCP device tool callbacks
     deviceToolCallbacks.onSetExpression = [](const char* expression, int durationMs) {
+        expressionSequence.stop();  // Latest command wins
         Expression expr = parseExpression(expression);
         setExpression(expr);
     };
+    deviceToolCallbacks.onPlaySequence = [](const SequenceStep* steps, size_t count) -> bool {
+        return expressionSequence.play(steps, count);
+    };
     deviceToolCallbacks.onSetTimer = [](int seconds, const char* name) {
         countdownTimer.start(seconds, name);
     };
@@ -1675,6 +1838,19 @@ void setup() {
         }
         return false;
     };
+    deviceToolCallbacks.onReadResource = readDeviceResource;
+
+    // Sequence steps run on this loop's frame clock
+    expressionSequence.begin();
+    expressionSequence.onStep([](const SequenceStep& step) {
+        if (step.setsExpression) setExpression(step.expression);
+        if (step.sound[0]) {
+            String path = "/";
+            path += step.sound;
+            path += ".mp3";
+            audioPlayer.play(path.c_str());
+        }
+    });
 
     // Initialize gaze tweeners
     gazeX.setSmoothTime(0.15f);
@@ -1722,6 +1898,9 @@ void setup() {
 void loop() {
     uint32_t now = millis();
 
+    // Run device tool calls staged by other tasks without waiting for a frame
+    deviceToolQueue.update();
+
     // Calculate delta time
     deltaTime = (now - lastFrameTime) / 1000.0f;
     if (deltaTime < 0.001f) deltaTime = 0.001f;  // Clamp minimum
@@ -1731,6 +1910,9 @@ void loop() {
     if (deltaTime < 0.033f) return;
     lastFrameTime = now;
 
+    // Mirror the frame drawn last time round to /api/display/stream viewers
+    displayStream.capture(eyeBuffer, now);
+
     // Update WiFi state machine (handles connection, reconnection, factory reset)
     wifiManager.update();
 
@@ -1759,6 +1941,15 @@ void loop() {
     // Update MCP SSE keepalive
     mcpServer.update();
 
+    // Push state changes to MCP resource subscribers
+    publishDeviceState();
+
+    // Push status changes to open settings pages
+    webServer.update(now);
+
+    // Expire idle pooled HTTPS connections
+    connectionManager.update();
+
     // Apply settings changes from web interface
     if (webServer.hasSettingsChange()) {
         audioPlayer.setVolume(settingsMenu.getVolume());
@@ -2340,6 +2531,9 @@ void loop() {
         joyBouncePhase += deltaTime * 3.0f;  // Same bounce rate as Joy
     }
 
+    // Fire due play_sequence steps
+    expressionSequence.update(now);
+
     //=========================================================================
     // Micro-Expression Behavior (random idle personality moments)
     //=========================================================================
@@ -2349,6 +2543,7 @@ void loop() {
         !sleepBehavior.isDrowsy() && !isPetted && !isImuReacting &&
         !showingIrritated && !showingLove && !showingJoy &&
         !debugExpressionActive && currentExpression == Expression::Neutral &&
+        !expressionSequence.isActive() &&
         !breathingExercise.needsFullScreenRender() &&
         breathingRelaxedUntil == 0 && breathingContentUntil == 0) {
         triggerRandomMicroExpression();
@@ -2374,7 +2569,7 @@ void loop() {
 
     // Cancel micro-expression on interaction
     if (microExprActive && (isPetted || isImuReacting || showingLove ||
-        showingIrritated || showingJoy)) {
+        showingIrritated || showingJoy || expressionSequence.isActive())) {
         microExprActive = false;
         currentMicroExpr = MicroExpressionType::None;
         Serial.println("Micro-expression cancelled by interaction");
@@ -2404,7 +2599,7 @@ void loop() {
     // Only applies when no active behaviors are controlling the expression
     if (currentExpression != Expression::Neutral &&
         !isPetted && !isImuReacting && !showingLove && !showingJoy && !microExprActive &&
-        !showingIrritated && !debugExpressionActive &&
+        !showingIrritated && !debugExpressionActive && !expressionSequence.isActive() &&
         !sleepBehavior.isDrowsy() && !sleepBehavior.isWakingUp() &&
         (now - lastExpressionChange > EXPRESSION_TIMEOUT)) {
         Serial.println("Expression timeout - returning to Neutral");
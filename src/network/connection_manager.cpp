@@ -0,0 +1,430 @@
+/**
+ * @file connection_manager.cpp
+ * @brief Shared HTTPS connection pool implementation
+ */
+
+#include "connection_manager.h"
+#include <WiFi.h>
+
+// Global instance
+ConnectionManager connectionManager;
+
+//=============================================================================
+// HttpChunkDecoder
+//=============================================================================
+
+void HttpChunkDecoder::reset() {
+    state = State::Size;
+    remaining = 0;
+    trailerLineLen = 0;
+    sawDigit = false;
+}
+
+size_t HttpChunkDecoder::decode(uint8_t* buf, size_t length) {
+    size_t out = 0;
+    size_t i = 0;
+
+    while (i < length && state != State::Done && state != State::Error) {
+        uint8_t c = buf[i];
+
+        switch (state) {
+            case State::Size:
+                if (isxdigit(c)) {
+                    int digit = isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10);
+                    remaining = (remaining << 4) | digit;
+                    sawDigit = true;
+                } else if (c == ';' || c == ' ') {
+                    state = State::Extension;
+                } else if (c == '\n') {
+                    if (!sawDigit) {
+                        state = State::Error;
+                    } else {
+                        state = remaining > 0 ? State::Data : State::Trailer;
+                    }
+                } else if (c != '\r') {
+                    state = State::Error;
+                }
+                i++;
+                break;
+
+            case State::Extension:
+                if (c == '\n') {
+                    state = remaining > 0 ? State::Data : State::Trailer;
+                }
+                i++;
+                break;
+
+            case State::Data: {
+                size_t n = min(remaining, length - i);
+                memmove(buf + out, buf + i, n);
+                out += n;
+                i += n;
+                remaining -= n;
+                if (remaining == 0) state = State::DataEnd;
+                break;
+            }
+
+            case State::DataEnd:
+                if (c == '\n') {
+                    state = State::Size;
+                    remaining = 0;
+                    sawDigit = false;
+                } else if (c != '\r') {
+                    state = State::Error;
+                }
+                i++;
+                break;
+
+            case State::Trailer:
+                // Trailer headers end with an empty line
+                if (c == '\n') {
+                    if (trailerLineLen == 0) state = State::Done;
+                    trailerLineLen = 0;
+                } else if (c != '\r') {
+                    trailerLineLen++;
+                }
+                i++;
+                break;
+
+            default:
+                i++;
+                break;
+        }
+    }
+
+    return out;
+}
+
+//=============================================================================
+// HttpBodyStream
+//=============================================================================
+
+HttpBodyStream::HttpBodyStream(NetworkClient* source, bool chunked, int contentLength, uint32_t timeoutMs)
+    : source(source)
+    , chunked(chunked)
+    , remaining(chunked ? -1 : contentLength)
+    , timeoutMs(timeoutMs)
+    , bufLen(0)
+    , bufPos(0)
+{
+}
+
+bool HttpBodyStream::isComplete() const {
+    if (bufPos < bufLen) return false;
+    return chunked ? decoder.isComplete() : remaining == 0;
+}
+
+bool HttpBodyStream::fill(uint32_t waitMs) {
+    if (bufPos < bufLen) return true;
+    if (!source) return false;
+
+    uint32_t startTime = millis();
+
+    while (true) {
+        if (chunked ? (decoder.isComplete() || decoder.hasError()) : remaining == 0) {
+            return false;
+        }
+
+        size_t avail = source->available();
+        if (avail > 0) {
+            size_t toRead = min(avail, sizeof(buf));
+            if (!chunked && remaining > 0) toRead = min(toRead, (size_t)remaining);
+
+            int n = source->read(buf, toRead);
+            if (n > 0) {
+                if (!chunked && remaining > 0) remaining -= n;
+                bufLen = chunked ? decoder.decode(buf, n) : n;
+                bufPos = 0;
+                if (bufLen > 0) return true;
+                continue;   // Only framing bytes - keep going
+            }
+        }
+
+        if (!source->connected() || millis() - startTime >= waitMs) return false;
+        delay(1);
+    }
+}
+
+int HttpBodyStream::available() {
+    fill(0);
+    return bufLen - bufPos;
+}
+
+int HttpBodyStream::peek() {
+    if (!fill(timeoutMs)) return -1;
+    return buf[bufPos];
+}
+
+int HttpBodyStream::read() {
+    if (!fill(timeoutMs)) return -1;
+    return buf[bufPos++];
+}
+
+size_t HttpBodyStream::readBytes(char* buffer, size_t length) {
+    size_t copied = 0;
+
+    while (copied < length && fill(timeoutMs)) {
+        size_t n = min(length - copied, bufLen - bufPos);
+        memcpy(buffer + copied, buf + bufPos, n);
+        copied += n;
+        bufPos += n;
+    }
+    return copied;
+}
+
+bool HttpBodyStream::drain(uint32_t waitMs) {
+    while (fill(waitMs)) {
+        bufPos = bufLen;
+    }
+    return isComplete();
+}
+
+//=============================================================================
+// Constructor / Initialization
+//=============================================================================
+
+ConnectionManager::ConnectionManager()
+    : mutex(nullptr)
+{
+    memset(&stats, 0, sizeof(stats));
+    for (int i = 0; i < CONN_MAX_CONNECTIONS; i++) {
+        entries[i].host[0] = '\0';
+        entries[i].port = 0;
+        entries[i].client = nullptr;
+        entries[i].inUse = false;
+        entries[i].lastUsed = 0;
+    }
+}
+
+bool ConnectionManager::begin() {
+    if (mutex) return true;
+
+    mutex = xSemaphoreCreateMutex();
+    if (!mutex) {
+        Serial.println("[Conn] Failed to create mutex");
+        return false;
+    }
+
+    Serial.printf("[Conn] Pool ready (%d TLS connections, %d KB cap)\n",
+                  CONN_MAX_CONNECTIONS, CONN_TLS_MEMORY_CAP / 1024);
+    return true;
+}
+
+//=============================================================================
+// Leasing
+//=============================================================================
+
+NetworkClientSecure* ConnectionManager::acquire(const char* host, uint16_t port) {
+    if (!host || !*host || strlen(host) >= CONN_MAX_HOST_LENGTH) return nullptr;
+    if (!mutex && !begin()) return nullptr;
+
+    uint32_t startTime = millis();
+
+    while (true) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+
+        // Kept-alive socket to the same host - no handshake needed
+        for (int i = 0; i < CONN_MAX_CONNECTIONS; i++) {
+            Entry& e = entries[i];
+            if (e.inUse || !e.client || e.port != port || strcmp(e.host, host) != 0) continue;
+            if (!e.client->connected()) continue;
+
+            // Discard anything left over from the previous response
+            while (e.client->available() > 0) e.client->read();
+
+            e.inUse = true;
+            e.lastUsed = millis();
+            stats.reuses++;
+            xSemaphoreGive(mutex);
+            return e.client;
+        }
+
+        int idx = claimEntry(host, port);
+        xSemaphoreGive(mutex);
+
+        if (idx >= 0) {
+            Entry& e = entries[idx];
+            if (connectEntry(e)) return e.client;
+
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            e.inUse = false;
+            xSemaphoreGive(mutex);
+            return nullptr;
+        }
+
+        // Every connection is leased - wait for one to come back
+        if (millis() - startTime > CONN_ACQUIRE_TIMEOUT_MS) {
+            Serial.printf("[Conn] Pool exhausted, no connection for %s\n", host);
+            return nullptr;
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+
+NetworkClientSecure* ConnectionManager::acquireForUrl(const char* url) {
+    if (!url || strncmp(url, "https://", 8) != 0) return nullptr;
+
+    const char* start = url + 8;
+    const char* end = start;
+    while (*end && *end != '/' && *end != ':' && *end != '?') end++;
+
+    size_t hostLen = end - start;
+    if (hostLen == 0 || hostLen >= CONN_MAX_HOST_LENGTH) return nullptr;
+
+    char host[CONN_MAX_HOST_LENGTH];
+    memcpy(host, start, hostLen);
+    host[hostLen] = '\0';
+
+    uint16_t port = 443;
+    if (*end == ':') {
+        port = (uint16_t)atoi(end + 1);
+    }
+
+    return acquire(host, port);
+}
+
+void ConnectionManager::release(NetworkClientSecure* client, bool keepAlive) {
+    if (!client || !mutex) return;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (int i = 0; i < CONN_MAX_CONNECTIONS; i++) {
+        Entry& e = entries[i];
+        if (e.client != client) continue;
+
+        if (!keepAlive && e.client->connected()) {
+            e.client->stop();
+        }
+        e.inUse = false;
+        e.lastUsed = millis();
+        break;
+    }
+    xSemaphoreGive(mutex);
+}
+
+int ConnectionManager::claimEntry(const char* host, uint16_t port) {
+    int target = -1;
+
+    // Prefer the same host's closed entry, then an empty or closed slot
+    for (int i = 0; i < CONN_MAX_CONNECTIONS && target < 0; i++) {
+        Entry& e = entries[i];
+        if (!e.inUse && e.client && e.port == port && strcmp(e.host, host) == 0) target = i;
+    }
+    for (int i = 0; i < CONN_MAX_CONNECTIONS && target < 0; i++) {
+        Entry& e = entries[i];
+        if (!e.inUse && (!e.client || !e.client->connected())) target = i;
+    }
+
+    // Pool full - evict the least recently used idle connection
+    if (target < 0) {
+        uint32_t oldest = 0;
+        for (int i = 0; i < CONN_MAX_CONNECTIONS; i++) {
+            Entry& e = entries[i];
+            if (e.inUse) continue;
+            uint32_t age = millis() - e.lastUsed;
+            if (target < 0 || age > oldest) {
+                target = i;
+                oldest = age;
+            }
+        }
+        if (target >= 0) {
+            Serial.printf("[Conn] Evicting idle connection to %s\n", entries[target].host);
+            entries[target].client->stop();
+            stats.evictions++;
+        }
+    }
+
+    if (target >= 0) {
+        Entry& e = entries[target];
+        strncpy(e.host, host, sizeof(e.host) - 1);
+        e.host[sizeof(e.host) - 1] = '\0';
+        e.port = port;
+        e.inUse = true;
+        e.lastUsed = millis();
+    }
+    return target;
+}
+
+bool ConnectionManager::connectEntry(Entry& e) {
+    if (!e.client) {
+        e.client = new NetworkClientSecure();
+        if (!e.client) {
+            Serial.println("[Conn] Failed to create secure client");
+            return false;
+        }
+        // Skip certificate verification (matches previous per-client setup)
+        e.client->setInsecure();
+    } else if (e.client->connected()) {
+        e.client->stop();
+    }
+
+    uint32_t t0 = millis();
+    bool ok = e.client->connect(e.host, e.port);
+    uint32_t elapsed = millis() - t0;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (ok) {
+        stats.handshakes++;
+        stats.handshakeTotalMs += elapsed;
+        if (elapsed > stats.handshakeMaxMs) stats.handshakeMaxMs = elapsed;
+    } else {
+        stats.handshakeFailures++;
+    }
+    xSemaphoreGive(mutex);
+
+    if (ok) {
+        Serial.printf("[Conn] TLS handshake to %s: %lu ms (#%u)\n",
+                      e.host, elapsed, stats.handshakes);
+    } else {
+        Serial.printf("[Conn] Failed to connect to %s:%u\n", e.host, e.port);
+    }
+    return ok;
+}
+
+//=============================================================================
+// Maintenance
+//=============================================================================
+
+void ConnectionManager::update() {
+    if (!mutex) return;
+
+    if (!WiFi.isConnected()) {
+        closeIdle();
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (int i = 0; i < CONN_MAX_CONNECTIONS; i++) {
+        Entry& e = entries[i];
+        if (e.inUse || !e.client || !e.client->connected()) continue;
+        if (millis() - e.lastUsed > CONN_IDLE_TIMEOUT_MS) {
+            Serial.printf("[Conn] Closing idle connection to %s\n", e.host);
+            e.client->stop();
+        }
+    }
+    xSemaphoreGive(mutex);
+}
+
+void ConnectionManager::closeIdle() {
+    if (!mutex) return;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (int i = 0; i < CONN_MAX_CONNECTIONS; i++) {
+        Entry& e = entries[i];
+        if (!e.inUse && e.client && e.client->connected()) {
+            e.client->stop();
+        }
+    }
+    xSemaphoreGive(mutex);
+}
+
+int ConnectionManager::getOpenCount() {
+    if (!mutex) return 0;
+
+    int count = 0;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    for (int i = 0; i < CONN_MAX_CONNECTIONS; i++) {
+        if (entries[i].client && (entries[i].inUse || entries[i].client->connected())) count++;
+    }
+    xSemaphoreGive(mutex);
+    return count;
+}
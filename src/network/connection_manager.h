@@ -0,0 +1,282 @@
+/**
+ * @file connection_manager.h
+ * @brief Shared pool of persistent HTTPS connections
+ *
+ * LLM, STT, TTS and MCP clients lease a pre-connected NetworkClientSecure
+ * for their host instead of owning one each. After a request the
+ * connection is returned with HTTP keep-alive intact, so the next request
+ * to the same host (STT -> GPT -> TTS all hit api.openai.com) skips the
+ * TLS handshake entirely.
+ *
+ * The number of live TLS contexts is bounded by CONN_TLS_MEMORY_CAP; when
+ * the pool is full the least recently used idle connection is closed.
+ *
+ * Arduino's NetworkClientSecure does not expose mbedTLS session tickets,
+ * so resumption is done at the connection level: a kept-alive socket is
+ * the cheapest possible "resumed" session.
+ */
+
+#ifndef CONNECTION_MANAGER_H
+#define CONNECTION_MANAGER_H
+
+#include <Arduino.h>
+#include <NetworkClientSecure.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Approximate heap held by one connected mbedTLS context (bytes) */
+#define CONN_TLS_CONTEXT_BYTES (42 * 1024)
+
+/** Global cap on heap used by pooled TLS contexts (bytes) */
+#define CONN_TLS_MEMORY_CAP (128 * 1024)
+
+/** Pool size derived from the memory cap */
+#define CONN_MAX_CONNECTIONS (CONN_TLS_MEMORY_CAP / CONN_TLS_CONTEXT_BYTES)
+
+/** Close connections idle longer than this (servers drop at ~60s) */
+#define CONN_IDLE_TIMEOUT_MS 45000
+
+/** How long acquire() waits for a busy pool before giving up (ms) */
+#define CONN_ACQUIRE_TIMEOUT_MS 5000
+
+/** Maximum host name length */
+#define CONN_MAX_HOST_LENGTH 64
+
+//=============================================================================
+// Statistics
+//=============================================================================
+
+/**
+ * @struct ConnectionStats
+ * @brief Handshake and reuse counters since boot
+ */
+struct ConnectionStats {
+    uint32_t handshakes;            ///< Full TLS handshakes performed
+    uint32_t handshakeFailures;     ///< Handshakes that failed
+    uint32_t handshakeTotalMs;      ///< Sum of handshake durations
+    uint32_t handshakeMaxMs;        ///< Slowest handshake
+    uint32_t reuses;                ///< Leases served by a kept-alive socket
+    uint32_t evictions;             ///< Idle connections closed to make room
+};
+
+//=============================================================================
+// HttpChunkDecoder
+//=============================================================================
+
+/**
+ * @class HttpChunkDecoder
+ * @brief In-place decoder for HTTP/1.1 chunked transfer encoding
+ *
+ * Streaming readers (SSE, TTS audio) read the raw socket via
+ * HTTPClient::getStreamPtr(). On a keep-alive connection the body arrives
+ * chunked, so the framing is stripped here and the end of the body is
+ * detected without waiting for the server to close the socket.
+ */
+class HttpChunkDecoder {
+public:
+    HttpChunkDecoder() { reset(); }
+
+    /**
+     * @brief Reset for a new response body
+     */
+    void reset();
+
+    /**
+     * @brief Strip chunk framing in place
+     * @param buf Raw bytes from the socket, replaced by payload bytes
+     * @param length Number of raw bytes
+     * @return Number of payload bytes now at the start of buf
+     */
+    size_t decode(uint8_t* buf, size_t length);
+
+    /**
+     * @brief True after the terminating zero-length chunk and trailers
+     */
+    bool isComplete() const { return state == State::Done; }
+
+    /**
+     * @brief True if the framing was malformed
+     */
+    bool hasError() const { return state == State::Error; }
+
+private:
+    enum class State {
+        Size,           ///< Reading hex chunk size
+        Extension,      ///< Skipping ";ext" until end of line
+        Data,           ///< Copying payload
+        DataEnd,        ///< Expecting CRLF after payload
+        Trailer,        ///< Skipping trailer lines after the last chunk
+        Done,
+        Error
+    };
+
+    State state;
+    size_t remaining;
+    size_t trailerLineLen;
+    bool sawDigit;
+};
+
+//=============================================================================
+// HttpBodyStream
+//=============================================================================
+
+/** Decode buffer for HttpBodyStream (bytes) */
+#define HTTP_BODY_BUFFER_SIZE 512
+
+/**
+ * @class HttpBodyStream
+ * @brief Read-only Stream over a response body, de-chunked and bounded
+ *
+ * Lets deserializeJson() consume a response straight from the socket
+ * instead of from an http.getString() copy. Reads stop at the end of the
+ * body (Content-Length or terminating chunk), so a kept-alive socket is
+ * left positioned at the next response.
+ */
+class HttpBodyStream : public Stream {
+public:
+    /**
+     * @param source Socket from HTTPClient::getStreamPtr()
+     * @param chunked Response uses Transfer-Encoding: chunked
+     * @param contentLength Content-Length, or -1 if unknown
+     * @param timeoutMs Maximum wait for the next byte
+     */
+    HttpBodyStream(NetworkClient* source, bool chunked, int contentLength, uint32_t timeoutMs);
+
+    /**
+     * @brief Consume whatever is left of the body (e.g. trailing whitespace)
+     * @return true if the full body was read and the socket can be reused
+     */
+    bool drain(uint32_t timeoutMs);
+
+    /**
+     * @brief True once the end of the body has been read
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief True if the chunk framing was malformed
+     */
+    bool hasError() const { return decoder.hasError(); }
+
+    // Stream interface
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char* buffer, size_t length) override;
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    /**
+     * @brief Refill the decode buffer
+     * @param waitMs How long to wait for socket data (0 = don't block)
+     * @return true if payload bytes are buffered
+     */
+    bool fill(uint32_t waitMs);
+
+    NetworkClient* source;
+    bool chunked;
+    int remaining;          ///< Raw bytes left for Content-Length bodies
+    uint32_t timeoutMs;
+    HttpChunkDecoder decoder;
+
+    uint8_t buf[HTTP_BODY_BUFFER_SIZE];
+    size_t bufLen;
+    size_t bufPos;
+};
+
+//=============================================================================
+// ConnectionManager Class
+//=============================================================================
+
+/**
+ * @class ConnectionManager
+ * @brief Per-host keep-alive pool of TLS connections
+ *
+ * Thread-safe: the LLM worker task and the main loop may lease
+ * connections concurrently. A leased connection is exclusive until
+ * release() is called.
+ */
+class ConnectionManager {
+public:
+    ConnectionManager();
+
+    /**
+     * @brief Create the pool mutex (safe to call more than once)
+     */
+    bool begin();
+
+    /**
+     * @brief Close idle-expired connections (call from loop)
+     */
+    void update();
+
+    /**
+     * @brief Lease a connected client for host:port
+     * @param host Server host name
+     * @param port Server port
+     * @return Connected client, or nullptr on failure / pool exhaustion
+     */
+    NetworkClientSecure* acquire(const char* host, uint16_t port = 443);
+
+    /**
+     * @brief Lease a connected client for the host in an https:// URL
+     */
+    NetworkClientSecure* acquireForUrl(const char* url);
+
+    /**
+     * @brief Return a leased client to the pool
+     * @param client Client from acquire()
+     * @param keepAlive false if the response was not fully read (the
+     *        socket is closed so stale bytes can't leak into the next request)
+     */
+    void release(NetworkClientSecure* client, bool keepAlive = true);
+
+    /**
+     * @brief Close every idle connection (e.g. when WiFi drops)
+     */
+    void closeIdle();
+
+    /**
+     * @brief Number of currently connected sockets (leased or idle)
+     */
+    int getOpenCount();
+
+    /**
+     * @brief Handshake/reuse counters
+     */
+    const ConnectionStats& getStats() const { return stats; }
+
+private:
+    struct Entry {
+        char host[CONN_MAX_HOST_LENGTH];
+        uint16_t port;
+        NetworkClientSecure* client;
+        bool inUse;
+        uint32_t lastUsed;
+    };
+
+    /**
+     * @brief Pick an entry to (re)connect for host, evicting LRU if full
+     * @return Entry index or -1 if everything is leased (mutex held)
+     */
+    int claimEntry(const char* host, uint16_t port);
+
+    /**
+     * @brief Run the TLS handshake for a claimed entry (mutex not held)
+     */
+    bool connectEntry(Entry& entry);
+
+    Entry entries[CONN_MAX_CONNECTIONS];
+    SemaphoreHandle_t mutex;
+    ConnectionStats stats;
+};
+
+// Global connection manager instance
+extern ConnectionManager connectionManager;
+
+#endif // CONNECTION_MANAGER_H
@@ -0,0 +1,328 @@
+/**
+ * @file display_stream.cpp
+ * @brief Framebuffer mirror implementation
+ */
+
+#include "display_stream.h"
+#include <esp_heap_caps.h>
+
+DisplayStream displayStream;
+
+/** Bytes before the palette */
+static const size_t HEADER_SIZE = 12;
+
+/** Largest palette; one more colour switches the frame to RGB565 runs */
+static const size_t MAX_PALETTE = 255;
+
+/** Frames from the client are read and discarded */
+static const size_t MAX_RECV = 64;
+
+static inline void put16(uint8_t*& p, uint16_t value) {
+    *p++ = value & 0xFF;
+    *p++ = value >> 8;
+}
+
+//=============================================================================
+// Constructor / Initialization
+//=============================================================================
+
+DisplayStream::DisplayStream()
+    : server(nullptr)
+    , sourceWidth(0)
+    , sourceHeight(0)
+    , width(0)
+    , height(0)
+    , captureBuffer(nullptr)
+    , sentBuffer(nullptr)
+    , encoded(nullptr)
+    , clientCount(0)
+    , needKeyFrame(false)
+    , pending(false)
+    , lastCaptureMs(0)
+    , sequence(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void DisplayStream::begin(httpd_handle_t httpServer, uint16_t bufferWidth, uint16_t bufferHeight) {
+    server = httpServer;
+    sourceWidth = bufferWidth;
+    sourceHeight = bufferHeight;
+    width = bufferWidth / DISPLAY_STREAM_SCALE;
+    height = bufferHeight / DISPLAY_STREAM_SCALE;
+    clientCount = 0;
+    pending = false;
+}
+
+void DisplayStream::end() {
+    clientCount = 0;
+    server = nullptr;
+}
+
+bool DisplayStream::allocate() {
+    if (encoded) return true;
+
+    size_t frameBytes = (size_t)width * height * sizeof(uint16_t);
+    size_t encodedBytes = maxEncodedSize(width, height);
+    captureBuffer = (uint16_t*)heap_caps_malloc(frameBytes, MALLOC_CAP_SPIRAM);
+    sentBuffer = (uint16_t*)heap_caps_malloc(frameBytes, MALLOC_CAP_SPIRAM);
+    encoded = (uint8_t*)heap_caps_malloc(encodedBytes, MALLOC_CAP_SPIRAM);
+    if (!captureBuffer || !sentBuffer || !encoded) {
+        Serial.println("[DisplayStream] PSRAM allocation failed");
+        heap_caps_free(captureBuffer);
+        heap_caps_free(sentBuffer);
+        heap_caps_free(encoded);
+        captureBuffer = sentBuffer = nullptr;
+        encoded = nullptr;
+        return false;
+    }
+    Serial.printf("[DisplayStream] %ux%u mirror, %u KB PSRAM\n",
+                  width, height, (unsigned)((2 * frameBytes + encodedBytes) / 1024));
+    return true;
+}
+
+//=============================================================================
+// Clients (httpd task)
+//=============================================================================
+
+bool DisplayStream::addClient(int fd) {
+    for (uint8_t i = 0; i < clientCount; i++) {
+        if (clients[i] == fd) return true;  // Socket number reused before pruning
+    }
+    if (clientCount >= DISPLAY_STREAM_MAX_CLIENTS) return false;
+    clients[clientCount++] = fd;
+    return true;
+}
+
+void DisplayStream::removeClient(uint8_t index) {
+    clientCount--;
+    clients[index] = clients[clientCount];
+}
+
+esp_err_t DisplayStream::handleRequest(httpd_req_t* req) {
+    if (req->method == HTTP_GET) {
+        int fd = httpd_req_to_sockfd(req);
+        if (!allocate() || !addClient(fd)) {
+            stats.rejected++;
+            Serial.printf("[DisplayStream] Rejected client %d\n", fd);
+            return ESP_FAIL;  // Closes the socket
+        }
+        stats.connects++;
+        needKeyFrame = true;
+        Serial.printf("[DisplayStream] Client %d watching (%u open)\n", fd, clientCount);
+        return ESP_OK;
+    }
+
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+    if (err != ESP_OK) return err;
+    if (frame.len == 0) return ESP_OK;
+    if (frame.len > MAX_RECV) return ESP_FAIL;
+
+    uint8_t buffer[MAX_RECV];
+    frame.payload = buffer;
+    return httpd_ws_recv_frame(req, &frame, frame.len);
+}
+
+//=============================================================================
+// Capture (main loop)
+//=============================================================================
+
+void DisplayStream::capture(const uint16_t* frame, uint32_t nowMs) {
+    if (clientCount == 0 || !frame || !server) return;
+    if (nowMs - lastCaptureMs < 1000 / DISPLAY_STREAM_MAX_FPS) return;
+    lastCaptureMs = nowMs;
+
+    // Never wait for the socket: skip this frame instead
+    if (pending) {
+        stats.dropped++;
+        return;
+    }
+
+    uint32_t start = micros();
+    for (uint16_t y = 0; y < height; y++) {
+        const uint16_t* src = frame + (size_t)y * DISPLAY_STREAM_SCALE * sourceWidth;
+        uint16_t* dst = captureBuffer + (size_t)y * width;
+#if DISPLAY_STREAM_SCALE == 1
+        memcpy(dst, src, width * sizeof(uint16_t));
+#else
+        for (uint16_t x = 0; x < width; x++) {
+            dst[x] = src[x * DISPLAY_STREAM_SCALE];
+        }
+#endif
+    }
+    uint32_t elapsed = micros() - start;
+    stats.captured++;
+    stats.captureUsTotal += elapsed;
+    if (elapsed > stats.captureUsMax) stats.captureUsMax = elapsed;
+
+    pending = true;
+    if (httpd_queue_work(server, sendWork, this) != ESP_OK) {
+        pending = false;
+    }
+}
+
+//=============================================================================
+// Encode and send (httpd task)
+//=============================================================================
+
+void DisplayStream::sendWork(void* arg) {
+    DisplayStream* self = (DisplayStream*)arg;
+    self->send();
+    self->pending = false;
+}
+
+void DisplayStream::send() {
+    for (uint8_t i = clientCount; i-- > 0;) {
+        if (!server || httpd_ws_get_fd_info(server, clients[i]) != HTTPD_WS_CLIENT_WEBSOCKET) {
+            Serial.printf("[DisplayStream] Client %d gone\n", clients[i]);
+            removeClient(i);
+        }
+    }
+    if (clientCount == 0) return;
+
+    uint32_t start = micros();
+    bool keyFrame = needKeyFrame;
+    needKeyFrame = false;
+    bool paletteOverflow = false;
+    size_t size = encode(captureBuffer, sentBuffer, width, height, keyFrame,
+                         sequence, encoded, paletteOverflow);
+    uint32_t elapsed = micros() - start;
+    if (elapsed > stats.encodeUsMax) stats.encodeUsMax = elapsed;
+
+    if (size == 0) {
+        stats.unchanged++;
+        return;
+    }
+
+    // This frame is the reference for the next delta
+    uint16_t* swap = sentBuffer;
+    sentBuffer = captureBuffer;
+    captureBuffer = swap;
+    sequence++;
+
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.final = true;
+    frame.type = HTTPD_WS_TYPE_BINARY;
+    frame.payload = encoded;
+    frame.len = size;
+
+    for (uint8_t i = clientCount; i-- > 0;) {
+        if (httpd_ws_send_frame_async(server, clients[i], &frame) != ESP_OK) {
+            Serial.printf("[DisplayStream] Send to client %d failed, dropping\n", clients[i]);
+            httpd_sess_trigger_close(server, clients[i]);
+            removeClient(i);
+        }
+    }
+
+    stats.sent++;
+    if (keyFrame) stats.keyFrames++;
+    if (paletteOverflow) stats.paletteOverflows++;
+    stats.bytesSent += size;
+    if (size > stats.maxFrameBytes) stats.maxFrameBytes = size;
+}
+
+//=============================================================================
+// Encoding
+//=============================================================================
+
+size_t DisplayStream::maxEncodedSize(uint16_t width, uint16_t height) {
+    // Worst case: every row changed, every pixel its own RGB565 run
+    return HEADER_SIZE + MAX_PALETTE * 2 + (size_t)height * (4 + (size_t)width * 3);
+}
+
+size_t DisplayStream::encode(const uint16_t* current, const uint16_t* previous,
+                             uint16_t width, uint16_t height, bool keyFrame,
+                             uint16_t sequence, uint8_t* out, bool& paletteOverflow) {
+    uint16_t palette[MAX_PALETTE];
+    size_t paletteSize = 0;
+    bool rgb565 = false;
+    uint16_t rows;
+    uint8_t* p;
+
+    // Rows are written after room for the largest palette, then moved down
+    // once the palette is known. Too many colours restarts with RGB565 runs.
+    for (;;) {
+        uint8_t* rowsStart = out + HEADER_SIZE + (rgb565 ? 0 : MAX_PALETTE * 2);
+        p = rowsStart;
+        rows = 0;
+        size_t lastIndex = 0;
+        bool overflow = false;
+
+        for (uint16_t y = 0; y < height && !overflow; y++) {
+            const uint16_t* row = current + (size_t)y * width;
+            if (!keyFrame && memcmp(row, previous + (size_t)y * width, width * sizeof(uint16_t)) == 0) {
+                continue;
+            }
+
+            put16(p, y);
+            uint8_t* runCount = p;
+            p += 2;
+            uint16_t runs = 0;
+
+            for (uint16_t x = 0; x < width;) {
+                uint16_t color = row[x];
+                uint16_t length = 1;
+                while (x + length < width && row[x + length] == color && length < DISPLAY_STREAM_MAX_RUN) {
+                    length++;
+                }
+                x += length;
+                *p++ = length - 1;
+                runs++;
+
+                if (rgb565) {
+                    put16(p, color);
+                    continue;
+                }
+                if (paletteSize == 0 || palette[lastIndex] != color) {
+                    size_t i = 0;
+                    while (i < paletteSize && palette[i] != color) i++;
+                    if (i == paletteSize) {
+                        if (paletteSize == MAX_PALETTE) {
+                            overflow = true;
+                            break;
+                        }
+                        palette[paletteSize++] = color;
+                    }
+                    lastIndex = i;
+                }
+                *p++ = (uint8_t)lastIndex;
+            }
+
+            runCount[0] = runs & 0xFF;
+            runCount[1] = runs >> 8;
+            rows++;
+        }
+
+        if (overflow) {
+            rgb565 = true;
+            paletteSize = 0;
+            continue;
+        }
+
+        if (rows == 0) return 0;
+
+        size_t rowBytes = p - rowsStart;
+        uint8_t* paletteEnd = out + HEADER_SIZE + paletteSize * 2;
+        if (!rgb565) memmove(paletteEnd, rowsStart, rowBytes);
+        p = paletteEnd + rowBytes;
+        break;
+    }
+
+    uint8_t* h = out;
+    *h++ = 'F';
+    *h++ = (keyFrame ? 0x01 : 0) | (rgb565 ? 0x02 : 0);
+    put16(h, width);
+    put16(h, height);
+    put16(h, sequence);
+    put16(h, rows);
+    put16(h, paletteSize);
+    for (size_t i = 0; i < paletteSize; i++) {
+        put16(h, palette[i]);
+    }
+
+    paletteOverflow = rgb565;
+    return p - out;
+}
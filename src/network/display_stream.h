@@ -0,0 +1,169 @@
+/**
+ * @file display_stream.h
+ * @brief Live mirror of the eye framebuffer over a WebSocket
+ *
+ * /api/display/stream sends what the display shows to a canvas in the
+ * web UI, for watching animation timing without the device in view.
+ *
+ * Capture (main loop): once a frame has been drawn, capture() copies
+ * eyeBuffer into a spare PSRAM buffer, at most DISPLAY_STREAM_MAX_FPS
+ * times a second and only while a client is connected. If the previous
+ * capture is still being encoded or sent, the frame is dropped instead of
+ * waiting, so a slow socket costs frames, never render time. The copy is
+ * decimated by DISPLAY_STREAM_SCALE, which bounds its cost.
+ *
+ * Encode and send (httpd task): only rows that differ from the last sent
+ * frame are encoded, each as runs of one colour. The eyes use a handful of
+ * colours, so colours are indexed into a per-frame palette and a run takes
+ * two bytes. A frame with more than 255 colours is sent with RGB565 runs.
+ *
+ * Binary frame, little-endian:
+ *
+ *     u8  'F'
+ *     u8  flags         bit 0: key frame (every row), bit 1: RGB565 runs
+ *     u16 width, height (after scaling, buffer orientation)
+ *     u16 sequence      frames sent, wraps
+ *     u16 rows          rows that follow
+ *     u16 paletteSize   0 with RGB565 runs
+ *     u16 palette[paletteSize]
+ *     rows times:  u16 y, u16 runs, runs times: u8 length-1, then
+ *                  u8 palette index or u16 RGB565
+ *
+ * The buffer is the display rotated: the page turns the canvas 90 degrees
+ * clockwise to show it as the screen does.
+ */
+
+#ifndef DISPLAY_STREAM_H
+#define DISPLAY_STREAM_H
+
+#include <Arduino.h>
+#include <esp_http_server.h>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Most clients watching at once (each holds an httpd socket, see WEB_SERVER_MAX_SOCKETS) */
+#define DISPLAY_STREAM_MAX_CLIENTS 1
+
+/** Highest frame rate captured */
+#define DISPLAY_STREAM_MAX_FPS 15
+
+/**
+ * Every Nth pixel of every Nth row is captured. 2 copies a quarter of the
+ * 273 KB buffer per frame; 1 streams full resolution.
+ */
+#define DISPLAY_STREAM_SCALE 2
+
+/** Longest run one run entry can hold */
+#define DISPLAY_STREAM_MAX_RUN 256
+
+//=============================================================================
+// Types
+//=============================================================================
+
+/**
+ * @struct DisplayStreamStats
+ * @brief Mirror traffic since boot
+ */
+struct DisplayStreamStats {
+    uint32_t connects;
+    uint32_t rejected;
+    uint32_t captured;          ///< Frames copied from eyeBuffer
+    uint32_t dropped;           ///< Frames skipped, previous one not sent yet
+    uint32_t sent;              ///< Frames sent (to at least one client)
+    uint32_t keyFrames;
+    uint32_t unchanged;         ///< Captured frames identical to the last sent
+    uint32_t paletteOverflows;  ///< Frames sent with RGB565 runs
+    uint64_t bytesSent;         ///< Encoded frame bytes, once per frame
+    uint32_t maxFrameBytes;
+    uint32_t captureUsMax;      ///< Longest copy in the render loop
+    uint64_t captureUsTotal;
+    uint32_t encodeUsMax;
+};
+
+//=============================================================================
+// DisplayStream Class
+//=============================================================================
+
+class DisplayStream {
+public:
+    DisplayStream();
+
+    /**
+     * @brief Attach to a running server
+     * @param width Source buffer width (pixels)
+     * @param height Source buffer height (pixels)
+     */
+    void begin(httpd_handle_t server, uint16_t width, uint16_t height);
+
+    /**
+     * @brief Forget all clients (the server closes their sockets)
+     */
+    void end();
+
+    /**
+     * @brief WebSocket URI handler body (httpd task)
+     *
+     * The first client allocates the capture buffers in PSRAM; they are
+     * kept for later clients.
+     */
+    esp_err_t handleRequest(httpd_req_t* req);
+
+    /**
+     * @brief Copy a finished frame if one is due (main loop)
+     * @param frame Source buffer, RGB565, as given to begin()
+     * @param nowMs Frame time
+     */
+    void capture(const uint16_t* frame, uint32_t nowMs);
+
+    uint8_t getClientCount() const { return clientCount; }
+    uint16_t getWidth() const { return width; }
+    uint16_t getHeight() const { return height; }
+    const DisplayStreamStats& getStats() const { return stats; }
+
+    /**
+     * @brief Encode one frame
+     * @param current Scaled frame to send
+     * @param previous Last frame sent; ignored for a key frame
+     * @param out Buffer of maxEncodedSize() bytes
+     * @param paletteOverflow Set when the frame needed RGB565 runs
+     * @return Encoded size, 0 if no row changed
+     */
+    static size_t encode(const uint16_t* current, const uint16_t* previous,
+                         uint16_t width, uint16_t height, bool keyFrame,
+                         uint16_t sequence, uint8_t* out, bool& paletteOverflow);
+
+    static size_t maxEncodedSize(uint16_t width, uint16_t height);
+
+private:
+    static void sendWork(void* arg);
+
+    bool allocate();
+    bool addClient(int fd);
+    void removeClient(uint8_t index);
+    void send();
+
+    httpd_handle_t server;
+    uint16_t sourceWidth;
+    uint16_t sourceHeight;
+    uint16_t width;
+    uint16_t height;
+
+    uint16_t* captureBuffer;    ///< Written by capture() while !pending
+    uint16_t* sentBuffer;       ///< Last frame sent, for the row deltas
+    uint8_t* encoded;
+
+    int clients[DISPLAY_STREAM_MAX_CLIENTS];
+    volatile uint8_t clientCount;
+    volatile bool needKeyFrame;
+    volatile bool pending;      ///< captureBuffer holds a frame not yet sent
+    uint32_t lastCaptureMs;
+    uint16_t sequence;
+
+    DisplayStreamStats stats;
+};
+
+extern DisplayStream displayStream;
+
+#endif // DISPLAY_STREAM_H
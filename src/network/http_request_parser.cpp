@@ -0,0 +1,196 @@
+/**
+ * @file http_request_parser.cpp
+ * @brief Incremental HTTP/1.1 request parser implementation
+ */
+
+#include "http_request_parser.h"
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+static inline char toLowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+static inline bool isOws(char c) {
+    return c == ' ' || c == '\t';
+}
+
+bool HttpRequestParser::equalsIgnoreCase(const char* text, size_t length, const char* lower) {
+    size_t i = 0;
+    for (; i < length; i++) {
+        if (lower[i] == '\0' || toLowerAscii(text[i]) != lower[i]) return false;
+    }
+    return lower[i] == '\0';
+}
+
+bool HttpRequestParser::containsIgnoreCase(const char* text, size_t length, const char* lower) {
+    size_t needle = strlen(lower);
+    if (needle == 0) return true;
+    for (size_t i = 0; i + needle <= length; i++) {
+        if (equalsIgnoreCase(text + i, needle, lower)) return true;
+    }
+    return false;
+}
+
+//=============================================================================
+// Constructor / Reset
+//=============================================================================
+
+HttpRequestParser::HttpRequestParser()
+    : headerCallback(nullptr)
+    , bodyCallback(nullptr)
+{
+    reset();
+}
+
+void HttpRequestParser::reset() {
+    state = HttpParserState::RequestLine;
+    lineLength = 0;
+    method[0] = '\0';
+    uri[0] = '\0';
+    contentLength = 0;
+    bodyRemaining = 0;
+    keepAlive = false;
+    errorStatus = 0;
+}
+
+void HttpRequestParser::fail(uint16_t status) {
+    state = HttpParserState::Error;
+    errorStatus = status;
+}
+
+bool HttpRequestParser::isPath(const char* path) const {
+    size_t length = strlen(path);
+    return strncmp(uri, path, length) == 0 && (uri[length] == '\0' || uri[length] == '?');
+}
+
+//=============================================================================
+// Parsing
+//=============================================================================
+
+size_t HttpRequestParser::feed(const uint8_t* data, size_t length) {
+    size_t i = 0;
+
+    while (i < length) {
+        if (state == HttpParserState::Body) {
+            size_t n = length - i;
+            if (n > bodyRemaining) n = bodyRemaining;
+            if (bodyCallback) bodyCallback(data + i, n);
+            i += n;
+            consumeBody(n);
+            return i;
+        }
+        if (state != HttpParserState::RequestLine && state != HttpParserState::Headers) {
+            return i;
+        }
+
+        uint8_t c = data[i++];
+        if (c != '\n') {
+            if (lineLength >= HTTP_PARSER_LINE_SIZE - 1) {
+                fail(state == HttpParserState::RequestLine ? 414 : 431);
+                return i;
+            }
+            line[lineLength++] = (char)c;
+            continue;
+        }
+
+        // End of line; CR is optional
+        if (lineLength > 0 && line[lineLength - 1] == '\r') lineLength--;
+        line[lineLength] = '\0';
+
+        if (state == HttpParserState::RequestLine) {
+            // Blank lines before a request (after a previous body) are allowed
+            if (lineLength > 0) {
+                if (!parseRequestLine()) return i;
+                state = HttpParserState::Headers;
+            }
+        } else if (lineLength == 0) {
+            finishHeaders();
+            lineLength = 0;
+            return i;
+        } else if (!parseHeaderLine()) {
+            return i;
+        }
+        lineLength = 0;
+    }
+    return i;
+}
+
+bool HttpRequestParser::parseRequestLine() {
+    // METHOD SP request-target SP HTTP-version
+    char* sp1 = (char*)memchr(line, ' ', lineLength);
+    if (!sp1) { fail(400); return false; }
+    char* target = sp1 + 1;
+    char* sp2 = (char*)memchr(target, ' ', lineLength - (target - line));
+    if (!sp2 || sp2 == target) { fail(400); return false; }
+
+    size_t methodLength = sp1 - line;
+    size_t uriLength = sp2 - target;
+    if (methodLength == 0 || methodLength >= HTTP_PARSER_METHOD_SIZE) { fail(501); return false; }
+    if (uriLength >= HTTP_PARSER_URI_SIZE) { fail(414); return false; }
+
+    const char* version = sp2 + 1;
+    if (strcmp(version, "HTTP/1.1") == 0) {
+        keepAlive = true;
+    } else if (strcmp(version, "HTTP/1.0") == 0) {
+        keepAlive = false;
+    } else {
+        fail(505);
+        return false;
+    }
+
+    memcpy(method, line, methodLength);
+    method[methodLength] = '\0';
+    memcpy(uri, target, uriLength);
+    uri[uriLength] = '\0';
+    return true;
+}
+
+bool HttpRequestParser::parseHeaderLine() {
+    char* colon = (char*)memchr(line, ':', lineLength);
+    if (!colon || colon == line) { fail(400); return false; }
+
+    const char* name = line;
+    size_t nameLength = colon - line;
+    if (isOws(name[nameLength - 1])) { fail(400); return false; }
+
+    // Value without surrounding whitespace
+    const char* value = colon + 1;
+    const char* end = line + lineLength;
+    while (value < end && isOws(*value)) value++;
+    while (end > value && isOws(end[-1])) end--;
+    size_t valueLength = end - value;
+
+    if (equalsIgnoreCase(name, nameLength, "content-length")) {
+        if (valueLength == 0) { fail(400); return false; }
+        uint64_t n = 0;
+        for (size_t k = 0; k < valueLength; k++) {
+            if (value[k] < '0' || value[k] > '9') { fail(400); return false; }
+            n = n * 10 + (value[k] - '0');
+            if (n > UINT32_MAX) { fail(413); return false; }
+        }
+        contentLength = (uint32_t)n;
+    } else if (equalsIgnoreCase(name, nameLength, "connection")) {
+        if (containsIgnoreCase(value, valueLength, "close")) keepAlive = false;
+        else if (containsIgnoreCase(value, valueLength, "keep-alive")) keepAlive = true;
+    } else if (equalsIgnoreCase(name, nameLength, "transfer-encoding")) {
+        fail(501);
+        return false;
+    }
+
+    if (headerCallback) headerCallback(name, nameLength, value, valueLength);
+    return true;
+}
+
+void HttpRequestParser::finishHeaders() {
+    bodyRemaining = contentLength;
+    state = bodyRemaining > 0 ? HttpParserState::Body : HttpParserState::Complete;
+}
+
+void HttpRequestParser::consumeBody(size_t length) {
+    if (state != HttpParserState::Body) return;
+    bodyRemaining -= (length < bodyRemaining) ? length : bodyRemaining;
+    if (bodyRemaining == 0) state = HttpParserState::Complete;
+}
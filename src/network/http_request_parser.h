@@ -0,0 +1,156 @@
+/**
+ * @file http_request_parser.h
+ * @brief Incremental HTTP/1.1 request parser for raw-socket servers
+ *
+ * Fed whatever bytes the socket has, in any split: the parser keeps its
+ * position in a small state machine and a fixed line buffer, so a request
+ * that arrives over several reads needs no reassembly by the caller and
+ * no heap allocation.
+ *
+ * Header names are matched case-insensitively in place. Content-Length
+ * and Connection are interpreted by the parser; every header is also
+ * passed to the onHeader() callback as pointer/length pairs into the
+ * line buffer (valid only during the callback).
+ *
+ * feed() stops right after the blank line that ends the headers, so the
+ * caller can size a buffer from Content-Length; body bytes fed after that
+ * go to onBody() until Content-Length is reached. Nothing here waits for
+ * the socket - bodies have no size limit of their own.
+ *
+ * Not supported: chunked request bodies (501), obsolete line folding.
+ */
+
+#ifndef HTTP_REQUEST_PARSER_H
+#define HTTP_REQUEST_PARSER_H
+
+#include <Arduino.h>
+#include <functional>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Longest request line or header line (bytes) */
+#define HTTP_PARSER_LINE_SIZE 512
+
+/** Longest request target kept after the request line (bytes) */
+#define HTTP_PARSER_URI_SIZE 256
+
+/** Longest method name ("OPTIONS" is the longest we route) */
+#define HTTP_PARSER_METHOD_SIZE 8
+
+//=============================================================================
+// Types
+//=============================================================================
+
+enum class HttpParserState : uint8_t {
+    RequestLine,    ///< Waiting for (the rest of) the request line
+    Headers,        ///< Reading header lines
+    Body,           ///< Headers done, body bytes outstanding
+    Complete,       ///< Whole request received
+    Error           ///< Malformed; see getErrorStatus()
+};
+
+using HttpHeaderCallback = std::function<void(const char* name, size_t nameLength,
+                                              const char* value, size_t valueLength)>;
+using HttpBodyCallback = std::function<void(const uint8_t* data, size_t length)>;
+
+//=============================================================================
+// HttpRequestParser Class
+//=============================================================================
+
+class HttpRequestParser {
+public:
+    HttpRequestParser();
+
+    /**
+     * @brief Start a new request (keeps the callbacks)
+     */
+    void reset();
+
+    /**
+     * @brief Consume request bytes
+     *
+     * Returns early when the headers complete, so the caller can decide
+     * how to read the body, and when the request is complete, so bytes of
+     * a pipelined next request are left unconsumed.
+     *
+     * @return Bytes consumed
+     */
+    size_t feed(const uint8_t* data, size_t length);
+
+    void onHeader(HttpHeaderCallback callback) { headerCallback = callback; }
+    void onBody(HttpBodyCallback callback) { bodyCallback = callback; }
+
+    //-------------------------------------------------------------------------
+    // State
+    //-------------------------------------------------------------------------
+
+    HttpParserState getState() const { return state; }
+
+    /** Nothing of a request has been received yet */
+    bool isIdle() const { return state == HttpParserState::RequestLine && lineLength == 0; }
+
+    bool headersComplete() const {
+        return state == HttpParserState::Body || state == HttpParserState::Complete;
+    }
+
+    bool hasError() const { return state == HttpParserState::Error; }
+
+    /** Status code to answer a malformed request with */
+    uint16_t getErrorStatus() const { return errorStatus; }
+
+    //-------------------------------------------------------------------------
+    // Request
+    //-------------------------------------------------------------------------
+
+    const char* getMethod() const { return method; }
+    const char* getUri() const { return uri; }
+    bool isMethod(const char* name) const { return strcmp(method, name) == 0; }
+
+    /** URI path equals path, ignoring any query string */
+    bool isPath(const char* path) const;
+
+    uint32_t getContentLength() const { return contentLength; }
+    uint32_t getBodyRemaining() const { return bodyRemaining; }
+
+    /** HTTP/1.1 without "Connection: close", or HTTP/1.0 with keep-alive */
+    bool isKeepAlive() const { return keepAlive; }
+
+    /**
+     * @brief Account for body bytes read by the caller
+     */
+    void consumeBody(size_t length);
+
+    //-------------------------------------------------------------------------
+    // Helpers
+    //-------------------------------------------------------------------------
+
+    /** text[0..length) equals lower, ASCII case-insensitive */
+    static bool equalsIgnoreCase(const char* text, size_t length, const char* lower);
+
+    /** text[0..length) contains lower, ASCII case-insensitive */
+    static bool containsIgnoreCase(const char* text, size_t length, const char* lower);
+
+private:
+    bool parseRequestLine();
+    bool parseHeaderLine();
+    void finishHeaders();
+    void fail(uint16_t status);
+
+    HttpParserState state;
+    char line[HTTP_PARSER_LINE_SIZE];
+    uint16_t lineLength;
+
+    char method[HTTP_PARSER_METHOD_SIZE];
+    char uri[HTTP_PARSER_URI_SIZE];
+    uint32_t contentLength;
+    uint32_t bodyRemaining;
+    bool keepAlive;
+    uint16_t errorStatus;
+
+    HttpHeaderCallback headerCallback;
+    HttpBodyCallback bodyCallback;
+};
+
+#endif // HTTP_REQUEST_PARSER_H
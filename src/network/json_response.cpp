@@ -0,0 +1,94 @@
+/**
+ * @file json_response.cpp
+ * @brief Streaming JSON response implementation
+ */
+
+#include "json_response.h"
+
+static JsonResponseStats stats = {};
+
+//=============================================================================
+// HttpdJsonWriter
+//=============================================================================
+
+HttpdJsonWriter::HttpdJsonWriter(httpd_req_t* request)
+    : req(request)
+    , used(0)
+    , total(0)
+    , chunks(0)
+    , error(ESP_OK)
+{
+}
+
+size_t HttpdJsonWriter::write(uint8_t c) {
+    if (error != ESP_OK) return 0;
+    if (used == sizeof(buffer) && !flush()) return 0;
+    buffer[used++] = c;
+    total++;
+    return 1;
+}
+
+size_t HttpdJsonWriter::write(const uint8_t* data, size_t length) {
+    size_t written = 0;
+    while (written < length && error == ESP_OK) {
+        if (used == sizeof(buffer) && !flush()) break;
+        size_t n = length - written;
+        if (n > sizeof(buffer) - used) n = sizeof(buffer) - used;
+        memcpy(buffer + used, data + written, n);
+        used += n;
+        written += n;
+    }
+    total += written;
+    return written;
+}
+
+bool HttpdJsonWriter::flush() {
+    error = httpd_resp_send_chunk(req, (const char*)buffer, used);
+    if (error != ESP_OK) return false;
+    chunks++;
+    used = 0;
+    return true;
+}
+
+esp_err_t HttpdJsonWriter::finish() {
+    if (error != ESP_OK) return error;
+
+    // Never filled the buffer: one plain response with Content-Length
+    if (chunks == 0) {
+        return error = httpd_resp_send(req, (const char*)buffer, used);
+    }
+
+    if (used > 0 && !flush()) return error;
+    return error = httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+esp_err_t sendJsonResponse(httpd_req_t* req, JsonVariantConst json) {
+    httpd_resp_set_type(req, "application/json");
+
+    HttpdJsonWriter writer(req);
+    serializeJson(json, writer);
+    esp_err_t err = writer.finish();
+
+    stats.responses++;
+    stats.bytes += writer.getBytesWritten();
+    if (writer.getBytesWritten() > stats.maxBytes) stats.maxBytes = writer.getBytesWritten();
+    if (writer.isChunked()) {
+        stats.chunked++;
+        stats.chunks += writer.getChunkCount();
+    }
+    if (err != ESP_OK) {
+        stats.errors++;
+        Serial.printf("[WebServer] JSON reply cut short (%u bytes serialized): %s\n",
+                      writer.getBytesWritten(), esp_err_to_name(err));
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+const JsonResponseStats& getJsonResponseStats() {
+    return stats;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file json_response.h
+ * @brief Serialize JSON straight into an esp_http_server response
+ *
+ * Handlers used to serialize their JsonDocument into a String and send
+ * that. ArduinoJson fills a String 31 bytes at a time and Arduino's String
+ * grows to the exact new length on every append, so a 3 KB reply cost
+ * about a hundred reallocs on top of the final copy.
+ *
+ * HttpdJsonWriter is an ArduinoJson output: serializeJson() writes into a
+ * fixed JSON_RESPONSE_BUFFER_SIZE buffer (on the httpd task's stack), and
+ * every full buffer goes out with httpd_resp_send_chunk(). A reply that
+ * fits in one buffer is sent with httpd_resp_send() instead, so it keeps
+ * its Content-Length and costs no chunk framing. Either way nothing is
+ * allocated for the output.
+ */
+
+#ifndef JSON_RESPONSE_H
+#define JSON_RESPONSE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_http_server.h>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/** Output buffer; replies up to this size are sent unchunked */
+#define JSON_RESPONSE_BUFFER_SIZE 1024
+
+//=============================================================================
+// Statistics
+//=============================================================================
+
+/**
+ * @struct JsonResponseStats
+ * @brief JSON replies since boot
+ */
+struct JsonResponseStats {
+    uint32_t responses;
+    uint32_t chunked;       ///< Larger than one buffer, sent in chunks
+    uint32_t chunks;        ///< httpd_resp_send_chunk() calls with data
+    uint32_t bytes;         ///< JSON bytes sent
+    uint32_t maxBytes;      ///< Largest reply
+    uint32_t errors;        ///< Replies cut short by a send error
+};
+
+//=============================================================================
+// HttpdJsonWriter
+//=============================================================================
+
+/**
+ * @class HttpdJsonWriter
+ * @brief ArduinoJson writer that streams into an httpd response
+ *
+ * Set the content type first, pass the writer to serializeJson(), then
+ * call finish(). After a send error the rest of the output is dropped
+ * and finish() returns the error.
+ */
+class HttpdJsonWriter {
+public:
+    explicit HttpdJsonWriter(httpd_req_t* req);
+
+    // ArduinoJson writer interface
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Send what is buffered and end the response
+     * @return ESP_OK, or the first send error
+     */
+    esp_err_t finish();
+
+    size_t getBytesWritten() const { return total; }
+    bool isChunked() const { return chunks > 0; }
+    uint32_t getChunkCount() const { return chunks; }
+
+private:
+    bool flush();
+
+    httpd_req_t* req;
+    uint8_t buffer[JSON_RESPONSE_BUFFER_SIZE];
+    size_t used;
+    size_t total;
+    uint32_t chunks;
+    esp_err_t error;
+};
+
+/**
+ * @brief Send a JSON reply (application/json) without a String copy
+ * @return Result for the handler to return; ESP_FAIL closes the socket
+ *         after a reply was cut short
+ */
+esp_err_t sendJsonResponse(httpd_req_t* req, JsonVariantConst json);
+
+const JsonResponseStats& getJsonResponseStats();
+
+#endif // JSON_RESPONSE_H
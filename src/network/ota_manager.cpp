@@ -6,11 +6,18 @@
 #include "ota_manager.h"
 #include "version.h"
 #include <esp_app_format.h>
+#include <esp_heap_caps.h>
 #include <Preferences.h>
 
 // ESP32 image magic byte
 #define ESP_IMAGE_HEADER_MAGIC 0xE9
 
+// Flash erase unit
+#define OTA_SECTOR_SIZE 4096
+
+static_assert(OTA_PIPELINE_BUFFER_SIZE % OTA_SECTOR_SIZE == 0,
+              "Pipeline buffers must be whole sectors");
+
 // NVS namespace for OTA settings
 #define OTA_NVS_NAMESPACE "ota"
 #define OTA_NVS_KEY "sigkey"
@@ -25,8 +32,19 @@ OtaManager::OtaManager()
     , firmwareSize(0)
     , headerValidated(false)
     , signingKeySet(false)
-    , signatureBufferPos(0) {
+    , signatureBufferPos(0)
+    , freeQueue(nullptr)
+    , writeQueue(nullptr)
+    , writerDone(nullptr)
+    , writerTask(nullptr)
+    , fillIndex(-1)
+    , fillLength(0)
+    , queuedBytes(0)
+    , writerError(ESP_OK)
+    , writerAbort(false) {
     errorMessage[0] = '\0';
+    memset(buffers, 0, sizeof(buffers));
+    memset(&pipelineStats, 0, sizeof(pipelineStats));
     memset(signingKey, 0, sizeof(signingKey));
     memset(receivedSignature, 0, sizeof(receivedSignature));
     memset(signatureBuffer, 0, sizeof(signatureBuffer));
@@ -93,14 +111,24 @@ bool OtaManager::startUpload(size_t size) {
         return false;
     }
 
-    // Begin OTA with firmware size (excluding signature)
-    esp_err_t err = esp_ota_begin(updatePartition, firmwareSize, &otaHandle);
+    // Begin without erasing: given the image size, esp_ota_begin() erases
+    // all of it before returning. esp_ota_write() erases each sector as
+    // the writer task reaches it instead.
+    esp_err_t err = esp_ota_begin(updatePartition, OTA_WITH_SEQUENTIAL_WRITES, &otaHandle);
     if (err != ESP_OK) {
         snprintf(errorMessage, sizeof(errorMessage), "OTA begin failed: %s", esp_err_to_name(err));
         state = OtaState::Error;
         return false;
     }
 
+    memset(&pipelineStats, 0, sizeof(pipelineStats));
+    pipelineStats.startMs = millis();
+    fillIndex = -1;
+    fillLength = 0;
+    queuedBytes = 0;
+    writerError = ESP_OK;
+    writerAbort = false;
+
     totalBytes = size;
     bytesReceived = 0;
     headerValidated = false;
@@ -117,87 +145,89 @@ bool OtaManager::startUpload(size_t size) {
         mbedtls_md_hmac_starts(&hmacCtx, signingKey, sizeof(signingKey));
     }
 
+    if (!startPipeline()) {
+        stopPipeline(true);
+        esp_ota_abort(otaHandle);
+        otaHandle = 0;
+        setError("Out of memory for upload buffers");
+        state = OtaState::Error;
+        return false;
+    }
+
     Serial.printf("[OTA] Upload started, expecting %lu bytes (firmware: %lu, signature: %s)\n",
                   totalBytes, firmwareSize, signingKeySet ? "yes" : "no");
     return true;
 }
 
-bool OtaManager::writeChunk(const uint8_t* data, size_t length) {
+uint8_t* OtaManager::getReceiveBuffer(size_t& length) {
+    length = 0;
     if (state != OtaState::Uploading) {
-        setError("No upload in progress");
-        return false;
+        if (state != OtaState::Error) setError("No upload in progress");
+        return nullptr;
     }
 
-    // Validate header on first chunk
-    if (!headerValidated && bytesReceived == 0) {
-        if (!validateImageHeader(data, length)) {
-            cancelUpload();
-            return false;
-        }
-        headerValidated = true;
+    // The trailing signature is kept here, never written to flash
+    if (bytesReceived >= firmwareSize) {
+        length = signingKeySet ? OTA_SIGNATURE_SIZE - signatureBufferPos : 0;
+        return receivedSignature + signatureBufferPos;
     }
 
-    size_t dataToProcess = length;
-    size_t dataOffset = 0;
-
-    if (signingKeySet) {
-        // Calculate how much of this chunk is firmware vs signature
-        size_t totalAfterThisChunk = bytesReceived + length;
-
-        if (totalAfterThisChunk > firmwareSize) {
-            // Some or all of this chunk is signature data
-            size_t firmwareInChunk = 0;
-            if (bytesReceived < firmwareSize) {
-                firmwareInChunk = firmwareSize - bytesReceived;
-            }
+    if (fillIndex < 0) {
+        uint8_t index;
+        uint32_t waitStart = millis();
+        if (xQueueReceive(freeQueue, &index, pdMS_TO_TICKS(OTA_PIPELINE_TIMEOUT_MS)) != pdTRUE) {
+            setError("Flash writer stalled");
+            state = OtaState::Error;
+            return nullptr;
+        }
+        pipelineStats.stallMs += millis() - waitStart;
+        fillIndex = index;
+        fillLength = 0;
+    }
 
-            // Write firmware portion to flash and update HMAC
-            if (firmwareInChunk > 0) {
-                esp_err_t err = esp_ota_write(otaHandle, data, firmwareInChunk);
-                if (err != ESP_OK) {
-                    snprintf(errorMessage, sizeof(errorMessage), "Write failed: %s", esp_err_to_name(err));
-                    state = OtaState::Error;
-                    esp_ota_abort(otaHandle);
-                    return false;
-                }
-                mbedtls_md_hmac_update(&hmacCtx, data, firmwareInChunk);
-            }
+    length = OTA_PIPELINE_BUFFER_SIZE - fillLength;
+    if (length > firmwareSize - bytesReceived) {
+        length = firmwareSize - bytesReceived;
+    }
+    return buffers[fillIndex] + fillLength;
+}
 
-            // Copy signature portion to buffer
-            size_t signatureInChunk = length - firmwareInChunk;
-            const uint8_t* sigData = data + firmwareInChunk;
+bool OtaManager::commitReceived(size_t length) {
+    if (state != OtaState::Uploading || !checkWriter()) {
+        return false;
+    }
 
-            for (size_t i = 0; i < signatureInChunk && signatureBufferPos < OTA_SIGNATURE_SIZE; i++) {
-                receivedSignature[signatureBufferPos++] = sigData[i];
-            }
+    if (bytesReceived >= firmwareSize) {
+        signatureBufferPos += length;
+        bytesReceived += length;
+        return true;
+    }
 
-            bytesReceived += length;
-            return true;
-        }
+    fillLength += length;
+    bytesReceived += length;
+    if (fillLength == OTA_PIPELINE_BUFFER_SIZE || bytesReceived == firmwareSize) {
+        return queueFill();
+    }
+    return true;
+}
 
-        // All data is firmware
-        esp_err_t err = esp_ota_write(otaHandle, data, length);
-        if (err != ESP_OK) {
-            snprintf(errorMessage, sizeof(errorMessage), "Write failed: %s", esp_err_to_name(err));
+bool OtaManager::writeChunk(const uint8_t* data, size_t length) {
+    while (length > 0) {
+        size_t space;
+        uint8_t* dest = getReceiveBuffer(space);
+        if (!dest) return false;
+        if (space == 0) {
+            setError("More data than expected");
             state = OtaState::Error;
-            esp_ota_abort(otaHandle);
             return false;
         }
-        mbedtls_md_hmac_update(&hmacCtx, data, length);
-        bytesReceived += length;
-        return true;
-    }
 
-    // No signature verification - write everything
-    esp_err_t err = esp_ota_write(otaHandle, data, length);
-    if (err != ESP_OK) {
-        snprintf(errorMessage, sizeof(errorMessage), "Write failed: %s", esp_err_to_name(err));
-        state = OtaState::Error;
-        esp_ota_abort(otaHandle);
-        return false;
+        size_t n = length < space ? length : space;
+        memcpy(dest, data, n);
+        if (!commitReceived(n)) return false;
+        data += n;
+        length -= n;
     }
-
-    bytesReceived += length;
     return true;
 }
 
@@ -207,6 +237,20 @@ bool OtaManager::finishUpload() {
         return false;
     }
 
+    // Hand over the last partial buffer and wait for the writer to drain
+    if (!queueFill()) {
+        stopPipeline(true);
+        esp_ota_abort(otaHandle);
+        otaHandle = 0;
+        return false;
+    }
+    stopPipeline(false);
+    if (!checkWriter()) {
+        esp_ota_abort(otaHandle);
+        otaHandle = 0;
+        return false;
+    }
+
     state = OtaState::Verifying;
     Serial.println("[OTA] Verifying firmware...");
 
@@ -214,13 +258,17 @@ bool OtaManager::finishUpload() {
     if (signingKeySet) {
         if (!verifySignature()) {
             esp_ota_abort(otaHandle);
+            otaHandle = 0;
             return false;
         }
         Serial.println("[OTA] Signature verified");
     }
 
     // End OTA - this verifies the image
+    uint32_t verifyStart = millis();
     esp_err_t err = esp_ota_end(otaHandle);
+    otaHandle = 0;
+    pipelineStats.verifyMs = millis() - verifyStart;
     if (err != ESP_OK) {
         if (err == ESP_ERR_OTA_VALIDATE_FAILED) {
             setError("Firmware validation failed");
@@ -231,6 +279,18 @@ bool OtaManager::finishUpload() {
         return false;
     }
 
+    pipelineStats.totalMs = millis() - pipelineStats.startMs;
+    Serial.printf("[OTA] %lu KB in %lu.%lu s (%lu KB/s)\n",
+                  (unsigned long)(pipelineStats.bytes / 1024),
+                  (unsigned long)(pipelineStats.totalMs / 1000),
+                  (unsigned long)(pipelineStats.totalMs % 1000 / 100),
+                  (unsigned long)getThroughputKBps());
+    Serial.printf("[OTA] Writer: erase+write %lu ms, hash %lu ms, waited %lu ms for data; "
+                  "receiver waited %lu ms for buffers; verify %lu ms\n",
+                  (unsigned long)pipelineStats.writeMs,
+                  (unsigned long)pipelineStats.hashMs, (unsigned long)pipelineStats.starveMs,
+                  (unsigned long)pipelineStats.stallMs, (unsigned long)pipelineStats.verifyMs);
+
     state = OtaState::Installing;
     Serial.println("[OTA] Setting boot partition...");
 
@@ -248,11 +308,16 @@ bool OtaManager::finishUpload() {
 }
 
 void OtaManager::cancelUpload() {
-    if (state == OtaState::Uploading && otaHandle != 0) {
+    bool failed = (state == OtaState::Error);
+    stopPipeline(true);
+    if ((state == OtaState::Uploading || failed) && otaHandle != 0) {
         esp_ota_abort(otaHandle);
         Serial.println("[OTA] Upload cancelled");
     }
     reset();
+
+    // Keep the reason for the error reply sent after cancelling
+    if (!failed) errorMessage[0] = '\0';
 }
 
 const char* OtaManager::getStateString() const {
@@ -272,6 +337,18 @@ int OtaManager::getProgress() const {
     return (int)((bytesReceived * 100) / totalBytes);
 }
 
+uint32_t OtaManager::getThroughputKBps() const {
+    uint32_t elapsed = pipelineStats.totalMs;
+    size_t bytes = pipelineStats.bytes;
+    if (elapsed == 0) {
+        if (state != OtaState::Uploading) return 0;
+        elapsed = millis() - pipelineStats.startMs;
+        bytes = bytesReceived;
+    }
+    if (elapsed == 0) return 0;
+    return (uint32_t)((uint64_t)bytes * 1000 / 1024 / elapsed);
+}
+
 const char* OtaManager::getVersion() {
     return FIRMWARE_VERSION;
 }
@@ -328,6 +405,140 @@ void OtaManager::restart() {
     ESP.restart();
 }
 
+//=============================================================================
+// Upload pipeline
+//=============================================================================
+
+bool OtaManager::startPipeline() {
+    for (int i = 0; i < OTA_PIPELINE_BUFFERS; i++) {
+        // Internal RAM: flash writes from PSRAM go through a bounce buffer
+        buffers[i] = (uint8_t*)heap_caps_malloc(OTA_PIPELINE_BUFFER_SIZE,
+                                                MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!buffers[i]) buffers[i] = (uint8_t*)malloc(OTA_PIPELINE_BUFFER_SIZE);
+        if (!buffers[i]) return false;
+    }
+
+    freeQueue = xQueueCreate(OTA_PIPELINE_BUFFERS, sizeof(uint8_t));
+    writeQueue = xQueueCreate(OTA_PIPELINE_BUFFERS + 1, sizeof(PipelineBlock));  // + stop
+    writerDone = xSemaphoreCreateBinary();
+    if (!freeQueue || !writeQueue || !writerDone) return false;
+
+    for (uint8_t i = 0; i < OTA_PIPELINE_BUFFERS; i++) {
+        xQueueSend(freeQueue, &i, 0);
+    }
+
+    if (xTaskCreatePinnedToCore(writerTaskEntry, "ota_writer", OTA_PIPELINE_WRITER_STACK, this,
+                                OTA_PIPELINE_WRITER_PRIORITY, &writerTask,
+                                OTA_PIPELINE_WRITER_CORE) != pdPASS) {
+        writerTask = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void OtaManager::stopPipeline(bool abort) {
+    if (writerTask) {
+        // Aborting skips the queued blocks; a write already in progress
+        // completes. The writer is never deleted from here: inside
+        // esp_ota_write() it may hold the SPI flash lock with the cache
+        // disabled, and every later flash access would deadlock. So this
+        // waits for it however long the flash takes.
+        if (abort) writerAbort = true;
+        PipelineBlock stop = { OTA_PIPELINE_BUFFERS, 0, 0 };
+        xQueueSend(writeQueue, &stop, portMAX_DELAY);
+        xSemaphoreTake(writerDone, portMAX_DELAY);
+        writerTask = nullptr;
+    }
+
+    if (freeQueue) vQueueDelete(freeQueue);
+    if (writeQueue) vQueueDelete(writeQueue);
+    if (writerDone) vSemaphoreDelete(writerDone);
+    freeQueue = nullptr;
+    writeQueue = nullptr;
+    writerDone = nullptr;
+
+    for (int i = 0; i < OTA_PIPELINE_BUFFERS; i++) {
+        free(buffers[i]);
+        buffers[i] = nullptr;
+    }
+    fillIndex = -1;
+    fillLength = 0;
+}
+
+bool OtaManager::queueFill() {
+    if (fillIndex < 0 || fillLength == 0) return true;
+
+    // Checked before the first byte reaches flash
+    if (!headerValidated) {
+        if (!validateImageHeader(buffers[fillIndex], fillLength)) return false;
+        headerValidated = true;
+    }
+
+    PipelineBlock block = { (uint8_t)fillIndex, (uint32_t)queuedBytes, (uint32_t)fillLength };
+    xQueueSend(writeQueue, &block, portMAX_DELAY);  // Never full: one slot per buffer
+    queuedBytes += fillLength;
+    fillIndex = -1;
+    fillLength = 0;
+    return true;
+}
+
+bool OtaManager::checkWriter() {
+    esp_err_t err = writerError;
+    if (err == ESP_OK) return true;
+
+    snprintf(errorMessage, sizeof(errorMessage), "Write failed: %s", esp_err_to_name(err));
+    Serial.printf("[OTA] Error: %s\n", errorMessage);
+    state = OtaState::Error;
+    return false;
+}
+
+void OtaManager::writerTaskEntry(void* arg) {
+    OtaManager* self = (OtaManager*)arg;
+    self->writerLoop();
+    xSemaphoreGive(self->writerDone);
+    vTaskDelete(nullptr);
+}
+
+void OtaManager::writerLoop() {
+    for (;;) {
+        PipelineBlock block;
+        uint32_t waitStart = millis();
+        xQueueReceive(writeQueue, &block, portMAX_DELAY);
+        pipelineStats.starveMs += millis() - waitStart;
+
+        if (block.index >= OTA_PIPELINE_BUFFERS) break;
+
+        // After an error or an abort, buffers are only returned so the
+        // receiver never blocks
+        if (writerError == ESP_OK && !writerAbort) {
+            uint8_t* data = buffers[block.index];
+
+            if (signingKeySet) {
+                uint32_t start = millis();
+                mbedtls_md_hmac_update(&hmacCtx, data, block.length);
+                pipelineStats.hashMs += millis() - start;
+            }
+
+            // Blocks arrive in order (block.offset == bytes written so far),
+            // so the sequential esp_ota_write() fits: it erases each new
+            // sector, buffers the 16-byte remainder for encrypted flash, and
+            // counts what esp_ota_end() needs to accept the image
+            uint32_t start = millis();
+            esp_err_t err = esp_ota_write(otaHandle, data, block.length);
+            pipelineStats.writeMs += millis() - start;
+
+            if (err == ESP_OK) {
+                pipelineStats.bytes += block.length;
+                pipelineStats.buffers++;
+            } else {
+                writerError = err;
+            }
+        }
+
+        xQueueSend(freeQueue, &block.index, portMAX_DELAY);
+    }
+}
+
 bool OtaManager::validateImageHeader(const uint8_t* data, size_t length) {
     if (length < sizeof(esp_image_header_t)) {
         setError("Data too small for header");
@@ -362,7 +573,6 @@ void OtaManager::reset() {
     firmwareSize = 0;
     headerValidated = false;
     signatureBufferPos = 0;
-    errorMessage[0] = '\0';
 }
 
 bool OtaManager::verifySignature() {
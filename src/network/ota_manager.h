@@ -8,12 +8,24 @@
  * - Progress tracking
  * - Automatic rollback on boot failure
  * - Optional HMAC-SHA256 signature verification
+ *
+ * Upload pipeline: the HTTP handler receives straight into one of two
+ * OTA_PIPELINE_BUFFER_SIZE buffers (whole flash sectors) and hands each
+ * full buffer to a writer task on core OTA_PIPELINE_WRITER_CORE, which
+ * updates the HMAC and writes it with esp_ota_write() while the handler
+ * fills the other one. The session is begun with
+ * OTA_WITH_SEQUENTIAL_WRITES, so esp_ota_write() erases each sector as
+ * it reaches it; esp_ota_begin() used to erase the whole image size
+ * before the first byte was read.
  */
 
 #ifndef OTA_MANAGER_H
 #define OTA_MANAGER_H
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 #include <esp_ota_ops.h>
 #include <esp_partition.h>
 #include <mbedtls/md.h>
@@ -21,6 +33,18 @@
 // Signature size (HMAC-SHA256 = 32 bytes)
 #define OTA_SIGNATURE_SIZE 32
 
+// Upload pipeline: buffers in flight, each a whole number of 4 KB sectors
+#define OTA_PIPELINE_BUFFERS 2
+#define OTA_PIPELINE_BUFFER_SIZE (16 * 1024)
+
+// Writer task; the display loop runs on core 1
+#define OTA_PIPELINE_WRITER_CORE 0
+#define OTA_PIPELINE_WRITER_PRIORITY 5
+#define OTA_PIPELINE_WRITER_STACK 4096
+
+// Longest wait for the writer to free a buffer
+#define OTA_PIPELINE_TIMEOUT_MS 10000
+
 // OTA operation states
 enum class OtaState {
     Idle,
@@ -31,6 +55,25 @@ enum class OtaState {
     Error
 };
 
+/**
+ * @struct OtaPipelineStats
+ * @brief Timing of the current (or last) upload
+ *
+ * stallMs is time the receiver waited for a free buffer (flash-bound);
+ * starveMs is time the writer waited for data (network-bound).
+ */
+struct OtaPipelineStats {
+    uint32_t startMs;       ///< millis() at startUpload()
+    uint32_t totalMs;       ///< startUpload() to image verified, 0 while running
+    uint32_t bytes;         ///< Firmware bytes written to flash
+    uint32_t buffers;       ///< Buffers written
+    uint32_t writeMs;       ///< Writer erasing and writing (esp_ota_write)
+    uint32_t hashMs;        ///< Writer updating the HMAC
+    uint32_t starveMs;
+    uint32_t stallMs;
+    uint32_t verifyMs;      ///< esp_ota_end() image check
+};
+
 /**
  * @class OtaManager
  * @brief Manages OTA firmware updates with safety features
@@ -52,11 +95,32 @@ public:
      */
     bool startUpload(size_t totalSize);
 
+    /**
+     * @brief Where to receive the next upload bytes
+     * @param length Set to the most bytes that may be written there
+     * @return Buffer to receive into, or nullptr if not uploading
+     *
+     * Receive into this and call commitReceived() with the count; there
+     * is no copy. Stops at the signature so it never reaches flash.
+     */
+    uint8_t* getReceiveBuffer(size_t& length);
+
+    /**
+     * @brief Account for bytes received into getReceiveBuffer()
+     * @return false on error (see getErrorMessage(); cancel the upload)
+     *
+     * A full buffer is queued to the writer; blocks while both buffers
+     * are still being written.
+     */
+    bool commitReceived(size_t length);
+
     /**
      * @brief Write a chunk of firmware data
      * @param data Pointer to chunk data
      * @param length Length of chunk
      * @return true if chunk written successfully
+     *
+     * Copies through getReceiveBuffer()/commitReceived().
      */
     bool writeChunk(const uint8_t* data, size_t length);
 
@@ -101,6 +165,16 @@ public:
      */
     const char* getErrorMessage() const { return errorMessage; }
 
+    /**
+     * @brief Get upload timing (current upload while one is running)
+     */
+    const OtaPipelineStats& getPipelineStats() const { return pipelineStats; }
+
+    /**
+     * @brief Upload throughput so far, or of the last upload (KB/s)
+     */
+    uint32_t getThroughputKBps() const;
+
     /**
      * @brief Get current firmware version
      */
@@ -174,6 +248,32 @@ private:
     uint8_t signatureBuffer[OTA_SIGNATURE_SIZE];  // Rolling buffer for last 32 bytes
     size_t signatureBufferPos;
 
+    // Upload pipeline
+    struct PipelineBlock {
+        uint8_t index;      ///< Buffer, or OTA_PIPELINE_BUFFERS to stop the writer
+        uint32_t offset;    ///< Partition offset
+        uint32_t length;
+    };
+
+    uint8_t* buffers[OTA_PIPELINE_BUFFERS];
+    QueueHandle_t freeQueue;        ///< Buffer indexes ready to fill
+    QueueHandle_t writeQueue;       ///< PipelineBlocks for the writer
+    SemaphoreHandle_t writerDone;
+    TaskHandle_t writerTask;
+    int fillIndex;                  ///< Buffer being received into, -1 if none
+    size_t fillLength;
+    size_t queuedBytes;             ///< Firmware bytes handed to the writer
+    volatile esp_err_t writerError;
+    volatile bool writerAbort;      ///< Skip queued blocks, set by stopPipeline(true)
+    OtaPipelineStats pipelineStats;
+
+    bool startPipeline();
+    void stopPipeline(bool abort);
+    bool queueFill();
+    bool checkWriter();
+    static void writerTaskEntry(void* arg);
+    void writerLoop();
+
     bool validateImageHeader(const uint8_t* data, size_t length);
     void setError(const char* msg);
     void reset();
@@ -0,0 +1,214 @@
+/**
+ * @file status_push.cpp
+ * @brief Live status WebSocket push implementation
+ */
+
+#include "status_push.h"
+
+/** FNV-1a, enough to notice that a serialized field changed */
+static uint32_t hashValue(const String& text) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < text.length(); i++) {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;  // 0 means "never read"
+}
+
+//=============================================================================
+// Constructor / Initialization
+//=============================================================================
+
+StatusPush::StatusPush()
+    : server(nullptr)
+    , fieldCount(0)
+    , clientCount(0)
+    , flushQueued(false)
+    , lastQueueMs(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void StatusPush::begin(httpd_handle_t httpServer) {
+    server = httpServer;
+    clientCount = 0;
+    flushQueued = false;
+}
+
+void StatusPush::end() {
+    server = nullptr;
+    clientCount = 0;
+    flushQueued = false;
+}
+
+bool StatusPush::addField(const char* key, StatusFieldWriter writer) {
+    if (fieldCount >= STATUS_PUSH_MAX_FIELDS) {
+        Serial.printf("[StatusPush] Field table full, '%s' not pushed\n", key);
+        return false;
+    }
+    Field& field = fields[fieldCount++];
+    field.key = key;
+    field.writer = writer;
+    field.hash = 0;
+    field.version = 0;
+    field.sentVersion = 0;
+    return true;
+}
+
+//=============================================================================
+// Clients (httpd task)
+//=============================================================================
+
+bool StatusPush::addClient(int fd) {
+    for (uint8_t i = 0; i < clientCount; i++) {
+        if (clients[i] == fd) {
+            // Socket number reused before the old client was pruned
+            needsSnapshot[i] = true;
+            return true;
+        }
+    }
+    if (clientCount >= STATUS_PUSH_MAX_CLIENTS) return false;
+    clients[clientCount] = fd;
+    needsSnapshot[clientCount] = true;
+    clientCount++;
+    return true;
+}
+
+void StatusPush::removeClient(uint8_t index) {
+    clientCount--;
+    clients[index] = clients[clientCount];
+    needsSnapshot[index] = needsSnapshot[clientCount];
+}
+
+bool StatusPush::send(int fd, const String& payload) {
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.final = true;
+    frame.type = HTTPD_WS_TYPE_TEXT;
+    frame.payload = (uint8_t*)payload.c_str();
+    frame.len = payload.length();
+
+    if (httpd_ws_send_frame_async(server, fd, &frame) != ESP_OK) return false;
+    stats.bytesSent += payload.length();
+    return true;
+}
+
+esp_err_t StatusPush::handleRequest(httpd_req_t* req) {
+    if (req->method == HTTP_GET) {
+        // Handshake: the server has already answered the upgrade
+        int fd = httpd_req_to_sockfd(req);
+        if (!addClient(fd)) {
+            stats.rejected++;
+            Serial.printf("[StatusPush] Rejected client %d, %d already connected\n",
+                          fd, STATUS_PUSH_MAX_CLIENTS);
+            return ESP_FAIL;  // Closes the socket
+        }
+        stats.connects++;
+        Serial.printf("[StatusPush] Client %d connected (%u open)\n", fd, clientCount);
+        flush();
+        return ESP_OK;
+    }
+
+    // The page only listens; read whatever arrives so the socket stays usable
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+    if (err != ESP_OK) return err;
+    if (frame.len == 0) return ESP_OK;
+    if (frame.len > STATUS_PUSH_MAX_RECV) return ESP_FAIL;
+
+    uint8_t buffer[STATUS_PUSH_MAX_RECV];
+    frame.payload = buffer;
+    return httpd_ws_recv_frame(req, &frame, frame.len);
+}
+
+//=============================================================================
+// Push
+//=============================================================================
+
+void StatusPush::update(uint32_t nowMs) {
+    if (!server || clientCount == 0 || flushQueued) return;
+    if (nowMs - lastQueueMs < STATUS_PUSH_INTERVAL_MS) return;
+
+    lastQueueMs = nowMs;
+    flushQueued = true;
+    if (httpd_queue_work(server, flushWork, this) != ESP_OK) {
+        flushQueued = false;
+    }
+}
+
+void StatusPush::flushWork(void* arg) {
+    StatusPush* self = (StatusPush*)arg;
+    self->flushQueued = false;
+    self->flush();
+}
+
+void StatusPush::flush() {
+    if (!server) return;
+
+    // Drop clients whose socket the server has closed
+    for (uint8_t i = clientCount; i-- > 0;) {
+        if (httpd_ws_get_fd_info(server, clients[i]) != HTTPD_WS_CLIENT_WEBSOCKET) {
+            Serial.printf("[StatusPush] Client %d gone\n", clients[i]);
+            removeClient(i);
+        }
+    }
+    if (clientCount == 0) return;
+
+    stats.polls++;
+
+    JsonDocument current;
+    JsonDocument delta;
+    String scratch;
+    for (uint8_t i = 0; i < fieldCount; i++) {
+        Field& field = fields[i];
+        JsonVariant value = current[field.key].to<JsonVariant>();
+        field.writer(value);
+
+        scratch = "";
+        serializeJson(value, scratch);
+        uint32_t hash = hashValue(scratch);
+        if (hash != field.hash) {
+            field.hash = hash;
+            field.version++;
+        }
+        if (field.version != field.sentVersion) {
+            delta[field.key] = value;
+            field.sentVersion = field.version;
+            stats.fieldUpdates++;
+        }
+    }
+
+    String deltaJson;
+    if (delta.size() > 0) {
+        serializeJson(delta, deltaJson);
+        stats.deltas++;
+    }
+    String snapshotJson;
+
+    bool sentAny = false;
+    for (uint8_t i = clientCount; i-- > 0;) {
+        const String* payload = nullptr;
+        if (needsSnapshot[i]) {
+            if (snapshotJson.isEmpty()) {
+                serializeJson(current, snapshotJson);
+                stats.snapshots++;
+            }
+            payload = &snapshotJson;
+        } else if (!deltaJson.isEmpty()) {
+            payload = &deltaJson;
+        }
+        if (!payload) continue;
+
+        if (!send(clients[i], *payload)) {
+            stats.dropped++;
+            Serial.printf("[StatusPush] Send to client %d failed, dropping\n", clients[i]);
+            httpd_sess_trigger_close(server, clients[i]);
+            removeClient(i);
+            continue;
+        }
+        needsSnapshot[i] = false;
+        sentAny = true;
+    }
+    if (!sentAny) stats.idlePolls++;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file status_push.h
+ * @brief Live status pushed to web UI clients over a WebSocket
+ *
+ * Replaces the settings page's one-second /api/status poll. The status is
+ * split into named fields (mood, timers, mic level, OTA progress, ...),
+ * each written by a callback into a JSON value. At most every
+ * STATUS_PUSH_INTERVAL_MS every field is re-read and hashed; a field whose
+ * hash changed gets a new version, and only fields whose version is newer
+ * than the last one sent go out, as one small JSON object:
+ *
+ *     {"currentMood":"Happy","assistant":{"state":"Listening","mic":35}}
+ *
+ * A new client gets every field once as a snapshot. Nothing is read or
+ * sent while no client is connected, and nothing is sent while nothing
+ * changed.
+ *
+ * Fields are read and frames sent in the httpd task (the same task that
+ * answered /api/status before), so the client list and versions need no
+ * lock. update() on the main loop only queues that work.
+ */
+
+#ifndef STATUS_PUSH_H
+#define STATUS_PUSH_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <esp_http_server.h>
+#include <functional>
+
+//=============================================================================
+// Configuration
+//=============================================================================
+
+/**
+ * Most WebSocket clients at once. Each holds an httpd socket for as long
+ * as the page is open; WEB_SERVER_MAX_SOCKETS counts them in.
+ */
+#define STATUS_PUSH_MAX_CLIENTS 2
+
+/** Most status fields */
+#define STATUS_PUSH_MAX_FIELDS 12
+
+/** Shortest gap between pushes (ms); changes in between are coalesced */
+#define STATUS_PUSH_INTERVAL_MS 250
+
+/** Largest frame accepted from a client (the page sends none) */
+#define STATUS_PUSH_MAX_RECV 128
+
+//=============================================================================
+// Types
+//=============================================================================
+
+/** Writes one field's current value */
+using StatusFieldWriter = std::function<void(JsonVariant out)>;
+
+/**
+ * @struct StatusPushStats
+ * @brief Push traffic since boot
+ */
+struct StatusPushStats {
+    uint32_t connects;
+    uint32_t rejected;      ///< Refused, STATUS_PUSH_MAX_CLIENTS already open
+    uint32_t dropped;       ///< Removed after a failed send
+    uint32_t polls;         ///< Times the fields were read
+    uint32_t idlePolls;     ///< Reads where nothing changed (nothing sent)
+    uint32_t snapshots;
+    uint32_t deltas;
+    uint32_t fieldUpdates;  ///< Changed fields, summed over deltas
+    uint32_t bytesSent;     ///< Frame payloads, summed over clients
+};
+
+//=============================================================================
+// StatusPush Class
+//=============================================================================
+
+class StatusPush {
+public:
+    StatusPush();
+
+    /**
+     * @brief Attach to a running server
+     */
+    void begin(httpd_handle_t server);
+
+    /**
+     * @brief Forget all clients (the server closes their sockets)
+     */
+    void end();
+
+    /**
+     * @brief Add a field; call before begin()
+     * @param key JSON key, a string literal
+     * @return false if STATUS_PUSH_MAX_FIELDS are already registered
+     */
+    bool addField(const char* key, StatusFieldWriter writer);
+
+    /**
+     * @brief WebSocket URI handler body (httpd task)
+     *
+     * The handshake registers the client and sends it a snapshot; frames
+     * from the client are read and ignored.
+     */
+    esp_err_t handleRequest(httpd_req_t* req);
+
+    /**
+     * @brief Queue a push if one is due (main loop)
+     * @param nowMs Current time
+     */
+    void update(uint32_t nowMs);
+
+    /**
+     * @brief Read the fields and send what changed (httpd task)
+     *
+     * Also called directly by handlers that keep the httpd task busy for
+     * a long time, such as the OTA upload, so progress still goes out.
+     */
+    void flush();
+
+    uint8_t getClientCount() const { return clientCount; }
+    const StatusPushStats& getStats() const { return stats; }
+
+private:
+    struct Field {
+        const char* key;
+        StatusFieldWriter writer;
+        uint32_t hash;          ///< Of the serialized value, 0 before the first read
+        uint32_t version;
+        uint32_t sentVersion;
+    };
+
+    static void flushWork(void* arg);
+
+    bool addClient(int fd);
+    void removeClient(uint8_t index);
+    bool send(int fd, const String& payload);
+
+    httpd_handle_t server;
+
+    Field fields[STATUS_PUSH_MAX_FIELDS];
+    uint8_t fieldCount;
+
+    int clients[STATUS_PUSH_MAX_CLIENTS];
+    bool needsSnapshot[STATUS_PUSH_MAX_CLIENTS];
+    volatile uint8_t clientCount;
+
+    volatile bool flushQueued;
+    uint32_t lastQueueMs;
+
+    StatusPushStats stats;
+};
+
+#endif // STATUS_PUSH_H
@@ -6,10 +6,12 @@
  * with Arduino ESP32 3.x framework.
  *
  * Endpoints:
- * - GET /               - Main settings page
+ * - GET /               - Main settings page (gzipped, ETag / 304)
  * - GET /api/settings   - Get all settings as JSON
  * - POST /api/settings  - Update settings
  * - GET /api/status     - Device status (WiFi, pomodoro)
+ * - GET /ws/status      - WebSocket, pushes status changes (see status_push.h)
+ * - GET /api/display/stream - WebSocket, live framebuffer mirror (see display_stream.h)
  * - GET /api/time       - Get current time
  * - POST /api/time      - Set time (hour, minute, is24Hour)
  * - GET /api/wifi/scan  - Scan for WiFi networks
@@ -24,6 +26,10 @@
  * - POST /api/ota/cancel     - Cancel OTA upload
  * - POST /api/system/restart - Restart device
  * - POST /api/system/rollback - Rollback to previous firmware
+ *
+ * The settings page is web/settings.html, minified and gzipped at build
+ * time by scripts/build_web_ui.py into web_ui_gz.h. Everything dynamic on
+ * it is fetched from the JSON APIs.
  */
 
 #ifndef WEB_SERVER_H
@@ -32,6 +38,24 @@
 #include <Arduino.h>
 #include <esp_http_server.h>
 #include <ArduinoJson.h>
+#include "status_push.h"
+#include "display_stream.h"
+
+/** Bytes per chunk when sending the settings page */
+#define WEB_UI_CHUNK_SIZE 4096
+
+/** httpd sockets left for page and API requests besides the WebSockets */
+#define WEB_SERVER_HTTP_SOCKETS 4
+
+/**
+ * httpd's max_open_sockets. WebSocket clients hold theirs while the page
+ * is open, so they are counted on top of the request sockets. httpd uses
+ * 3 more of lwIP's CONFIG_LWIP_MAX_SOCKETS (16, fixed in the Arduino
+ * core's prebuilt libraries), which the MCP server and outgoing TLS
+ * connections share too.
+ */
+#define WEB_SERVER_MAX_SOCKETS \
+    (STATUS_PUSH_MAX_CLIENTS + DISPLAY_STREAM_MAX_CLIENTS + WEB_SERVER_HTTP_SOCKETS)
 
 // Forward declarations
 class SettingsMenu;
@@ -51,6 +75,19 @@ typedef void (*AudioTestCallback)();
 // Current mood getter callback type
 typedef const char* (*MoodGetterCallback)();
 
+// Microphone level getter callback type (0.0 - 1.0)
+typedef float (*MicLevelCallback)();
+
+/**
+ * @struct WebUiStats
+ * @brief Settings page requests since boot
+ */
+struct WebUiStats {
+    uint32_t pageLoads;     ///< Page sent in full
+    uint32_t notModified;   ///< Answered 304 from the browser's copy
+    uint32_t bytesSent;     ///< Gzipped page bytes sent
+};
+
 /**
  * @class WebServerManager
  * @brief HTTP server for remote settings management
@@ -86,6 +123,13 @@ public:
      */
     bool hasSettingsChange();
 
+    /**
+     * @brief Push status changes to WebSocket clients
+     * Call this in loop(); does nothing while no page is connected
+     * @param nowMs Current time
+     */
+    void update(uint32_t nowMs) { statusPush.update(nowMs); }
+
     /**
      * @brief Clear the settings changed flag after applying changes
      */
@@ -109,6 +153,12 @@ public:
      */
     void setMoodGetterCallback(MoodGetterCallback callback) { moodGetterCallback = callback; }
 
+    /**
+     * @brief Set callback to get the microphone level
+     * @param callback Function that returns the smoothed level 0.0 - 1.0
+     */
+    void setMicLevelCallback(MicLevelCallback callback) { micLevelCallback = callback; }
+
     /**
      * @brief Set breathing exercise instance for wellness features
      * @param breathing Pointer to BreathingExercise
@@ -131,6 +181,7 @@ private:
     ExpressionCallback expressionCallback;
     AudioTestCallback audioTestCallback;
     MoodGetterCallback moodGetterCallback;
+    MicLevelCallback micLevelCallback;
     httpd_handle_t server;
     SettingsMenu* settingsMenu;
     PomodoroTimer* pomodoroTimer;
@@ -140,12 +191,16 @@ private:
     CountdownTimer* countdownTimer;
     ReminderManager* reminderManager;
     bool settingsChanged;
+    WebUiStats uiStats;
+    StatusPush statusPush;
 
     // Static handler wrappers (esp_http_server requires C-style callbacks)
     static esp_err_t handleRoot(httpd_req_t* req);
     static esp_err_t handleGetSettings(httpd_req_t* req);
     static esp_err_t handlePostSettings(httpd_req_t* req);
     static esp_err_t handleGetStatus(httpd_req_t* req);
+    static esp_err_t handleStatusSocket(httpd_req_t* req);
+    static esp_err_t handleDisplayStream(httpd_req_t* req);
     static esp_err_t handleWiFiScan(httpd_req_t* req);
     static esp_err_t handleWiFiConnect(httpd_req_t* req);
     static esp_err_t handleWiFiForget(httpd_req_t* req);
@@ -187,12 +242,15 @@ private:
     // Helper to get WebServerManager instance from request context
     static WebServerManager* getInstance(httpd_req_t* req);
 
-    // Generate settings page HTML
-    String generateSettingsPage();
-
     // Build JSON responses
     void buildSettingsJson(JsonDocument& doc);
     void buildStatusJson(JsonDocument& doc);
+    void buildTimeJson(JsonObject time);
+    void buildWifiJson(JsonObject wifi);
+    void buildPomodoroJson(JsonObject pomodoro);
+    void buildTimerJson(JsonObject timer);
+    void buildRemindersJson(JsonArray reminders);
+    void registerStatusFields();
 };
 
 #endif // WEB_SERVER_H
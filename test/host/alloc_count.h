@@ -0,0 +1,20 @@
+/**
+ * @file alloc_count.h
+ * @brief Count heap allocations in a host test or benchmark
+ *
+ * Link alloc_count.cpp with ALLOC_COUNT_LDFLAGS (see Makefile): malloc,
+ * calloc and realloc are wrapped at link time and operator new is routed
+ * through malloc, so every allocation made by the firmware sources,
+ * ArduinoJson and the String stub is counted. Allocations inside the
+ * shared C++ runtime itself are not.
+ */
+
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <cstddef>
+
+/** Allocations (malloc, calloc, realloc, new) since the program started */
+size_t hostAllocations();
+
+#endif // ALLOC_COUNT_H
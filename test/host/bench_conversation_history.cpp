@@ -0,0 +1,284 @@
+/**
+ * @file bench_conversation_history.cpp
+ * @brief Heap churn and CPU per turn of a multi-turn Claude request
+ *
+ * Plays a conversation turn by turn (every third turn calls a tool) and,
+ * after each, builds the request body two ways: from the pre-serialized
+ * history fragments through a FragmentStream, the way LLMClient does, and
+ * by rebuilding one JsonDocument from a vector of String messages and
+ * serializing it to a String, the way it did before. Both bodies are read
+ * out in TCP-segment-sized pieces as if sent, and must carry the same
+ * messages. Host numbers; the ESP32-S3 at 240 MHz is roughly 10-20x
+ * slower, and each allocation there also takes the heap lock.
+ */
+
+#include "alloc_count.h"
+#include "assistant/conversation_history.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+//=============================================================================
+// Conversation
+//=============================================================================
+
+static const char* const MODEL = "claude-sonnet-4-20250514";
+static const int MAX_TOKENS = 1024;
+static const int TURNS = 10;
+
+static const char* const SYSTEM_PROMPT =
+    "You are a small desk robot with a face on a round display. Answer in one or two short "
+    "sentences, as they are spoken aloud. Use the tools to set timers, change your expression "
+    "and adjust the volume when the user asks for it.";
+
+struct Tool {
+    const char* name;
+    const char* description;
+    const char* schema;
+};
+
+static const Tool TOOLS[] = {
+    { "set_timer", "Start a countdown timer",
+      "{\"type\":\"object\",\"properties\":{\"duration_seconds\":{\"type\":\"integer\"},"
+      "\"name\":{\"type\":\"string\"}},\"required\":[\"duration_seconds\"]}" },
+    { "set_expression", "Show a facial expression",
+      "{\"type\":\"object\",\"properties\":{\"expression\":{\"type\":\"string\","
+      "\"enum\":[\"neutral\",\"happy\",\"sad\",\"surprised\",\"sleepy\",\"angry\"]}},"
+      "\"required\":[\"expression\"]}" },
+    { "set_volume", "Set the speaker volume",
+      "{\"type\":\"object\",\"properties\":{\"volume\":{\"type\":\"integer\",\"minimum\":0,"
+      "\"maximum\":100}},\"required\":[\"volume\"]}" },
+};
+
+/** The pre-arena history entry */
+struct Message {
+    MessageRole role;
+    String content;
+    String toolUseId;
+    String toolName;
+    String toolInput;
+};
+
+static std::string question(int turn) {
+    return "Turn " + std::to_string(turn) + ": could you tell me something short about the weather, "
+           "and maybe set a timer for the tea?";
+}
+
+static std::string answer(int turn) {
+    return "Sure. It is mild and a little cloudy for turn " + std::to_string(turn) +
+           ", with a chance of rain later this evening. Your tea timer is running.";
+}
+
+//=============================================================================
+// Request Bodies
+//=============================================================================
+
+/** Fragments rebuilt only when tools or the prompt change (not timed) */
+struct Fragments {
+    String tools;
+    String system;
+    String head;
+
+    Fragments() {
+        JsonDocument doc;
+        JsonArray array = doc.to<JsonArray>();
+        for (const Tool& tool : TOOLS) {
+            JsonObject object = array.add<JsonObject>();
+            object["name"] = tool.name;
+            object["description"] = tool.description;
+            object["input_schema"] = serialized(tool.schema);
+        }
+        serializeJson(doc, tools);
+
+        JsonDocument prompt;
+        prompt.set(SYSTEM_PROMPT);
+        serializeJson(prompt, system);
+    }
+};
+
+/** LLMClient::buildClaudeRequest() */
+static void buildFromFragments(ConversationHistory& history, Fragments& fragments, FragmentStream& body) {
+    char head[160];
+    snprintf(head, sizeof(head), "{\"model\":\"%s\",\"max_tokens\":%d,", MODEL, MAX_TOKENS);
+    fragments.head = head;
+
+    body.clear();
+    body.add(fragments.head);
+    body.add("\"tools\":");
+    body.add(fragments.tools);
+    body.add(",\"system\":");
+    body.add(fragments.system);
+    body.add(",\"messages\":[");
+    for (size_t i = 0; i < history.size(); i++) {
+        size_t length;
+        const uint8_t* fragment = history.claudeFragment(i, length);
+        if (i > 0) body.add(",");
+        body.add(fragment, length);
+    }
+    body.add("]}");
+}
+
+/** The JsonDocument build it replaced */
+static String buildFromDocument(const std::vector<Message>& history) {
+    JsonDocument doc;
+    doc["model"] = MODEL;
+    doc["max_tokens"] = MAX_TOKENS;
+    doc["system"] = SYSTEM_PROMPT;
+
+    JsonArray messages = doc["messages"].to<JsonArray>();
+    for (const Message& msg : history) {
+        JsonObject msgObj = messages.add<JsonObject>();
+        if (msg.role == MessageRole::User) {
+            msgObj["role"] = "user";
+            msgObj["content"] = msg.content;
+        } else if (msg.role == MessageRole::Tool) {
+            msgObj["role"] = "user";
+            JsonObject toolResult = msgObj["content"].to<JsonArray>().add<JsonObject>();
+            toolResult["type"] = "tool_result";
+            toolResult["tool_use_id"] = msg.toolUseId;
+            toolResult["content"] = msg.content;
+        } else if (!msg.toolName.isEmpty()) {
+            msgObj["role"] = "assistant";
+            JsonArray content = msgObj["content"].to<JsonArray>();
+            if (!msg.content.isEmpty()) {
+                JsonObject textBlock = content.add<JsonObject>();
+                textBlock["type"] = "text";
+                textBlock["text"] = msg.content;
+            }
+            JsonObject toolUse = content.add<JsonObject>();
+            toolUse["type"] = "tool_use";
+            toolUse["id"] = msg.toolUseId;
+            toolUse["name"] = msg.toolName;
+            JsonDocument inputDoc;
+            deserializeJson(inputDoc, msg.toolInput);
+            toolUse["input"] = inputDoc;
+        } else {
+            msgObj["role"] = "assistant";
+            msgObj["content"] = msg.content;
+        }
+    }
+
+    JsonArray toolsArray = doc["tools"].to<JsonArray>();
+    for (const Tool& tool : TOOLS) {
+        JsonObject toolObj = toolsArray.add<JsonObject>();
+        toolObj["name"] = tool.name;
+        toolObj["description"] = tool.description;
+        JsonDocument schemaDoc;
+        deserializeJson(schemaDoc, tool.schema);
+        toolObj["input_schema"] = schemaDoc;
+    }
+
+    String body;
+    serializeJson(doc, body);
+    return body;
+}
+
+//=============================================================================
+// Measurement
+//=============================================================================
+
+/** One TCP segment's worth, as HTTPClient copies a Stream body */
+static char segment[1436];
+
+/** Keeps the reads from being optimized away */
+static volatile size_t sent;
+
+static void send(FragmentStream& body) {
+    body.rewind();
+    size_t n;
+    while ((n = body.readBytes(segment, sizeof(segment))) > 0) sent = sent + n;
+}
+
+static void send(const String& body) {
+    for (size_t offset = 0; offset < body.length(); offset += sizeof(segment)) {
+        size_t n = std::min(sizeof(segment), (size_t)body.length() - offset);
+        memcpy(segment, body.c_str() + offset, n);
+        sent = sent + n;
+    }
+}
+
+struct Cost {
+    double us;
+    double allocations;
+};
+
+template <typename Build>
+static Cost measure(Build build, int rounds) {
+    size_t before = hostAllocations();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) build();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return { std::chrono::duration<double, std::micro>(elapsed).count() / rounds,
+             (double)(hostAllocations() - before) / rounds };
+}
+
+/** The messages[] array of a body, re-serialized so key order and spacing match */
+static std::string messagesOf(const char* body, size_t length) {
+    JsonDocument doc;
+    if (deserializeJson(doc, body, length)) return "unparsable";
+    std::string text;
+    serializeJson(doc["messages"], text);
+    return text;
+}
+
+int main() {
+    ConversationHistory history;
+    history.begin();
+    std::vector<Message> messages;
+    Fragments fragments;
+    FragmentStream body;
+    bool same = true;
+
+    const int rounds = 2000;
+    // Per request: build and send; per turn: allocations adding its messages
+    printf("%4s %5s %6s | %-25s | %-25s\n", "", "", "", "fragments", "JsonDocument");
+    printf("%4s %5s %6s | %8s %9s %6s | %8s %9s %6s\n",
+           "turn", "msgs", "bytes", "us", "allocs", "add", "us", "allocs", "add");
+
+    for (int turn = 1; turn <= TURNS; turn++) {
+        // Adding the turn: serialized once into the arena, or kept as Strings
+        std::string q = question(turn);
+        std::string a = answer(turn);
+        std::string id = "toolu_" + std::to_string(turn);
+        bool tool = turn % 3 == 0;
+
+        size_t before = hostAllocations();
+        history.add(MessageRole::User, q.c_str());
+        if (tool) {
+            history.add(MessageRole::Assistant, "", id.c_str(), "set_timer", "{\"duration_seconds\":240}");
+            history.add(MessageRole::Tool, "{\"success\":true,\"timer\":\"tea\"}", id.c_str());
+        }
+        history.add(MessageRole::Assistant, a.c_str());
+        size_t addedToArena = hostAllocations() - before;
+
+        before = hostAllocations();
+        messages.push_back({ MessageRole::User, q.c_str(), "", "", "" });
+        if (tool) {
+            messages.push_back({ MessageRole::Assistant, "", id.c_str(), "set_timer", "{\"duration_seconds\":240}" });
+            messages.push_back({ MessageRole::Tool, "{\"success\":true,\"timer\":\"tea\"}", id.c_str(), "", "" });
+        }
+        messages.push_back({ MessageRole::Assistant, a.c_str(), "", "", "" });
+        size_t addedAsStrings = hostAllocations() - before;
+
+        Cost streamed = measure([&]() {
+            buildFromFragments(history, fragments, body);
+            send(body);
+        }, rounds);
+        Cost rebuilt = measure([&]() { send(buildFromDocument(messages)); }, rounds);
+
+        std::string streamedText(body.size(), '\0');
+        body.rewind();
+        body.readBytes(&streamedText[0], streamedText.size());
+        String rebuiltText = buildFromDocument(messages);
+        if (messagesOf(streamedText.data(), streamedText.size()) !=
+            messagesOf(rebuiltText.c_str(), rebuiltText.length())) {
+            printf("turn %d: the bodies carry different messages\n", turn);
+            same = false;
+        }
+
+        printf("%4d %5zu %6zu | %8.2f %9.1f %6zu | %8.2f %9.1f %6zu\n",
+               turn, history.size(), body.size(), streamed.us, streamed.allocations, addedToArena,
+               rebuilt.us, rebuilt.allocations, addedAsStrings);
+    }
+    return same ? 0 : 1;
+}
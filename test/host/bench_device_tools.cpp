@@ -0,0 +1,74 @@
+/**
+ * @file bench_device_tools.cpp
+ * @brief Time device tool lookup and dispatch
+ *
+ * Compares findDeviceTool()'s perfect hash with the strcmp chain it
+ * replaced (every name in table order, then a name that is not a tool),
+ * and prints what a whole executeDeviceTool() call costs next to it.
+ * Host numbers; the ESP32-S3 at 240 MHz is roughly 10-20x slower.
+ */
+
+#include "assistant/device_tools.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Registration is not timed; these only satisfy the linker
+bool LLMClient::addTool(const char*, const char*, const char*, uint8_t) { return true; }
+MCPServer::MCPServer() {}
+MCPServer::~MCPServer() {}
+void MCPServer::addTool(const char*, const char*, const char*) {}
+bool MCPServer::addResource(const char*, const char*, const char*, MCPResourceReader) { return true; }
+void MCPServer::notifyResourceUpdated(const char*) {}
+MCPServer mcpServer;
+
+/** The lookup before the table: one strcmp per tool until a match */
+static const DeviceToolDescriptor* findByStrcmp(const char* name) {
+    for (size_t i = 0; i < getDeviceToolCount(); i++) {
+        if (strcmp(getDeviceTool(i).name, name) == 0) return &getDeviceTool(i);
+    }
+    return nullptr;
+}
+
+/** Keeps the lookups from being optimized away */
+static volatile size_t found;
+
+template <typename Lookup>
+static double nsPerLookup(const std::vector<std::string>& names, Lookup lookup, int rounds) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        for (const std::string& name : names) {
+            found = found + (lookup(name.c_str()) != nullptr);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / rounds / names.size();
+}
+
+int main() {
+    // Copies, so neither lookup can win on pointer equality
+    std::vector<std::string> names;
+    for (size_t i = 0; i < getDeviceToolCount(); i++) names.push_back(getDeviceTool(i).name);
+    std::vector<std::string> miss = { "set_volumes" };
+    std::vector<std::string> last = { names.back() };
+
+    const int rounds = 1000000;
+    printf("%-22s %10s %10s\n", "", "hash", "strcmp");
+    printf("%-22s %8.1f ns %8.1f ns\n", "each tool (average)",
+           nsPerLookup(names, findDeviceTool, rounds), nsPerLookup(names, findByStrcmp, rounds));
+    printf("%-22s %8.1f ns %8.1f ns\n", ("last (" + names.back() + ")").c_str(),
+           nsPerLookup(last, findDeviceTool, rounds * 4), nsPerLookup(last, findByStrcmp, rounds * 4));
+    printf("%-22s %8.1f ns %8.1f ns\n", "not a tool",
+           nsPerLookup(miss, findDeviceTool, rounds * 4), nsPerLookup(miss, findByStrcmp, rounds * 4));
+
+    // Parse, bind, handler and result serialization together
+    int volume = -1;
+    deviceToolCallbacks.onSetVolume = [&volume](int v) { volume = v; };
+    const int calls = 200000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) executeDeviceTool("set_volume", "{\"volume\":40}");
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    printf("executeDeviceTool(set_volume): %.0f ns\n",
+           std::chrono::duration<double, std::nano>(elapsed).count() / calls);
+    return volume == 40 ? 0 : 1;
+}
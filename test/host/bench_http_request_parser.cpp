@@ -0,0 +1,55 @@
+/**
+ * @file bench_http_request_parser.cpp
+ * @brief Time HttpRequestParser on a typical MCP request
+ *
+ * Prints the cost per request and per byte, fed whole and in 256-byte
+ * reads (MCP_READ_CHUNK_SIZE). Host numbers; the ESP32-S3 at 240 MHz is
+ * roughly 10-20x slower.
+ */
+
+#include "network/http_request_parser.h"
+#include <chrono>
+
+static double nsPerRequest(HttpRequestParser& parser, const std::string& request, size_t piece, int rounds) {
+    size_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        parser.reset();
+        for (size_t offset = 0; offset < request.size() && parser.getState() != HttpParserState::Complete;) {
+            size_t n = std::min(piece, request.size() - offset);
+            size_t used = parser.feed((const uint8_t*)request.data() + offset, n);
+            offset += used;
+            sum += used;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (sum == 0) printf("nothing parsed\n");
+    return std::chrono::duration<double, std::nano>(elapsed).count() / rounds;
+}
+
+int main() {
+    std::string body = "{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"tools/call\","
+                       "\"params\":{\"name\":\"set_timer\",\"arguments\":{\"duration_seconds\":300}}}";
+    std::string request =
+        "POST /mcp HTTP/1.1\r\nHost: 192.168.1.42:3001\r\nUser-Agent: node\r\n"
+        "Accept: application/json, text/event-stream\r\nContent-Type: application/json\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: keep-alive\r\n\r\n" + body;
+
+    HttpRequestParser parser;
+    bool accept = false;
+    std::string collected;
+    parser.onHeader([&accept](const char* name, size_t nameLength, const char*, size_t) {
+        if (HttpRequestParser::equalsIgnoreCase(name, nameLength, "accept")) accept = true;
+    });
+    parser.onBody([&collected](const uint8_t* data, size_t length) {
+        collected.assign((const char*)data, length);
+    });
+
+    const int rounds = 1000000;
+    for (size_t piece : {request.size(), (size_t)256, (size_t)16}) {
+        double ns = nsPerRequest(parser, request, piece, rounds);
+        printf("%zu-byte request in %zu-byte reads: %.0f ns (%.2f ns/byte)\n",
+               request.size(), piece, ns, ns / request.size());
+    }
+    return accept ? 0 : 1;
+}
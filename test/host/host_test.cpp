@@ -0,0 +1,39 @@
+/**
+ * @file host_test.cpp
+ * @brief Runs every registered TEST and reports failed checks
+ */
+
+#include "host_test.h"
+
+static HostTest* firstTest = nullptr;
+static HostTest** lastTest = &firstTest;
+static int failures = 0;
+
+HostTest::HostTest(const char* testName, void (*testRun)())
+    : name(testName), run(testRun), next(nullptr)
+{
+    *lastTest = this;
+    lastTest = &next;
+}
+
+void hostTestFail(const char* file, int line, const std::string& message) {
+    printf("  %s:%d: %s\n", file, line, message.c_str());
+    failures++;
+}
+
+int main(int argc, char** argv) {
+    int tests = 0;
+    int failedTests = 0;
+    for (HostTest* test = firstTest; test; test = test->next) {
+        if (argc > 1 && strcmp(argv[1], test->name) != 0) continue;
+        int before = failures;
+        test->run();
+        tests++;
+        if (failures != before) {
+            printf("FAIL %s\n", test->name);
+            failedTests++;
+        }
+    }
+    printf("%s: %d tests, %d failed\n", argv[0], tests, failedTests);
+    return failedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file host_test.h
+ * @brief Minimal test runner for the host tests
+ *
+ * TEST(name) { ... } registers a test; CHECK* record a failure and carry
+ * on, so one run reports every broken expectation. host_test.cpp holds
+ * main(), which runs all tests and exits non-zero if any check failed.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+struct HostTest {
+    const char* name;
+    void (*run)();
+    HostTest* next;
+
+    HostTest(const char* testName, void (*testRun)());
+};
+
+/** Record a failed check (used by the CHECK macros) */
+void hostTestFail(const char* file, int line, const std::string& message);
+
+#define TEST(name) \
+    static void name(); \
+    static HostTest name##Registration(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) hostTestFail(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto actualValue = (actual); \
+        auto expectedValue = (expected); \
+        if (!(actualValue == expectedValue)) { \
+            hostTestFail(__FILE__, __LINE__, std::string(#actual " == " #expected " (got ") + \
+                         hostTestFormat(actualValue) + ", expected " + \
+                         hostTestFormat(expectedValue) + ")"); \
+        } \
+    } while (0)
+
+#define CHECK_STR(actual, expected) \
+    do { \
+        std::string actualValue = (actual); \
+        std::string expectedValue = (expected); \
+        if (actualValue != expectedValue) { \
+            hostTestFail(__FILE__, __LINE__, std::string(#actual " (got \"") + actualValue + \
+                         "\", expected \"" + expectedValue + "\")"); \
+        } \
+    } while (0)
+
+inline std::string hostTestFormat(const std::string& value) { return "\"" + value + "\""; }
+inline std::string hostTestFormat(const char* value) { return value ? hostTestFormat(std::string(value)) : "null"; }
+inline std::string hostTestFormat(bool value) { return value ? "true" : "false"; }
+template <typename T>
+std::string hostTestFormat(const T& value) { return std::to_string(value); }
+
+#endif // HOST_TEST_H
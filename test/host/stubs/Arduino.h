@@ -0,0 +1,260 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the parts of the Arduino core the tested
+ *        modules use
+ *
+ * String is backed by std::string; millis()/micros() read a virtual
+ * clock that only moves when delay() or hostAdvanceMs() moves it, so
+ * timing tests are exact. Serial output is dropped unless HOST_SERIAL
+ * is set in the environment.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <string>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+
+#define PROGMEM
+#define IRAM_ATTR
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+//=============================================================================
+// Virtual Clock
+//=============================================================================
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+/** Move the virtual clock forward */
+void hostAdvanceMs(uint32_t ms);
+
+/** Wall clock set by hostSetLocalTime(); false until then, like before SNTP */
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+
+/** Set the wall clock, or nullptr to make it unsynced again */
+void hostSetLocalTime(const struct tm* time);
+
+//=============================================================================
+// String
+//=============================================================================
+
+class String {
+public:
+    String() {}
+    String(const char* text) { if (text) s = text; }
+    String(const char* text, unsigned int length) { if (text) s.assign(text, length); }
+    String(const String&) = default;
+    String(String&&) = default;
+    explicit String(char c) : s(1, c) {}
+    explicit String(int value) : s(std::to_string(value)) {}
+    explicit String(unsigned int value) : s(std::to_string(value)) {}
+    explicit String(long value) : s(std::to_string(value)) {}
+    explicit String(unsigned long value) : s(std::to_string(value)) {}
+    explicit String(float value, unsigned int decimals = 2) { setFloat(value, decimals); }
+    explicit String(double value, unsigned int decimals = 2) { setFloat(value, decimals); }
+
+    String& operator=(const String&) = default;
+    String& operator=(String&&) = default;
+    String& operator=(const char* text) { s = text ? text : ""; return *this; }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    bool reserve(unsigned int size) { s.reserve(size); return true; }
+
+    bool concat(const String& other) { s += other.s; return true; }
+    bool concat(const char* text) { if (text) s += text; return true; }
+    bool concat(const char* text, unsigned int length) { if (text) s.append(text, length); return true; }
+    bool concat(char c) { s += c; return true; }
+    bool concat(int value) { s += std::to_string(value); return true; }
+    bool concat(unsigned int value) { s += std::to_string(value); return true; }
+    bool concat(long value) { s += std::to_string(value); return true; }
+    bool concat(unsigned long value) { s += std::to_string(value); return true; }
+    bool concat(float value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String& operator+=(const T& value) { concat(value); return *this; }
+
+    bool operator==(const String& other) const { return s == other.s; }
+    bool operator==(const char* text) const { return s == (text ? text : ""); }
+    bool operator!=(const String& other) const { return s != other.s; }
+    bool operator!=(const char* text) const { return !(*this == text); }
+    bool operator<(const String& other) const { return s < other.s; }
+    bool equals(const String& other) const { return s == other.s; }
+    bool equalsIgnoreCase(const String& other) const {
+        return s.size() == other.s.size() &&
+               std::equal(s.begin(), s.end(), other.s.begin(), [](char a, char b) {
+                   return tolower((unsigned char)a) == tolower((unsigned char)b);
+               });
+    }
+
+    char operator[](unsigned int i) const { return i < s.size() ? s[i] : '\0'; }
+    char& operator[](unsigned int i) { return s[i]; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+    void setCharAt(unsigned int i, char c) { if (i < s.size()) s[i] = c; }
+
+    bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String& suffix) const {
+        return s.size() >= suffix.s.size() &&
+               s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const { return found(s.find(c, from)); }
+    int indexOf(const String& text, unsigned int from = 0) const { return found(s.find(text.s, from)); }
+    int lastIndexOf(char c) const { return found(s.rfind(c)); }
+    int lastIndexOf(const String& text) const { return found(s.rfind(text.s)); }
+
+    String substring(unsigned int from) const {
+        return from < s.size() ? String(s.c_str() + from) : String();
+    }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= s.size()) return String();
+        return String(s.c_str() + from, std::min<size_t>(to, s.size()) - from);
+    }
+
+    void remove(unsigned int index) { if (index < s.size()) s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < s.size()) s.erase(index, count); }
+    void replace(const String& find, const String& replacement) {
+        if (find.s.empty()) return;
+        for (size_t pos = 0; (pos = s.find(find.s, pos)) != std::string::npos; pos += replacement.s.size()) {
+            s.replace(pos, find.s.size(), replacement.s);
+        }
+    }
+    void trim() {
+        size_t first = 0;
+        while (first < s.size() && isspace((unsigned char)s[first])) first++;
+        size_t last = s.size();
+        while (last > first && isspace((unsigned char)s[last - 1])) last--;
+        s = s.substr(first, last - first);
+    }
+    void toLowerCase() { for (char& c : s) c = tolower((unsigned char)c); }
+    void toUpperCase() { for (char& c : s) c = toupper((unsigned char)c); }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+
+    const char* begin() const { return s.c_str(); }
+    const char* end() const { return s.c_str() + s.size(); }
+
+private:
+    static int found(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+    void setFloat(double value, unsigned int decimals) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+        s = buf;
+    }
+
+    std::string s;
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+
+//=============================================================================
+// Print / Stream
+//=============================================================================
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t length) {
+        size_t n = 0;
+        while (n < length && write(data[n])) n++;
+        return n;
+    }
+    size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+    size_t write(const char* data, size_t length) { return write((const uint8_t*)data, length); }
+    virtual void flush() {}
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write((const uint8_t*)text.c_str(), text.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value) { return print(String(value)); }
+    size_t print(unsigned int value) { return print(String(value)); }
+    size_t print(long value) { return print(String(value)); }
+    size_t print(unsigned long value) { return print(String(value)); }
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+
+    template <typename T>
+    size_t println(const T& value) { return print(value) + print("\r\n"); }
+    size_t println() { return print("\r\n"); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buf[512];
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (n < 0) return 0;
+        return write((const uint8_t*)buf, std::min<size_t>(n, sizeof(buf) - 1));
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    /** Host streams never block: whatever is available, up to length */
+    virtual size_t readBytes(char* buffer, size_t length) {
+        size_t n = 0;
+        int c;
+        while (n < length && (c = read()) >= 0) buffer[n++] = (char)c;
+        return n;
+    }
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    void setTimeout(unsigned long) {}
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+//=============================================================================
+// ESP32 Heap
+//=============================================================================
+
+#include "esp_heap_caps.h"
+
+/** Heap figures only feed log lines on the host */
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 0; }
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,43 @@
+/**
+ * @file HTTPClient.h
+ * @brief Declaration-only HTTPClient so headers that hold one compile
+ *
+ * Linking a call to any of these is an error that says the test pulled
+ * in more firmware than it meant to, unless the test defines them itself
+ * to script the server (test_llm_tool_calls.cpp, test_mcp_client.cpp).
+ */
+
+#ifndef HOST_HTTP_CLIENT_H
+#define HOST_HTTP_CLIENT_H
+
+#include "NetworkClient.h"
+
+#define HTTP_CODE_OK 200
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+class HTTPClient {
+public:
+    bool begin(NetworkClient& client, const String& url);
+    bool begin(const String& url);
+    void end();
+    void setTimeout(uint16_t timeout);
+    void setConnectTimeout(int32_t timeout);
+    void setReuse(bool reuse);
+    void useHTTP10(bool http10 = true);
+    void addHeader(const String& name, const String& value);
+    void collectHeaders(const char* headerKeys[], size_t count);
+    String header(const char* name);
+    bool hasHeader(const char* name);
+    int GET();
+    int POST(const String& payload);
+    int POST(uint8_t* payload, size_t size);
+    int sendRequest(const char* type, const String& payload);
+    int sendRequest(const char* type, Stream* stream, size_t size);
+    int getSize();
+    String getString();
+    NetworkClient* getStreamPtr();
+    NetworkClient& getStream();
+    bool connected();
+};
+
+#endif // HOST_HTTP_CLIENT_H
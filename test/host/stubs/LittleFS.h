@@ -0,0 +1,110 @@
+/**
+ * @file LittleFS.h
+ * @brief Host stand-in for LittleFS backed by a directory on disk
+ *
+ * Paths map into LittleFS.root (build/littlefs), so a test can cut or
+ * corrupt the image with ordinary file calls between "boots". Setting
+ * writeBudget makes writes fail once that many more bytes have gone out,
+ * the way a power cut or a full partition leaves a partial write.
+ */
+
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include <Arduino.h>
+#include <filesystem>
+#include <memory>
+
+class File : public Stream {
+public:
+    File() {}
+    explicit File(FILE* f) : handle(f, fclose) {}
+
+    explicit operator bool() const { return handle != nullptr; }
+    void close() { handle.reset(); }
+
+    size_t size() {
+        if (!handle) return 0;
+        long pos = ftell(handle.get());
+        fseek(handle.get(), 0, SEEK_END);
+        long end = ftell(handle.get());
+        fseek(handle.get(), pos, SEEK_SET);
+        return end;
+    }
+    size_t position() { return handle ? ftell(handle.get()) : 0; }
+    bool seek(uint32_t pos) { return handle && fseek(handle.get(), pos, SEEK_SET) == 0; }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t length) override;
+    using Print::write;
+
+    size_t read(uint8_t* buffer, size_t length) {
+        return handle ? fread(buffer, 1, length, handle.get()) : 0;
+    }
+    int read() override {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int peek() override {
+        int c = handle ? fgetc(handle.get()) : EOF;
+        if (c != EOF) ungetc(c, handle.get());
+        return c;
+    }
+    int available() override { return handle ? (int)(size() - position()) : 0; }
+
+private:
+    std::shared_ptr<FILE> handle;
+};
+
+class FSClass {
+public:
+    /** Host directory holding the image */
+    std::string root = "build/littlefs";
+
+    /** Bytes that may still be written before writes fail (-1 = no limit) */
+    long writeBudget = -1;
+
+    /** Bytes written since the last format() */
+    size_t bytesWritten = 0;
+
+    bool begin(bool formatOnFail = false) {
+        std::error_code ec;
+        std::filesystem::create_directories(root, ec);
+        return !ec;
+    }
+    bool format() {
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+        bytesWritten = 0;
+        writeBudget = -1;
+        return begin();
+    }
+
+    /** Host path of a LittleFS path */
+    std::string hostPath(const char* path) const { return root + path; }
+
+    File open(const char* path, const char* mode = "r") {
+        std::string binary = std::string(mode) + "b";
+        return File(fopen(hostPath(path).c_str(), binary.c_str()));
+    }
+    bool exists(const char* path) { return std::filesystem::exists(hostPath(path)); }
+    bool remove(const char* path) { return ::remove(hostPath(path).c_str()) == 0; }
+    bool rename(const char* from, const char* to) {
+        return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+    }
+};
+
+extern FSClass LittleFS;
+
+inline size_t File::write(const uint8_t* data, size_t length) {
+    if (!handle) return 0;
+    if (LittleFS.writeBudget >= 0) {
+        length = std::min(length, (size_t)LittleFS.writeBudget);
+        LittleFS.writeBudget -= length;
+    }
+    size_t n = fwrite(data, 1, length, handle.get());
+    LittleFS.bytesWritten += n;
+    return n;
+}
+
+#endif // HOST_LITTLEFS_H
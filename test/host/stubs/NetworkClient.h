@@ -0,0 +1,82 @@
+/**
+ * @file NetworkClient.h
+ * @brief Host stand-in for a TCP client whose received bytes are scripted
+ *
+ * receive() queues one segment; available() and read() never look past
+ * the current segment, so each segment is what one socket read would
+ * return. A test can split a recorded response anywhere it likes.
+ */
+
+#ifndef HOST_NETWORK_CLIENT_H
+#define HOST_NETWORK_CLIENT_H
+
+#include <Arduino.h>
+#include <deque>
+#include <string>
+
+class NetworkClient : public Stream {
+public:
+    virtual ~NetworkClient() {}
+
+    /** Queue bytes to arrive as one read */
+    void receive(const std::string& segment) { if (!segment.empty()) segments.push_back(segment); }
+
+    /** Close the connection once the queued bytes have been read */
+    void closeAfterReceive() { open = false; }
+
+    /** Everything written to the client */
+    const std::string& sent() const { return sentBytes; }
+
+    /** Host that refuses connections, and how long a connect takes (ms) */
+    static inline const char* refusedHost = nullptr;
+    static inline uint32_t connectMs = 0;
+
+    virtual int connect(const char* host, uint16_t port) {
+        delay(connectMs);
+        if (refusedHost && strcmp(host, refusedHost) == 0) return 0;
+        open = true;
+        return 1;
+    }
+    virtual void stop() { open = false; segments.clear(); }
+    virtual uint8_t connected() { return open || !segments.empty(); }
+    operator bool() { return connected(); }
+
+    int available() override { return segments.empty() ? 0 : (int)(segments.front().size() - offset); }
+
+    int read() override {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    int read(uint8_t* buffer, size_t length) {
+        if (segments.empty()) return -1;
+        const std::string& front = segments.front();
+        size_t n = std::min(length, front.size() - offset);
+        memcpy(buffer, front.data() + offset, n);
+        offset += n;
+        if (offset == front.size()) {
+            segments.pop_front();
+            offset = 0;
+        }
+        return (int)n;
+    }
+
+    int peek() override { return segments.empty() ? -1 : (uint8_t)segments.front()[offset]; }
+
+    size_t write(uint8_t c) override { sentBytes += (char)c; return 1; }
+    size_t write(const uint8_t* data, size_t length) override {
+        sentBytes.append((const char*)data, length);
+        return length;
+    }
+    using Print::write;
+
+protected:
+    bool open = true;
+
+private:
+    std::deque<std::string> segments;
+    size_t offset = 0;
+    std::string sentBytes;
+};
+
+#endif // HOST_NETWORK_CLIENT_H
@@ -0,0 +1,21 @@
+/**
+ * @file NetworkClientSecure.h
+ * @brief Host stand-in for the TLS client (no TLS, scripted like NetworkClient)
+ */
+
+#ifndef HOST_NETWORK_CLIENT_SECURE_H
+#define HOST_NETWORK_CLIENT_SECURE_H
+
+#include "NetworkClient.h"
+
+class NetworkClientSecure : public NetworkClient {
+public:
+    /** Unlike a scripted NetworkClient, closed until connect() */
+    NetworkClientSecure() { open = false; }
+
+    void setInsecure() {}
+    void setCACert(const char*) {}
+    void setHandshakeTimeout(unsigned long) {}
+};
+
+#endif // HOST_NETWORK_CLIENT_SECURE_H
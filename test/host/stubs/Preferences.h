@@ -0,0 +1,74 @@
+/**
+ * @file Preferences.h
+ * @brief Host stand-in for NVS Preferences, kept in memory
+ *
+ * Values live for the whole test process, so a test can "reboot" by
+ * making a new object that loads its settings again. clear() empties the
+ * open namespace.
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false) {
+        ns = std::string(name) + "/";
+        this->readOnly = readOnly;
+        return true;
+    }
+    void end() {}
+
+    bool clear() {
+        if (readOnly) return false;
+        auto& values = storage();
+        for (auto it = values.lower_bound(ns); it != values.end() && it->first.compare(0, ns.size(), ns) == 0; ) {
+            it = values.erase(it);
+        }
+        return true;
+    }
+    bool remove(const char* key) { return !readOnly && storage().erase(ns + key) > 0; }
+    bool isKey(const char* key) { return storage().count(ns + key) > 0; }
+
+    size_t putString(const char* key, const String& value) { return put(key, value.c_str()); }
+    size_t putInt(const char* key, int32_t value) { return put(key, std::to_string(value)) ? 4 : 0; }
+    size_t putBool(const char* key, bool value) { return put(key, value ? "1" : "0") ? 1 : 0; }
+
+    String getString(const char* key, const String& defaultValue = String()) {
+        const std::string* value = get(key);
+        return value ? String(value->c_str()) : defaultValue;
+    }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) {
+        const std::string* value = get(key);
+        return value ? (int32_t)strtol(value->c_str(), nullptr, 10) : defaultValue;
+    }
+    bool getBool(const char* key, bool defaultValue = false) {
+        const std::string* value = get(key);
+        return value ? *value == "1" : defaultValue;
+    }
+
+private:
+    static std::map<std::string, std::string>& storage() {
+        static std::map<std::string, std::string> values;
+        return values;
+    }
+
+    size_t put(const char* key, const std::string& value) {
+        if (readOnly) return 0;
+        storage()[ns + key] = value;
+        return value.size();
+    }
+    const std::string* get(const char* key) {
+        auto it = storage().find(ns + key);
+        return it == storage().end() ? nullptr : &it->second;
+    }
+
+    std::string ns;
+    bool readOnly = false;
+};
+
+#endif // HOST_PREFERENCES_H
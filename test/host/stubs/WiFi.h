@@ -0,0 +1,20 @@
+/**
+ * @file WiFi.h
+ * @brief Host stand-in for the WiFi object (always connected)
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "NetworkClient.h"
+
+using WiFiClient = NetworkClient;
+
+class WiFiClass {
+public:
+    bool isConnected() { return true; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
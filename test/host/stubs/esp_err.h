@@ -0,0 +1,24 @@
+/**
+ * @file esp_err.h
+ * @brief Host stand-in for ESP-IDF error codes
+ */
+
+#ifndef HOST_ESP_ERR_H
+#define HOST_ESP_ERR_H
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_HTTPD_RESP_SEND (0xb000 + 6)
+
+inline const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_HTTPD_RESP_SEND: return "ESP_ERR_HTTPD_RESP_SEND";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+#endif // HOST_ESP_ERR_H
@@ -0,0 +1,58 @@
+/**
+ * @file esp_http_server.h
+ * @brief Host stand-in for an esp_http_server response that records
+ *        what a handler sends
+ *
+ * Each httpd_req_t keeps the bytes sent, one entry per send call, and
+ * whether the response was ended (httpd_resp_send() or the empty
+ * terminating chunk). failChunk makes one httpd_resp_send_chunk() call
+ * fail the way it does when the client has gone away.
+ */
+
+#ifndef HOST_ESP_HTTP_SERVER_H
+#define HOST_ESP_HTTP_SERVER_H
+
+#include <cstring>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include "esp_err.h"
+
+#define HTTPD_RESP_USE_STRLEN -1
+
+struct httpd_req_t {
+    std::string contentType;
+    std::string body;               ///< Every byte sent, in order
+    int sends = 0;                  ///< httpd_resp_send() calls
+    std::vector<size_t> chunks;     ///< Length of each httpd_resp_send_chunk() call, 0 ends
+    bool ended = false;
+    int failChunk = -1;             ///< Index of the chunk call that fails
+};
+
+inline esp_err_t httpd_resp_set_type(httpd_req_t* req, const char* type) {
+    req->contentType = type;
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_resp_send(httpd_req_t* req, const char* buf, ssize_t length) {
+    if (length == HTTPD_RESP_USE_STRLEN) length = buf ? strlen(buf) : 0;
+    req->sends++;
+    req->body.append(buf, length);
+    req->ended = true;
+    return ESP_OK;
+}
+
+inline esp_err_t httpd_resp_send_chunk(httpd_req_t* req, const char* chunk, ssize_t length) {
+    if (length == HTTPD_RESP_USE_STRLEN) length = chunk ? strlen(chunk) : 0;
+    int call = (int)req->chunks.size();
+    req->chunks.push_back(length);
+    if (call == req->failChunk) return ESP_ERR_HTTPD_RESP_SEND;
+    if (length == 0) {
+        req->ended = true;
+    } else {
+        req->body.append(chunk, length);
+    }
+    return ESP_OK;
+}
+
+#endif // HOST_ESP_HTTP_SERVER_H
@@ -0,0 +1,30 @@
+/**
+ * @file semphr.h
+ * @brief Host stand-in for FreeRTOS semaphores (counters, never block)
+ *
+ * A give from a task is stamped with the task's virtual time; taking a
+ * counting or binary semaphore moves the taker's clock up to it, as the
+ * take would have waited until then.
+ */
+
+#ifndef HOST_SEMPHR_H
+#define HOST_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+struct HostSemaphore {
+    UBaseType_t count;
+    UBaseType_t max;
+    bool mutex;
+    uint64_t givenUs;     ///< Latest give from a task (virtual us)
+};
+typedef HostSemaphore* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif // HOST_SEMPHR_H
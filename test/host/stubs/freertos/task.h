@@ -0,0 +1,28 @@
+/**
+ * @file task.h
+ * @brief Host stand-in for FreeRTOS task calls (virtual clock)
+ *
+ * A created task does not start at once: it runs to completion when the
+ * creating code blocks, on a semaphore or in delay(), from the virtual
+ * time it was created at, as if on a core of its own. A creator that
+ * blocked on a semaphore then reads the latest of the tasks' finishing
+ * times and its own; one that was in delay() gets there when it takes
+ * what the tasks gave (see semphr.h). Fork-join code sees parallel calls
+ * take the longest one's time, and a work queue shared with the creator
+ * is drained by the tasks while the creator waits on its first item.
+ */
+
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+TickType_t xTaskGetTickCount();
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+
+#endif // HOST_TASK_H
@@ -0,0 +1,162 @@
+/**
+ * @file host_stubs.cpp
+ * @brief Virtual clock, Serial, WiFi, LittleFS and FreeRTOS stand-ins for
+ *        host tests
+ */
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <algorithm>
+#include <deque>
+#include <list>
+
+//=============================================================================
+// Virtual Clock
+//=============================================================================
+
+static uint64_t hostClockUs = 0;
+
+static bool runPendingTasks();
+static bool hostInTask = false;
+
+unsigned long millis() { return (unsigned long)(hostClockUs / 1000); }
+unsigned long micros() { return (unsigned long)hostClockUs; }
+
+void delay(unsigned long ms) {
+    // Created tasks get the CPU while their creator waits (see task.h)
+    uint64_t nowUs = hostClockUs;
+    if (!hostInTask && runPendingTasks()) hostClockUs = nowUs;
+    hostClockUs += (uint64_t)ms * 1000;
+}
+void yield() {}
+void hostAdvanceMs(uint32_t ms) { hostClockUs += (uint64_t)ms * 1000; }
+
+static bool hostTimeSet = false;
+static struct tm hostTime;
+
+bool getLocalTime(struct tm* info, uint32_t ms) {
+    if (hostTimeSet) *info = hostTime;
+    return hostTimeSet;
+}
+
+void hostSetLocalTime(const struct tm* time) {
+    hostTimeSet = time != nullptr;
+    if (time) hostTime = *time;
+}
+
+//=============================================================================
+// Serial
+//=============================================================================
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static bool serialEnabled() {
+    static const bool enabled = getenv("HOST_SERIAL") != nullptr;
+    return enabled;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (serialEnabled()) fputc(c, stderr);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t length) {
+    if (serialEnabled()) fwrite(data, 1, length, stderr);
+    return length;
+}
+
+//=============================================================================
+// WiFi
+//=============================================================================
+
+WiFiClass WiFi;
+
+//=============================================================================
+// LittleFS
+//=============================================================================
+
+FSClass LittleFS;
+
+//=============================================================================
+// FreeRTOS
+//=============================================================================
+
+static int hostTask;
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return &hostTask; }
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+
+struct HostPendingTask {
+    TaskFunction_t run;
+    void* param;
+    uint64_t startUs;
+};
+static std::deque<HostPendingTask> hostPendingTasks;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    hostPendingTasks.push_back(HostPendingTask{task, param, hostClockUs});
+    if (handle) *handle = &hostTask;
+    return pdPASS;
+}
+
+// The task function returns after this; nothing is left to clean up
+void vTaskDelete(TaskHandle_t task) {}
+
+/** Run the created tasks side by side in virtual time (see task.h) */
+static bool runPendingTasks() {
+    if (hostPendingTasks.empty()) return false;
+
+    uint64_t endUs = hostClockUs;
+    bool nested = hostInTask;
+    hostInTask = true;
+    while (!hostPendingTasks.empty()) {
+        HostPendingTask task = hostPendingTasks.front();
+        hostPendingTasks.pop_front();
+        hostClockUs = task.startUs;
+        task.run(task.param);
+        endUs = std::max(endUs, hostClockUs);
+    }
+    hostInTask = nested;
+    hostClockUs = endUs;
+    return true;
+}
+
+// Firmware objects create semaphores and never delete them; keeping them
+// here stops LeakSanitizer from reporting every object a test made
+static std::list<HostSemaphore> hostSemaphores;
+
+static SemaphoreHandle_t createSemaphore(UBaseType_t count, UBaseType_t max, bool mutex) {
+    hostSemaphores.push_back(HostSemaphore{count, max, mutex, 0});
+    return &hostSemaphores.back();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return createSemaphore(1, 1, true); }
+SemaphoreHandle_t xSemaphoreCreateBinary() { return createSemaphore(0, 1, false); }
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    return createSemaphore(initial, max, false);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait) {
+    if (semaphore->count == 0 && wait > 0) runPendingTasks();
+    if (semaphore->count == 0) return pdFALSE;
+    semaphore->count--;
+    // Mutexes are held briefly; a signal from a task can't arrive early
+    if (!semaphore->mutex) hostClockUs = std::max(hostClockUs, semaphore->givenUs);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore->count >= semaphore->max) return pdFALSE;
+    semaphore->count++;
+    if (hostInTask) semaphore->givenUs = std::max(semaphore->givenUs, hostClockUs);
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    hostSemaphores.remove_if([semaphore](const HostSemaphore& s) { return &s == semaphore; });
+}
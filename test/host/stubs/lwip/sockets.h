@@ -0,0 +1,17 @@
+/**
+ * @file sockets.h
+ * @brief lwIP sockets on the host are the BSD ones
+ */
+
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#endif // HOST_LWIP_SOCKETS_H
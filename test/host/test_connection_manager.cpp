@@ -0,0 +1,165 @@
+/**
+ * @file test_connection_manager.cpp
+ * @brief ConnectionManager: keep-alive reuse, the TLS memory cap and
+ *        eviction, counted in handshakes
+ *
+ * The NetworkClientSecure stub "handshakes" on connect() (taking
+ * NetworkClient::connectMs of virtual time), so stats.handshakes is the
+ * number of TLS handshakes the device would pay. Pools are function
+ * statics: pooled clients live as long as the firmware's global pool.
+ */
+
+#include "host_test.h"
+#include "network/connection_manager.h"
+
+//=============================================================================
+// Keep-Alive Reuse
+//=============================================================================
+
+TEST(sameHostReusesOneHandshake) {
+    static ConnectionManager pool;
+    NetworkClient::connectMs = 300;
+
+    // STT -> GPT -> TTS in one turn, all on api.openai.com
+    for (int i = 0; i < 3; i++) {
+        NetworkClientSecure* client = pool.acquire("api.openai.com");
+        CHECK(client != nullptr);
+        pool.release(client, true);
+    }
+    CHECK_EQ(pool.getStats().handshakes, 1u);
+    CHECK_EQ(pool.getStats().reuses, 2u);
+    CHECK_EQ(pool.getStats().handshakeTotalMs, 300u);
+    CHECK_EQ(pool.getOpenCount(), 1);
+    NetworkClient::connectMs = 0;
+}
+
+TEST(portsAndUrlsAreSeparateHosts) {
+    static ConnectionManager pool;
+    NetworkClientSecure* a = pool.acquireForUrl("https://mcp.example.com:8443/mcp");
+    CHECK(a != nullptr);
+    pool.release(a);
+    NetworkClientSecure* b = pool.acquireForUrl("https://mcp.example.com/mcp");
+    CHECK(b != nullptr && b != a);
+    pool.release(b);
+    CHECK(pool.acquireForUrl("https://mcp.example.com:8443/other") == a);
+    CHECK(pool.acquireForUrl("http://mcp.example.com/mcp") == nullptr);
+    CHECK_EQ(pool.getStats().handshakes, 2u);
+}
+
+TEST(leftoverBytesAreDiscardedOnReuse) {
+    static ConnectionManager pool;
+    NetworkClientSecure* client = pool.acquire("api.anthropic.com");
+    client->receive("stale response tail");
+    pool.release(client, true);
+    CHECK(pool.acquire("api.anthropic.com") == client);
+    CHECK_EQ(client->available(), 0);
+}
+
+TEST(unreadResponseClosesTheSocket) {
+    static ConnectionManager pool;
+    NetworkClientSecure* client = pool.acquire("api.openai.com");
+    pool.release(client, false);
+    CHECK_EQ(pool.getOpenCount(), 0);
+    pool.release(pool.acquire("api.openai.com"));
+    CHECK_EQ(pool.getStats().handshakes, 2u);
+    CHECK_EQ(pool.getStats().reuses, 0u);
+}
+
+TEST(serverClosedSocketIsReconnected) {
+    static ConnectionManager pool;
+    NetworkClientSecure* client = pool.acquire("api.openai.com");
+    client->closeAfterReceive();    // Server closed it while idle
+    pool.release(client, true);
+    CHECK(pool.acquire("api.openai.com") == client);
+    CHECK(client->connected());
+    CHECK_EQ(pool.getStats().handshakes, 2u);
+}
+
+//=============================================================================
+// Memory Cap
+//=============================================================================
+
+TEST(poolNeverExceedsTheMemoryCap) {
+    static ConnectionManager pool;
+    static const char* const HOSTS[] = {
+        "api.openai.com", "api.anthropic.com", "api.elevenlabs.io", "mcp.example.com",
+    };
+    CHECK(CONN_MAX_CONNECTIONS * CONN_TLS_CONTEXT_BYTES <= CONN_TLS_MEMORY_CAP);
+    CHECK(CONN_MAX_CONNECTIONS < 4);
+
+    // Round-robin over more hosts than fit: each lease past the cap evicts
+    for (int round = 0; round < 3; round++) {
+        for (const char* host : HOSTS) {
+            NetworkClientSecure* client = pool.acquire(host);
+            CHECK(client != nullptr);
+            CHECK(pool.getOpenCount() <= CONN_MAX_CONNECTIONS);
+            hostAdvanceMs(10);
+            pool.release(client);
+        }
+    }
+    CHECK_EQ(pool.getOpenCount(), CONN_MAX_CONNECTIONS);
+    CHECK_EQ(pool.getStats().evictions, 12u - CONN_MAX_CONNECTIONS);
+    CHECK_EQ(pool.getStats().handshakes, 12u);
+}
+
+TEST(leastRecentlyUsedIdleConnectionIsEvicted) {
+    static ConnectionManager pool;
+    NetworkClientSecure* hosts[CONN_MAX_CONNECTIONS];
+    for (int i = 0; i < CONN_MAX_CONNECTIONS; i++) {
+        hosts[i] = pool.acquire(("host" + std::to_string(i) + ".example.com").c_str());
+        hostAdvanceMs(10);
+    }
+    for (int i = CONN_MAX_CONNECTIONS - 1; i >= 0; i--) {
+        pool.release(hosts[i]);     // host0 released last: most recently used
+        hostAdvanceMs(10);
+    }
+
+    NetworkClientSecure* fresh = pool.acquire("new.example.com");
+    CHECK(fresh == hosts[CONN_MAX_CONNECTIONS - 1]);
+    CHECK_EQ(pool.getStats().evictions, 1u);
+    pool.release(fresh);
+
+    // host0 survived and is still reused
+    uint32_t handshakes = pool.getStats().handshakes;
+    CHECK(pool.acquire("host0.example.com") == hosts[0]);
+    CHECK_EQ(pool.getStats().handshakes, handshakes);
+}
+
+TEST(fullyLeasedPoolWaitsThenGivesUp) {
+    static ConnectionManager pool;
+    for (int i = 0; i < CONN_MAX_CONNECTIONS; i++) {
+        CHECK(pool.acquire(("busy" + std::to_string(i) + ".example.com").c_str()) != nullptr);
+    }
+    unsigned long start = millis();
+    CHECK(pool.acquire("late.example.com") == nullptr);
+    CHECK(millis() - start >= CONN_ACQUIRE_TIMEOUT_MS);
+    CHECK_EQ(pool.getOpenCount(), CONN_MAX_CONNECTIONS);
+    CHECK_EQ(pool.getStats().evictions, 0u);
+}
+
+//=============================================================================
+// Failures and Idle Timeout
+//=============================================================================
+
+TEST(failedHandshakeFreesTheSlot) {
+    static ConnectionManager pool;
+    NetworkClient::refusedHost = "down.example.com";
+    for (int i = 0; i < CONN_MAX_CONNECTIONS + 2; i++) {
+        CHECK(pool.acquire("down.example.com") == nullptr);
+    }
+    NetworkClient::refusedHost = nullptr;
+    CHECK_EQ(pool.getStats().handshakeFailures, (uint32_t)CONN_MAX_CONNECTIONS + 2);
+    CHECK_EQ(pool.getOpenCount(), 0);
+    CHECK(pool.acquire("up.example.com") != nullptr);
+}
+
+TEST(idleConnectionsCloseAfterTimeout) {
+    static ConnectionManager pool;
+    pool.release(pool.acquire("api.openai.com"));
+    hostAdvanceMs(CONN_IDLE_TIMEOUT_MS - 1000);
+    pool.update();
+    CHECK_EQ(pool.getOpenCount(), 1);
+    hostAdvanceMs(2000);
+    pool.update();
+    CHECK_EQ(pool.getOpenCount(), 0);
+}
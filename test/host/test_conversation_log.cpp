@@ -0,0 +1,298 @@
+/**
+ * @file test_conversation_log.cpp
+ * @brief ConversationLog on a file-backed LittleFS image: restore after a
+ *        reboot, torn and corrupt records, compaction at the size cap
+ *
+ * A "reboot" is a fresh ConversationHistory and ConversationLog over the
+ * same image in build/littlefs. Between boots the tests cut or corrupt
+ * the log file the way a power cut or a bad flash page would; whatever
+ * was intact before the damage must come back, and the next append must
+ * leave a clean log again.
+ */
+
+#include "host_test.h"
+#include "assistant/conversation_log.h"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+/** u16 magic | u8 role | u8 flags | u16 claudeLen | u16 openaiLen | u32 crc */
+static const size_t RECORD_HEADER = 12;
+
+static const char* const ROLE_NAMES[] = { "user", "assistant", "user" };
+
+struct Device {
+    ConversationHistory history;
+    ConversationLog log;
+
+    /** Boot over whatever the image holds */
+    Device() {
+        history.begin();
+        log.begin();
+    }
+
+    /** Add a message the way LLMClient does: history first, then the log */
+    void say(MessageRole role, const std::string& text) {
+        std::string claude = std::string("{\"role\":\"") + ROLE_NAMES[(int)role] +
+                             "\",\"content\":\"" + text + "\"}";
+        std::string openai = claude;
+        history.restore(role, false, (const uint8_t*)claude.data(), claude.size(),
+                        (const uint8_t*)openai.data(), openai.size());
+        log.appendNewest(history);
+    }
+
+    /** n user/assistant turns, numbered from first */
+    void talk(int turns, int first = 1, size_t padding = 0) {
+        for (int i = first; i < first + turns; i++) {
+            say(MessageRole::User, "question " + std::to_string(i) + std::string(padding, 'q'));
+            say(MessageRole::Assistant, "answer " + std::to_string(i) + std::string(padding, 'a'));
+        }
+    }
+
+    std::string claudeAt(size_t i) const {
+        size_t length;
+        const uint8_t* fragment = history.claudeFragment(i, length);
+        return std::string((const char*)fragment, length);
+    }
+};
+
+static std::string logPath() {
+    return LittleFS.hostPath(CONV_LOG_PATH);
+}
+
+static size_t logSize() {
+    std::error_code ec;
+    size_t size = std::filesystem::file_size(logPath(), ec);
+    return ec ? 0 : size;
+}
+
+/** Offsets of every record in the log file */
+static std::vector<size_t> recordOffsets() {
+    std::ifstream file(logPath(), std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<size_t> offsets;
+    for (size_t pos = 0; pos + RECORD_HEADER <= bytes.size();) {
+        offsets.push_back(pos);
+        uint16_t claudeLen, openaiLen;
+        memcpy(&claudeLen, &bytes[pos + 4], 2);
+        memcpy(&openaiLen, &bytes[pos + 6], 2);
+        pos += RECORD_HEADER + claudeLen + openaiLen;
+    }
+    return offsets;
+}
+
+static void flipByte(size_t offset) {
+    std::fstream file(logPath(), std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(offset);
+    char c = file.get();
+    file.seekp(offset);
+    file.put(c ^ 0x20);
+}
+
+//=============================================================================
+// Restore
+//=============================================================================
+
+TEST(conversationSurvivesAReboot) {
+    LittleFS.format();
+    {
+        Device device;
+        CHECK(device.log.isRestored());         // Nothing to restore on a fresh image
+        device.talk(3);
+        CHECK_EQ(device.log.getStats().appends, 6u);
+        CHECK_EQ(device.log.getFileSize(), logSize());
+    }
+
+    Device device;
+    CHECK_EQ(device.log.getFileSize(), logSize());
+    CHECK(!device.log.isRestored());            // begin() only looked at the size
+    CHECK_EQ(device.log.restore(device.history), 6u);
+    CHECK_EQ(device.history.size(), 6u);
+    CHECK_STR(device.claudeAt(0), "{\"role\":\"user\",\"content\":\"question 1\"}");
+    CHECK_STR(device.claudeAt(5), "{\"role\":\"assistant\",\"content\":\"answer 3\"}");
+    CHECK(device.history.at(5).role == MessageRole::Assistant);
+    CHECK_EQ(device.log.getStats().corruptRecords, 0u);
+
+    // Restoring twice would duplicate the history
+    CHECK_EQ(device.log.restore(device.history), 0u);
+    CHECK_EQ(device.history.size(), 6u);
+}
+
+TEST(clearDeletesTheLog) {
+    LittleFS.format();
+    {
+        Device device;
+        device.talk(2);
+        device.log.clear();
+        CHECK(!LittleFS.exists(CONV_LOG_PATH));
+    }
+    Device device;
+    CHECK(device.log.isRestored());
+    CHECK_EQ(device.log.restore(device.history), 0u);
+}
+
+//=============================================================================
+// Damaged Logs
+//=============================================================================
+
+TEST(tornTailRecordIsDroppedAndRepaired) {
+    // Cut the last record at every byte, header and payload alike
+    LittleFS.format();
+    {
+        Device device;
+        device.talk(2);
+    }
+    std::filesystem::copy_file(logPath(), "build/conversation.intact",
+                               std::filesystem::copy_options::overwrite_existing);
+    size_t intact = logSize();
+    size_t lastRecord = recordOffsets().back();
+
+    for (size_t cut = lastRecord + 1; cut < intact; cut++) {
+        std::filesystem::copy_file("build/conversation.intact", logPath(),
+                                   std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::resize_file(logPath(), cut);
+
+        Device device;
+        if (device.log.restore(device.history) != 3 || device.log.getStats().corruptRecords != 1) {
+            hostTestFail(__FILE__, __LINE__, "cut at " + std::to_string(cut) + " of " +
+                         std::to_string(intact) + ": " + std::to_string(device.history.size()) +
+                         " messages restored");
+            return;
+        }
+
+        // The next append rewrites the log without the torn bytes
+        device.say(MessageRole::Assistant, "answer 2 again");
+        CHECK_EQ(device.log.getStats().compactions, 1u);
+        CHECK_EQ(logSize(), device.log.getFileSize());
+
+        Device rebooted;
+        CHECK_EQ(rebooted.log.restore(rebooted.history), 4u);
+        CHECK_EQ(rebooted.log.getStats().corruptRecords, 0u);
+        CHECK_STR(rebooted.claudeAt(3), "{\"role\":\"assistant\",\"content\":\"answer 2 again\"}");
+    }
+    std::filesystem::remove("build/conversation.intact");
+}
+
+TEST(crcMismatchEndsTheRestore) {
+    LittleFS.format();
+    {
+        Device device;
+        device.talk(3);
+    }
+    std::vector<size_t> offsets = recordOffsets();
+    CHECK_EQ(offsets.size(), 6u);
+
+    // A flipped payload byte in "answer 2" stops the restore after "question 2"
+    flipByte(offsets[3] + RECORD_HEADER + 10);
+    Device device;
+    CHECK_EQ(device.log.restore(device.history), 3u);
+    CHECK_EQ(device.log.getStats().corruptRecords, 1u);
+    CHECK_STR(device.claudeAt(2), "{\"role\":\"user\",\"content\":\"question 2\"}");
+
+    device.say(MessageRole::Assistant, "answer 2");
+    Device rebooted;
+    CHECK_EQ(rebooted.log.restore(rebooted.history), 4u);
+    CHECK_EQ(rebooted.log.getStats().corruptRecords, 0u);
+}
+
+TEST(corruptHeaderEndsTheRestore) {
+    LittleFS.format();
+    {
+        Device device;
+        device.talk(2);
+    }
+    std::vector<size_t> offsets = recordOffsets();
+
+    // Bad magic, an unknown role, and a length that runs past the file
+    for (size_t field : { (size_t)0, (size_t)2, (size_t)5 }) {
+        LittleFS.format();
+        {
+            Device device;
+            device.talk(2);
+        }
+        flipByte(offsets[2] + field);
+        Device device;
+        CHECK_EQ(device.log.restore(device.history), 2u);
+        CHECK_EQ(device.log.getStats().corruptRecords, 1u);
+    }
+}
+
+TEST(restoredHistoryStartsWithAUserMessage) {
+    // A log whose first intact record is an answer (the question was
+    // compacted away) restores from the next question on
+    LittleFS.format();
+    {
+        Device device;
+        device.say(MessageRole::Assistant, "orphan answer");
+        device.talk(1);
+    }
+    Device device;
+    CHECK_EQ(device.log.restore(device.history), 3u);
+    CHECK_EQ(device.history.size(), 2u);
+    CHECK(device.history.at(0).role == MessageRole::User);
+}
+
+TEST(failedAppendIsRepairedByTheNextOne) {
+    LittleFS.format();
+    {
+        Device device;
+        device.talk(1);
+
+        // Flash full halfway through the record
+        LittleFS.writeBudget = 20;
+        device.say(MessageRole::User, "question 2");
+        CHECK_EQ(device.log.getStats().appends, 2u);
+        LittleFS.writeBudget = -1;
+
+        // Compaction writes it again from the history, along with this one
+        device.say(MessageRole::Assistant, "answer 2");
+        CHECK_EQ(device.log.getStats().compactions, 1u);
+    }
+    Device device;
+    CHECK_EQ(device.log.restore(device.history), 4u);
+    CHECK_EQ(device.log.getStats().corruptRecords, 0u);
+    CHECK_STR(device.claudeAt(2), "{\"role\":\"user\",\"content\":\"question 2\"}");
+}
+
+//=============================================================================
+// Compaction
+//=============================================================================
+
+TEST(logStaysUnderTheCapAndKeepsTheNewestTurns) {
+    LittleFS.format();
+    size_t largest = 0;
+    int turns = 150;
+    {
+        Device device;
+        // ~1 KB records: the cap is hit every couple of dozen turns
+        device.talk(turns, 1, 200);
+        largest = device.log.getFileSize();
+
+        const ConversationLogStats& stats = device.log.getStats();
+        CHECK(stats.compactions >= 3);
+        CHECK_EQ(stats.appends, (uint32_t)turns * 2);
+        CHECK_EQ(stats.flashBytes, (uint32_t)LittleFS.bytesWritten);
+
+        // Compaction keeps half the cap, so each rewrite buys that much room
+        // and flash writes stay within 2x of what was appended
+        CHECK(stats.flashBytes < stats.appendedBytes * 2);
+        CHECK(stats.flashBytes > stats.appendedBytes);
+        CHECK(!LittleFS.exists(CONV_LOG_TEMP_PATH));
+    }
+    CHECK(largest <= CONV_LOG_MAX_BYTES);
+    CHECK(logSize() <= CONV_LOG_MAX_BYTES);
+
+    Device device;
+    size_t restored = device.log.restore(device.history);
+    // The log holds more than the history ring; the oldest turns are evicted
+    CHECK(restored >= device.history.size());
+    CHECK(device.history.size() > HISTORY_MAX_ENTRIES / 2);
+    CHECK(device.history.at(0).role == MessageRole::User);
+    std::string last = "{\"role\":\"assistant\",\"content\":\"answer " + std::to_string(turns) +
+                       std::string(200, 'a') + "\"}";
+    CHECK_STR(device.claudeAt(device.history.size() - 1), last);
+}
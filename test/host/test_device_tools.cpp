@@ -0,0 +1,304 @@
+/**
+ * @file test_device_tools.cpp
+ * @brief Device tool table: perfect-hash lookup, argument defaults and
+ *        clamping, dispatch to the right callback
+ *
+ * findDeviceTool() trusts a seed searched at compile time, so the lookup
+ * is checked against every table name and against many strings that are
+ * not tools (near misses of each name and random ones that land in used
+ * slots). Arguments go through executeDeviceTool() with recording
+ * callbacks: what a handler sees for a missing or mistyped argument is
+ * exactly the table's default, and Int ranges are clamped.
+ */
+
+#include "host_test.h"
+#include "assistant/device_tools.h"
+#include <random>
+#include <set>
+#include <vector>
+
+//=============================================================================
+// Link Seams
+//=============================================================================
+// device_tools.cpp registers with the LLM client and the MCP server; the
+// test records those calls instead of linking either.
+
+static std::vector<std::string> mcpTools;
+static std::vector<std::string> mcpResources;
+static std::vector<std::string> mcpUpdates;
+
+bool LLMClient::addTool(const char* name, const char* description, const char* inputSchema,
+                        uint8_t flags) {
+    return true;
+}
+
+MCPServer::MCPServer() {}
+MCPServer::~MCPServer() {}
+
+void MCPServer::addTool(const char* name, const char* description, const char* inputSchema) {
+    mcpTools.push_back(name);
+}
+
+bool MCPServer::addResource(const char* uri, const char* name, const char* description,
+                            MCPResourceReader reader) {
+    mcpResources.push_back(uri);
+    return true;
+}
+
+void MCPServer::notifyResourceUpdated(const char* uri) {
+    mcpUpdates.push_back(uri);
+}
+
+MCPServer mcpServer;
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+/** Last callback that ran and the arguments it got, as text */
+static std::string called;
+
+static void recordCallbacks() {
+    DeviceToolCallbacks& cb = deviceToolCallbacks;
+    cb = DeviceToolCallbacks();
+    cb.onSetExpression = [](const char* expression, int ms) {
+        called = "expression " + std::string(expression) + " " + std::to_string(ms);
+    };
+    cb.onSetTimer = [](int seconds, const char* name) {
+        called = "timer " + std::to_string(seconds) + " " + name;
+    };
+    cb.onCancelTimer = []() { called = "cancel timer"; };
+    cb.onStartPomodoro = [](int work, int rest) {
+        called = "pomodoro " + std::to_string(work) + " " + std::to_string(rest);
+    };
+    cb.onStopPomodoro = []() { called = "stop pomodoro"; };
+    cb.onGetDeviceInfo = []() -> String { called = "device info"; return "{\"battery\":80}"; };
+    cb.onPlaySound = [](const char* sound) { called = "sound " + std::string(sound); };
+    cb.onSetReminder = [](int hour, int minute, const char* message, bool recurring) {
+        called = "reminder " + std::to_string(hour) + ":" + std::to_string(minute) + " \"" +
+                 message + "\"" + (recurring ? " daily" : "");
+        return true;
+    };
+    cb.onCancelReminder = [](const char* message) {
+        called = "cancel reminder \"" + std::string(message) + "\"";
+        return true;
+    };
+    cb.onListReminders = []() -> String { called = "list reminders"; return "[]"; };
+    cb.onStartBreathing = []() { called = "breathing"; };
+    cb.onSetVolume = [](int volume) { called = "volume " + std::to_string(volume); };
+    cb.onSetBrightness = [](int brightness) { called = "brightness " + std::to_string(brightness); };
+    cb.onSetEyeColor = [](const char* color) { called = "eyes " + std::string(color); return true; };
+    cb.onPlaySequence = [](const SequenceStep* steps, size_t count) {
+        called = "sequence " + std::to_string(count);
+        return true;
+    };
+}
+
+/** Run a tool and return the callback it reached ("" if none) */
+static std::string run(const char* tool, const char* input, std::string* result = nullptr) {
+    called.clear();
+    String output = executeDeviceTool(tool, input);
+    if (result) *result = output.c_str();
+    return called;
+}
+
+//=============================================================================
+// Perfect Hash Lookup
+//=============================================================================
+
+TEST(everyToolIsFoundByName) {
+    std::set<std::string> names;
+    for (size_t i = 0; i < getDeviceToolCount(); i++) {
+        const DeviceToolDescriptor& tool = getDeviceTool(i);
+        CHECK(names.insert(tool.name).second);
+
+        // A copy, so the match cannot be a pointer comparison
+        std::string name = tool.name;
+        CHECK(findDeviceTool(name.c_str()) == &tool);
+    }
+    CHECK_EQ(names.size(), (size_t)15);
+}
+
+TEST(nearMissesAreNotTools) {
+    CHECK(findDeviceTool(nullptr) == nullptr);
+    CHECK(findDeviceTool("") == nullptr);
+
+    size_t tried = 0;
+    for (size_t i = 0; i < getDeviceToolCount(); i++) {
+        std::string name = getDeviceTool(i).name;
+        std::vector<std::string> misses;
+        for (size_t n = 1; n < name.size(); n++) misses.push_back(name.substr(0, n));
+        for (size_t n = 0; n < name.size(); n++) {
+            misses.push_back(name.substr(0, n) + name.substr(n + 1));
+            std::string changed = name;
+            changed[n] = changed[n] == 'x' ? 'y' : 'x';
+            misses.push_back(changed);
+            if (isalpha((unsigned char)name[n])) {
+                changed = name;
+                changed[n] = toupper(changed[n]);
+                misses.push_back(changed);
+            }
+        }
+        misses.push_back(name + "_");
+        misses.push_back(name + "s");
+        misses.push_back(" " + name);
+
+        for (const std::string& miss : misses) {
+            if (findDeviceTool(miss.c_str()) != nullptr) {
+                hostTestFail(__FILE__, __LINE__, "\"" + miss + "\" found as " +
+                             findDeviceTool(miss.c_str())->name);
+            }
+        }
+        tried += misses.size();
+    }
+    CHECK(tried > 500);
+}
+
+TEST(randomNamesInUsedSlotsAreRejected) {
+    // Half the slots hold a tool, so about half of these get as far as the
+    // strcmp; none may be mistaken for a tool
+    std::mt19937 rng(66);
+    const char alphabet[] = "abcdefghijklmnopqrstuvwxyz_";
+    for (int i = 0; i < 200000; i++) {
+        std::string name(1 + rng() % 20, ' ');
+        for (char& c : name) c = alphabet[rng() % (sizeof(alphabet) - 1)];
+        const DeviceToolDescriptor* tool = findDeviceTool(name.c_str());
+        if (tool && name != tool->name) {
+            hostTestFail(__FILE__, __LINE__, "\"" + name + "\" found as " + tool->name);
+            return;
+        }
+    }
+}
+
+//=============================================================================
+// Argument Binding
+//=============================================================================
+
+TEST(missingArgumentsGetTheTableDefaults) {
+    recordCallbacks();
+    CHECK_STR(run("set_expression", "{}"), "expression neutral 0");
+    CHECK_STR(run("set_timer", "{}"), "timer 60 Timer");
+    CHECK_STR(run("start_pomodoro", "{}"), "pomodoro 25 5");
+    CHECK_STR(run("play_sound", "{}"), "sound confirm");
+    CHECK_STR(run("set_reminder", "{}"), "reminder 0:0 \"\"");
+    CHECK_STR(run("cancel_reminder", "{}"), "cancel reminder \"\"");
+    CHECK_STR(run("set_volume", "{}"), "volume 50");
+    CHECK_STR(run("set_brightness", "{}"), "brightness 50");
+    CHECK_STR(run("set_eye_color", "{}"), "eyes cyan");
+
+    // An empty input is no arguments at all, not an error
+    CHECK_STR(executeDeviceTool("set_volume", JsonObjectConst()).c_str(), "{\"success\":true,\"volume\":50}");
+}
+
+TEST(mistypedArgumentsGetTheTableDefaults) {
+    recordCallbacks();
+    CHECK_STR(run("set_timer", "{\"duration_seconds\":\"five minutes\",\"name\":42}"), "timer 60 Timer");
+    CHECK_STR(run("set_volume", "{\"volume\":\"loud\"}"), "volume 50");
+    CHECK_STR(run("set_expression", "{\"expression\":[\"happy\"],\"duration_ms\":true}"), "expression neutral 0");
+    CHECK_STR(run("set_reminder", "{\"hour\":9,\"minute\":15,\"message\":\"Stretch\",\"recurring\":\"yes\"}"),
+              "reminder 9:15 \"Stretch\"");
+
+    std::string result;
+    CHECK_STR(run("play_sequence", "{\"steps\":\"wave\"}", &result), "");
+    CHECK_STR(result, "{\"error\":\"steps must be a non-empty array\"}");
+}
+
+TEST(givenArgumentsArePassedByPosition) {
+    recordCallbacks();
+    std::string result;
+    CHECK_STR(run("set_reminder", "{\"recurring\":true,\"message\":\"Water the plants\",\"minute\":30,\"hour\":7}",
+                  &result), "reminder 7:30 \"Water the plants\" daily");
+    CHECK_STR(result, "{\"success\":true,\"hour\":7,\"minute\":30,\"message\":\"Water the plants\",\"recurring\":true}");
+    CHECK_STR(run("set_timer", "{\"name\":\"Tea\",\"duration_seconds\":240}"), "timer 240 Tea");
+    CHECK_STR(run("set_expression", "{\"expression\":\"happy\",\"duration_ms\":1500}"), "expression happy 1500");
+}
+
+TEST(rangedArgumentsAreClamped) {
+    recordCallbacks();
+    std::string result;
+    CHECK_STR(run("set_volume", "{\"volume\":150}", &result), "volume 100");
+    CHECK_STR(result, "{\"success\":true,\"volume\":100}");
+    CHECK_STR(run("set_volume", "{\"volume\":-5}"), "volume 0");
+    CHECK_STR(run("set_volume", "{\"volume\":100}"), "volume 100");
+    CHECK_STR(run("set_volume", "{\"volume\":0}"), "volume 0");
+    CHECK_STR(run("set_brightness", "{\"brightness\":101}"), "brightness 100");
+    CHECK_STR(run("set_brightness", "{\"brightness\":-1}"), "brightness 0");
+
+    // Without a range nothing is clamped
+    CHECK_STR(run("set_timer", "{\"duration_seconds\":86400}"), "timer 86400 Timer");
+}
+
+//=============================================================================
+// Dispatch and Errors
+//=============================================================================
+
+TEST(everyToolReachesItsOwnCallback) {
+    static const char* const EXPECTED[][2] = {
+        { "set_expression", "expression neutral 0" },
+        { "play_sequence", "sequence 1" },
+        { "set_timer", "timer 60 Timer" },
+        { "cancel_timer", "cancel timer" },
+        { "start_pomodoro", "pomodoro 25 5" },
+        { "stop_pomodoro", "stop pomodoro" },
+        { "get_device_info", "device info" },
+        { "play_sound", "sound confirm" },
+        { "set_reminder", "reminder 0:0 \"\"" },
+        { "cancel_reminder", "cancel reminder \"\"" },
+        { "list_reminders", "list reminders" },
+        { "start_breathing", "breathing" },
+        { "set_volume", "volume 50" },
+        { "set_brightness", "brightness 50" },
+        { "set_eye_color", "eyes cyan" },
+    };
+    CHECK_EQ(sizeof(EXPECTED) / sizeof(EXPECTED[0]), getDeviceToolCount());
+
+    recordCallbacks();
+    for (const auto& expected : EXPECTED) {
+        const char* input = strcmp(expected[0], "play_sequence") == 0
+            ? "{\"steps\":[{\"expression\":\"happy\",\"duration_ms\":500}]}" : "{}";
+        std::string result;
+        CHECK_STR(run(expected[0], input, &result), expected[1]);
+        CHECK(result.find("\"success\":true") != std::string::npos);
+    }
+
+    // Pre-serialized callback results are embedded, not quoted
+    std::string result;
+    run("get_device_info", "{}", &result);
+    CHECK_STR(result, "{\"device_info\":{\"battery\":80},\"success\":true}");
+}
+
+TEST(unknownToolsAndBadInputAreErrors) {
+    recordCallbacks();
+    std::string result;
+    CHECK_STR(run("set_volumes", "{\"volume\":10}", &result), "");
+    CHECK_STR(result, "{\"error\":\"Unknown tool\",\"tool_name\":\"set_volumes\"}");
+    CHECK_STR(run("set_volume", "{\"volume\":", &result), "");
+    CHECK_STR(result, "{\"error\":\"Invalid JSON input\"}");
+
+    // A tool whose callback is not connected says so instead of succeeding
+    deviceToolCallbacks.onSetVolume = nullptr;
+    CHECK_STR(run("set_volume", "{\"volume\":10}", &result), "");
+    CHECK_STR(result, "{\"error\":\"Volume control not available\"}");
+}
+
+//=============================================================================
+// Registration
+//=============================================================================
+
+TEST(mcpRegistrationFollowsTheTable) {
+    mcpTools.clear();
+    registerMcpDeviceTools(mcpServer);
+    CHECK_EQ(mcpTools.size(), getDeviceToolCount());
+    for (size_t i = 0; i < mcpTools.size() && i < getDeviceToolCount(); i++) {
+        CHECK_STR(mcpTools[i], getDeviceTool(i).name);
+    }
+
+    mcpResources.clear();
+    registerMcpDeviceResources(mcpServer);
+    CHECK_EQ(mcpResources.size(), (size_t)DeviceResource::Count);
+    mcpUpdates.clear();
+    notifyDeviceResource(DeviceResource::Settings);
+    notifyDeviceResource(DeviceResource::Count);
+    CHECK_EQ(mcpUpdates.size(), (size_t)1);
+    CHECK_STR(mcpUpdates[0], "deskbuddy://state/settings");
+}
@@ -0,0 +1,242 @@
+/**
+ * @file test_expression_sequence.cpp
+ * @brief ExpressionSequence: timeline validation and step timing on a
+ *        jittery frame clock
+ *
+ * The frames here arrive at 60 fps with random jitter and occasional long
+ * stalls, as the main loop does when a render or a flash write runs long.
+ * Every step must fire on the first frame at or after its scheduled time,
+ * so it is never late by more than the frame gap that covered it, and the
+ * lateness must not build up along the sequence.
+ */
+
+#include "host_test.h"
+#include "behavior/expression_sequence.h"
+#include <random>
+#include <vector>
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+static int parseTimeline(const char* json, SequenceStep* steps, String& error) {
+    JsonDocument doc;
+    if (deserializeJson(doc, json)) {
+        error = "bad JSON";
+        return -1;
+    }
+    return ExpressionSequence::parse(doc.as<JsonArrayConst>(), steps, error);
+}
+
+static const char* TIMELINE =
+    "[{\"look\":\"left\",\"duration_ms\":400},"
+    " {\"expression\":\"surprised\",\"sound\":\"alert\",\"duration_ms\":250},"
+    " {\"expression\":\"wink\",\"gaze_x\":0.5,\"duration_ms\":350},"
+    " {\"expression\":\"happy\",\"look\":\"center\",\"duration_ms\":3000}]";
+
+struct Firing {
+    uint32_t atMs;              ///< Scheduled offset
+    uint32_t firedMs;           ///< Frame time that fired it
+    uint32_t frameGapMs;        ///< Gap between that frame and the one before
+};
+
+//=============================================================================
+// Validation
+//=============================================================================
+
+TEST(parseSchedulesStepsBackToBack) {
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    String error;
+    CHECK_EQ(parseTimeline(TIMELINE, steps, error), 4);
+    CHECK_EQ(steps[0].atMs, 0u);
+    CHECK_EQ(steps[1].atMs, 400u);
+    CHECK_EQ(steps[2].atMs, 650u);
+    CHECK_EQ(steps[3].atMs, 1000u);
+    CHECK_EQ(ExpressionSequence::totalMs(steps, 4), 4000u);
+
+    CHECK(steps[0].setsGaze && !steps[0].setsExpression);
+    CHECK(steps[0].gazeX == -1.0f);
+    CHECK(steps[1].expression == Expression::Surprised);
+    CHECK_STR(steps[1].sound, "alert");
+    CHECK(steps[2].expression == Expression::Wink);
+    CHECK(steps[2].gazeX == 0.5f && steps[2].gazeY == 0.0f);
+}
+
+TEST(rejectsInvalidTimelines) {
+    static const char* const BAD[][2] = {
+        { "[]", "non-empty" },
+        { "{\"expression\":\"happy\"}", "non-empty" },
+        { "[{\"expression\":\"elated\"}]", "unknown expression" },
+        { "[{\"look\":\"left\",\"gaze_x\":0.2}]", "either look" },
+        { "[{\"look\":\"behind\"}]", "look must be" },
+        { "[{\"gaze_x\":1.5}]", "between -1 and 1" },
+        { "[{\"gaze_y\":\"up\"}]", "must be numbers" },
+        { "[{\"sound\":\"boing\"}]", "sound must be" },
+        { "[{\"duration_ms\":1.5}]", "integer" },
+        { "[{\"duration_ms\":10001}]", "0 to 10000" },
+        { "[{}]", "does nothing" },
+        { "[{\"expression\":\"happy\"}, 3]", "Step 2: not an object" },
+    };
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    for (const auto& bad : BAD) {
+        String error;
+        CHECK_EQ(parseTimeline(bad[0], steps, error), -1);
+        if (error.indexOf(bad[1]) < 0) {
+            hostTestFail(__FILE__, __LINE__, std::string(bad[0]) + " -> " + error.c_str());
+        }
+    }
+
+    // Too many steps, and too long overall
+    std::string many = "[";
+    for (int i = 0; i <= SEQUENCE_MAX_STEPS; i++) many += std::string(i ? "," : "") + "{\"duration_ms\":10}";
+    String error;
+    CHECK_EQ(parseTimeline((many + "]").c_str(), steps, error), -1);
+    std::string longest = "[";
+    for (int i = 0; i < 7; i++) longest += std::string(i ? "," : "") + "{\"duration_ms\":10000}";
+    CHECK_EQ(parseTimeline((longest + "]").c_str(), steps, error), -1);
+    CHECK(error.indexOf("longer than") >= 0);
+}
+
+//=============================================================================
+// Timing
+//=============================================================================
+
+TEST(stepsFireOnFirstFrameAtOrAfterSchedule) {
+    std::mt19937 rng(1);
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    String error;
+
+    // 30 short steps: plenty of chances for lateness to build up
+    std::string timeline = "[";
+    for (int i = 0; i < 30; i++) {
+        timeline += std::string(i ? "," : "") + "{\"look\":\"" + (i % 2 ? "left" : "right") +
+                    "\",\"duration_ms\":" + std::to_string(40 + (i * 37) % 200) + "}";
+    }
+    int count = parseTimeline((timeline + "]").c_str(), steps, error);
+    CHECK_EQ(count, 30);
+    uint32_t planned = ExpressionSequence::totalMs(steps, count);
+
+    for (int run = 0; run < 200; run++) {
+        ExpressionSequence sequence;
+        sequence.begin();
+        std::vector<Firing> fired;
+        uint32_t now = 1000 + rng() % 100000;
+        uint32_t gap = 0;
+        uint32_t startMs = 0;
+        sequence.onStep([&](const SequenceStep& step) {
+            fired.push_back({ step.atMs, now, gap });
+        });
+
+        CHECK(sequence.play(steps, count));
+        uint32_t maxGap = 0;
+        for (int frame = 0; frame < 2000 && sequence.isActive(); frame++) {
+            if (frame == 0) {
+                startMs = now;
+            } else {
+                // 60 fps with jitter; one frame in 25 stalls for up to 150 ms
+                gap = 14 + rng() % 8;
+                if (rng() % 25 == 0) gap += rng() % 150;
+                now += gap;
+                if (gap > maxGap) maxGap = gap;
+            }
+            sequence.update(now);
+        }
+
+        CHECK(!sequence.isActive());
+        CHECK_EQ(fired.size(), (size_t)count);
+        for (const Firing& f : fired) {
+            // Fired at or after due, by the first frame that got there
+            uint32_t due = startMs + f.atMs;
+            bool firstFrame = f.firedMs == startMs;
+            if (f.firedMs < due || (!firstFrame && f.firedMs - f.frameGapMs >= due)) {
+                hostTestFail(__FILE__, __LINE__, "step at " + std::to_string(f.atMs) +
+                             " ms fired at +" + std::to_string(f.firedMs - startMs) + " ms");
+                return;
+            }
+        }
+        const SequenceStats& stats = sequence.getStats();
+        CHECK(stats.maxLateMs <= maxGap);
+        CHECK(stats.lastEndErrorMs <= maxGap);
+        CHECK_EQ(stats.stepsRun, (uint32_t)count);
+        CHECK(planned > 3000);
+    }
+}
+
+TEST(lateFrameDoesNotShiftLaterSteps) {
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    String error;
+    int count = parseTimeline("[{\"look\":\"left\",\"duration_ms\":100},"
+                              " {\"look\":\"right\",\"duration_ms\":100},"
+                              " {\"look\":\"up\",\"duration_ms\":100}]", steps, error);
+    ExpressionSequence sequence;
+    sequence.begin();
+    std::vector<uint32_t> fired;
+    uint32_t now = 0;
+    sequence.onStep([&](const SequenceStep&) { fired.push_back(now); });
+    sequence.play(steps, count);
+
+    // A 180 ms stall fires step 1 80 ms late; step 2 is still on time
+    for (uint32_t t : { 0u, 180u, 190u, 200u, 210u, 300u }) {
+        now = t;
+        sequence.update(now);
+    }
+    CHECK_EQ(fired.size(), 3u);
+    CHECK_EQ(fired[1], 180u);
+    CHECK_EQ(fired[2], 200u);
+    CHECK_EQ(sequence.getStats().maxLateMs, 80u);
+    CHECK_EQ(sequence.getStats().lastEndErrorMs, 0u);
+}
+
+TEST(stepsRunOnlyInUpdate) {
+    // play() may come from another task: nothing happens until the frame
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    String error;
+    int count = parseTimeline("[{\"look\":\"down\",\"duration_ms\":500}]", steps, error);
+    ExpressionSequence sequence;
+    sequence.begin();
+    int calls = 0;
+    sequence.onStep([&](const SequenceStep&) { calls++; });
+    CHECK(sequence.play(steps, count));
+    CHECK(sequence.isActive());
+    CHECK_EQ(calls, 0);
+
+    float x, y;
+    CHECK(!sequence.getGaze(x, y));
+    sequence.update(5000);
+    CHECK_EQ(calls, 1);
+    CHECK(sequence.getGaze(x, y));
+    CHECK(y == 1.0f);
+}
+
+TEST(stopAndReplaceEndTheRunningSequence) {
+    SequenceStep steps[SEQUENCE_MAX_STEPS];
+    String error;
+    int count = parseTimeline(TIMELINE, steps, error);
+    ExpressionSequence sequence;
+    sequence.begin();
+    float x, y;
+
+    sequence.play(steps, count);
+    sequence.update(0);
+    sequence.update(500);
+    sequence.stop();
+    sequence.update(520);
+    CHECK(!sequence.isActive());
+    CHECK(!sequence.getGaze(x, y));
+    CHECK_EQ(sequence.getStats().stopped, 1u);
+
+    // A newer sequence replaces the running one and starts from its own step 0
+    sequence.play(steps, count);
+    sequence.update(1000);
+    sequence.play(steps, count);
+    sequence.update(1400);
+    CHECK_EQ(sequence.getStats().stopped, 2u);
+    CHECK_EQ(sequence.getStats().played, 3u);
+    sequence.update(5400);
+    CHECK(!sequence.isActive());
+    CHECK_EQ(sequence.getStats().lastEndErrorMs, 0u);
+
+    // Without begin() there is nowhere to hand it over
+    ExpressionSequence idle;
+    CHECK(!idle.play(steps, count));
+}
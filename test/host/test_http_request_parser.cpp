@@ -0,0 +1,238 @@
+/**
+ * @file test_http_request_parser.cpp
+ * @brief HttpRequestParser: known requests, every split of them, and a
+ *        mutation fuzz
+ *
+ * A request fed in arbitrary pieces - one byte at a time or whatever one
+ * select() wakeup read - must parse exactly as if fed whole; that is what
+ * lets MCPServer collect a body across wakeups. The fuzz feeds mutated
+ * and random bytes and checks the parser's invariants (run under
+ * ASan/UBSan with make SANITIZE=1).
+ */
+
+#include "host_test.h"
+#include "network/http_request_parser.h"
+#include <random>
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+struct ParseResult {
+    HttpParserState state;
+    uint16_t errorStatus;
+    std::string method;
+    std::string uri;
+    std::string headers;        ///< "name=value;" for each header
+    std::string body;
+    uint32_t contentLength;
+    bool keepAlive;
+    size_t consumed;            ///< Bytes of the input the request took
+
+    bool operator==(const ParseResult& o) const {
+        return state == o.state && errorStatus == o.errorStatus && method == o.method &&
+               uri == o.uri && headers == o.headers && body == o.body &&
+               contentLength == o.contentLength && keepAlive == o.keepAlive &&
+               consumed == o.consumed;
+    }
+};
+
+/**
+ * Feed input in pieces of 1..maxPiece bytes (whole when maxPiece is 0),
+ * the way MCPServer::serviceConnection() does: stop at the end of the
+ * request so pipelined bytes are left over.
+ */
+static ParseResult parse(HttpRequestParser& parser, const std::string& input,
+                         std::mt19937& rng, size_t maxPiece) {
+    ParseResult r{};
+    parser.onHeader([&r](const char* name, size_t nameLength, const char* value, size_t valueLength) {
+        r.headers.append(name, nameLength);
+        r.headers += '=';
+        r.headers.append(value, valueLength);
+        r.headers += ';';
+    });
+    parser.onBody([&r](const uint8_t* data, size_t length) {
+        r.body.append((const char*)data, length);
+    });
+    parser.reset();
+
+    size_t offset = 0;
+    while (offset < input.size()) {
+        size_t piece = maxPiece ? 1 + rng() % maxPiece : input.size();
+        size_t end = std::min(input.size(), offset + piece);
+
+        // One wakeup: feed until this piece is used up or the request ends
+        while (offset < end) {
+            size_t used = parser.feed((const uint8_t*)input.data() + offset, end - offset);
+            offset += used;
+            if (parser.getState() == HttpParserState::Complete || parser.hasError()) break;
+            if (used == 0) break;
+        }
+        if (parser.getState() == HttpParserState::Complete || parser.hasError()) break;
+    }
+
+    r.state = parser.getState();
+    r.errorStatus = parser.getErrorStatus();
+    r.method = parser.getMethod();
+    r.uri = parser.getUri();
+    r.contentLength = parser.getContentLength();
+    r.keepAlive = parser.isKeepAlive();
+    r.consumed = offset;
+    return r;
+}
+
+static ParseResult parseWhole(const std::string& input) {
+    HttpRequestParser parser;
+    std::mt19937 rng(0);
+    return parse(parser, input, rng, 0);
+}
+
+static const char* SAMPLES[] = {
+    "POST /mcp HTTP/1.1\r\nHost: x\r\nContent-Type: application/json\r\n"
+    "ACCEPT: application/json, text/event-stream\r\nContent-Length: 13\r\n\r\n"
+    "{\"a\":\"hello\"}GET / HTTP/1.1\r\n\r\n",
+    "GET /sse HTTP/1.0\nConnection: keep-alive\n\n",
+    "\r\n\r\nOPTIONS /mcp HTTP/1.1\r\nconnection:   Close  \r\n\r\n",
+    "GET /x HTTP/2.0\r\n\r\n",
+    "POST /a HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n",
+    "POST /a HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n",
+    "POST /a HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",
+    "POST /a HTTP/1.1\r\nBad header\r\n\r\n",
+};
+
+//=============================================================================
+// Known Requests
+//=============================================================================
+
+TEST(parsesRequestWithBody) {
+    ParseResult r = parseWhole(SAMPLES[0]);
+    CHECK(r.state == HttpParserState::Complete);
+    CHECK_STR(r.method, "POST");
+    CHECK_STR(r.uri, "/mcp");
+    CHECK_EQ(r.contentLength, 13u);
+    CHECK_STR(r.body, "{\"a\":\"hello\"}");
+    CHECK(r.keepAlive);
+    CHECK(r.headers.find("ACCEPT=application/json, text/event-stream;") != std::string::npos);
+
+    // The pipelined request that follows is left unconsumed
+    CHECK_STR(std::string(SAMPLES[0]).substr(r.consumed), "GET / HTTP/1.1\r\n\r\n");
+}
+
+TEST(connectionHeaderAndVersionSetKeepAlive) {
+    CHECK(parseWhole(SAMPLES[1]).keepAlive);        // HTTP/1.0 keep-alive, bare LF
+    ParseResult r = parseWhole(SAMPLES[2]);          // Leading blank lines, "Close"
+    CHECK(r.state == HttpParserState::Complete);
+    CHECK_STR(r.method, "OPTIONS");
+    CHECK(!r.keepAlive);
+    CHECK_STR(r.headers, "connection=Close;");
+}
+
+TEST(rejectsMalformedRequests) {
+    CHECK_EQ(parseWhole(SAMPLES[3]).errorStatus, 505);
+    CHECK_EQ(parseWhole(SAMPLES[4]).errorStatus, 501);
+    CHECK_EQ(parseWhole(SAMPLES[5]).errorStatus, 413);
+    CHECK_EQ(parseWhole(SAMPLES[6]).errorStatus, 400);
+    CHECK_EQ(parseWhole(SAMPLES[7]).errorStatus, 400);
+
+    std::string longUri = "GET /" + std::string(300, 'a') + " HTTP/1.1\r\n\r\n";
+    CHECK_EQ(parseWhole(longUri).errorStatus, 414);
+    std::string longHeader = "GET / HTTP/1.1\r\nX: " + std::string(600, 'a') + "\r\n\r\n";
+    CHECK_EQ(parseWhole(longHeader).errorStatus, 431);
+}
+
+TEST(isPathIgnoresQuery) {
+    HttpRequestParser parser;
+    std::string request = "POST /mcp/message?sessionId=ab HTTP/1.1\r\n\r\n";
+    parser.feed((const uint8_t*)request.data(), request.size());
+    CHECK(parser.isPath("/mcp/message"));
+    CHECK(!parser.isPath("/mcp"));
+}
+
+//=============================================================================
+// Split Feeds
+//=============================================================================
+
+TEST(anySplitParsesLikeWhole) {
+    std::mt19937 rng(1);
+    HttpRequestParser parser;
+    for (const char* sample : SAMPLES) {
+        ParseResult whole = parseWhole(sample);
+        for (size_t maxPiece : {1, 2, 7, 17, 64}) {
+            for (int k = 0; k < 200; k++) {
+                ParseResult split = parse(parser, sample, rng, maxPiece);
+                if (!(split == whole)) {
+                    hostTestFail(__FILE__, __LINE__, std::string("split parse differs for: ") + sample);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+TEST(largeBodyArrivesOverManyWakeups) {
+    // A 40 KB body in 256-byte reads, as the MCP server task sees it
+    std::string body(40 * 1024, 'x');
+    std::string request = "POST /mcp HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) +
+                          "\r\n\r\n" + body;
+    HttpRequestParser parser;
+    std::string received;
+    parser.onBody([&received](const uint8_t* data, size_t length) {
+        received.append((const char*)data, length);
+    });
+
+    size_t offset = 0;
+    int wakeups = 0;
+    while (offset < request.size()) {
+        size_t end = std::min(request.size(), offset + 256);
+        while (offset < end) offset += parser.feed((const uint8_t*)request.data() + offset, end - offset);
+        wakeups++;
+        bool last = offset == request.size();
+        CHECK_EQ(parser.getState() == HttpParserState::Complete, last);
+    }
+    CHECK_EQ(received.size(), body.size());
+    CHECK_EQ(parser.getBodyRemaining(), 0u);
+    CHECK(wakeups > 100);
+}
+
+//=============================================================================
+// Fuzz
+//=============================================================================
+
+TEST(mutatedInputKeepsInvariants) {
+    std::mt19937 rng(2);
+    HttpRequestParser parser;
+    const size_t sampleCount = sizeof(SAMPLES) / sizeof(SAMPLES[0]);
+    int completed = 0;
+    int rejected = 0;
+
+    for (int k = 0; k < 100000; k++) {
+        std::string input = SAMPLES[rng() % sampleCount];
+        int mutations = rng() % 6;
+        for (int m = 0; m < mutations && !input.empty(); m++) {
+            size_t i = rng() % input.size();
+            switch (rng() % 3) {
+                case 0:  input[i] = (char)rng(); break;
+                case 1:  input.erase(i, 1); break;
+                default: input.insert(i, 1, (char)rng()); break;
+            }
+        }
+        if (rng() % 10 == 0) {
+            input.clear();
+            for (int n = rng() % 1200; n > 0; n--) input += (char)rng();
+        }
+
+        ParseResult r = parse(parser, input, rng, rng() % 2 ? 17 : 0);
+        if (r.consumed > input.size() || r.body.size() > r.contentLength ||
+            r.method.size() >= HTTP_PARSER_METHOD_SIZE || r.uri.size() >= HTTP_PARSER_URI_SIZE ||
+            (r.state == HttpParserState::Error) != (r.errorStatus != 0)) {
+            hostTestFail(__FILE__, __LINE__, "invariant broken for input of " +
+                         std::to_string(input.size()) + " bytes");
+            return;
+        }
+        if (r.state == HttpParserState::Complete) completed++;
+        if (r.state == HttpParserState::Error) rejected++;
+    }
+    // The mix must exercise both outcomes
+    CHECK(completed > 1000);
+    CHECK(rejected > 1000);
+}
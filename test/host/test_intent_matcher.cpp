@@ -0,0 +1,155 @@
+/**
+ * @file test_intent_matcher.cpp
+ * @brief IntentMatcher against a corpus of transcribed voice commands
+ *
+ * data/intent_corpus.txt lists transcripts with the device tool and the
+ * exact arguments they must produce, and near misses that must go to the
+ * LLM instead. A wrong local match runs the wrong command without asking,
+ * so the near misses matter as much as the hits.
+ */
+
+#include "host_test.h"
+#include "assistant/intent_matcher.h"
+#include <fstream>
+#include <vector>
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+struct CorpusEntry {
+    int line;
+    std::string transcript;
+    std::string tool;           ///< Device tool, "local" or "llm"
+    std::string input;          ///< Expected arguments (JSON, device tools only)
+};
+
+static std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    size_t last = text.find_last_not_of(" \t\r");
+    return first == std::string::npos ? "" : text.substr(first, last - first + 1);
+}
+
+static std::vector<CorpusEntry> readCorpus() {
+    std::vector<CorpusEntry> corpus;
+    std::ifstream file("data/intent_corpus.txt");
+    std::string text;
+    for (int line = 1; std::getline(file, text); line++) {
+        if (trim(text).empty() || trim(text)[0] == '#') continue;
+        size_t bar1 = text.find('|');
+        size_t bar2 = text.find('|', bar1 + 1);
+        CorpusEntry entry;
+        entry.line = line;
+        entry.transcript = trim(text.substr(0, bar1));
+        entry.tool = trim(text.substr(bar1 + 1, bar2 == std::string::npos ? std::string::npos : bar2 - bar1 - 1));
+        entry.input = bar2 == std::string::npos ? "" : trim(text.substr(bar2 + 1));
+        corpus.push_back(entry);
+    }
+    return corpus;
+}
+
+/** 10:30 AM, the time the corpus is written for */
+static void setClock(bool synced) {
+    struct tm now = {};
+    now.tm_year = 2025 - 1900;
+    now.tm_mon = 5;
+    now.tm_mday = 12;
+    now.tm_hour = 10;
+    now.tm_min = 30;
+    hostSetLocalTime(synced ? &now : nullptr);
+}
+
+//=============================================================================
+// Corpus
+//=============================================================================
+
+TEST(corpusMatchesExpectedToolAndArguments) {
+    std::vector<CorpusEntry> corpus = readCorpus();
+    CHECK(corpus.size() >= 50);
+    setClock(true);
+
+    IntentMatcher matcher;
+    uint32_t expectedMatches = 0;
+    for (const CorpusEntry& entry : corpus) {
+        IntentMatch match;
+        bool matched = matcher.match(entry.transcript.c_str(), match);
+        std::string where = "data/intent_corpus.txt:" + std::to_string(entry.line) + " \"" +
+                            entry.transcript + "\" -> ";
+
+        if (entry.tool == "llm") {
+            if (matched) {
+                hostTestFail(__FILE__, __LINE__, where + (match.tool ? match.tool : "local") +
+                             " " + match.input.c_str() + ", expected the LLM");
+            }
+            continue;
+        }
+        expectedMatches++;
+        if (!matched) {
+            hostTestFail(__FILE__, __LINE__, where + "LLM, expected " + entry.tool);
+        } else if (entry.tool == "local") {
+            if (match.tool) hostTestFail(__FILE__, __LINE__, where + match.tool + ", expected local");
+        } else if (!match.tool || entry.tool != match.tool || entry.input != match.input.c_str()) {
+            hostTestFail(__FILE__, __LINE__, where + (match.tool ? match.tool : "local") + " " +
+                         match.input.c_str() + ", expected " + entry.tool + " " + entry.input);
+        } else {
+            CHECK(match.confidence >= INTENT_MIN_CONFIDENCE);
+        }
+    }
+
+    const IntentStats& stats = matcher.getStats();
+    CHECK_EQ(stats.utterances, (uint32_t)corpus.size());
+    CHECK_EQ(stats.matches, expectedMatches);
+    CHECK(stats.nearMisses >= 3);
+    setClock(false);
+}
+
+//=============================================================================
+// Clock and Replies
+//=============================================================================
+
+TEST(timeQuestionsNeedASyncedClock) {
+    IntentMatcher matcher;
+    IntentMatch match;
+    setClock(false);
+    CHECK(!matcher.match("What time is it?", match));
+    CHECK(!matcher.match("Remind me to stretch in 20 minutes.", match));
+
+    // An absolute time needs no clock
+    CHECK(matcher.match("Remind me to call mom at 3 pm.", match));
+    CHECK_STR(match.input.c_str(), "{\"hour\":15,\"minute\":0,\"message\":\"Call mom\"}");
+
+    setClock(true);
+    CHECK(matcher.match("What time is it?", match));
+    CHECK(match.id == IntentId::TellTime);
+    CHECK_STR(matcher.formatReply(match, "").c_str(), "It's 10:30 AM.");
+
+    // "at 9" has already passed today at 10:30, so it means 9 PM
+    CHECK(matcher.match("Remind me at 9 to take out the trash.", match));
+    CHECK_EQ(match.hour, 21);
+    setClock(false);
+}
+
+TEST(repliesAreTemplatedFromTheSlots) {
+    IntentMatcher matcher;
+    IntentMatch match;
+
+    CHECK(matcher.match("Set a timer for an hour and a half.", match));
+    CHECK_STR(matcher.formatReply(match, "{\"success\":true}").c_str(), "Timer set for 1 hour 30 minutes.");
+    CHECK_STR(matcher.formatReply(match, "{\"error\":\"Timer busy\"}").c_str(), "Sorry, that didn't work.");
+
+    CHECK(matcher.match("Volume 40.", match));
+    CHECK_STR(matcher.formatReply(match, "{\"success\":true}").c_str(), "Volume set to 40.");
+
+    CHECK(matcher.match("Remind me at noon to eat lunch.", match));
+    CHECK_STR(matcher.formatReply(match, "{\"success\":true}").c_str(), "Okay, I'll remind you at 12:00 PM.");
+
+    CHECK(matcher.match("What are my reminders?", match));
+    CHECK_STR(matcher.formatReply(match, "{\"reminders\":[]}").c_str(), "You don't have any reminders.");
+    CHECK_STR(matcher.formatReply(match,
+              "{\"reminders\":[{\"message\":\"Call mom\",\"hour\":15,\"minute\":0}]}").c_str(),
+              "You have 1 reminder: Call mom at 3:00 PM.");
+
+    // The face is the answer
+    CHECK(matcher.match("Be happy!", match));
+    CHECK_STR(matcher.formatReply(match, "{\"success\":true}").c_str(), "");
+}
@@ -0,0 +1,206 @@
+/**
+ * @file test_json_response.cpp
+ * @brief sendJsonResponse() on a recording httpd_req_t: one plain send up
+ *        to JSON_RESPONSE_BUFFER_SIZE, chunks past it, abort on a failed
+ *        chunk
+ *
+ * The replies are {"pad":"xxx..."} padded to an exact length, so the
+ * boundary cases land on the buffer size byte for byte. Whatever the
+ * path, the bytes sent must be what serializeJson() gives as a String,
+ * and nothing may be allocated on the way (alloc_count.h).
+ */
+
+#include "host_test.h"
+#include "alloc_count.h"
+#include "network/json_response.h"
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+static_assert(JSON_RESPONSE_BUFFER_SIZE == 1024, "The chunk lengths below are for a 1 KB buffer");
+
+/** {"pad":""} */
+static const size_t PAD_OVERHEAD = 10;
+
+static void padTo(JsonDocument& doc, size_t bytes) {
+    doc["pad"] = std::string(bytes - PAD_OVERHEAD, 'x');
+}
+
+static std::string asString(JsonVariantConst json) {
+    String text;
+    serializeJson(json, text);
+    return text.c_str();
+}
+
+/** Chunk lengths as text, e.g. "1024 1 0" */
+static std::string chunkList(const httpd_req_t& req) {
+    std::string list;
+    for (size_t length : req.chunks) list += (list.empty() ? "" : " ") + std::to_string(length);
+    return list;
+}
+
+//=============================================================================
+// Plain and Chunked Replies
+//=============================================================================
+
+TEST(smallReplyIsOneSendWithContentLength) {
+    JsonDocument doc;
+    doc["ok"] = true;
+    doc["count"] = 3;
+    JsonResponseStats before = getJsonResponseStats();
+
+    httpd_req_t req;
+    CHECK_EQ(sendJsonResponse(&req, doc.as<JsonVariantConst>()), ESP_OK);
+    CHECK_STR(req.contentType, "application/json");
+    CHECK_STR(req.body, asString(doc.as<JsonVariantConst>()));
+    CHECK_EQ(req.sends, 1);
+    CHECK(req.chunks.empty());
+
+    const JsonResponseStats& after = getJsonResponseStats();
+    CHECK_EQ(after.responses, before.responses + 1);
+    CHECK_EQ(after.chunked, before.chunked);
+    CHECK_EQ(after.bytes, before.bytes + (uint32_t)req.body.size());
+}
+
+TEST(exactlyOneBufferIsStillOneSend) {
+    JsonDocument doc;
+    padTo(doc, JSON_RESPONSE_BUFFER_SIZE);
+    CHECK_EQ(asString(doc.as<JsonVariantConst>()).size(), (size_t)JSON_RESPONSE_BUFFER_SIZE);
+
+    httpd_req_t req;
+    CHECK_EQ(sendJsonResponse(&req, doc.as<JsonVariantConst>()), ESP_OK);
+    CHECK_EQ(req.sends, 1);
+    CHECK(req.chunks.empty());
+    CHECK_EQ(req.body.size(), (size_t)JSON_RESPONSE_BUFFER_SIZE);
+    CHECK_STR(req.body, asString(doc.as<JsonVariantConst>()));
+}
+
+TEST(oneByteMoreIsChunked) {
+    JsonDocument doc;
+    padTo(doc, JSON_RESPONSE_BUFFER_SIZE + 1);
+    JsonResponseStats before = getJsonResponseStats();
+
+    httpd_req_t req;
+    CHECK_EQ(sendJsonResponse(&req, doc.as<JsonVariantConst>()), ESP_OK);
+    CHECK_EQ(req.sends, 0);
+    CHECK_STR(chunkList(req), "1024 1 0");
+    CHECK(req.ended);
+    CHECK_STR(req.body, asString(doc.as<JsonVariantConst>()));
+
+    const JsonResponseStats& after = getJsonResponseStats();
+    CHECK_EQ(after.chunked, before.chunked + 1);
+    CHECK_EQ(after.chunks, before.chunks + 2);     // The terminator carries no data
+    CHECK(after.maxBytes >= JSON_RESPONSE_BUFFER_SIZE + 1);
+}
+
+TEST(fullBuffersAreSentWhole) {
+    static const struct {
+        size_t bytes;
+        const char* chunks;
+    } CASES[] = {
+        { 2 * JSON_RESPONSE_BUFFER_SIZE, "1024 1024 0" },
+        { 2 * JSON_RESPONSE_BUFFER_SIZE + 1, "1024 1024 1 0" },
+        { 5000, "1024 1024 1024 1024 904 0" },
+    };
+    for (const auto& c : CASES) {
+        JsonDocument doc;
+        padTo(doc, c.bytes);
+        httpd_req_t req;
+        CHECK_EQ(sendJsonResponse(&req, doc.as<JsonVariantConst>()), ESP_OK);
+        CHECK_STR(chunkList(req), c.chunks);
+        CHECK_EQ(req.body.size(), c.bytes);
+        CHECK_STR(req.body, asString(doc.as<JsonVariantConst>()));
+    }
+}
+
+//=============================================================================
+// Allocations
+//=============================================================================
+
+TEST(replyAllocatesNothing) {
+    static const struct {
+        size_t bytes;
+        const char* chunks;
+    } CASES[] = {
+        { JSON_RESPONSE_BUFFER_SIZE, "" },
+        { 5000, "1024 1024 1024 1024 904 0" },
+    };
+    for (const auto& c : CASES) {
+        JsonDocument doc;
+        padTo(doc, c.bytes);
+
+        // The recording request's own storage is reserved up front, so
+        // only the serializer and the writer are counted
+        httpd_req_t req;
+        req.contentType.reserve(64);
+        req.body.reserve(c.bytes);
+        req.chunks.reserve(8);
+
+        size_t before = hostAllocations();
+        CHECK_EQ(sendJsonResponse(&req, doc.as<JsonVariantConst>()), ESP_OK);
+        CHECK_EQ(hostAllocations() - before, (size_t)0);
+        CHECK_STR(chunkList(req), c.chunks);
+        CHECK_EQ(req.body.size(), c.bytes);
+    }
+}
+
+//=============================================================================
+// Send Errors
+//=============================================================================
+
+TEST(failedChunkAbortsTheReply) {
+    JsonDocument doc;
+    padTo(doc, 3000);
+    JsonResponseStats before = getJsonResponseStats();
+
+    // The client went away during the second chunk: nothing more is sent,
+    // not even the terminator, and the handler gets ESP_FAIL so the
+    // server closes the socket
+    httpd_req_t req;
+    req.failChunk = 1;
+    CHECK_EQ(sendJsonResponse(&req, doc.as<JsonVariantConst>()), ESP_FAIL);
+    CHECK_STR(chunkList(req), "1024 1024");
+    CHECK_EQ(req.body.size(), (size_t)JSON_RESPONSE_BUFFER_SIZE);
+    CHECK(!req.ended);
+    CHECK_EQ(getJsonResponseStats().errors, before.errors + 1);
+}
+
+TEST(failedFirstOrLastChunkIsAnErrorToo) {
+    JsonDocument doc;
+    padTo(doc, 3000);
+
+    httpd_req_t first;
+    first.failChunk = 0;
+    CHECK_EQ(sendJsonResponse(&first, doc.as<JsonVariantConst>()), ESP_FAIL);
+    CHECK_STR(chunkList(first), "1024");
+    CHECK(first.body.empty());
+
+    // Every byte went out but the terminator did not
+    httpd_req_t last;
+    last.failChunk = 3;
+    CHECK_EQ(sendJsonResponse(&last, doc.as<JsonVariantConst>()), ESP_FAIL);
+    CHECK_STR(chunkList(last), "1024 1024 952 0");
+    CHECK_EQ(last.body.size(), (size_t)3000);
+    CHECK(!last.ended);
+}
+
+TEST(writerDropsOutputAfterAnError) {
+    httpd_req_t req;
+    req.failChunk = 0;
+    HttpdJsonWriter writer(&req);
+    std::string data(JSON_RESPONSE_BUFFER_SIZE, 'x');
+
+    // Filling the buffer sends nothing yet; the next byte needs the flush
+    CHECK_EQ(writer.write((const uint8_t*)data.data(), data.size()), data.size());
+    CHECK(req.chunks.empty());
+    CHECK_EQ(writer.write('y'), (size_t)0);
+    CHECK_EQ(req.chunks.size(), (size_t)1);
+
+    CHECK_EQ(writer.write((const uint8_t*)data.data(), 10), (size_t)0);
+    CHECK_EQ(writer.write('z'), (size_t)0);
+    CHECK_EQ(req.chunks.size(), (size_t)1);
+    CHECK_EQ(writer.finish(), ESP_ERR_HTTPD_RESP_SEND);
+    CHECK_EQ(writer.getBytesWritten(), data.size());
+    CHECK_EQ(req.sends, 0);
+}
@@ -0,0 +1,221 @@
+/**
+ * @file test_llm_tool_calls.cpp
+ * @brief LLMClient tool rounds: remote calls run side by side, an ordered
+ *        call runs alone, and every result goes back in one follow-up
+ *
+ * HTTPClient is defined here: each request's body is recorded and the
+ * next scripted Claude response is queued on the pooled socket. Tool
+ * calls take virtual time (delay()); worker tasks run from the time they
+ * were started, as on their own core (stubs/freertos/task.h), so the
+ * wall time of a round is what it would be on the device.
+ */
+
+#include "host_test.h"
+#include "assistant/llm_client.h"
+#include <deque>
+#include <map>
+
+//=============================================================================
+// HTTPClient: recorded requests, scripted responses
+//=============================================================================
+
+static std::vector<std::string> requests;
+static std::deque<std::string> responses;
+static NetworkClient* httpSocket = nullptr;
+static size_t httpResponseSize = 0;
+
+bool HTTPClient::begin(NetworkClient& client, const String&) { httpSocket = &client; return true; }
+void HTTPClient::end() {}
+void HTTPClient::setTimeout(uint16_t) {}
+void HTTPClient::setReuse(bool) {}
+void HTTPClient::addHeader(const String&, const String&) {}
+void HTTPClient::collectHeaders(const char*[], size_t) {}
+String HTTPClient::header(const char*) { return ""; }
+String HTTPClient::getString() { return ""; }
+NetworkClient* HTTPClient::getStreamPtr() { return httpSocket; }
+int HTTPClient::getSize() { return (int)httpResponseSize; }
+
+int HTTPClient::sendRequest(const char*, Stream* stream, size_t size) {
+    std::string body(size, '\0');
+    stream->readBytes(&body[0], size);
+    requests.push_back(body);
+
+    if (responses.empty()) return 500;
+    httpResponseSize = responses.front().size();
+    httpSocket->receive(responses.front());
+    responses.pop_front();
+    return HTTP_CODE_OK;
+}
+
+//=============================================================================
+// Tools
+//=============================================================================
+
+static const char* const SCHEMA = "{\"type\":\"object\",\"properties\":{}}";
+
+struct ToolRun {
+    std::string name;
+    uint32_t startMs;
+    uint32_t endMs;
+};
+
+/** How long each tool takes (virtual ms) */
+static std::map<std::string, uint32_t> toolMs = {
+    { "web_search", 300 },
+    { "weather", 200 },
+    { "delete_note", 100 },
+};
+
+static std::vector<ToolRun> runs;
+
+static String runTool(const char* name, const char* input) {
+    uint32_t start = millis();
+    delay(toolMs[name]);
+    runs.push_back({ name, start, (uint32_t)millis() });
+    return String("{\"tool\":\"") + name + "\",\"input\":" + input + "}";
+}
+
+static const ToolRun* findRun(const char* name) {
+    for (const ToolRun& run : runs) {
+        if (run.name == name) return &run;
+    }
+    return nullptr;
+}
+
+/** Two remote lookups, then a destructive remote call that must run alone */
+static void addTools(LLMClient& client) {
+    client.addTool("web_search", "Search the web", SCHEMA, LLM_TOOL_REMOTE);
+    client.addTool("weather", "Current weather", SCHEMA, LLM_TOOL_REMOTE);
+    client.addTool("delete_note", "Delete a note", SCHEMA, LLM_TOOL_REMOTE | LLM_TOOL_ORDERED);
+    client.setToolExecutor(runTool);
+}
+
+static std::vector<ToolCall> threeCalls() {
+    std::vector<ToolCall> calls(3);
+    calls[0] = { "toolu_1", "web_search", "{\"q\":\"tea\"}" };
+    calls[1] = { "toolu_2", "weather", "{\"city\":\"Oslo\"}" };
+    calls[2] = { "toolu_3", "delete_note", "{\"id\":7}" };
+    return calls;
+}
+
+static void reset() {
+    requests.clear();
+    responses.clear();
+    runs.clear();
+}
+
+//=============================================================================
+// executeToolCalls
+//=============================================================================
+
+TEST(remoteCallsOverlapAndResultsKeepCallOrder) {
+    reset();
+    LLMClient client;
+    addTools(client);
+    std::vector<ToolCall> calls = threeCalls();
+    std::vector<ToolResult> results;
+
+    uint32_t start = millis();
+    client.executeToolCalls(calls, results);
+    uint32_t wallMs = millis() - start;
+
+    CHECK_EQ(results.size(), (size_t)3);
+    for (size_t i = 0; i < results.size() && i < calls.size(); i++) {
+        CHECK_STR(results[i].id.c_str(), calls[i].id.c_str());
+        CHECK_STR(results[i].content.c_str(),
+                  std::string("{\"tool\":\"") + calls[i].name.c_str() + "\",\"input\":" + calls[i].input.c_str() + "}");
+    }
+
+    // web_search and weather side by side, then delete_note on its own
+    const ToolRun* search = findRun("web_search");
+    const ToolRun* weather = findRun("weather");
+    const ToolRun* remove = findRun("delete_note");
+    CHECK(search && weather && remove);
+    if (search && weather && remove) {
+        CHECK_EQ(search->startMs, weather->startMs);
+        CHECK(remove->startMs >= search->endMs);
+        CHECK(remove->startMs >= weather->endMs);
+    }
+
+    uint32_t sequentialMs = 300 + 200 + 100;
+    CHECK_EQ(wallMs, (uint32_t)400);
+    CHECK(wallMs < sequentialMs);
+
+    const LLMToolStats& stats = client.getToolStats();
+    CHECK_EQ(stats.calls, (uint32_t)3);
+    CHECK_EQ(stats.parallelCalls, (uint32_t)2);
+    CHECK_EQ(stats.wallMs, wallMs);
+    CHECK_EQ(stats.serialMs, sequentialMs);
+}
+
+TEST(orderedCallFirstRunsBeforeTheRest) {
+    reset();
+    LLMClient client;
+    addTools(client);
+    std::vector<ToolCall> calls = threeCalls();
+    std::swap(calls[0], calls[2]);     // delete_note, weather, web_search
+    std::vector<ToolResult> results;
+
+    uint32_t start = millis();
+    client.executeToolCalls(calls, results);
+
+    // The ordered call finishes before the lookups start, which overlap
+    CHECK_EQ(millis() - start, (unsigned long)(100 + 300));
+    const ToolRun* remove = findRun("delete_note");
+    const ToolRun* weather = findRun("weather");
+    CHECK(remove && weather && weather->startMs >= remove->endMs);
+    for (size_t i = 0; i < results.size(); i++) CHECK_STR(results[i].id.c_str(), calls[i].id.c_str());
+}
+
+//=============================================================================
+// A whole tool round through send()
+//=============================================================================
+
+TEST(threeToolCallsMakeOneFollowUpRequest) {
+    reset();
+    LLMClient client;
+    CHECK(client.begin("sk-test", LLMProvider::Claude));
+    client.clearHistory();
+    client.setStreaming(false);
+    addTools(client);
+
+    responses.push_back(
+        "{\"content\":["
+        "{\"type\":\"text\",\"text\":\"[thinking] Let me check.\"},"
+        "{\"type\":\"tool_use\",\"id\":\"toolu_1\",\"name\":\"web_search\",\"input\":{\"q\":\"tea\"}},"
+        "{\"type\":\"tool_use\",\"id\":\"toolu_2\",\"name\":\"weather\",\"input\":{\"city\":\"Oslo\"}},"
+        "{\"type\":\"tool_use\",\"id\":\"toolu_3\",\"name\":\"delete_note\",\"input\":{\"id\":7}}],"
+        "\"usage\":{\"input_tokens\":900,\"output_tokens\":60}}");
+    responses.push_back(
+        "{\"content\":[{\"type\":\"text\",\"text\":\"It is 12 degrees, and the note is gone.\"}],"
+        "\"usage\":{\"input_tokens\":1000,\"output_tokens\":20}}");
+
+    LLMResponse response = client.send("What's the weather, and delete note 7");
+    CHECK(response.success);
+    CHECK(response.toolCalls.empty());
+    CHECK_STR(response.text.c_str(), "[thinking] Let me check. It is 12 degrees, and the note is gone.");
+    CHECK_EQ(runs.size(), (size_t)3);
+
+    // The question, then exactly one request carrying all three results
+    CHECK_EQ(requests.size(), (size_t)2);
+    CHECK_EQ(client.getToolStats().roundTrips, (uint32_t)1);
+    if (requests.size() == 2) {
+        JsonDocument body;
+        CHECK(!deserializeJson(body, requests[1].c_str()));
+        JsonArray messages = body["messages"];
+        CHECK_EQ(messages.size(), (size_t)3);      // question, tool_use, tool_results
+
+        JsonObject last = messages[messages.size() - 1];
+        CHECK_STR(last["role"].as<const char*>(), "user");
+        JsonArray blocks = last["content"];
+        CHECK_EQ(blocks.size(), (size_t)3);
+        const char* ids[] = { "toolu_1", "toolu_2", "toolu_3" };
+        const char* names[] = { "web_search", "weather", "delete_note" };
+        for (size_t i = 0; i < 3 && i < blocks.size(); i++) {
+            CHECK_STR(blocks[i]["type"].as<const char*>(), "tool_result");
+            CHECK_STR(blocks[i]["tool_use_id"].as<const char*>(), ids[i]);
+            CHECK(strstr(blocks[i]["content"].as<const char*>(), names[i]) != nullptr);
+        }
+    }
+    client.end();
+}
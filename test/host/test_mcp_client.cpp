@@ -0,0 +1,299 @@
+/**
+ * @file test_mcp_client.cpp
+ * @brief MCPClient tool cache and discovery: lists survive a reboot,
+ *        corrupt or outdated entries are dropped, a dead server costs one
+ *        deadline
+ *
+ * HTTPClient is defined here and answers from a table of scripted
+ * servers, keyed by host: a live server replies to the batched
+ * initialize + tools/list after its latency, a dead one never accepts
+ * and the connect fails once the client's connect timeout has passed.
+ * A "reboot" is a fresh MCPClient over the same Preferences and the
+ * LittleFS image in build/littlefs.
+ */
+
+#include "host_test.h"
+#include "assistant/mcp_client.h"
+#include <Preferences.h>
+#include <LittleFS.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <vector>
+
+//=============================================================================
+// HTTPClient: scripted servers
+//=============================================================================
+
+struct ScriptedServer {
+    std::string toolsJson;      ///< Contents of result.tools
+    uint32_t latencyMs;
+    bool dead;
+};
+
+static std::map<std::string, ScriptedServer> scriptedServers;
+static std::vector<std::string> requestUrls;
+
+/** Per-HTTPClient request state (the stub class has no members) */
+struct Exchange {
+    std::string url;
+    uint32_t connectTimeoutMs = 0;
+    NetworkClient socket;
+    size_t size = 0;
+};
+static std::map<HTTPClient*, Exchange> exchanges;
+
+static std::string hostOf(const std::string& url) {
+    size_t start = url.find("://");
+    start = start == std::string::npos ? 0 : start + 3;
+    size_t end = url.find_first_of(":/", start);
+    return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+bool HTTPClient::begin(NetworkClient&, const String& url) { return begin(url); }
+bool HTTPClient::begin(const String& url) {
+    exchanges[this] = Exchange();
+    exchanges[this].url = url.c_str();
+    return true;
+}
+void HTTPClient::end() { exchanges[this].socket.stop(); }
+void HTTPClient::setTimeout(uint16_t) {}
+void HTTPClient::setConnectTimeout(int32_t timeout) { exchanges[this].connectTimeoutMs = timeout; }
+void HTTPClient::setReuse(bool) {}
+void HTTPClient::addHeader(const String&, const String&) {}
+void HTTPClient::collectHeaders(const char*[], size_t) {}
+String HTTPClient::header(const char*) { return ""; }
+bool HTTPClient::hasHeader(const char*) { return false; }
+String HTTPClient::getString() { return ""; }
+NetworkClient* HTTPClient::getStreamPtr() { return &exchanges[this].socket; }
+int HTTPClient::getSize() { return (int)exchanges[this].size; }
+int HTTPClient::GET() { return POST(String()); }
+
+int HTTPClient::POST(const String&) {
+    Exchange& exchange = exchanges[this];
+    requestUrls.push_back(exchange.url);
+
+    auto it = scriptedServers.find(hostOf(exchange.url));
+    if (it == scriptedServers.end() || it->second.dead) {
+        delay(exchange.connectTimeoutMs);
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    delay(it->second.latencyMs);
+    std::string reply =
+        "[{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{\"protocolVersion\":\"2025-03-26\"}},"
+        "{\"jsonrpc\":\"2.0\",\"id\":2,\"result\":{\"tools\":" + it->second.toolsJson + "}}]";
+    exchange.size = reply.size();
+    exchange.socket.receive(reply);
+    return HTTP_CODE_OK;
+}
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+static const char* const HOME_TOOLS =
+    "[{\"name\":\"lights_on\",\"description\":\"Turn on a light\","
+    "\"inputSchema\":{\"type\":\"object\",\"properties\":{\"room\":{\"type\":\"string\"}}}},"
+    "{\"name\":\"lock_door\",\"description\":\"Lock the front door\","
+    "\"inputSchema\":{\"type\":\"object\",\"properties\":{}},"
+    "\"annotations\":{\"destructiveHint\":true}}]";
+
+static const char* const CALENDAR_TOOLS =
+    "[{\"name\":\"list_events\",\"description\":\"Today's events\","
+    "\"inputSchema\":{\"type\":\"object\",\"properties\":{}}}]";
+
+static const char* const ATTIC_TOOLS =
+    "[{\"name\":\"fan_speed\",\"description\":\"Set the attic fan\","
+    "\"inputSchema\":{\"type\":\"object\",\"properties\":{\"speed\":{\"type\":\"integer\"}}}}]";
+
+/** Same flash, no servers configured, every server up */
+static void reset() {
+    LittleFS.format();
+    Preferences prefs;
+    prefs.begin("mcp_client", false);
+    prefs.clear();
+    prefs.end();
+
+    scriptedServers.clear();
+    scriptedServers["home.local"] = { HOME_TOOLS, 150, false };
+    scriptedServers["cal.local"] = { CALENDAR_TOOLS, 150, false };
+    scriptedServers["attic.local"] = { ATTIC_TOOLS, 150, false };
+    requestUrls.clear();
+}
+
+/** Configure servers by host, fetch their tools (writing the cache) and shut down */
+static void firstBoot(const std::vector<const char*>& hosts) {
+    MCPClient client;
+    client.begin();
+    for (const std::string host : hosts) {
+        client.addServer(host.substr(0, host.find('.')).c_str(), ("http://" + host + ":8080").c_str());
+    }
+    client.discoverTools();
+    client.end();
+}
+
+static std::string cachePath() {
+    return LittleFS.hostPath(MCP_TOOL_CACHE_PATH);
+}
+
+static size_t cacheSize() {
+    std::error_code ec;
+    size_t size = std::filesystem::file_size(cachePath(), ec);
+    return ec ? 0 : size;
+}
+
+static void flipByte(size_t offset) {
+    std::fstream file(cachePath(), std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(offset);
+    char c = file.get();
+    file.seekp(offset);
+    file.put(c ^ 0x20);
+}
+
+static std::vector<std::string> toolNames(const MCPClient& client) {
+    std::vector<std::string> names;
+    for (const MCPRemoteTool& tool : client.getTools()) names.push_back(tool.name.c_str());
+    return names;
+}
+
+//=============================================================================
+// Tool cache
+//=============================================================================
+
+TEST(toolListsSurviveAReboot) {
+    reset();
+    firstBoot({ "home.local", "cal.local" });
+    CHECK(LittleFS.exists(MCP_TOOL_CACHE_PATH));
+    CHECK(!LittleFS.exists(MCP_TOOL_CACHE_TEMP_PATH));
+    size_t fetches = requestUrls.size();
+    CHECK_EQ(fetches, (size_t)2);
+
+    MCPClient client;
+    client.begin();
+    CHECK_EQ(requestUrls.size(), fetches);     // No request at boot
+    CHECK_EQ(client.getToolCount(), 3);
+    CHECK_EQ(client.getDiscoveryStats().cachedTools, (uint32_t)3);
+
+    const MCPRemoteTool* lights = client.findTool("home_lights_on");
+    const MCPRemoteTool* lock = client.findTool("home_lock_door");
+    const MCPRemoteTool* events = client.findTool("cal_list_events");
+    CHECK(lights && lock && events);
+    if (lights && lock && events) {
+        CHECK_STR(lights->description.c_str(), "Turn on a light");
+        CHECK_STR(lights->inputSchema.c_str(),
+                  "{\"type\":\"object\",\"properties\":{\"room\":{\"type\":\"string\"}}}");
+        CHECK(!lights->ordered);
+        CHECK(lock->ordered);
+        CHECK_EQ(lights->serverIndex, 0);
+        CHECK_EQ(events->serverIndex, 1);
+    }
+    for (int i = 0; i < client.getServerCount(); i++) {
+        CHECK(client.getServer(i)->toolsCached);
+        CHECK(client.getServer(i)->connected);
+        CHECK(client.getServer(i)->toolsFetchedAt > 0);
+    }
+    client.end();
+}
+
+TEST(corruptEntryEndsTheLoad) {
+    reset();
+    firstBoot({ "home.local", "cal.local" });
+
+    // The calendar's entry is last; its final byte is a tool's flags
+    flipByte(cacheSize() - 1);
+    {
+        MCPClient client;
+        client.begin();
+        CHECK((toolNames(client) == std::vector<std::string>{ "home_lights_on", "home_lock_door" }));
+        CHECK(client.getServer(0)->toolsCached);
+        CHECK(!client.getServer(1)->toolsCached);
+        CHECK(!client.getServer(1)->connected);
+        client.end();
+    }
+
+    // Cut inside the first entry's tools: nothing is trusted
+    std::filesystem::resize_file(cachePath(), 4 + 18 + 10);
+    {
+        MCPClient client;
+        client.begin();
+        CHECK_EQ(client.getToolCount(), 0);
+        CHECK_EQ(client.getDiscoveryStats().cachedTools, (uint32_t)0);
+        client.end();
+    }
+
+    // A file from another format version is ignored whole
+    reset();
+    firstBoot({ "home.local" });
+    flipByte(0);
+    {
+        MCPClient client;
+        client.begin();
+        CHECK_EQ(client.getToolCount(), 0);
+        client.end();
+    }
+}
+
+TEST(changedServerDropsItsCachedTools) {
+    reset();
+    firstBoot({ "home.local", "cal.local" });
+
+    // Point the calendar at another host, as the web UI would
+    {
+        MCPClient client;
+        client.begin();
+        client.updateServer(1, "cal", "http://cal2.local:8080", "");
+        client.end();
+    }
+
+    MCPClient client;
+    client.begin();
+    CHECK((toolNames(client) == std::vector<std::string>{ "home_lights_on", "home_lock_door" }));
+    CHECK(!client.getServer(1)->toolsCached);
+
+    // Its tools come back from the new host once fetched
+    scriptedServers["cal2.local"] = { CALENDAR_TOOLS, 150, false };
+    CHECK(client.discoverServerTools(1));
+    CHECK(client.findTool("cal_list_events") != nullptr);
+    client.end();
+}
+
+//=============================================================================
+// Discovery
+//=============================================================================
+
+TEST(deadServerCostsOneDeadline) {
+    reset();
+    firstBoot({ "attic.local", "home.local", "cal.local" });
+    scriptedServers["attic.local"].dead = true;
+
+    MCPClient client;
+    client.begin();
+    CHECK_EQ(client.getToolCount(), 4);
+
+    uint32_t start = millis();
+    client.discoverTools();
+    uint32_t wallMs = millis() - start;
+
+    // The attic's connect runs into the discovery deadline while the
+    // other workers fetch the live servers
+    uint32_t sequentialMs = MCP_DISCOVERY_TIMEOUT_MS + 150 + 150;
+    CHECK_EQ(wallMs, (uint32_t)MCP_DISCOVERY_TIMEOUT_MS);
+    CHECK(wallMs < sequentialMs);
+    CHECK_EQ(client.getDiscoveryStats().lastRunMs, wallMs);
+
+    const MCPServerConfig* attic = client.getServer(0);
+    CHECK(!attic->connected);
+    CHECK_STR(attic->lastError.c_str(), "No response from server");
+    CHECK(client.findTool("attic_fan_speed") != nullptr);  // Cached list stays
+    for (int i = 1; i < client.getServerCount(); i++) {
+        CHECK(client.getServer(i)->connected);
+        CHECK(!client.getServer(i)->toolsCached);
+    }
+
+    const MCPDiscoveryStats& stats = client.getDiscoveryStats();
+    CHECK_EQ(stats.serversFetched, (uint32_t)2);
+    CHECK_EQ(stats.serversFailed, (uint32_t)1);
+    CHECK_EQ(stats.unchangedLists, (uint32_t)2);
+    client.end();
+}
@@ -0,0 +1,303 @@
+/**
+ * @file test_stream_replay.cpp
+ * @brief Recorded Claude / OpenAI streams replayed through HttpChunkDecoder
+ *        and SSEParser, split every way a socket could split them
+ *
+ * data/claude_stream.sse and data/openai_stream.sse are streamed response
+ * bodies as the APIs send them. Each replay chunk-encodes the body with
+ * random chunk sizes, cuts the result into random socket reads and runs
+ * it through the same loop LLMClient::streamRequest() uses, so chunk
+ * headers, event boundaries and CRLF pairs land inside and across reads.
+ * The events must come out exactly as from the whole body in one feed.
+ */
+
+#include "host_test.h"
+#include "assistant/sse_parser.h"
+#include "network/connection_manager.h"
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+/** Read buffer of LLMClient::streamRequest() (LLM_STREAM_READ_SIZE) */
+static const size_t STREAM_READ_SIZE = 512;
+
+struct Replay {
+    std::vector<std::pair<std::string, std::string>> events;
+    uint32_t dropped = 0;
+    bool complete = false;      ///< Terminating chunk seen
+    bool malformed = false;     ///< Chunk decoder error
+};
+
+static std::string readFixture(const char* name) {
+    std::ifstream file(std::string("data/") + name, std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+static std::string withCRLF(const std::string& body) {
+    std::string out;
+    for (char c : body) {
+        if (c == '\n') out += '\r';
+        out += c;
+    }
+    return out;
+}
+
+/** Chunked transfer encoding with 1..maxChunk byte chunks */
+static std::string chunkEncode(const std::string& body, std::mt19937& rng, size_t maxChunk) {
+    std::string out;
+    char size[24];
+    for (size_t offset = 0; offset < body.size();) {
+        size_t n = std::min(body.size() - offset, 1 + rng() % maxChunk);
+        snprintf(size, sizeof(size), rng() % 2 ? "%zx" : "%zX", n);
+        out += size;
+        if (rng() % 8 == 0) out += ";ext=1";
+        out += "\r\n";
+        out.append(body, offset, n);
+        out += "\r\n";
+        offset += n;
+    }
+    return out + "0\r\n\r\n";
+}
+
+/** Queue bytes on the client as socket reads of 1..maxPiece bytes */
+static void receiveInPieces(NetworkClient& client, const std::string& bytes,
+                            std::mt19937& rng, size_t maxPiece) {
+    for (size_t offset = 0; offset < bytes.size();) {
+        size_t n = std::min(bytes.size() - offset, 1 + rng() % maxPiece);
+        client.receive(bytes.substr(offset, n));
+        offset += n;
+    }
+}
+
+/** The read loop of LLMClient::streamRequest(), minus the HTTP client */
+static Replay replay(NetworkClient& client, bool chunked) {
+    Replay r;
+    SSEParser parser;
+    HttpChunkDecoder decoder;
+    parser.onEvent([&r](const char* event, const char* data) {
+        r.events.emplace_back(event, data);
+    });
+
+    uint8_t buf[STREAM_READ_SIZE];
+    while (true) {
+        size_t available = client.available();
+        if (available > 0) {
+            int bytesRead = client.read(buf, std::min(available, sizeof(buf)));
+            if (bytesRead > 0) {
+                size_t payload = chunked ? decoder.decode(buf, bytesRead) : bytesRead;
+                if (decoder.hasError()) {
+                    r.malformed = true;
+                    break;
+                }
+                parser.feed(buf, payload);
+                if (decoder.isComplete()) {
+                    r.complete = true;
+                    break;
+                }
+            }
+            continue;
+        }
+        if (!client.connected()) break;
+        delay(1);
+    }
+    parser.finish();
+    r.dropped = parser.getDroppedCount();
+    return r;
+}
+
+static Replay replayWhole(const std::string& body) {
+    Replay r;
+    SSEParser parser;
+    parser.onEvent([&r](const char* event, const char* data) {
+        r.events.emplace_back(event, data);
+    });
+    parser.feed((const uint8_t*)body.data(), body.size());
+    parser.finish();
+    r.dropped = parser.getDroppedCount();
+    return r;
+}
+
+/** Concatenate every "key":"..." string value in the event data */
+static std::string joinField(const Replay& r, const char* key) {
+    std::string needle = std::string("\"") + key + "\":\"";
+    std::string out;
+    for (const auto& event : r.events) {
+        const std::string& data = event.second;
+        size_t pos = data.find(needle);
+        if (pos == std::string::npos) continue;
+        for (size_t i = pos + needle.size(); i < data.size() && data[i] != '"'; i++) {
+            if (data[i] == '\\' && i + 1 < data.size()) i++;
+            out += data[i];
+        }
+    }
+    return out;
+}
+
+/** Replay a body under many chunkings and read splits; all must match whole */
+static bool replaysLikeWhole(const std::string& body, std::mt19937& rng) {
+    Replay whole = replayWhole(body);
+    for (size_t maxChunk : {1, 3, 16, 100, 4096}) {
+        for (size_t maxPiece : {1, 2, 7, 64, 600}) {
+            for (int k = 0; k < 20; k++) {
+                NetworkClient client;
+                receiveInPieces(client, chunkEncode(body, rng, maxChunk), rng, maxPiece);
+                Replay split = replay(client, true);
+                if (!split.complete || split.malformed || split.dropped != whole.dropped ||
+                    split.events != whole.events || client.available() != 0) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+//=============================================================================
+// Recorded Streams
+//=============================================================================
+
+TEST(claudeStreamEvents) {
+    Replay r = replayWhole(readFixture("claude_stream.sse"));
+    CHECK_EQ(r.events.size(), 14u);
+    CHECK_EQ(r.dropped, 0u);
+    CHECK_STR(r.events.front().first, "message_start");
+    CHECK_STR(r.events[2].first, "ping");
+    CHECK_STR(r.events.back().first, "message_stop");
+    CHECK_STR(joinField(r, "text"), "[happy] Sure, five minutes starting now.");
+    CHECK_STR(joinField(r, "partial_json"), "{\"duration_seconds\": 300, \"name\": \"tea\"}");
+}
+
+TEST(openAIStreamEvents) {
+    Replay r = replayWhole(readFixture("openai_stream.sse"));
+    CHECK_EQ(r.events.size(), 7u);              // The keep-alive comment is not an event
+    CHECK_EQ(r.dropped, 0u);
+    CHECK_STR(r.events.front().first, "message");
+    CHECK_STR(r.events.back().second, "[DONE]");
+    CHECK_STR(joinField(r, "content"), "[curious] It is 3:42 PM right now.");
+}
+
+//=============================================================================
+// Split Replays
+//=============================================================================
+
+TEST(claudeStreamAnySplitReplaysLikeWhole) {
+    std::mt19937 rng(1);
+    std::string body = readFixture("claude_stream.sse");
+    CHECK(!body.empty());
+    CHECK(replaysLikeWhole(body, rng));
+    CHECK(replaysLikeWhole(withCRLF(body), rng));
+}
+
+TEST(openAIStreamAnySplitReplaysLikeWhole) {
+    std::mt19937 rng(2);
+    std::string body = readFixture("openai_stream.sse");
+    CHECK(!body.empty());
+    CHECK(replaysLikeWhole(body, rng));
+    CHECK(replaysLikeWhole(withCRLF(body), rng));
+}
+
+TEST(crlfSplitAcrossReadsEndsOneLine) {
+    // "\r" closing one read and "\n" opening the next is a single line end
+    NetworkClient client;
+    client.receive("data: a\r");
+    client.receive("\n\r");
+    client.receive("\ndata: b\r\n\r\n");
+    client.closeAfterReceive();
+    Replay r = replay(client, false);
+    CHECK_EQ(r.events.size(), 2u);
+    CHECK_STR(r.events[0].second, "a");
+    CHECK_STR(r.events[1].second, "b");
+}
+
+TEST(identityStreamEndsWhenSocketCloses) {
+    std::mt19937 rng(3);
+    std::string body = readFixture("openai_stream.sse");
+    NetworkClient client;
+    receiveInPieces(client, body, rng, 40);
+    client.closeAfterReceive();
+    Replay r = replay(client, false);
+    CHECK(!r.complete);
+    CHECK(r.events == replayWhole(body).events);
+}
+
+TEST(oversizedLineIsDroppedAndStreamContinues) {
+    std::mt19937 rng(4);
+    std::string body = "event: content_block_delta\ndata: " + std::string(SSE_MAX_LINE_LENGTH + 500, 'x') +
+                       "\n\n" + readFixture("claude_stream.sse");
+    Replay whole = replayWhole(body);
+    CHECK_EQ(whole.dropped, 1u);
+    CHECK_EQ(whole.events.size(), 14u);
+    CHECK(replaysLikeWhole(body, rng));
+}
+
+TEST(truncatedChunkedStreamIsIncomplete) {
+    std::mt19937 rng(5);
+    std::string body = readFixture("claude_stream.sse");
+    std::string encoded = chunkEncode(body, rng, 100);
+    NetworkClient client;
+    receiveInPieces(client, encoded.substr(0, encoded.size() / 2), rng, 64);
+    client.closeAfterReceive();
+    Replay r = replay(client, true);
+    CHECK(!r.complete);
+    CHECK(!r.malformed);
+    CHECK(r.events.size() < 14u);
+}
+
+TEST(malformedChunkSizeStopsTheStream) {
+    NetworkClient client;
+    client.receive("5\r\ndata:\r\nzz\r\n");
+    Replay r = replay(client, true);
+    CHECK(r.malformed);
+    CHECK(!r.complete);
+}
+
+//=============================================================================
+// HttpBodyStream
+//=============================================================================
+
+TEST(bodyStreamReadsChunkedBodyAcrossReads) {
+    std::mt19937 rng(6);
+    std::string body = readFixture("claude_stream.sse");
+    for (size_t maxPiece : {1, 5, 300, 5000}) {
+        NetworkClient client;
+        receiveInPieces(client, chunkEncode(body, rng, 200), rng, maxPiece);
+        HttpBodyStream stream(&client, true, -1, 1000);
+
+        std::string received(body.size() + 16, '\0');
+        size_t n = stream.readBytes(&received[0], received.size());
+        received.resize(n);
+        CHECK(received == body);
+        CHECK(stream.isComplete());
+        CHECK(!stream.hasError());
+        CHECK_EQ(client.available(), 0);
+    }
+}
+
+TEST(bodyStreamStopsAtContentLength) {
+    // Bytes past Content-Length belong to the next response on the socket
+    std::string body = readFixture("openai_stream.sse");
+    NetworkClient client;
+    client.receive(body.substr(0, 100));
+    client.receive(body.substr(100) + "HTTP/1.1 200 OK\r\n");
+    HttpBodyStream stream(&client, false, (int)body.size(), 1000);
+    CHECK(stream.drain(1000));
+    CHECK_EQ(client.available(), 17);
+}
+
+TEST(bodyStreamGivesUpOnStalledSocket) {
+    NetworkClient client;
+    client.receive("a\r\n0123");
+    HttpBodyStream stream(&client, true, -1, 250);
+    char buf[32];
+    unsigned long start = millis();
+    CHECK_EQ(stream.readBytes(buf, sizeof(buf)), 4u);
+    CHECK(!stream.isComplete());
+    CHECK(millis() - start >= 250);
+}